@@ -12,6 +12,7 @@
 #include <ErrorHandler/ErrorHandler.h>
 #include <ClassName.h>
 #include "time/getMillis.hpp"
+#include "time/TimeService.hpp"
 #include "WatchDog/WatchDogUtils.hpp"
 #include "PacketQueue/PacketQueue.hpp"
 #include "SharedMemory/SharedMemory.hpp"
@@ -30,6 +31,8 @@
 
 // ------------------ STORAGE ------------------
 #include <StorageManager/StorageManager.hpp>
+#include <StorageManager/InstrumentedStorageManager/InstrumentedStorageManager.hpp>
+#include <StorageManager/DeferredStorageManager/DeferredStorageManager.hpp>
 
 // ------------------ PORTS ------------------
 #include <Ports/IPort.h>
@@ -107,6 +110,7 @@
 
 // ------------------ STORAGE ------------------
 #include <StorageManager/HDDStorageManager/HddStorageManager.hpp>
+#include <StorageManager/FdStorageManager/FdStorageManager.hpp>
 
 // ------------------ BATTERY ------------------
 #include <MockBatteryController/MockBatteryController.h>
@@ -1,174 +1,1616 @@
 #include "PacketQueue.hpp"
 
 #include <cstdio>
+#include <cstring>
 
 #include "SharedMemory/SharedMemory.hpp"
 #include "BinaryFrame/BinaryFrame.hpp"
 #include "Logger/Logger.h"
+#include "time/getMillis.hpp"
+#include "ProtoUtils/ProtoUtils.hpp"
 
-PacketQueue::PacketQueue(StorageManager& storage, RTCController& rtc) : storage_(storage), rtc_(rtc), writeOffset_{0}
+namespace
 {
+    void writeLE16(uint8_t* out, const uint16_t value) noexcept
+    {
+        out[0] = static_cast<uint8_t>(value & 0xFF);
+        out[1] = static_cast<uint8_t>((value >> 8) & 0xFF);
+    }
+
+    void writeLE32(uint8_t* out, const uint32_t value) noexcept
+    {
+        out[0] = static_cast<uint8_t>(value & 0xFF);
+        out[1] = static_cast<uint8_t>((value >> 8) & 0xFF);
+        out[2] = static_cast<uint8_t>((value >> 16) & 0xFF);
+        out[3] = static_cast<uint8_t>((value >> 24) & 0xFF);
+    }
+
+    uint16_t readLE16(const uint8_t* in) noexcept
+    {
+        return static_cast<uint16_t>(in[0] | in[1] << 8);
+    }
+
+    uint32_t readLE32(const uint8_t* in) noexcept
+    {
+        return static_cast<uint32_t>(in[0])
+            | static_cast<uint32_t>(in[1]) << 8
+            | static_cast<uint32_t>(in[2]) << 16
+            | static_cast<uint32_t>(in[3]) << 24;
+    }
+
+    // File name suffix of each lane. Bulk keeps the original names ("/queue1.00A")
+    constexpr const char* LANE_SUFFIX[] = {"c", "r", ""};
+}
+
+PacketQueue::PacketQueue(StorageManager& storage, RTCController& rtc, const PacketQueueConfig& config)
+    : storage_(storage), rtc_(rtc), config_(config)
+{
+}
+
+PacketQueue::Priority PacketQueue::priorityOf(const uint8_t* data, const size_t length)
+{
+    switch (ProtoUtils::CommunicationPacket::peekBodyTag(data, length))
+    {
+    case acousea_CommunicationPacket_command_tag:
+    case acousea_CommunicationPacket_error_tag:
+        return Priority::Control;
+    case acousea_CommunicationPacket_response_tag:
+    case acousea_CommunicationPacket_report_tag:
+        return Priority::Report;
+    default:
+        return Priority::Bulk;
+    }
+}
+
+void PacketQueue::segmentPath(const uint8_t stream, const uint16_t segment, char* outPath,
+                              const size_t outPathSize) const
+{
+    // 8.3 compatible: "/queue1.00A" (bulk), "/queue1c.00A" (control)
+    snprintf(outPath, outPathSize, "%s%u%s.%03X", queueBaseName_, portOf(stream), LANE_SUFFIX[laneOf(stream)],
+             static_cast<unsigned int>(segment));
+}
+
+void PacketQueue::cursorPath(const uint8_t stream, const uint8_t slot, char* outPath, const size_t outPathSize) const
+{
+    // Slot 0 keeps the name of the single cursor file of older firmware: "/queue1.cur", "/queue1.cub"
+    snprintf(outPath, outPathSize, "%s%u%s.%s", queueBaseName_, portOf(stream), LANE_SUFFIX[laneOf(stream)],
+             slot == 0 ? "cur" : "cub");
+}
+
+void PacketQueue::indexPath(const uint8_t stream, const uint16_t segment, char* outPath,
+                            const size_t outPathSize) const
+{
+    // 8.3 compatible: "/qidx1.00A" (bulk), "/qidx1c.00A" (control)
+    snprintf(outPath, outPathSize, "%s%u%s.%03X", indexBaseName_, portOf(stream), LANE_SUFFIX[laneOf(stream)],
+             static_cast<unsigned int>(segment));
+}
+
+bool PacketQueue::begin()
+{
+    stagedLength_ = 0;
+    stagedCount_ = 0;
+    stagedStream_ = NO_STREAM;
+    peekedBatch_ = PeekedBatch{};
+    memset(selectedLane_, NO_LANE, sizeof(selectedLane_));
+    memset(laneCredits_, 0, sizeof(laneCredits_));
+    for (auto& counters : dropCounters_)
+    {
+        counters = DropCounters{};
+    }
+
+    // Revisar cada carril de cada puerto
+    for (uint8_t stream = 0; stream < STREAM_COUNT; stream++)
+    {
+        if (!beginStream(stream))
+        {
+            return false;
+        }
+    }
+
+    LOG_CLASS_INFO("PacketQueue::begin() -> All queues initialized");
+    return true;
+}
+
+bool PacketQueue::beginStream(const uint8_t stream)
+{
+    const uint8_t port = portOf(stream);
+    char path[32];
+    auto& cursor = cursors_[stream];
+    cursor = StreamCursor{};
+    indexWindows_[port] = IndexWindow{};
+
+    if (loadCursor(stream))
+    {
+        // Cursor persistido -> reanudar donde se quedó la lectura
+        segmentPath(stream, cursor.writeSegment, path, sizeof(path));
+        bool created = false;
+        if (!storage_.fileExists(path) && !createSegment(stream, cursor.writeSegment, created))
+        {
+            return false;
+        }
+        cursor.writeOffset = static_cast<uint32_t>(storage_.fileSize(path));
+        // A preallocated segment is as large as its extent: its logical end is found through the index below
+        cursor.preallocated = usesPreallocation() && cursor.writeOffset == SEGMENT_MAX_BYTES;
+
+        if (config_.frameIndex)
+        {
+            // Frames appended right before a reset may be missing from the index of the write segment
+            indexPath(stream, cursor.writeSegment, path, sizeof(path));
+            // fileExists() first: fileSize() of a missing file is logged as an error by the SD/Fd backends
+            const bool indexExists = storage_.fileExists(path);
+            uint32_t end = 0;
+            if (!indexExists || storage_.fileSize(path) % INDEX_RECORD_SIZE != 0)
+            {
+                LOG_CLASS_WARNING("PacketQueue::begin() -> Port %u: rebuilding index %s", port, path);
+                if (!storage_.createEmptyFile(path))
+                {
+                    LOG_CLASS_ERROR("PacketQueue::begin() -> Cannot create file: %s", path);
+                    return false;
+                }
+            }
+            else
+            {
+                end = indexedEnd(stream, cursor.writeSegment);
+            }
+            if (end < cursor.writeOffset)
+            {
+                uint32_t scannedEnd = end;
+                (void)scanSegment(stream, cursor.writeSegment, end, cursor.writeOffset, true, &scannedEnd);
+                if (cursor.preallocated)
+                {
+                    cursor.writeOffset = scannedEnd; // The rest of the extent was never written
+                }
+            }
+        }
+
+        if (cursor.readSegment != cursor.writeSegment)
+        {
+            cursor.readSegmentEnd = closedSegmentEnd(stream, cursor.readSegment);
+        }
+
+        const uint32_t readLimit = (cursor.readSegment == cursor.writeSegment)
+                                       ? cursor.writeOffset
+                                       : cursor.readSegmentEnd;
+        if (cursor.readOffset > readLimit)
+        {
+            segmentPath(stream, cursor.readSegment, path, sizeof(path));
+            LOG_CLASS_WARNING("PacketQueue::begin() -> %s: read offset beyond segment end, clamping", path);
+            cursor.readOffset = readLimit;
+        }
+        cursor.nextReadOffset = cursor.readOffset;
+
+        return compactStream(stream) && rebuildPendingCounters(stream);
+    }
+
+    // Both cursor slots torn but the segments are there: rebuild the cursor from them instead of starting over
+    if (findSurvivingSegments(stream))
+    {
+        return resyncStream(stream);
+    }
+
+    // Sin cursor: formato antiguo ("/queueN" sin segmentos, solo carril bulk) o primera ejecución.
+    // The legacy file was always treated as fully consumed on boot, so it is simply reclaimed.
+    snprintf(path, sizeof(path), "%s%u", queueBaseName_, port);
+    if (laneOf(stream) == static_cast<uint8_t>(Priority::Bulk) && storage_.fileExists(path))
+    {
+        LOG_CLASS_WARNING("PacketQueue::begin() -> Port %u: removing legacy queue file %s", port, path);
+        if (!storage_.deleteFile(path))
+        {
+            LOG_CLASS_ERROR("PacketQueue::begin() -> Cannot delete legacy file: %s", path);
+        }
+    }
+
+    if (!createSegment(stream, 0, cursor.preallocated))
+    {
+        return false;
+    }
+    indexPath(stream, 0, path, sizeof(path));
+    if (config_.frameIndex && !storage_.createEmptyFile(path))
+    {
+        LOG_CLASS_ERROR("PacketQueue::begin() -> Cannot create file: %s", path);
+        return false;
+    }
+    return persistCursor(stream);
+}
+
+bool PacketQueue::clear(uint8_t port)
+{
+    if (port == 0 || port > MAX_PORT)
+        return false;
+
+    for (uint8_t lane = 0; lane < LANE_COUNT; lane++)
+    {
+        if (!clearStream(streamOf(port, lane)))
+        {
+            return false;
+        }
+    }
+    selectedLane_[port] = NO_LANE;
+    indexWindows_[port] = IndexWindow{};
+    return true;
+}
+
+bool PacketQueue::clearStream(const uint8_t stream)
+{
+    char path[32];
+    auto& cursor = cursors_[stream];
+
+    // Los frames en staging de este carril también se descartan
+    if (stagedStream_ == stream)
+    {
+        stagedLength_ = 0;
+        stagedCount_ = 0;
+        stagedStream_ = NO_STREAM;
+    }
+
+    // Borrar todos los segmentos vivos del carril (y sus índices)
+    for (uint16_t segment = cursor.readSegment;; segment = nextSegment(segment))
+    {
+        segmentPath(stream, segment, path, sizeof(path));
+        if (storage_.fileExists(path) && !storage_.deleteFile(path))
+        {
+            return false;
+        }
+        indexPath(stream, segment, path, sizeof(path));
+        if (storage_.fileExists(path) && !storage_.deleteFile(path))
+        {
+            return false;
+        }
+        if (segment == cursor.writeSegment)
+            break;
+    }
+
+    // The sequence goes on: the slot written next must not be older than the other one
+    const uint32_t cursorSequence = cursor.cursorSequence;
+    cursor = StreamCursor{};
+    cursor.cursorSequence = cursorSequence;
+    laneCredits_[stream] = 0;
+    if (peekedBatch_.stream == stream)
+    {
+        peekedBatch_ = PeekedBatch{};
+    }
+
+    if (const bool createOK = createSegment(stream, 0, cursor.preallocated); !createOK)
+    {
+        return false;
+    }
+    indexPath(stream, 0, path, sizeof(path));
+    if (config_.frameIndex && !storage_.createEmptyFile(path))
+    {
+        return false;
+    }
+
+    return persistCursor(stream);
+}
+
+bool PacketQueue::isEmpty() const
+{
+    for (uint8_t port = 1; port <= MAX_PORT; port++)
+    {
+        if (!isPortEmpty(port))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool PacketQueue::arePortsEmpty(const uint8_t* ports, const size_t portCount) const
+{
+    if (!ports || portCount == 0)
+        return true;
+
+    for (size_t i = 0; i < portCount; i++)
+    {
+        const uint8_t port = ports[i];
+        if (port == 0 || port > MAX_PORT)
+            continue;
+
+        if (!isPortEmpty(port))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool PacketQueue::isPortEmpty(uint8_t port) const
+{
+    if (port == 0 || port > MAX_PORT)
+        return true;
+
+    for (uint8_t lane = 0; lane < LANE_COUNT; lane++)
+    {
+        if (!isStreamEmpty(streamOf(port, lane)))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool PacketQueue::isStreamEmpty(const uint8_t stream) const
+{
+    const auto& cursor = cursors_[stream];
+
+    // Empty when the reader has caught up with the writer (same segment, same offset) and nothing is staged.
+    // Purely in RAM: no storage access needed.
+    if (stagedStream_ == stream && stagedLength_ > 0)
+        return false;
+
+    return cursor.readSegment == cursor.writeSegment && cursor.readOffset == cursor.writeOffset;
+}
+
+uint8_t PacketQueue::selectLane(const uint8_t port) const
+{
+    // Anti-starvation: a lower lane that has been passed over often enough goes first
+    for (uint8_t lane = LANE_COUNT - 1; lane > 0; lane--)
+    {
+        const uint8_t stream = streamOf(port, lane);
+        if (laneCredits_[stream] >= LANE_AGING_THRESHOLD && !isStreamEmpty(stream))
+        {
+            return lane;
+        }
+    }
+
+    for (uint8_t lane = 0; lane < LANE_COUNT; lane++)
+    {
+        if (!isStreamEmpty(streamOf(port, lane)))
+        {
+            return lane;
+        }
+    }
+    return NO_LANE;
+}
+
+uint8_t PacketQueue::activeLane(const uint8_t port) const
+{
+    const uint8_t lane = selectedLane_[port];
+    if (lane != NO_LANE && !isStreamEmpty(streamOf(port, lane)))
+    {
+        return lane;
+    }
+    return selectLane(port);
+}
+
+bool PacketQueue::push(uint8_t port, const uint8_t* data, const uint16_t dataLength, const Priority priority)
+{
+    if (!data || dataLength == 0)
+        return false;
+    if (port == 0 || port > MAX_PORT)
+        return false;
+    if (static_cast<uint8_t>(priority) >= LANE_COUNT)
+        return false;
+
+    resyncLostWrites();
+
+    const uint8_t stream = streamOf(port, static_cast<uint8_t>(priority));
+    const size_t frameSize = BinaryFrame::requiredSize(dataLength, FRAME_VERSION);
+    if (frameSize > SharedMemory::tmpBufferSize())
+    {
+        // Readers without their own buffer peek whole frames into the shared tmp buffer
+        LOG_CLASS_ERROR("PacketQueue::push() -> Port %u: frame of %u bytes is too large", port,
+                        static_cast<unsigned int>(frameSize));
+        return false;
+    }
+
+    if (const bool roomOk = makeRoom(port, frameSize); !roomOk)
+    {
+        return false;
+    }
+
+    // A single staging buffer is shared by all lanes: another lane's frames or lack of room force a flush
+    if (stagedLength_ > 0 && (stagedStream_ != stream || stagedLength_ + frameSize > STAGING_BUFFER_SIZE))
+    {
+        if (const bool flushOk = flush(); !flushOk)
+        {
+            return false;
+        }
+    }
+    if (const bool flushOk = flushIfStale(); !flushOk)
+    {
+        return false;
+    }
+
+    auto& cursor = cursors_[stream];
+    const size_t pendingBytes = cursor.writeOffset + stagedLength_;
+    if (pendingBytes > 0 && pendingBytes + frameSize > SEGMENT_MAX_BYTES)
+    {
+        if (const bool flushOk = flush(); !flushOk)
+        {
+            return false;
+        }
+        if (const bool rotateOk = rotateWriteSegment(stream); !rotateOk)
+        {
+            return false;
+        }
+    }
+
+    const uint32_t ts = rtc_.getEpoch();
+
+    if (frameSize > STAGING_BUFFER_SIZE)
+    {
+        // Too big to be staged: append header, payload and footer directly (nothing is staged at this point)
+        uint8_t header[BinaryFrame::HEADER_SIZE];
+        uint8_t footer[BinaryFrame::FOOTER_SIZE_V2];
+        const size_t footerLen = BinaryFrame::wrapParts(header, footer, data, dataLength, ts, FRAME_VERSION);
+        if (footerLen == 0)
+        {
+            LOG_CLASS_ERROR("PacketQueue::push() -> Failed to wrap data for port %u", port);
+            return false;
+        }
+        const IoVec parts[] = {{header, sizeof(header)}, {data, dataLength}, {footer, footerLen}};
+        if (const bool appendOk = appendFrames(stream, parts, 3); !appendOk)
+        {
+            return false;
+        }
+        cursor.pendingCount++;
+        cursor.pendingBytes += frameSize;
+        return true;
+    }
+
+    if (const bool wrapOk = BinaryFrame::wrapInPlace(staging_ + stagedLength_, STAGING_BUFFER_SIZE - stagedLength_,
+                                                     data, dataLength, ts, FRAME_VERSION);
+        !wrapOk)
+    {
+        LOG_CLASS_ERROR("PacketQueue::push() -> Failed to stage data for port %u", port);
+        return false;
+    }
+
+    if (stagedLength_ == 0)
+    {
+        stagedStream_ = stream;
+        stagedSinceMs_ = getMillis();
+    }
+    stagedLength_ += frameSize;
+    stagedCount_++;
+    cursor.pendingCount++;
+    cursor.pendingBytes += frameSize;
+    return true;
+}
+
+bool PacketQueue::flush()
+{
+    if (stagedLength_ == 0)
+        return true;
+
+    const IoVec staged = {staging_, stagedLength_};
+    const bool ok = appendFrames(stagedStream_, &staged, 1);
+    if (!ok)
+    {
+        LOG_CLASS_ERROR("PacketQueue::flush() -> Port %u: failed to append %u staged bytes",
+                        portOf(stagedStream_), static_cast<unsigned int>(stagedLength_));
+        // Frames that could not be written are dropped: keeping them would block every other port
+        auto& cursor = cursors_[stagedStream_];
+        cursor.pendingCount -= stagedCount_;
+        cursor.pendingBytes -= stagedLength_;
+    }
+    stagedLength_ = 0;
+    stagedCount_ = 0;
+    stagedStream_ = NO_STREAM;
+    return ok;
+}
+
+bool PacketQueue::flushIfStale()
+{
+    if (stagedLength_ == 0 || getMillis() - stagedSinceMs_ < STAGING_MAX_AGE_MS)
+        return true;
+
+    return flush();
+}
+
+bool PacketQueue::sync()
+{
+    if (!appendedSinceSync_)
+        return true;
+
+    appendedSinceSync_ = false;
+    if (!storage_.sync())
+    {
+        LOG_CLASS_ERROR("PacketQueue::sync() -> Failed to sync appended frames");
+        return false;
+    }
+    return true;
+}
+
+bool PacketQueue::appendFrames(const uint8_t stream, const IoVec* parts, const size_t count)
+{
+    auto& cursor = cursors_[stream];
+
+    char path[32];
+    segmentPath(stream, cursor.writeSegment, path, sizeof(path));
+
+    size_t length = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        length += parts[i].length;
+    }
+
+    // A preallocated segment already spans its whole extent: the frames are written at the logical end
+    const uint32_t baseOffset = cursor.writeOffset;
+    if (const bool ok = cursor.preallocated
+                            ? storage_.writeFileRegionV(path, baseOffset, parts, count)
+                            : storage_.appendBytesToFileV(path, parts, count); !ok)
+    {
+        return false;
+    }
+    cursor.writeOffset += length; // Update write offset
+    appendedSinceSync_ = true;
+
+    // The frames are safe at this point: a missing index record only costs a full read later (and is rebuilt on begin)
+    if (config_.frameIndex && !appendIndexRecords(stream, parts[0].data, parts[0].length, baseOffset))
+    {
+        LOG_CLASS_WARNING("PacketQueue::appendFrames() -> Port %u lane %u: failed to update index",
+                          portOf(stream), laneOf(stream));
+    }
+    return true;
+}
+
+bool PacketQueue::appendIndexRecords(const uint8_t stream, const uint8_t* frames, const size_t length,
+                                     const uint32_t baseOffset)
+{
+    char path[32];
+    indexPath(stream, cursors_[stream].writeSegment, path, sizeof(path));
+
+    uint8_t records[INDEX_RECORD_SIZE * 8];
+    size_t recordsLength = 0;
+    size_t pos = 0;
+    while (pos + BinaryFrame::HEADER_SIZE <= length)
+    {
+        BinaryFrame::Header header{};
+        if (!BinaryFrame::parseHeader(frames + pos, length - pos, header) || BinaryFrame::frameSize(header) == 0)
+        {
+            return false;
+        }
+        writeLE32(records + recordsLength, baseOffset + pos);
+        writeLE16(records + recordsLength + 4, header.payloadLength);
+        writeLE32(records + recordsLength + 6, header.timestamp);
+        recordsLength += INDEX_RECORD_SIZE;
+        pos += BinaryFrame::frameSize(header);
+
+        if (recordsLength == sizeof(records))
+        {
+            if (!storage_.appendBytesToFile(path, records, recordsLength))
+            {
+                return false;
+            }
+            recordsLength = 0;
+        }
+    }
+    return recordsLength == 0 || storage_.appendBytesToFile(path, records, recordsLength);
+}
+
+bool PacketQueue::lookupIndexRecord(const uint8_t stream, IndexRecord& outRecord)
+{
+    const auto& cursor = cursors_[stream];
+    auto& window = indexWindows_[portOf(stream)];
+
+    const bool hit = window.count > 0
+        && window.stream == stream
+        && window.segment == cursor.readSegment
+        && cursor.readRecord >= window.firstRecord
+        && cursor.readRecord < window.firstRecord + window.count;
+
+    if (!hit)
+    {
+        // Refill the window starting at the current record
+        char path[32];
+        indexPath(stream, cursor.readSegment, path, sizeof(path));
+
+        uint8_t raw[INDEX_RECORD_SIZE * INDEX_WINDOW_RECORDS];
+        const size_t readBytes = storage_.readFileRegionBytes(
+            path, static_cast<size_t>(cursor.readRecord) * INDEX_RECORD_SIZE, raw, sizeof(raw)
+        );
+
+        window.stream = stream;
+        window.segment = cursor.readSegment;
+        window.firstRecord = cursor.readRecord;
+        window.count = static_cast<uint8_t>(readBytes / INDEX_RECORD_SIZE);
+        for (uint8_t i = 0; i < window.count; i++)
+        {
+            const uint8_t* record = raw + i * INDEX_RECORD_SIZE;
+            window.records[i].offset = readLE32(record);
+            window.records[i].length = readLE16(record + 4);
+            window.records[i].timestamp = readLE32(record + 6);
+        }
+        if (window.count == 0)
+        {
+            return false;
+        }
+    }
+
+    outRecord = window.records[cursor.readRecord - window.firstRecord];
+    return true;
+}
+
+bool PacketQueue::seekIndexRecord(const uint8_t stream, const uint32_t offset, uint32_t& outRecord)
+{
+    const auto& cursor = cursors_[stream];
+    char path[32];
+    indexPath(stream, cursor.readSegment, path, sizeof(path));
+
+    // Records are in offset order and the target is usually a few frames ahead: read forward in small chunks
+    uint8_t raw[INDEX_RECORD_SIZE * 8];
+    uint32_t record = cursor.readRecord;
+    for (;;)
+    {
+        const size_t readBytes = storage_.readFileRegionBytes(
+            path, static_cast<size_t>(record) * INDEX_RECORD_SIZE, raw, sizeof(raw)
+        );
+        const size_t count = readBytes / INDEX_RECORD_SIZE;
+        for (size_t i = 0; i < count; i++, record++)
+        {
+            if (readLE32(raw + i * INDEX_RECORD_SIZE) >= offset)
+            {
+                outRecord = record;
+                return true;
+            }
+        }
+        if (count < sizeof(raw) / INDEX_RECORD_SIZE)
+        {
+            // End of the index: the offset is past its last record
+            outRecord = record;
+            return count > 0 || record > cursor.readRecord;
+        }
+    }
+}
+
+uint32_t PacketQueue::scanSegment(const uint8_t stream, const uint16_t segment, const uint32_t fromOffset,
+                                  const uint32_t toOffset, const bool writeIndex, uint32_t* outEndOffset)
+{
+    char path[32];
+    char idxPath[32];
+    segmentPath(stream, segment, path, sizeof(path));
+    indexPath(stream, segment, idxPath, sizeof(idxPath));
+
+    uint8_t headerBytes[BinaryFrame::HEADER_SIZE];
+    uint8_t records[INDEX_RECORD_SIZE * 8];
+    size_t recordsLength = 0;
+    uint32_t frames = 0;
+    uint32_t offset = fromOffset;
+
+    // Walks the frame headers of the segment (one small read per frame): only used on begin()
+    while (offset + BinaryFrame::HEADER_SIZE <= toOffset)
+    {
+        if (storage_.readFileRegionBytes(path, offset, headerBytes, sizeof(headerBytes)) != sizeof(headerBytes))
+            break;
+
+        // Erased (never written) tail of a preallocated segment
+        if (headerBytes[0] == 0x00 || headerBytes[0] == 0xFF)
+            break;
+
+        BinaryFrame::Header header{};
+        if (!BinaryFrame::parseHeader(headerBytes, sizeof(headerBytes), header)
+            || !BinaryFrame::isStartByte(header.startByte))
+        {
+            LOG_CLASS_WARNING("PacketQueue::scanSegment() -> %s: invalid frame header at %lu", path,
+                              static_cast<unsigned long>(offset));
+            break;
+        }
+        const auto frameSize = static_cast<uint32_t>(BinaryFrame::frameSize(header));
+        if (offset + frameSize > toOffset)
+            break;
+
+        if (writeIndex)
+        {
+            writeLE32(records + recordsLength, offset);
+            writeLE16(records + recordsLength + 4, header.payloadLength);
+            writeLE32(records + recordsLength + 6, header.timestamp);
+            recordsLength += INDEX_RECORD_SIZE;
+            if (recordsLength == sizeof(records))
+            {
+                if (!storage_.appendBytesToFile(idxPath, records, recordsLength))
+                    break;
+                recordsLength = 0;
+            }
+        }
+        offset += frameSize;
+        frames++;
+    }
+
+    if (recordsLength > 0 && !storage_.appendBytesToFile(idxPath, records, recordsLength))
+    {
+        LOG_CLASS_ERROR("PacketQueue::scanSegment() -> Cannot append to index %s", idxPath);
+    }
+    if (outEndOffset)
+    {
+        *outEndOffset = offset;
+    }
+    return frames;
+}
+
+bool PacketQueue::usesPreallocation() const
+{
+    // The logical end of a preallocated segment is recovered from its index
+    return config_.preallocateSegments && config_.frameIndex && storage_.supportsPreallocation();
+}
+
+bool PacketQueue::createSegment(const uint8_t stream, const uint16_t segment, bool& outPreallocated)
+{
+    char path[32];
+    segmentPath(stream, segment, path, sizeof(path));
+
+    // Without a contiguous run free (or without support) the segment grows by appends as before
+    outPreallocated = usesPreallocation() && storage_.preallocateFile(path, SEGMENT_MAX_BYTES);
+    if (!outPreallocated && !storage_.createEmptyFile(path))
+    {
+        LOG_CLASS_ERROR("PacketQueue::createSegment() -> Cannot create file: %s", path);
+        return false;
+    }
+    return true;
+}
+
+uint32_t PacketQueue::indexedEnd(const uint8_t stream, const uint16_t segment)
+{
+    char path[32];
+    indexPath(stream, segment, path, sizeof(path));
+    const size_t indexSize = storage_.fileSize(path);
+    if (indexSize < INDEX_RECORD_SIZE)
+    {
+        return 0;
+    }
+
+    // The frame size depends on its version: read the header of the last indexed frame
+    uint8_t raw[INDEX_RECORD_SIZE];
+    if (storage_.readFileRegionBytes(path, indexSize - indexSize % INDEX_RECORD_SIZE - INDEX_RECORD_SIZE, raw,
+                                     sizeof(raw)) != sizeof(raw))
+    {
+        return 0;
+    }
+    const uint32_t lastOffset = readLE32(raw);
+
+    uint8_t headerBytes[BinaryFrame::HEADER_SIZE];
+    BinaryFrame::Header header{};
+    segmentPath(stream, segment, path, sizeof(path));
+    if (storage_.readFileRegionBytes(path, lastOffset, headerBytes, sizeof(headerBytes)) != sizeof(headerBytes)
+        || !BinaryFrame::parseHeader(headerBytes, sizeof(headerBytes), header))
+    {
+        return 0;
+    }
+    return lastOffset + static_cast<uint32_t>(BinaryFrame::frameSize(header));
+}
+
+uint32_t PacketQueue::closedSegmentEnd(const uint8_t stream, const uint16_t segment)
+{
+    char path[32];
+    segmentPath(stream, segment, path, sizeof(path));
+    const auto size = static_cast<uint32_t>(storage_.fileSize(path));
+    if (!usesPreallocation() || size != SEGMENT_MAX_BYTES)
+    {
+        return size;
+    }
+    // Preallocated: the frames end where the last indexed one does (the index was completed on begin())
+    return indexedEnd(stream, segment);
+}
+
+bool PacketQueue::rebuildPendingCounters(const uint8_t stream)
+{
+    auto& cursor = cursors_[stream];
+    cursor.pendingCount = 0;
+    cursor.pendingBytes = 0;
+
+    char path[32];
+    for (uint16_t segment = cursor.readSegment;; segment = nextSegment(segment))
+    {
+        const bool isReadSegment = segment == cursor.readSegment;
+        uint32_t segmentEnd = cursor.writeOffset;
+        if (segment != cursor.writeSegment)
+        {
+            segmentEnd = isReadSegment ? cursor.readSegmentEnd : closedSegmentEnd(stream, segment);
+        }
+        const uint32_t segmentStart = isReadSegment ? cursor.readOffset : 0;
+        if (segmentEnd > segmentStart)
+        {
+            cursor.pendingBytes += segmentEnd - segmentStart;
+        }
+
+        if (config_.frameIndex)
+        {
+            indexPath(stream, segment, path, sizeof(path));
+            const auto records = static_cast<uint32_t>(storage_.fileSize(path) / INDEX_RECORD_SIZE);
+            const uint32_t consumed = isReadSegment ? cursor.readRecord : 0;
+            cursor.pendingCount += records > consumed ? records - consumed : 0;
+        }
+        else
+        {
+            cursor.pendingCount += scanSegment(stream, segment, segmentStart, segmentEnd, false);
+        }
+
+        if (segment == cursor.writeSegment)
+            break;
+    }
+
+    LOG_CLASS_INFO("PacketQueue::rebuildPendingCounters() -> Port %u lane %u: %lu packets (%lu bytes) pending",
+                   portOf(stream), laneOf(stream),
+                   static_cast<unsigned long>(cursor.pendingCount),
+                   static_cast<unsigned long>(cursor.pendingBytes));
+    return true;
+}
+
+bool PacketQueue::rotateWriteSegment(const uint8_t stream)
+{
+    auto& cursor = cursors_[stream];
+    const uint16_t newSegment = nextSegment(cursor.writeSegment);
+
+    if (newSegment == cursor.readSegment)
+    {
+        LOG_CLASS_ERROR("PacketQueue::rotateWriteSegment() -> Port %u lane %u: no free segment numbers left",
+                        portOf(stream), laneOf(stream));
+        return false;
+    }
+
+    char path[32];
+    indexPath(stream, newSegment, path, sizeof(path));
+    if (config_.frameIndex && !storage_.createEmptyFile(path))
+    {
+        LOG_CLASS_ERROR("PacketQueue::rotateWriteSegment() -> Cannot create file: %s", path);
+        return false;
+    }
+    bool preallocated = false;
+    if (!createSegment(stream, newSegment, preallocated))
+    {
+        return false;
+    }
+
+    // The segment being closed is the one the reader is on: remember where it ends
+    if (cursor.readSegment == cursor.writeSegment)
+    {
+        cursor.readSegmentEnd = cursor.writeOffset;
+    }
+    cursor.writeSegment = newSegment;
+    cursor.writeOffset = 0;
+    cursor.preallocated = preallocated;
+
+    // The cursor must know about the new segment before any data is written to it
+    if (!persistCursor(stream))
+    {
+        return false;
+    }
+
+    segmentPath(stream, newSegment, path, sizeof(path));
+    LOG_CLASS_INFO("PacketQueue::rotateWriteSegment() -> Port %u: now writing to %s", portOf(stream), path);
+    return compactStream(stream);
+}
+
+bool PacketQueue::compact(const uint8_t port)
+{
+    if (port == 0 || port > MAX_PORT)
+        return false;
+
+    bool ok = true;
+    for (uint8_t lane = 0; lane < LANE_COUNT; lane++)
+    {
+        ok = compactStream(streamOf(port, lane)) && ok;
+    }
+    return ok;
+}
+
+bool PacketQueue::compactStream(const uint8_t stream)
+{
+    auto& cursor = cursors_[stream];
+    bool changed = false;
+    char path[32];
+
+    // A closed segment whose last byte has been read can be deleted
+    while (cursor.readSegment != cursor.writeSegment && cursor.readOffset >= cursor.readSegmentEnd)
+    {
+        segmentPath(stream, cursor.readSegment, path, sizeof(path));
+        if (storage_.fileExists(path) && !storage_.deleteFile(path))
+        {
+            LOG_CLASS_ERROR("PacketQueue::compact() -> Cannot delete consumed segment %s", path);
+        }
+        indexPath(stream, cursor.readSegment, path, sizeof(path));
+        if (storage_.fileExists(path) && !storage_.deleteFile(path))
+        {
+            LOG_CLASS_ERROR("PacketQueue::compact() -> Cannot delete consumed index %s", path);
+        }
+
+        cursor.readSegment = nextSegment(cursor.readSegment);
+        cursor.readOffset = 0;
+        cursor.nextReadOffset = 0;
+        cursor.readRecord = 0;
+        if (auto& window = indexWindows_[portOf(stream)]; window.stream == stream)
+        {
+            window.count = 0;
+        }
+
+        if (cursor.readSegment != cursor.writeSegment)
+        {
+            cursor.readSegmentEnd = closedSegmentEnd(stream, cursor.readSegment);
+        }
+        else
+        {
+            cursor.readSegmentEnd = 0;
+        }
+        changed = true;
+    }
+
+    return !changed || persistCursor(stream);
+}
+
+bool PacketQueue::advanceReadCursor(const uint8_t stream)
+{
+    consumeFrame(stream);
+    return commitReadCursor(stream);
+}
+
+bool PacketQueue::resyncReadCursor(const uint8_t stream)
+{
+    auto& cursor = cursors_[stream];
+    const uint32_t readLimit = (cursor.readSegment == cursor.writeSegment)
+                                   ? cursor.writeOffset
+                                   : cursor.readSegmentEnd;
+    if (cursor.readOffset >= readLimit)
+        return false;
+
+    char path[32];
+    segmentPath(stream, cursor.readSegment, path, sizeof(path));
+
+    auto* dataBuffer = SharedMemory::tmpBuffer();
+    const size_t available = readLimit - cursor.readOffset;
+    const size_t readBytes = storage_.readFileRegionBytes(
+        path, cursor.readOffset, dataBuffer,
+        available < SharedMemory::tmpBufferSize() ? available : SharedMemory::tmpBufferSize()
+    );
+    if (readBytes == 0)
+        return false; // Read error: nothing is skipped
+
+    // The corrupt bytes are consumed as one packet
+    const size_t skip = BinaryFrame::findNextFrame(dataBuffer, readBytes, 1);
+    LOG_CLASS_WARNING("PacketQueue::resyncReadCursor() -> %s: skipping %u corrupt bytes at %lu",
+                      path, static_cast<unsigned int>(skip), static_cast<unsigned long>(cursor.readOffset));
+
+    cursor.nextReadOffset = cursor.readOffset + static_cast<uint32_t>(skip);
+
+    // They may have spanned several indexed frames: the index is re-seeked to the new read offset so that it
+    // stays in sync for the rest of the segment (consumeFrame() then counts the skip as one record)
+    if (uint32_t record = 0; config_.frameIndex && seekIndexRecord(stream, cursor.nextReadOffset, record)
+        && record > cursor.readRecord)
+    {
+        cursor.readRecord = record - 1;
+    }
+    return advanceReadCursor(stream);
+}
+
+bool PacketQueue::recoverShortSegment(const uint8_t stream)
+{
+    auto& cursor = cursors_[stream];
+    char path[32];
+    segmentPath(stream, cursor.readSegment, path, sizeof(path));
+    if (!storage_.fileExists(path))
+        return false; // Storage not answering: nothing is discarded
+
+    const auto size = static_cast<uint32_t>(storage_.fileSize(path));
+    if (size > cursor.readOffset)
+        return false;
+
+    LOG_CLASS_WARNING("PacketQueue::recoverShortSegment() -> %s ends at %lu, before the read cursor (%lu): "
+                      "the missing packets are skipped", path, static_cast<unsigned long>(size),
+                      static_cast<unsigned long>(cursor.readOffset));
+
+    if (peekedBatch_.stream == stream)
+    {
+        peekedBatch_ = PeekedBatch{};
+    }
+    if (auto& window = indexWindows_[portOf(stream)]; window.stream == stream)
+    {
+        window.count = 0; // Its records may belong to the index rebuilt below
+    }
+    cursor.readOffset = size;
+    cursor.nextReadOffset = size;
+    if (cursor.readSegment != cursor.writeSegment)
+    {
+        cursor.readSegmentEnd = size; // Consumed: compacted by commitReadCursor()
+    }
+    else
+    {
+        // New appends land at the real end of the file; the index loses the records of the missing frames
+        cursor.writeOffset = size;
+        cursor.readRecord = 0;
+        if (config_.frameIndex)
+        {
+            indexPath(stream, cursor.writeSegment, path, sizeof(path));
+            if (!storage_.createEmptyFile(path))
+            {
+                LOG_CLASS_ERROR("PacketQueue::recoverShortSegment() -> Cannot create file: %s", path);
+            }
+            cursor.readRecord = scanSegment(stream, cursor.writeSegment, 0, size, true);
+        }
+    }
+
+    if (!rebuildPendingCounters(stream) || !commitReadCursor(stream))
+    {
+        LOG_CLASS_ERROR("PacketQueue::recoverShortSegment() -> Port %u: failed to persist read cursor",
+                        portOf(stream));
+    }
+    return true;
+}
+
+void PacketQueue::onWriteLost(const char* path)
+{
+    if (!path)
+        return;
+
+    char ownPath[32];
+    for (uint8_t stream = 0; stream < STREAM_COUNT; stream++)
+    {
+        const auto& cursor = cursors_[stream];
+        for (uint16_t segment = cursor.readSegment;; segment = nextSegment(segment))
+        {
+            segmentPath(stream, segment, ownPath, sizeof(ownPath));
+            bool matches = std::strcmp(ownPath, path) == 0;
+            indexPath(stream, segment, ownPath, sizeof(ownPath));
+            matches = matches || std::strcmp(ownPath, path) == 0;
+            if (matches)
+            {
+                lostWriteStreams_ |= 1u << stream;
+                return;
+            }
+            if (segment == cursor.writeSegment)
+                break;
+        }
+    }
+}
+
+void PacketQueue::resyncLostWrites()
+{
+    // Taken before resyncing: a write lost meanwhile marks its stream again for the next call
+    const uint32_t streams = lostWriteStreams_;
+    lostWriteStreams_ = 0;
+    for (uint8_t stream = 0; stream < STREAM_COUNT; stream++)
+    {
+        if ((streams & (1u << stream)) && !resyncStream(stream))
+        {
+            LOG_CLASS_ERROR("PacketQueue::resyncLostWrites() -> Port %u lane %u: resync failed",
+                            portOf(stream), laneOf(stream));
+        }
+    }
+}
+
+bool PacketQueue::resyncStream(const uint8_t stream)
+{
+    auto& cursor = cursors_[stream];
+    LOG_CLASS_WARNING("PacketQueue::resyncStream() -> Port %u lane %u: rebuilding offsets and indexes from the files",
+                      portOf(stream), laneOf(stream));
+
+    if (peekedBatch_.stream == stream)
+    {
+        peekedBatch_ = PeekedBatch{};
+    }
+    if (auto& window = indexWindows_[portOf(stream)]; window.stream == stream)
+    {
+        window.count = 0;
+    }
+
+    // Same recovery as begin(), but every index is rebuilt: they may list frames whose bytes were lost
+    char path[32];
+    for (uint16_t segment = cursor.readSegment;; segment = nextSegment(segment))
+    {
+        segmentPath(stream, segment, path, sizeof(path));
+        auto end = static_cast<uint32_t>(storage_.fileSize(path));
+        const bool preallocated = usesPreallocation() && end == SEGMENT_MAX_BYTES;
+        if (config_.frameIndex)
+        {
+            indexPath(stream, segment, path, sizeof(path));
+            if (!storage_.createEmptyFile(path))
+            {
+                LOG_CLASS_ERROR("PacketQueue::resyncStream() -> Cannot create file: %s", path);
+                return false;
+            }
+            uint32_t scannedEnd = 0;
+            (void)scanSegment(stream, segment, 0, end, true, &scannedEnd);
+            if (preallocated)
+            {
+                end = scannedEnd; // The frames of a preallocated segment stop at the first unwritten byte
+            }
+        }
+
+        if (segment == cursor.writeSegment)
+        {
+            cursor.writeOffset = end;
+            cursor.preallocated = preallocated;
+            break;
+        }
+        if (segment == cursor.readSegment)
+        {
+            cursor.readSegmentEnd = end;
+        }
+    }
+
+    const uint32_t readLimit = (cursor.readSegment == cursor.writeSegment)
+                                   ? cursor.writeOffset
+                                   : cursor.readSegmentEnd;
+    if (cursor.readOffset > readLimit)
+    {
+        cursor.readOffset = readLimit;
+    }
+    cursor.nextReadOffset = cursor.readOffset;
+    cursor.readRecord = 0;
+    if (uint32_t record = 0; config_.frameIndex && seekIndexRecord(stream, cursor.readOffset, record))
+    {
+        cursor.readRecord = record;
+    }
+
+    if (!rebuildPendingCounters(stream))
+        return false;
+    if (stagedStream_ == stream)
+    {
+        // Still in RAM: appended at the new write offset on the next flush()
+        cursor.pendingCount += stagedCount_;
+        cursor.pendingBytes += static_cast<uint32_t>(stagedLength_);
+    }
+    return compactStream(stream) && persistCursor(stream);
 }
 
-bool PacketQueue::begin()
+uint8_t PacketQueue::prepareReadLane(const uint8_t port)
 {
-    // Revisar cada puerto
-    for (uint8_t port = 1; port <= MAX_PORT; port++)
+    resyncLostWrites();
+
+    // Every iteration either returns or leaves one more lane empty
+    for (;;)
     {
-        char path[32];
-        snprintf(path, sizeof(path), "%s%u", queueBaseName_, port);
+        const uint8_t lane = selectLane(port);
+        if (lane == NO_LANE)
+            return NO_LANE;
+        const uint8_t stream = streamOf(port, lane);
+
+        // Staged frames of this lane must reach storage before reading it
+        if (stagedStream_ == stream && !flush())
+            return NO_LANE;
 
-        if (storage_.fileExists(path))
+        if (!dropExpiredFrames(stream))
         {
-            // archivo existente -> calcular offset al final (nuevos paquetes)
-            writeOffset_[port] = storage_.fileSize(path);
-            readOffset_[port] = storage_.fileSize(path);
-            nextReadOffset_[port] = storage_.fileSize(path);
+            LOG_CLASS_ERROR("PacketQueue::prepareReadLane() -> Port %u: failed to persist cursor after expiry", port);
         }
-        else
+        if (!isStreamEmpty(stream))
         {
-            const bool createOk = storage_.createEmptyFile(path);
-            if (!createOk)
-            {
-                LOG_CLASS_ERROR("PacketQueue::begin() -> Cannot create file: %s", path);
-                return false;
-            }
-            writeOffset_[port] = 0;
-            readOffset_[port] = 0;
-            nextReadOffset_[port] = 0;
+            selectedLane_[port] = lane;
+            return lane;
         }
     }
+}
 
-    LOG_CLASS_INFO("PacketQueue::begin() -> All queues initialized");
+bool PacketQueue::readHeadTimestamp(const uint8_t stream, uint32_t& outTimestamp)
+{
+    const auto& cursor = cursors_[stream];
+
+    // The index already has the timestamp: no access to the segment at all
+    if (IndexRecord record{}; config_.frameIndex && lookupIndexRecord(stream, record)
+        && record.offset == cursor.readOffset)
+    {
+        outTimestamp = record.timestamp;
+        return true;
+    }
+
+    char path[32];
+    segmentPath(stream, cursor.readSegment, path, sizeof(path));
+
+    uint8_t headerBytes[BinaryFrame::HEADER_SIZE];
+    BinaryFrame::Header header{};
+    if (storage_.readFileRegionBytes(path, cursor.readOffset, headerBytes, sizeof(headerBytes)) != sizeof(headerBytes)
+        || !BinaryFrame::parseHeader(headerBytes, sizeof(headerBytes), header)
+        || BinaryFrame::frameSize(header) == 0)
+    {
+        return false;
+    }
+    outTimestamp = header.timestamp;
     return true;
 }
 
-bool PacketQueue::clear(uint8_t port)
+bool PacketQueue::dropHeadFrame(const uint8_t stream)
 {
-    if (port == 0 || port > MAX_PORT)
-        return false;
+    auto& cursor = cursors_[stream];
+    const uint32_t readLimit = (cursor.readSegment == cursor.writeSegment)
+                                   ? cursor.writeOffset
+                                   : cursor.readSegmentEnd;
 
     char path[32];
-    snprintf(path, sizeof(path), "%s%u", queueBaseName_, port);
+    segmentPath(stream, cursor.readSegment, path, sizeof(path));
 
-    if (storage_.fileExists(path) && !storage_.deleteFile(path))
+    // Only the header is needed to know where the next frame starts
+    uint8_t headerBytes[BinaryFrame::HEADER_SIZE];
+    BinaryFrame::Header header{};
+    if (storage_.readFileRegionBytes(path, cursor.readOffset, headerBytes, sizeof(headerBytes)) != sizeof(headerBytes)
+        || !BinaryFrame::parseHeader(headerBytes, sizeof(headerBytes), header))
     {
         return false;
     }
+    const size_t frameSize = BinaryFrame::frameSize(header);
+    if (frameSize == 0 || cursor.readOffset + frameSize > readLimit)
+    {
+        return false; // Corrupt: left for the resynchronization of _next()
+    }
 
-    const bool createOK = storage_.createEmptyFile(path);
-    if (!createOK)
+    // A dropped packet must not be skipped again by a pending skipToNextPacket()/skipPackets()
+    if (peekedBatch_.stream == stream)
     {
-        return false;
+        peekedBatch_ = PeekedBatch{};
     }
-    // Reset write offset for the port
-    writeOffset_[port] = 0;
-    readOffset_[port] = 0;
-    nextReadOffset_[port] = 0;
+    cursor.nextReadOffset = cursor.readOffset + static_cast<uint32_t>(frameSize);
+    consumeFrame(stream);
 
+    if (cursor.readSegment != cursor.writeSegment && cursor.readOffset >= cursor.readSegmentEnd)
+    {
+        return compactStream(stream);
+    }
     return true;
 }
 
-bool PacketQueue::isEmpty() const
+bool PacketQueue::dropExpiredFrames(const uint8_t stream)
 {
-    for (uint8_t port = 1; port <= MAX_PORT; port++)
+    const uint8_t port = portOf(stream);
+    const uint32_t maxAge = config_.ports[port].maxAgeSeconds;
+    if (maxAge == 0)
+        return true;
+
+    const uint32_t now = rtc_.getEpoch();
+    uint32_t expired = 0;
+    uint32_t timestamp = 0;
+    while (!isStreamEmpty(stream) && readHeadTimestamp(stream, timestamp))
     {
-        if (!isPortEmpty(port))
+        // Frames stamped in the future (RTC set backwards) are kept
+        if (timestamp > now || now - timestamp <= maxAge)
+            break;
+
+        if (!dropHeadFrame(stream))
+            break;
+        expired++;
+    }
+
+    if (expired == 0)
+        return true;
+
+    dropCounters_[port].expired += expired;
+    LOG_CLASS_WARNING("PacketQueue::dropExpiredFrames() -> Port %u lane %u: skipped %lu packets older than %lu s",
+                      port, laneOf(stream), static_cast<unsigned long>(expired), static_cast<unsigned long>(maxAge));
+    return persistCursor(stream);
+}
+
+bool PacketQueue::makeRoom(const uint8_t port, const size_t frameSize)
+{
+    const auto& policy = config_.ports[port];
+    if (policy.maxBytes == 0 || size(port) + frameSize <= policy.maxBytes)
+        return true;
+
+    if (policy.overflow == PacketQueuePortPolicy::Overflow::DropOldest && frameSize <= policy.maxBytes)
+    {
+        // Staged frames must be on storage before they can be dropped
+        if (const bool flushOk = flush(); !flushOk)
         {
             return false;
         }
+
+        // The oldest packets of the lowest priority lane go first
+        uint32_t evicted = 0;
+        uint8_t touchedLanes = 0;
+        while (size(port) + frameSize > policy.maxBytes)
+        {
+            uint8_t lane = LANE_COUNT;
+            while (lane > 0 && isStreamEmpty(streamOf(port, lane - 1)))
+            {
+                lane--;
+            }
+            if (lane == 0 || !dropHeadFrame(streamOf(port, lane - 1)))
+                break;
+
+            touchedLanes |= static_cast<uint8_t>(1u << (lane - 1));
+            evicted++;
+        }
+
+        for (uint8_t lane = 0; lane < LANE_COUNT; lane++)
+        {
+            if ((touchedLanes & (1u << lane)) && !persistCursor(streamOf(port, lane)))
+            {
+                LOG_CLASS_ERROR("PacketQueue::push() -> Port %u lane %u: failed to persist cursor after eviction",
+                                port, lane);
+            }
+        }
+        if (evicted > 0)
+        {
+            dropCounters_[port].evicted += evicted;
+            LOG_CLASS_WARNING("PacketQueue::push() -> Port %u full: evicted %lu oldest packets",
+                              port, static_cast<unsigned long>(evicted));
+        }
+        if (size(port) + frameSize <= policy.maxBytes)
+            return true;
     }
-    return true;
+
+    dropCounters_[port].rejected++;
+    LOG_CLASS_WARNING("PacketQueue::push() -> Port %u full (%lu of %lu bytes): packet rejected",
+                      port, static_cast<unsigned long>(size(port)), static_cast<unsigned long>(policy.maxBytes));
+    return false;
 }
 
-bool PacketQueue::arePortsEmpty(const uint8_t* ports, const size_t portCount) const
+void PacketQueue::consumeFrame(const uint8_t stream)
 {
-    if (!ports || portCount == 0)
-        return true;
+    auto& cursor = cursors_[stream];
+    const uint32_t previousOffset = cursor.readOffset;
+    cursor.readOffset = cursor.nextReadOffset;
+
+    // Ensure we do not exceed the end of the data
+    const uint32_t readLimit = (cursor.readSegment == cursor.writeSegment)
+                                   ? cursor.writeOffset
+                                   : cursor.readSegmentEnd;
+    if (cursor.readOffset > readLimit)
+    {
+        cursor.readOffset = readLimit;
+    }
 
-    for (size_t i = 0; i < portCount; i++)
+    // Exactly one frame is consumed per call
+    const uint32_t consumedBytes = cursor.readOffset - previousOffset;
+    cursor.readRecord++;
+    cursor.pendingCount = cursor.pendingCount > 0 ? cursor.pendingCount - 1 : 0;
+    cursor.pendingBytes = cursor.pendingBytes > consumedBytes ? cursor.pendingBytes - consumedBytes : 0;
+
+    // Keep the peeked batch pointing at the new head so that skipToNextPacket() keeps working on it
+    auto& batch = peekedBatch_;
+    if (batch.stream == stream && batch.count > 0 && batch.segment == cursor.readSegment
+        && batch.readOffset == previousOffset && batch.frameSizes[batch.first] == consumedBytes)
     {
-        const uint8_t port = ports[i];
-        if (port == 0 || port > MAX_PORT)
-            continue;
+        batch.readOffset = cursor.readOffset;
+        batch.first++;
+        batch.count--;
+        cursor.nextReadOffset = batch.count > 0 ? cursor.readOffset + batch.frameSizes[batch.first] : cursor.readOffset;
+    }
+    else if (batch.stream == stream)
+    {
+        batch = PeekedBatch{};
+    }
 
-        if (!isPortEmpty(port))
+    // Nothing left peeked in this lane: the next read selects the lane again
+    const uint8_t port = portOf(stream);
+    if (batch.stream != stream || batch.count == 0)
+    {
+        selectedLane_[port] = NO_LANE;
+    }
+
+    // Aging: the lane just served starts over, the lower lanes still waiting get one step closer to their turn
+    laneCredits_[stream] = 0;
+    for (uint8_t lane = laneOf(stream) + 1; lane < LANE_COUNT; lane++)
+    {
+        const uint8_t waiting = streamOf(port, lane);
+        if (!isStreamEmpty(waiting) && laneCredits_[waiting] < UINT8_MAX)
         {
-            return false;
+            laneCredits_[waiting]++;
         }
     }
+}
 
-    return true;
+bool PacketQueue::commitReadCursor(const uint8_t stream)
+{
+    const auto& cursor = cursors_[stream];
+    if (cursor.readSegment != cursor.writeSegment && cursor.readOffset >= cursor.readSegmentEnd)
+    {
+        return compactStream(stream); // compactStream() persists the cursor
+    }
+    return persistCursor(stream);
 }
 
-bool PacketQueue::isPortEmpty(uint8_t port) const
+bool PacketQueue::persistCursor(const uint8_t stream)
 {
-    if (port == 0 || port > MAX_PORT)
-        return true;
+    auto& cursor = cursors_[stream];
+    const uint32_t sequence = cursor.cursorSequence + 1;
+
+    uint8_t record[CURSOR_RECORD_SIZE];
+    writeLE16(record, cursor.readSegment);
+    writeLE16(record + 2, cursor.writeSegment);
+    writeLE32(record + 4, cursor.readOffset);
+    writeLE32(record + 8, cursor.readRecord);
+    writeLE32(record + 12, sequence);
+
+    // The record is stored as a BinaryFrame so that torn writes are detected on load
+    uint8_t frame[BinaryFrame::requiredSize(CURSOR_RECORD_SIZE, FRAME_VERSION)];
+    if (!BinaryFrame::wrapInPlace(frame, sizeof(frame), record, CURSOR_RECORD_SIZE, rtc_.getEpoch(), FRAME_VERSION))
+    {
+        return false;
+    }
 
+    // Slots are written alternately (odd sequences in slot 0): a torn write leaves the previous cursor intact in
+    // the other one
     char path[32];
-    snprintf(path, sizeof(path), "%s%u", queueBaseName_, port);
+    cursorPath(stream, static_cast<uint8_t>((sequence - 1) % CURSOR_SLOTS), path, sizeof(path));
+    // Synced on its own: cached handles are otherwise persisted only at the next sync point
+    if (const bool writeOk = storage_.overwriteBytesToFile(path, frame, sizeof(frame)) && storage_.syncFile(path);
+        !writeOk)
+    {
+        // The sequence is not advanced: the next write retries the same slot
+        LOG_CLASS_ERROR("PacketQueue::persistCursor() -> Cannot write cursor file: %s", path);
+        return false;
+    }
+    cursor.cursorSequence = sequence;
+    return true;
+}
+
+bool PacketQueue::readCursorSlot(const uint8_t stream, const uint8_t slot, StreamCursor& outCursor)
+{
+    char path[32];
+    cursorPath(stream, slot, path, sizeof(path));
 
     if (!storage_.fileExists(path))
     {
-        return true; // Si el archivo no existe, está vacío
+        return false;
     }
 
-    // LOG_CLASS_INFO("PacketQueue::isPortEmpty() -> Port %u: w=%lu:%lu r=%lu:%lu size=%lu",
-    //                port,
-    //                static_cast<unsigned long>(writeOffset_[port] >> 32),
-    //                static_cast<unsigned long>(writeOffset_[port] & 0xFFFFFFFF),
-    //                static_cast<unsigned long>(readOffset_[port] >> 32),
-    //                static_cast<unsigned long>(readOffset_[port] & 0xFFFFFFFF),
-    //                static_cast<unsigned long>(storage_.fileSize(path)));
+    uint8_t frame[BinaryFrame::requiredSize(CURSOR_RECORD_SIZE, FRAME_VERSION)]; // v1 cursors are shorter
+    const size_t readBytes = storage_.readFileBytes(path, frame, sizeof(frame));
+
+    BinaryFrame::FrameView view{};
+    if (!BinaryFrame::unwrap(frame, readBytes, view)
+        || (view.payloadLength != CURSOR_RECORD_SIZE && view.payloadLength != CURSOR_RECORD_SIZE_V1))
+    {
+        LOG_CLASS_WARNING("PacketQueue::loadCursor() -> Port %u: corrupt cursor file %s", portOf(stream), path);
+        return false;
+    }
 
-    // If the read offset is equal to the write offset, the port is empty (could also check if filesize == readOffset_)
-    return writeOffset_[port] == readOffset_[port];
+    const uint8_t* record = view.payload;
+    outCursor.readSegment = readLE16(record) & SEGMENT_SEQ_MASK;
+    outCursor.writeSegment = readLE16(record + 2) & SEGMENT_SEQ_MASK;
+    outCursor.readOffset = readLE32(record + 4);
+    outCursor.readRecord = readLE32(record + 8);
+    // The single cursor file of older firmware is slot 0 with the first sequence: the next write goes to slot 1
+    outCursor.cursorSequence = view.payloadLength == CURSOR_RECORD_SIZE ? readLE32(record + 12) : 1;
+    return true;
 }
 
-bool PacketQueue::push(uint8_t port, const uint8_t* data, const uint16_t dataLength)
+bool PacketQueue::loadCursor(const uint8_t stream)
 {
-    if (!data || dataLength == 0)
-        return false;
-    if (port == 0 || port > MAX_PORT)
+    // The newest valid slot wins
+    bool found = false;
+    for (uint8_t slot = 0; slot < CURSOR_SLOTS; slot++)
+    {
+        StreamCursor candidate{};
+        if (readCursorSlot(stream, slot, candidate)
+            && (!found || candidate.cursorSequence > cursors_[stream].cursorSequence))
+        {
+            cursors_[stream] = candidate;
+            found = true;
+        }
+    }
+    if (!found)
+    {
         return false;
+    }
 
-    char path[32];
-    snprintf(path, sizeof(path), "%s%u", queueBaseName_, port);
+    const auto& cursor = cursors_[stream];
+    LOG_CLASS_INFO("PacketQueue::loadCursor() -> Port %u lane %u: read=%u:%lu write=%u",
+                   portOf(stream), laneOf(stream),
+                   static_cast<unsigned int>(cursor.readSegment),
+                   static_cast<unsigned long>(cursor.readOffset),
+                   static_cast<unsigned int>(cursor.writeSegment));
+    return true;
+}
 
-    auto* outWrappedBuffer = SharedMemory::tmpBuffer();
-    constexpr size_t outWrapperBufferMaxLength = SharedMemory::tmpBufferSize();
-    const uint32_t ts = rtc_.getEpoch();
+bool PacketQueue::findSurvivingSegments(const uint8_t stream)
+{
+    char path[32];
+    bool cursorWritten = false;
+    for (uint8_t slot = 0; slot < CURSOR_SLOTS && !cursorWritten; slot++)
+    {
+        cursorPath(stream, slot, path, sizeof(path));
+        cursorWritten = storage_.fileExists(path);
+    }
+    segmentPath(stream, 0, path, sizeof(path));
+    if (!cursorWritten && !storage_.fileExists(path))
+    {
+        return false; // First run (or a v1 queue): nothing to recover
+    }
 
-    if (const bool wrapOk = BinaryFrame::wrapInPlace(outWrappedBuffer, outWrapperBufferMaxLength, data, dataLength, ts);
-        !wrapOk)
+    // Live segments are a run of consecutive numbers (modulo SEGMENT_SEQ_MASK): find one, then both ends
+    constexpr uint32_t segmentNumbers = SEGMENT_SEQ_MASK + 1u;
+    auto exists = [&](const uint16_t segment)
+    {
+        segmentPath(stream, segment, path, sizeof(path));
+        return storage_.fileExists(path);
+    };
+    uint32_t found = 0;
+    while (found < segmentNumbers && !exists(static_cast<uint16_t>(found)))
+    {
+        found++;
+    }
+    if (found == segmentNumbers)
     {
-        LOG_CLASS_ERROR("PacketQueue::push() -> Failed to wrap data for port %u", port);
         return false;
     }
 
-    // Calculate the end position (header + data + footer)
-    const size_t outWrapperBufferSize = BinaryFrame::requiredSize(dataLength);
+    auto& cursor = cursors_[stream];
+    cursor.readSegment = static_cast<uint16_t>(found);
+    cursor.writeSegment = static_cast<uint16_t>(found);
+    for (uint32_t i = 1; i < segmentNumbers; i++)
+    {
+        const auto previous = static_cast<uint16_t>((cursor.readSegment - 1) & SEGMENT_SEQ_MASK);
+        if (previous == cursor.writeSegment || !exists(previous))
+            break;
+        cursor.readSegment = previous;
+    }
+    for (uint32_t i = 1; i < segmentNumbers; i++)
+    {
+        const uint16_t next = nextSegment(cursor.writeSegment);
+        if (next == cursor.readSegment || !exists(next))
+            break;
+        cursor.writeSegment = next;
+    }
 
-    const bool ok = storage_.appendBytesToFile(path, outWrappedBuffer, outWrapperBufferSize);
-    if (ok)
+    // Where the reader was is unknown: everything left is delivered again rather than lost
+    cursor.readOffset = 0;
+    cursor.readRecord = 0;
+    LOG_CLASS_WARNING("PacketQueue::begin() -> Port %u lane %u: no valid cursor, rebuilt from segments %03X..%03X",
+                      portOf(stream), laneOf(stream),
+                      static_cast<unsigned int>(cursor.readSegment),
+                      static_cast<unsigned int>(cursor.writeSegment));
+    return true;
+}
+
+uint32_t PacketQueue::countPending(const uint8_t port) const
+{
+    if (port == 0 || port > MAX_PORT) return 0;
+    uint32_t total = 0;
+    for (uint8_t lane = 0; lane < LANE_COUNT; lane++)
     {
-        writeOffset_[port] += outWrapperBufferSize; // Update write offset
+        total += cursors_[streamOf(port, lane)].pendingCount;
     }
+    return total;
+}
 
-    return ok;
+uint32_t PacketQueue::countPending(const uint8_t port, const Priority priority) const
+{
+    if (port == 0 || port > MAX_PORT || static_cast<uint8_t>(priority) >= LANE_COUNT) return 0;
+    return cursors_[streamOf(port, static_cast<uint8_t>(priority))].pendingCount;
+}
+
+uint32_t PacketQueue::countPending() const
+{
+    uint32_t total = 0;
+    for (uint8_t stream = 0; stream < STREAM_COUNT; stream++)
+    {
+        total += cursors_[stream].pendingCount;
+    }
+    return total;
+}
+
+uint32_t PacketQueue::size(const uint8_t port) const
+{
+    if (port == 0 || port > MAX_PORT) return 0;
+    uint32_t total = 0;
+    for (uint8_t lane = 0; lane < LANE_COUNT; lane++)
+    {
+        total += cursors_[streamOf(port, lane)].pendingBytes;
+    }
+    return total;
+}
+
+uint32_t PacketQueue::size() const
+{
+    uint32_t total = 0;
+    for (uint8_t stream = 0; stream < STREAM_COUNT; stream++)
+    {
+        total += cursors_[stream].pendingBytes;
+    }
+    return total;
+}
+
+PacketQueue::DropCounters PacketQueue::getDropCounters(const uint8_t port) const
+{
+    if (port == 0 || port > MAX_PORT) return DropCounters{};
+    return dropCounters_[port];
 }
 
 uint64_t PacketQueue::getReadOffset(const uint8_t port) const
 {
     if (port == 0 || port > MAX_PORT) return 0;
-    return readOffset_[port];
+    uint8_t lane = activeLane(port);
+    if (lane == NO_LANE) lane = static_cast<uint8_t>(Priority::Bulk);
+    const auto& cursor = cursors_[streamOf(port, lane)];
+    return static_cast<uint64_t>(lane) << 48 | static_cast<uint64_t>(cursor.readSegment) << 32 | cursor.readOffset;
 }
 
 uint64_t PacketQueue::getNextReadOffset(const uint8_t port) const
 {
     if (port == 0 || port > MAX_PORT) return 0;
-    return nextReadOffset_[port];
+    uint8_t lane = activeLane(port);
+    if (lane == NO_LANE) lane = static_cast<uint8_t>(Priority::Bulk);
+    const auto& cursor = cursors_[streamOf(port, lane)];
+    return static_cast<uint64_t>(lane) << 48 | static_cast<uint64_t>(cursor.readSegment) << 32 | cursor.nextReadOffset;
 }
 
 uint16_t PacketQueue::peekNext(uint8_t port, uint8_t* outBuffer, uint16_t maxOutSize)
@@ -195,19 +1637,22 @@ uint16_t PacketQueue::peekAnyFromPorts(const uint8_t* ports, const size_t portCo
     if (!outBuffer || maxOutSize == 0)
         return 0;
 
-    // Iterate over the provided ports
+    // The port whose next lane has the highest priority wins (ties keep the order of `ports`)
+    uint8_t bestPort = 0;
+    uint8_t bestLane = NO_LANE;
     for (size_t i = 0; i < portCount; i++)
     {
-        // Check if this port is empty
-        if (isPortEmpty(ports[i]))
-        {
+        if (ports[i] == 0 || ports[i] > MAX_PORT)
             continue;
+
+        if (const uint8_t lane = selectLane(ports[i]); lane < bestLane)
+        {
+            bestPort = ports[i];
+            bestLane = lane;
         }
-        // If not empty, peek from this port
-        return _next(ports[i], outBuffer, maxOutSize, false);
     }
 
-    return 0;
+    return bestLane == NO_LANE ? 0 : _next(bestPort, outBuffer, maxOutSize, false);
 }
 
 
@@ -236,19 +1681,22 @@ uint16_t PacketQueue::popAnyFromPorts(const uint8_t* ports, const size_t portCou
     if (!outBuffer || maxOutSize == 0)
         return 0;
 
-    // Iterate over the provided ports
+    // The port whose next lane has the highest priority wins (ties keep the order of `ports`)
+    uint8_t bestPort = 0;
+    uint8_t bestLane = NO_LANE;
     for (size_t i = 0; i < portCount; i++)
     {
-        // Check if this port is empty
-        if (isPortEmpty(ports[i]))
-        {
+        if (ports[i] == 0 || ports[i] > MAX_PORT)
             continue;
+
+        if (const uint8_t lane = selectLane(ports[i]); lane < bestLane)
+        {
+            bestPort = ports[i];
+            bestLane = lane;
         }
-        // If not empty, pop from this port
-        return _next(ports[i], outBuffer, maxOutSize, true);
     }
 
-    return 0;
+    return bestLane == NO_LANE ? 0 : _next(bestPort, outBuffer, maxOutSize, true);
 }
 
 bool PacketQueue::skipToNextPacket(uint8_t port)
@@ -256,25 +1704,134 @@ bool PacketQueue::skipToNextPacket(uint8_t port)
     if (port == 0 || port > MAX_PORT)
         return false;
 
-    // Nowhere to skip to if the port is already empty
-    if (readOffset_[port] == writeOffset_[port])
+    // Only the lane of the last peek can be skipped
+    const uint8_t lane = selectedLane_[port];
+    if (lane == NO_LANE)
+        return false;
+
+    const uint8_t stream = streamOf(port, lane);
+    const auto& cursor = cursors_[stream];
+
+    // Nowhere to skip to if the lane is already empty
+    if (isStreamEmpty(stream))
         return false;
 
     // Nowhere to skip to if the next read offset is the same as the current read offset
     // (must have been peeked before)
-    if (nextReadOffset_[port] == readOffset_[port])
+    if (cursor.nextReadOffset == cursor.readOffset)
+        return false;
+
+    // Update the current read offset to the next read offset (and persist it)
+    return advanceReadCursor(stream);
+}
+
+size_t PacketQueue::peekBatch(const uint8_t port, uint8_t* buffer, const size_t bufferSize,
+                              BinaryFrame::FrameView* outViews, size_t maxFrames)
+{
+    if (!buffer || bufferSize == 0 || !outViews || maxFrames == 0)
+        return 0;
+    if (port == 0 || port > MAX_PORT)
+        return 0;
+
+    // A batch never mixes lanes: it holds consecutive packets of the lane that would be read next
+    const uint8_t lane = prepareReadLane(port);
+    if (lane == NO_LANE)
+        return 0;
+    const uint8_t stream = streamOf(port, lane);
+
+    if (maxFrames > MAX_BATCH_FRAMES)
+        maxFrames = MAX_BATCH_FRAMES;
+
+    auto& cursor = cursors_[stream];
+    const uint32_t readLimit = (cursor.readSegment == cursor.writeSegment)
+                                   ? cursor.writeOffset
+                                   : cursor.readSegmentEnd;
+    const size_t available = readLimit - cursor.readOffset;
+
+    char path[32];
+    segmentPath(stream, cursor.readSegment, path, sizeof(path));
+
+    // One region read for the whole batch (never crosses a segment)
+    const size_t readBytes = storage_.readFileRegionBytes(
+        path, cursor.readOffset, buffer, available < bufferSize ? available : bufferSize
+    );
+
+    auto& batch = peekedBatch_;
+    batch = PeekedBatch{};
+
+    size_t frames = 0;
+    size_t pos = 0;
+    while (frames < maxFrames && BinaryFrame::unwrap(buffer + pos, readBytes - pos, outViews[frames]))
+    {
+        const size_t frameSize = outViews[frames].frameLength;
+        batch.frameSizes[frames] = static_cast<uint16_t>(frameSize);
+        pos += frameSize;
+        frames++;
+    }
+
+    if (frames == 0)
+    {
+        // A head frame larger than the buffer is legal (up to the tmp buffer size): the caller peeks it alone
+        if (BinaryFrame::Header header{}; readBytes == bufferSize
+            && BinaryFrame::parseHeader(buffer, readBytes, header) && BinaryFrame::frameSize(header) > bufferSize)
+        {
+            LOG_CLASS_DEBUG("PacketQueue::peekBatch() -> Port %u: head frame of %u bytes does not fit in %u",
+                            port, static_cast<unsigned int>(BinaryFrame::frameSize(header)),
+                            static_cast<unsigned int>(bufferSize));
+            return 0;
+        }
+        LOG_CLASS_ERROR("PacketQueue::peekBatch() -> Port %u: no complete frame in %u bytes",
+                        port, static_cast<unsigned int>(readBytes));
+        return 0;
+    }
+
+    batch.stream = stream;
+    batch.count = static_cast<uint8_t>(frames);
+    batch.segment = cursor.readSegment;
+    batch.readOffset = cursor.readOffset;
+    cursor.nextReadOffset = cursor.readOffset + batch.frameSizes[0];
+
+    LOG_CLASS_INFO("PacketQueue::peekBatch() -> Port %u lane %u: %u packets in one read of %u bytes",
+                   port, lane, static_cast<unsigned int>(frames), static_cast<unsigned int>(readBytes));
+    return frames;
+}
+
+size_t PacketQueue::popBatch(const uint8_t port, uint8_t* buffer, const size_t bufferSize,
+                             BinaryFrame::FrameView* outViews, const size_t maxFrames)
+{
+    const size_t frames = peekBatch(port, buffer, bufferSize, outViews, maxFrames);
+    if (frames > 0 && !skipPackets(port, frames))
+    {
+        LOG_CLASS_ERROR("PacketQueue::popBatch() -> Port %u: Failed to persist read cursor", port);
+    }
+    return frames;
+}
+
+bool PacketQueue::skipPackets(const uint8_t port, const size_t count)
+{
+    if (port == 0 || port > MAX_PORT)
         return false;
 
-    // Update the current read offset to the next read offset
-    readOffset_[port] = nextReadOffset_[port];
+    // A lost write invalidates the peeked batch of its stream
+    resyncLostWrites();
 
-    // Ensure we do not exceed the write offset
-    if (readOffset_[port] > writeOffset_[port])
+    const auto& batch = peekedBatch_;
+    const uint8_t stream = batch.stream;
+    if (stream == NO_STREAM || portOf(stream) != port || batch.segment != cursors_[stream].readSegment
+        || batch.readOffset != cursors_[stream].readOffset || count > batch.count)
     {
-        readOffset_[port] = writeOffset_[port];
+        LOG_CLASS_ERROR("PacketQueue::skipPackets() -> Port %u: no peeked batch with %u packets",
+                        port, static_cast<unsigned int>(count));
+        return false;
     }
+    if (count == 0)
+        return true;
 
-    return true;
+    for (size_t i = 0; i < count; i++)
+    {
+        consumeFrame(stream); // nextReadOffset always points at the end of the batch head
+    }
+    return commitReadCursor(stream);
 }
 
 uint16_t PacketQueue::_next(const uint8_t port, uint8_t* outBuffer, const uint16_t maxOutSize, bool pop)
@@ -284,19 +1841,79 @@ uint16_t PacketQueue::_next(const uint8_t port, uint8_t* outBuffer, const uint16
     if (port == 0 || port > MAX_PORT)
         return 0;
 
+    const uint8_t lane = prepareReadLane(port);
+    if (lane == NO_LANE)
+        return 0;
+    const uint8_t stream = streamOf(port, lane);
+
+    if (portOf(peekedBatch_.stream) == port)
+    {
+        peekedBatch_ = PeekedBatch{};
+    }
+
+    auto& cursor = cursors_[stream];
+
     char path[32];
-    snprintf(path, sizeof(path), "%s%u", queueBaseName_, port);
+    segmentPath(stream, cursor.readSegment, path, sizeof(path));
 
     auto* dataBuffer = SharedMemory::tmpBuffer();
 
-    const size_t dataBufferSize = storage_.readFileRegionBytes(
-        path, readOffset_[port], dataBuffer, SharedMemory::tmpBufferSize()
-    );
+    // With the index only the bytes of this frame are read; otherwise a whole tmp buffer is read and parsed
+    size_t readLength = SharedMemory::tmpBufferSize();
+    if (IndexRecord record{}; config_.frameIndex && lookupIndexRecord(stream, record))
+    {
+        // Sized for a v2 frame: a v1 frame (older firmware) is 4 bytes shorter and still unwraps fine
+        if (const size_t frameSize = BinaryFrame::requiredSize(record.length, FRAME_VERSION);
+            record.offset == cursor.readOffset && frameSize <= readLength)
+        {
+            readLength = frameSize;
+        }
+        else
+        {
+            LOG_CLASS_WARNING("PacketQueue::popNext() -> Port %u: index out of sync at %lu, reading without it",
+                              port, static_cast<unsigned long>(cursor.readOffset));
+        }
+    }
+
+    // A backend that maps the file (gateway) is unwrapped in place; otherwise the frame is copied to the tmp buffer
+    const uint8_t* frameBytes = dataBuffer;
+    size_t frameBytesLength = 0;
+    if (const ByteSpan mapped = storage_.mapFileRegion(path, cursor.readOffset, readLength); !mapped.empty())
+    {
+        frameBytes = mapped.data;
+        frameBytesLength = mapped.length;
+    }
+    else
+    {
+        frameBytesLength = storage_.readFileRegionBytes(path, cursor.readOffset, dataBuffer, readLength);
+    }
+    if (frameBytesLength == 0)
+    {
+        // The segment may be shorter than the cursor (data lost before reaching storage): skip to its real end
+        if (recoverShortSegment(stream))
+        {
+            return 0;
+        }
+        // Otherwise a read error with the bytes in place: retried on the next call, never treated as corruption
+        LOG_CLASS_ERROR("PacketQueue::popNext() -> Port %u: Failed to read frame at %u:%lu",
+                        port,
+                        static_cast<unsigned int>(cursor.readSegment),
+                        static_cast<unsigned long>(cursor.readOffset));
+        return 0;
+    }
 
     BinaryFrame::FrameView outFrameView{};
-    if (const bool unwrapOk = BinaryFrame::unwrap(dataBuffer, dataBufferSize, outFrameView); !unwrapOk)
+    if (const bool unwrapOk = BinaryFrame::unwrap(frameBytes, frameBytesLength, outFrameView); !unwrapOk)
     {
-        LOG_CLASS_ERROR("PacketQueue::popNext() -> Port %u: Failed to unwrap binary frame", port);
+        LOG_CLASS_ERROR("PacketQueue::popNext() -> Port %u: Failed to unwrap binary frame at %u:%lu",
+                        port,
+                        static_cast<unsigned int>(cursor.readSegment),
+                        static_cast<unsigned long>(cursor.readOffset));
+        // Corrupt data (torn write) can never be read back: skip it so that the port does not stall
+        if (!resyncReadCursor(stream))
+        {
+            LOG_CLASS_ERROR("PacketQueue::popNext() -> Port %u: Failed to resynchronize read cursor", port);
+        }
         return 0;
     }
 
@@ -310,31 +1927,30 @@ uint16_t PacketQueue::_next(const uint8_t port, uint8_t* outBuffer, const uint16
                         static_cast<unsigned int>(outFrameView.payloadLength));
         return 0;
     }
-    memcpy(outBuffer, outFrameView.payload, outFrameView.payloadLength);
+    // The output buffer may be the shared tmp buffer itself (e.g. Router), so regions can overlap
+    memmove(outBuffer, outFrameView.payload, outFrameView.payloadLength);
 
-    LOG_CLASS_INFO("PacketQueue::popNext() -> Port %u: ts=%lu len=%u (w=%lu:%lu r=%lu:%lu size=%lu)",
+    LOG_CLASS_INFO("PacketQueue::popNext() -> Port %u lane %u: ts=%lu len=%u (w=%u:%lu r=%u:%lu)",
                    port,
+                   lane,
                    static_cast<unsigned long>(outFrameView.timestamp),
                    static_cast<unsigned int>(outFrameView.payloadLength),
-                   static_cast<unsigned long>(writeOffset_[port] >> 32),
-                   static_cast<unsigned long>(writeOffset_[port] & 0xFFFFFFFF),
-                   static_cast<unsigned long>(readOffset_[port] >> 32),
-                   static_cast<unsigned long>(readOffset_[port] & 0xFFFFFFFF),
-                   static_cast<unsigned long>(storage_.fileSize(path)));
+                   static_cast<unsigned int>(cursor.writeSegment),
+                   static_cast<unsigned long>(cursor.writeOffset),
+                   static_cast<unsigned int>(cursor.readSegment),
+                   static_cast<unsigned long>(cursor.readOffset));
 
 
-    const auto totalEntrySize = BinaryFrame::requiredSize(outFrameView.payloadLength);
+    const auto totalEntrySize = outFrameView.frameLength;
 
     // Always update the next read offset
-    nextReadOffset_[port] = readOffset_[port] + totalEntrySize;
+    cursor.nextReadOffset = cursor.readOffset + totalEntrySize;
 
     // Actualiza el índice para el siguiente paquete si es necesario
-    if (pop)
+    if (pop && !advanceReadCursor(stream))
     {
-        readOffset_[port] = nextReadOffset_[port];
+        LOG_CLASS_ERROR("PacketQueue::popNext() -> Port %u: Failed to persist read cursor", port);
     }
 
-    // LOG_CLASS_INFO("PacketQueue::popNext() -> Port %u, Read %u bytes", port, static_cast<unsigned int>(readLen));
     return outFrameView.payloadLength;
-
 }
@@ -8,10 +8,35 @@
 #include "Ports/IPort.h"
 #include "StorageManager/StorageManager.hpp"
 #include "StorageManager/SDStorageManager/SDPath/SDPath.hpp"
+#include "PacketQueueConfig.hpp"
+#include "BinaryFrame/BinaryFrame.hpp"
 
 
 /**
  * @brief Clase que implementa una cola de paquetes persistente utilizando un StorageManager.
+ *
+ * Cada puerto se almacena como una secuencia de segmentos append-only ("/queueN.XXX") más un pequeño
+ * registro de cursor persistido ("/queueN.cur"). El cursor sobrevive a reinicios del watchdog y los
+ * segmentos completamente consumidos se eliminan (compactación), de modo que el uso de SD es acotado.
+ * El cursor se escribe alternando dos ficheros (".cur" / ".cub") con un número de secuencia; si ninguno es válido
+ * se reconstruye a partir de los segmentos que quedan en la tarjeta.
+ *
+ * Los push() se acumulan en un pequeño buffer de staging en RAM (write-behind) y se escriben con un único
+ * append cuando se llena, cuando envejece (flushIfStale) o antes de leer el mismo puerto.
+ *
+ * Opcionalmente cada segmento tiene un índice ("/qidxN.XXX") con un registro (offset, longitud, timestamp) por
+ * frame, de modo que peekNext() lee exactamente los bytes de un frame.
+ *
+ * Con índice y un almacenamiento que lo soporte, cada segmento se crea preasignado (SEGMENT_MAX_BYTES contiguos) y
+ * los frames se escriben en su posición en lugar de con appends: el final lógico lo da el índice, no fileSize().
+ *
+ * Cada puerto tiene LANE_COUNT carriles de prioridad (control / report / bulk), cada uno con sus propios segmentos
+ * append-only ("/queueNc.XXX", "/queueNr.XXX" y "/queueN.XXX" para bulk). Las lecturas sirven primero el carril
+ * más prioritario, salvo que un carril inferior lleve LANE_AGING_THRESHOLD paquetes esperando (anti-starvation).
+ *
+ * Cada puerto puede tener una política de retención (PacketQueuePortPolicy): los paquetes más antiguos que maxAge se
+ * saltan al leer usando solo el timestamp de la cabecera (o del índice), y maxBytes limita el tamaño pendiente
+ * descartando los más antiguos o rechazando los nuevos.
  */
 class PacketQueue
 {
@@ -24,7 +49,45 @@ public:
     static constexpr size_t HEADER_SIZE = 1 + 4 + 2; // start + timestamp(4) + length(2)
     static constexpr size_t FOOTER_SIZE = 1; // end
 
-    explicit PacketQueue(StorageManager& storage, RTCController& rtc);
+    // Frames are written as BinaryFrame v2 (CRC-32); v1 frames written by older firmware are still read
+    static constexpr BinaryFrame::Version FRAME_VERSION = BinaryFrame::Version::V2;
+
+    // Max bytes per segment before rotating to a new one (keeps fileSize()/seek costs flat on FAT)
+    static constexpr uint32_t SEGMENT_MAX_BYTES = 16 * 1024;
+
+    // Write-behind staging buffer: frames of a single port are coalesced into one append
+    static constexpr size_t STAGING_BUFFER_SIZE = 512;
+    static constexpr unsigned long STAGING_MAX_AGE_MS = 2000;
+
+    // Max packets returned by a single peekBatch()/popBatch()
+    static constexpr size_t MAX_BATCH_FRAMES = 8;
+
+    // Priority lanes of each port (lower value = served first)
+    enum class Priority : uint8_t
+    {
+        Control = 0, // Commands and errors
+        Report = 1, // Responses and reports
+        Bulk = 2, // Everything else (unknown / undecodable payloads)
+    };
+
+    static constexpr uint8_t LANE_COUNT = 3;
+
+    // A non-empty lane that has been passed over this many times is served next
+    static constexpr uint8_t LANE_AGING_THRESHOLD = 4;
+
+    // Packets discarded by the retention policy of a port (RAM only, since begin())
+    struct DropCounters
+    {
+        uint32_t expired = 0; // Older than maxAgeSeconds when read
+        uint32_t evicted = 0; // Dropped to make room (Overflow::DropOldest)
+        uint32_t rejected = 0; // push() refused (Overflow::RejectNew)
+    };
+
+    // Classifies an encoded CommunicationPacket into a lane without decoding it
+    [[nodiscard]] static Priority priorityOf(const uint8_t* data, size_t length);
+
+    explicit PacketQueue(StorageManager& storage, RTCController& rtc,
+                         const PacketQueueConfig& config = PacketQueueConfig{});
 
     [[nodiscard]] bool begin();
 
@@ -40,47 +103,244 @@ public:
     // Checks if the specified port is empty
     [[nodiscard]] bool isPortEmpty(uint8_t port) const;
 
-    // Pushes a packet into the queue for the specified port
-    [[nodiscard]] bool push(uint8_t port, const uint8_t* data, uint16_t dataLength);
+    // Pushes a packet into the lane of the specified port
+    [[nodiscard]] bool push(uint8_t port, const uint8_t* data, uint16_t dataLength,
+                            Priority priority = Priority::Bulk);
 
-    // Peeks the next packet from the specified port without removing it
+    // Peeks the next packet from the specified port without removing it (highest priority lane, with aging).
+    // The selected lane is remembered for the following skipToNextPacket()/skipPackets()
     [[nodiscard]] uint16_t peekNext(uint8_t port, uint8_t* outBuffer, uint16_t maxOutSize);
 
-    // Peeks any packet from the queue (FI-FO among all ports) without removing it
+    // Peeks any packet from the queue (highest priority lane first, FI-FO among ports) without removing it
     [[nodiscard]] uint16_t peekAny(uint8_t* outBuffer, uint16_t maxOutSize);
 
-    // Peeks any packet from the specified ports (FI-FO among them) without removing it
+    // Peeks any packet from the specified ports (highest priority lane first) without removing it
     [[nodiscard]] uint16_t peekAnyFromPorts(const uint8_t* ports, size_t portCount, uint8_t* outBuffer,
                                             uint16_t maxOutSize);
 
     // Pops the next packet from the specified port
     [[nodiscard]] uint16_t popNext(uint8_t port, uint8_t* outBuffer, uint16_t maxOutSize);
 
-    // Pops any packet from the queue (FI-FO among all ports)
+    // Pops any packet from the queue (highest priority lane first, FI-FO among ports)
     [[nodiscard]] uint16_t popAny(uint8_t* outBuffer, uint16_t maxOutSize);
 
-    // Pops any packet from the specified ports (FI-FO among them)
+    // Pops any packet from the specified ports (highest priority lane first)
     [[nodiscard]] uint16_t popAnyFromPorts(const uint8_t* ports, size_t portCount, uint8_t* outBuffer,
                                            uint16_t maxOutSize);
 
     [[nodiscard]] bool skipToNextPacket(uint8_t port);
 
+    /**
+     * Peeks up to maxFrames consecutive packets of the port with a single storage read into buffer.
+     * The returned views point into buffer. Returns the number of packets peeked (0 if the first one
+     * does not fit in buffer).
+     */
+    [[nodiscard]] size_t peekBatch(uint8_t port, uint8_t* buffer, size_t bufferSize,
+                                   BinaryFrame::FrameView* outViews, size_t maxFrames);
+
+    // Same as peekBatch() but the packets are consumed with a single cursor update
+    [[nodiscard]] size_t popBatch(uint8_t port, uint8_t* buffer, size_t bufferSize,
+                                  BinaryFrame::FrameView* outViews, size_t maxFrames);
+
+    // Consumes the first `count` packets of the last peekBatch() of the port with a single cursor update
+    [[nodiscard]] bool skipPackets(uint8_t port, size_t count);
+
+    // Writes the staged frames (if any) to storage
+    [[nodiscard]] bool flush();
+
+    // Writes the staged frames only if they have been waiting for more than STAGING_MAX_AGE_MS
+    [[nodiscard]] bool flushIfStale();
+
+    // Sync point: persists the frames appended to storage since the last one (staged frames are not flushed)
+    [[nodiscard]] bool sync();
+
+    // Deletes the segments of the port that have been completely consumed
+    [[nodiscard]] bool compact(uint8_t port);
+
+    // A write already reported as done never reached `path` (DeferredStorageManager drain failure). Only takes
+    // note: the stream it belongs to is resynchronized with its files on the next push or read
+    void onWriteLost(const char* path);
+
+    // Number of packets pending in the port (staged ones included). O(1), no storage access
+    [[nodiscard]] uint32_t countPending(uint8_t port) const;
+
+    // Number of packets pending in one lane of the port
+    [[nodiscard]] uint32_t countPending(uint8_t port, Priority priority) const;
+
+    // Number of packets pending in all ports
+    [[nodiscard]] uint32_t countPending() const;
+
+    // Bytes (framed) pending in the port (staged ones included). O(1), no storage access
+    [[nodiscard]] uint32_t size(uint8_t port) const;
+
+    // Bytes (framed) pending in all ports
+    [[nodiscard]] uint32_t size() const;
+
+    // Packets dropped by the retention policy of the port
+    [[nodiscard]] DropCounters getDropCounters(uint8_t port) const;
+
+    // Logical read position of the selected lane: (lane << 48) | (segment << 32) | offset inside the segment
     [[nodiscard]] uint64_t getReadOffset(uint8_t port) const;
 
     [[nodiscard]] uint64_t getNextReadOffset(uint8_t port) const;
 
 private:
-    [[nodiscard]] uint16_t _next(uint8_t port,  uint8_t* outBuffer, uint16_t maxOutSize, bool pop);
+    // A stream is one lane of one port: stream = (port - 1) * LANE_COUNT + lane
+    static constexpr uint8_t MAX_PORT = static_cast<uint8_t>(IPort::MAX_PORT_TYPE_U8);
+    static constexpr uint8_t STREAM_COUNT = MAX_PORT * LANE_COUNT;
+    static constexpr uint8_t NO_STREAM = 0xFF;
+    static_assert(STREAM_COUNT <= 32, "lostWriteStreams_ has one bit per stream");
+    static constexpr uint8_t NO_LANE = 0xFF;
+
+    static constexpr uint8_t streamOf(const uint8_t port, const uint8_t lane)
+    {
+        return static_cast<uint8_t>((port - 1) * LANE_COUNT + lane);
+    }
+
+    static constexpr uint8_t portOf(const uint8_t stream) { return static_cast<uint8_t>(stream / LANE_COUNT + 1); }
+    static constexpr uint8_t laneOf(const uint8_t stream) { return static_cast<uint8_t>(stream % LANE_COUNT); }
+
+    [[nodiscard]] uint16_t _next(uint8_t port, uint8_t* outBuffer, uint16_t maxOutSize, bool pop);
+
+    // Per-stream cursor. Only readSegment/readOffset/writeSegment/readRecord are persisted, the rest is rebuilt
+    // on begin()
+    struct StreamCursor
+    {
+        uint16_t readSegment = 0;
+        uint16_t writeSegment = 0;
+        uint32_t readOffset = 0; // Offset inside readSegment
+        uint32_t nextReadOffset = 0; // Offset inside readSegment of the packet after the last peeked one
+        uint32_t readSegmentEnd = 0; // Logical end of readSegment once it is closed (readSegment != writeSegment)
+        uint32_t writeOffset = 0; // Offset inside writeSegment
+        uint32_t readRecord = 0; // Index record (frame number) of readOffset inside readSegment
+        uint32_t pendingCount = 0; // Frames not yet consumed (RAM only, rebuilt on begin())
+        uint32_t pendingBytes = 0; // Framed bytes not yet consumed (RAM only, rebuilt on begin())
+        bool preallocated = false; // writeSegment spans a preallocated extent: frames go at writeOffset (RAM only)
+        uint32_t cursorSequence = 0; // Sequence of the last persisted cursor record (0 = none yet)
+    };
+
+    struct IndexRecord
+    {
+        uint32_t offset = 0;
+        uint32_t timestamp = 0;
+        uint16_t length = 0; // Payload length
+    };
+
+    // Small per-port window of index records (of the lane being read) to avoid one index read per peek
+    struct IndexWindow
+    {
+        uint8_t stream = NO_STREAM;
+        uint16_t segment = 0;
+        uint32_t firstRecord = 0;
+        uint8_t count = 0; // 0 = invalid
+        IndexRecord records[4];
+    };
+
+    // Frames returned by the last peekBatch(), valid while the read cursor still points at `readOffset`
+    struct PeekedBatch
+    {
+        uint8_t stream = NO_STREAM;
+        uint8_t first = 0;
+        uint8_t count = 0;
+        uint16_t segment = 0;
+        uint32_t readOffset = 0;
+        uint16_t frameSizes[MAX_BATCH_FRAMES] = {};
+    };
+
+    static constexpr uint16_t SEGMENT_SEQ_MASK = 0x0FFF; // 3 hex digits in the 8.3 extension
+    // readSegment + writeSegment + readOffset + readRecord + sequence
+    static constexpr size_t CURSOR_RECORD_SIZE = 2 + 2 + 4 + 4 + 4;
+    static constexpr size_t CURSOR_RECORD_SIZE_V1 = 2 + 2 + 4 + 4; // Single cursor file, no sequence
+    static constexpr uint8_t CURSOR_SLOTS = 2;
+    static constexpr size_t INDEX_RECORD_SIZE = 4 + 2 + 4; // offset + length + timestamp
+    static constexpr uint8_t INDEX_WINDOW_RECORDS = sizeof(IndexWindow::records) / sizeof(IndexRecord);
+
+    static constexpr uint16_t nextSegment(const uint16_t segment)
+    {
+        return static_cast<uint16_t>((segment + 1) & SEGMENT_SEQ_MASK);
+    }
+
+    void segmentPath(uint8_t stream, uint16_t segment, char* outPath, size_t outPathSize) const;
+    void cursorPath(uint8_t stream, uint8_t slot, char* outPath, size_t outPathSize) const;
+    void indexPath(uint8_t stream, uint16_t segment, char* outPath, size_t outPathSize) const;
+
+    [[nodiscard]] bool isStreamEmpty(uint8_t stream) const;
+    // Lane to read next from the port (NO_LANE if the port is empty)
+    [[nodiscard]] uint8_t selectLane(uint8_t port) const;
+    // Lane remembered by the last peek of the port, or a fresh selection
+    [[nodiscard]] uint8_t activeLane(uint8_t port) const;
+    // Selects the lane to read and prepares it (staged frames flushed, expired frames skipped). NO_LANE if empty
+    [[nodiscard]] uint8_t prepareReadLane(uint8_t port);
+
+    // Timestamp of the frame at the read cursor (from the index when possible, otherwise from the frame header)
+    [[nodiscard]] bool readHeadTimestamp(uint8_t stream, uint32_t& outTimestamp);
+    // Consumes the frame at the read cursor reading only its header (the cursor is not persisted)
+    [[nodiscard]] bool dropHeadFrame(uint8_t stream);
+    [[nodiscard]] bool dropExpiredFrames(uint8_t stream);
+    [[nodiscard]] bool makeRoom(uint8_t port, size_t frameSize);
+
+    [[nodiscard]] bool beginStream(uint8_t stream);
+    [[nodiscard]] bool clearStream(uint8_t stream);
+    [[nodiscard]] bool compactStream(uint8_t stream);
+    [[nodiscard]] bool loadCursor(uint8_t stream);
+    // Reads one cursor slot: false if it is missing or torn
+    [[nodiscard]] bool readCursorSlot(uint8_t stream, uint8_t slot, StreamCursor& outCursor);
+    // No valid cursor slot: read and write segments are taken from the segments left on the storage (false if none)
+    [[nodiscard]] bool findSurvivingSegments(uint8_t stream);
+    [[nodiscard]] bool persistCursor(uint8_t stream);
+    [[nodiscard]] bool rotateWriteSegment(uint8_t stream);
+    [[nodiscard]] bool advanceReadCursor(uint8_t stream);
+    // Skips the corrupt bytes at the read cursor up to the next plausible frame boundary
+    [[nodiscard]] bool resyncReadCursor(uint8_t stream);
+    // After a failed read: if the read segment ends before the cursor (torn append, dropped deferred write) the
+    // cursor is clamped to its real end. False if the bytes are there (a plain read error, retried later)
+    [[nodiscard]] bool recoverShortSegment(uint8_t stream);
+    // Streams marked by onWriteLost(): offsets, indexes and counters are rebuilt from what the files hold
+    void resyncLostWrites();
+    [[nodiscard]] bool resyncStream(uint8_t stream);
+    void consumeFrame(uint8_t stream);
+    [[nodiscard]] bool commitReadCursor(uint8_t stream);
+    // Appends whole frames given as consecutive parts; parts[0] holds the headers of every frame (the staged frames,
+    // or the header of a single [header][payload][footer] frame)
+    [[nodiscard]] bool appendFrames(uint8_t stream, const IoVec* parts, size_t count);
+    [[nodiscard]] bool appendIndexRecords(uint8_t stream, const uint8_t* frames, size_t length, uint32_t baseOffset);
+    [[nodiscard]] bool lookupIndexRecord(uint8_t stream, IndexRecord& outRecord);
+    // Number of the first index record of the read segment at or after `offset`, searching from readRecord
+    [[nodiscard]] bool seekIndexRecord(uint8_t stream, uint32_t offset, uint32_t& outRecord);
+    [[nodiscard]] bool rebuildPendingCounters(uint8_t stream);
+    // Walks the frames in [fromOffset, toOffset); outEndOffset receives the end of the last whole frame
+    [[nodiscard]] uint32_t scanSegment(uint8_t stream, uint16_t segment, uint32_t fromOffset, uint32_t toOffset,
+                                       bool writeIndex, uint32_t* outEndOffset = nullptr);
+    [[nodiscard]] bool usesPreallocation() const;
+    // Creates an empty segment, preallocated when the storage supports it
+    [[nodiscard]] bool createSegment(uint8_t stream, uint16_t segment, bool& outPreallocated);
+    // End of the last frame listed in the index of the segment (0 if none)
+    [[nodiscard]] uint32_t indexedEnd(uint8_t stream, uint16_t segment);
+    // Logical end of a closed segment: its size, or the indexed end when it spans a preallocated extent
+    [[nodiscard]] uint32_t closedSegmentEnd(uint8_t stream, uint16_t segment);
 
 private:
     StorageManager& storage_;
     RTCController& rtc_;
+    const PacketQueueConfig config_;
     const char* queueBaseName_ = SD_PATH("/queue");
-    static constexpr uint8_t MAX_PORT = static_cast<uint8_t>(IPort::MAX_PORT_TYPE_U8);
+    const char* indexBaseName_ = SD_PATH("/qidx");
+    StreamCursor cursors_[STREAM_COUNT]{}; // Cursors for each lane of each port
+    IndexWindow indexWindows_[MAX_PORT + 1]{}; // Cached index records for each port (1-based index)
+    PeekedBatch peekedBatch_{};
+
+    uint8_t selectedLane_[MAX_PORT + 1]{}; // Lane of the last peek of each port (NO_LANE = none)
+    uint8_t laneCredits_[STREAM_COUNT]{}; // Times each lane has been passed over while not empty (aging)
+    DropCounters dropCounters_[MAX_PORT + 1]{}; // Retention policy drops of each port (1-based index)
+
+    uint8_t staging_[STAGING_BUFFER_SIZE]{}; // Wrapped frames pending to be appended
+    size_t stagedLength_ = 0;
+    uint16_t stagedCount_ = 0;
+    uint8_t stagedStream_ = NO_STREAM; // Stream the staged frames belong to
+    unsigned long stagedSinceMs_ = 0; // getMillis() when the first staged frame was added
 
-    uint64_t writeOffset_[MAX_PORT + 1]; // Current write offsets for each port (1-based index)
-    uint64_t readOffset_[MAX_PORT + 1]; // Current read offsets for each port (1-based index)
-    uint64_t nextReadOffset_[MAX_PORT + 1]; // Next read offsets for each port (1-based index)
+    uint32_t lostWriteStreams_ = 0; // Bit per stream with a lost write pending to be resynchronized
+    bool appendedSinceSync_ = false; // Frames appended to storage and not yet synced
 };
 
 
@@ -0,0 +1,45 @@
+#ifndef ACOUSEA_INFRASTRUCTURE_MKR_PACKETQUEUECONFIG_HPP
+#define ACOUSEA_INFRASTRUCTURE_MKR_PACKETQUEUECONFIG_HPP
+
+#include <cstdint>
+
+#include "Ports/IPort.h"
+
+/**
+ * @brief Límites de retención de un puerto de PacketQueue. Con los valores por defecto no hay límites.
+ */
+struct PacketQueuePortPolicy
+{
+    enum class Overflow : uint8_t
+    {
+        DropOldest, // Evict the oldest packets (lowest priority lane first) to make room
+        RejectNew, // push() fails while the port is full
+    };
+
+    // Packets older than this (RTC seconds, from the frame header) are skipped unread. 0 = never expire
+    uint32_t maxAgeSeconds = 0;
+
+    // Max framed bytes pending in the port (all lanes). 0 = unbounded
+    uint32_t maxBytes = 0;
+
+    Overflow overflow = Overflow::DropOldest;
+};
+
+/**
+ * @brief Opciones de PacketQueue. Los límites de retención se fijan por despliegue (ver dependencies.hpp).
+ */
+struct PacketQueueConfig
+{
+    // Keep a sidecar index ("/qidxN.XXX") of (offset, length, timestamp) per frame so that peeks read exactly
+    // one frame instead of a full tmp buffer. Costs one extra append per flush.
+    bool frameIndex = true;
+
+    // Create segments as contiguous preallocated extents (StorageManager::preallocateFile) so that appends do not
+    // fragment the FAT nor walk the cluster chain. Needs frameIndex (the index gives the logical end).
+    bool preallocateSegments = true;
+
+    // Retention policy of each port (1-based index, [0] is unused)
+    PacketQueuePortPolicy ports[IPort::MAX_PORT_TYPE_U8 + 1]{};
+};
+
+#endif //ACOUSEA_INFRASTRUCTURE_MKR_PACKETQUEUECONFIG_HPP
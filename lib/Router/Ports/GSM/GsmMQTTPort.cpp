@@ -48,7 +48,8 @@ void GsmMQTTPort::mqttMessageHandler(int messageSize)
         const bool pushOK = instance->packetQueue_.push(
             static_cast<uint8_t>(IPort::PortType::GsmMqttPort),
             packetBuffer,
-            static_cast<uint16_t>(readCount)
+            static_cast<uint16_t>(readCount),
+            PacketQueue::priorityOf(packetBuffer, readCount)
         );
         if (!pushOK)
         {
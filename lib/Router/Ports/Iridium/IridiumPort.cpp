@@ -63,8 +63,8 @@ void IridiumPort::init()
 
 bool IridiumPort::send(const uint8_t* data, const size_t length)
 {
-    LOG_CLASS_INFO("IridiumPort::send() -> Sending packet... Data: %s, Size: %d bytes",
-                   Logger::vectorToHexString(data, length).c_str(), length
+    LOG_CLASS_DEBUG_HEX(data, length, "IridiumPort::send() -> Sending packet... Size: %d bytes, Data: ",
+                        static_cast<int>(length)
     );
 
     auto* rxBuffer = SharedMemory::tmpBuffer();
@@ -168,11 +168,10 @@ void IridiumPort::logError(const int err)
 void IridiumPort::storeReceivedPacket(const uint8_t* data, size_t length)
 {
     // Print the received data
-    LOG_CLASS_INFO("::storeReceivedPacket() -> Received data: %s",
-                   Logger::vectorToHexString(data, length).c_str()
-    );
+    LOG_CLASS_DEBUG_HEX(data, length, "::storeReceivedPacket() -> Received data: ");
 
-    const bool pushOk = packetQueue_.push(getTypeU8(), data, static_cast<uint16_t>(length));
+    const bool pushOk = packetQueue_.push(getTypeU8(), data, static_cast<uint16_t>(length),
+                                          PacketQueue::priorityOf(data, length));
     if (!pushOk)
     {
         LOG_CLASS_ERROR("::storeReceivedPacket() -> Failed to store received packet in flash queue.");
@@ -13,8 +13,7 @@ void MockIridiumPort::init()
 
 bool MockIridiumPort::send(const uint8_t* data, const size_t length)
 {
-    LOG_CLASS_INFO("MockIridiumPort: Sending packet... %s",
-                   Logger::vectorToHexString(data, length).c_str());
+    LOG_CLASS_DEBUG_HEX(data, length, "MockIridiumPort: Sending packet... ");
     return true;
 }
 
@@ -44,8 +44,7 @@ void LoraPort::init()
 
 bool LoraPort::send(const uint8_t* data, size_t length)
 {
-    LOG_CLASS_INFO("LoraPort::send() -> Sending packet... %s",
-                   Logger::vectorToHexString(data, length).c_str());
+    LOG_CLASS_DEBUG_HEX(data, length, "LoraPort::send() -> Sending packet... ");
 
     while (!LoRa.beginPacket())
     {
@@ -93,8 +92,7 @@ void LoraPort::onReceive(int packetSize)
         receivedRawPackets.pop_front(); // Eliminar el paquete más antiguo
     }
 
-    LOG_CLASS_INFO("LoraPort::onReceive() -> Storing packet... %s",
-                   Logger::vectorToHexString(buffer.data(), buffer.size()).c_str());
+    LOG_CLASS_DEBUG_HEX(buffer.data(), buffer.size(), "LoraPort::onReceive() -> Storing packet... ");
     receivedRawPackets.push_back(buffer);
 }
 
@@ -17,7 +17,7 @@ void MockLoRaPort::init()
 bool MockLoRaPort::send(const uint8_t* data, size_t length)
 {
     // Print packet through serial monitor for debugging
-    LOG_CLASS_INFO("MockLoRaPort: Sending packet... %s", Logger::vectorToHexString(data, length).c_str());
+    LOG_CLASS_DEBUG_HEX(data, length, "MockLoRaPort: Sending packet... ");
     return true;
 }
 
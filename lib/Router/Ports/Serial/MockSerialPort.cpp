@@ -19,7 +19,7 @@ bool MockSerialPort::available()
 
 bool MockSerialPort::send(const uint8_t* data, const size_t length)
 {
-    LOG_CLASS_INFO("MOCKSerialPort::send() -> %s", Logger::vectorToHexString(data, length).c_str());
+    LOG_CLASS_DEBUG_HEX(data, length, "MOCKSerialPort::send() -> ");
     return true;
 }
 
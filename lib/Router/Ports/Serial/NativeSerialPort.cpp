@@ -140,8 +140,7 @@ bool NativeSerialPort::send(const std::vector<uint8_t>& data)
     const uint8_t sof = kSOF;
     const uint8_t len = static_cast<uint8_t>(data.size());
 
-    LOG_CLASS_INFO("::send() -> Sending packet: SOF=0x%02X, LEN=%d, DATA=%s", sof, len,
-                   Logger::vectorToHexString(data.data(), data.size()).c_str());
+    LOG_CLASS_DEBUG_HEX(data.data(), data.size(), "::send() -> Sending packet: SOF=0x%02X, LEN=%d, DATA=", sof, len);
 
 
     // Escribir paquete completo (pequeños buffers; una sola write normalmente basta)
@@ -35,10 +35,10 @@ bool SerialPort::send(const uint8_t* data, const size_t length)
         return false;
     }
     const auto len = static_cast<uint8_t>(length);
-    LOG_CLASS_INFO("::send() -> %s", Logger::vectorToHexString(data, length).c_str());
+    LOG_CLASS_DEBUG_HEX(data, length, "::send() -> ");
 
     LOG_CLASS_FREE_MEMORY("::send() -> Sending packet of %d bytes", length);
-    // Construir y enviar el frame binario
+    // Construir y enviar el frame binario (v1: es el formato que espera el otro extremo)
     auto* outBuffer = SharedMemory::tmpBuffer();
     constexpr size_t OUT_BUFFER_CAPACITY = SharedMemory::tmpBufferSize();
     if (const bool wrapOk = BinaryFrame::wrapInPlace(outBuffer, OUT_BUFFER_CAPACITY, data, len, 0);
@@ -67,7 +67,8 @@ bool SerialPort::sync()
     {
         // Check for start byte
         WatchdogUtils::reset(); // Reset the watchdog to avoid resets during long reads
-        if (const auto startByte = serialPort.peek(); startByte != BinaryFrame::START_BYTE)
+        if (const auto startByte = serialPort.peek();
+            startByte < 0 || !BinaryFrame::isStartByte(static_cast<uint8_t>(startByte)))
         {
             LOG_CLASS_ERROR("::sync() -> Invalid start byte 0x%02X, clearing buffer", startByte);
             serialPort.read(); // discard invalid byte
@@ -105,7 +106,7 @@ bool SerialPort::sync()
         }
 
         // Now we check if we have enough space for the full frame. If not, we discard the current buffer content.
-        const size_t totalFrameSize = BinaryFrame::requiredSize(header.payloadLength);
+        const size_t totalFrameSize = BinaryFrame::frameSize(header); // v1 or v2 (with CRC)
         if (totalFrameSize > RX_BUFFER_CAPACITY)
         {
             LOG_CLASS_ERROR(
@@ -150,7 +151,9 @@ bool SerialPort::sync()
                 break;
             }
             // Store the payload in the packet queue.
-            if (const bool pushOk = packetQueue_.push(getTypeU8(), frameView.payload, frameView.payloadLength);
+            if (const bool pushOk = packetQueue_.push(
+                    getTypeU8(), frameView.payload, frameView.payloadLength,
+                    PacketQueue::priorityOf(frameView.payload, frameView.payloadLength));
                 !pushOk)
             {
                 LOG_CLASS_ERROR("SerialPort::sync() -> Failed to push frame into Flash queue");
@@ -0,0 +1,110 @@
+#include "RecentIdFilter.hpp"
+
+#include <cstring>
+
+
+RecentIdFilter::RecentIdFilter()
+{
+    clear();
+}
+
+bool RecentIdFilter::isDuplicate(const uint8_t sender, const uint32_t packetId)
+{
+    if (find(sender, packetId) != TABLE_SIZE)
+    {
+        stats_.hits++;
+        return true;
+    }
+    stats_.misses++;
+    return false;
+}
+
+void RecentIdFilter::remember(const uint8_t sender, const uint32_t packetId)
+{
+    if (find(sender, packetId) != TABLE_SIZE)
+    {
+        return;
+    }
+
+    // Full: forget the oldest entry, which is the one about to be overwritten
+    if (count_ == CAPACITY)
+    {
+        const Entry& oldest = ring_[head_];
+        eraseSlot(find(oldest.sender, oldest.packetId));
+        count_--;
+    }
+
+    ring_[head_] = Entry{packetId, sender};
+
+    size_t slot = hashOf(sender, packetId);
+    while (table_[slot] != EMPTY_SLOT)
+    {
+        slot = (slot + 1) & (TABLE_SIZE - 1);
+    }
+    table_[slot] = static_cast<uint8_t>(head_);
+
+    head_ = (head_ + 1) % CAPACITY;
+    count_++;
+}
+
+void RecentIdFilter::clear()
+{
+    memset(table_, EMPTY_SLOT, sizeof(table_));
+    head_ = 0;
+    count_ = 0;
+}
+
+size_t RecentIdFilter::hashOf(const uint8_t sender, const uint32_t packetId)
+{
+    // Fibonacci hashing: packetIds are usually consecutive, the multiplication spreads them over the table
+    const uint32_t key = packetId ^ static_cast<uint32_t>(sender) << 24;
+    return (key * 2654435769u) >> 26 & (TABLE_SIZE - 1);
+}
+
+size_t RecentIdFilter::find(const uint8_t sender, const uint32_t packetId) const
+{
+    size_t slot = hashOf(sender, packetId);
+    while (table_[slot] != EMPTY_SLOT)
+    {
+        if (const Entry& entry = ring_[table_[slot]]; entry.packetId == packetId && entry.sender == sender)
+        {
+            return slot;
+        }
+        slot = (slot + 1) & (TABLE_SIZE - 1);
+    }
+    return TABLE_SIZE;
+}
+
+void RecentIdFilter::eraseSlot(size_t slot)
+{
+    if (slot >= TABLE_SIZE)
+    {
+        return;
+    }
+
+    // Backward shift deletion: move up the entries of the probe chain so that lookups never stop at the hole
+    table_[slot] = EMPTY_SLOT;
+    size_t next = slot;
+    while (true)
+    {
+        next = (next + 1) & (TABLE_SIZE - 1);
+        if (table_[next] == EMPTY_SLOT)
+        {
+            return;
+        }
+
+        const Entry& entry = ring_[table_[next]];
+        const size_t home = hashOf(entry.sender, entry.packetId);
+
+        // The entry may fill the hole only if its home slot is not cyclically in (slot, next]
+        const bool homeInRange = slot <= next
+                                     ? home > slot && home <= next
+                                     : home > slot || home <= next;
+        if (!homeInRange)
+        {
+            table_[slot] = table_[next];
+            table_[next] = EMPTY_SLOT;
+            slot = next;
+        }
+    }
+}
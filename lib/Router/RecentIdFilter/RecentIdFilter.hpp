@@ -0,0 +1,71 @@
+#ifndef ACOUSEA_INFRASTRUCTURE_MKR_RECENTIDFILTER_HPP
+#define ACOUSEA_INFRASTRUCTURE_MKR_RECENTIDFILTER_HPP
+
+#include <cstdint>
+#include <cstddef>
+
+
+/**
+ * @brief Filtro de memoria fija con los últimos CAPACITY paquetes (sender, packetId) procesados.
+ *
+ * Iridium puede re-entregar mensajes MT y el Pi reenvía tras un timeout, por lo que un mismo paquete puede llegar
+ * varias veces a la cola de un puerto. Los ids se guardan en un anillo (el más antiguo se olvida primero) indexado
+ * por una pequeña tabla hash de direccionamiento abierto, de modo que la consulta no recorre el anillo.
+ */
+class RecentIdFilter
+{
+public:
+    static constexpr size_t CAPACITY = 32;
+    static constexpr size_t TABLE_SIZE = 64; // Power of two, load factor <= 0.5
+
+    struct Stats
+    {
+        uint32_t hits = 0; // Duplicates detected
+        uint32_t misses = 0; // Packets seen for the first time
+    };
+
+    RecentIdFilter();
+
+    /**
+     * Returns true if the packet is in the filter. Counts a hit or a miss.
+     */
+    [[nodiscard]] bool isDuplicate(uint8_t sender, uint32_t packetId);
+
+    /**
+     * Remembers the packet, forgetting the oldest one if the filter is full. No-op if it is already there.
+     */
+    void remember(uint8_t sender, uint32_t packetId);
+
+    void clear();
+
+    [[nodiscard]] size_t size() const { return count_; }
+
+    [[nodiscard]] const Stats& getStats() const { return stats_; }
+
+private:
+    static constexpr uint8_t EMPTY_SLOT = 0xFF;
+    static_assert(CAPACITY < EMPTY_SLOT, "Ring positions must fit in a table slot");
+    static_assert((TABLE_SIZE & (TABLE_SIZE - 1)) == 0, "TABLE_SIZE must be a power of two");
+    static_assert(TABLE_SIZE >= 2 * CAPACITY, "Keep the hash table at most half full");
+
+    struct Entry
+    {
+        uint32_t packetId;
+        uint8_t sender;
+    };
+
+    Entry ring_[CAPACITY]{};
+    uint8_t table_[TABLE_SIZE]{}; // Ring position of each entry, EMPTY_SLOT if free
+    size_t head_ = 0; // Next ring position to write (the oldest entry when full)
+    size_t count_ = 0;
+    Stats stats_{};
+
+    [[nodiscard]] static size_t hashOf(uint8_t sender, uint32_t packetId);
+
+    // Table slot holding the entry, or TABLE_SIZE if it is not in the filter
+    [[nodiscard]] size_t find(uint8_t sender, uint32_t packetId) const;
+
+    void eraseSlot(size_t slot);
+};
+
+#endif //ACOUSEA_INFRASTRUCTURE_MKR_RECENTIDFILTER_HPP
@@ -1,24 +1,29 @@
 #include "Router.h"
 #include <cinttypes>
+#include <cstring>
 #include <Logger/Logger.h>
 
 #include "PacketQueue/PacketQueue.hpp"
 #include "ProtoUtils/ProtoUtils.hpp"
 #include "SharedMemory/SharedMemory.hpp"
+#include "time/TimeService.hpp"
 
 
 namespace pb
 {
     using ProtoUtils::CommunicationPacket::encodeInto;
     using ProtoUtils::CommunicationPacket::decodeInto;
+    using ProtoUtils::CommunicationPacket::patchTtlInPlace;
 }
 
 Router::Router(const std::vector<IPort*>& ports,
                const std::vector<IPort::PortType>& relayedPortTypes,
-               PacketQueue& packetQueue)
+               PacketQueue& packetQueue,
+               const RoutingTableConfig& routingConfig)
     : ports_(ports),
       relayedPortTypes_(relayedPortTypes),
-      packetQueue_(packetQueue)
+      packetQueue_(packetQueue),
+      routes_(routingConfig)
 {
 }
 
@@ -32,6 +37,16 @@ void Router::addRelayedPortType(IPort::PortType portType)
     relayedPortTypes_.push_back(portType);
 }
 
+bool Router::addStaticRoute(const uint8_t address, IPort::PortType portType)
+{
+    return routes_.addStatic(address, static_cast<uint8_t>(portType));
+}
+
+uint32_t Router::nowSeconds()
+{
+    return static_cast<uint32_t>(TimeService::monotonicMillis() / 1000);
+}
+
 Router::RouterSender Router::from(const uint8_t sender) const
 {
     return RouterSender(this, sender);
@@ -55,6 +70,20 @@ bool Router::syncAllPorts() const
             success = false;
         }
     }
+
+    // Bursts received during this sync stay staged in RAM only for a bounded time
+    if (!packetQueue_.flushIfStale())
+    {
+        LOG_CLASS_ERROR("Router::syncAllPorts -> Failed to flush staged packets");
+        success = false;
+    }
+
+    // Received packets appended to the queue reach the card here, not only at the end of the main loop
+    if (!packetQueue_.sync())
+    {
+        LOG_CLASS_ERROR("Router::syncAllPorts -> Failed to sync the packet queue");
+        success = false;
+    }
     return success;
 }
 
@@ -70,75 +99,64 @@ std::optional<std::pair<IPort::PortType, acousea_CommunicationPacket*>> Router::
         {
             continue;
         }
+        const auto portU8 = port->getTypeU8();
 
-        auto* readBuffer = SharedMemory::tmpBuffer();
-        constexpr auto readSize = SharedMemory::tmpBufferSize();
-
-
-        const auto numReadBytes = packetQueue_.peekNext(
-            port->getTypeU8(),
-            readBuffer,
-            readSize
-        );
-
-        if (numReadBytes == 0)
+        // Read a backlog of packets in one go: foreign and corrupt ones are drained without re-reading storage
+        BinaryFrame::FrameView views[BATCH_MAX_FRAMES];
+        const size_t numFrames = packetQueue_.peekBatch(portU8, batchBuffer_, sizeof(batchBuffer_), views,
+                                                        BATCH_MAX_FRAMES);
+        if (numFrames == 0)
         {
-            continue;
-        }
+            // The next packet does not fit in the batch buffer: peek it alone into the shared buffer
+            auto* readBuffer = SharedMemory::tmpBuffer();
+            constexpr auto readSize = SharedMemory::tmpBufferSize();
 
-        // Decodificar directamente en el buffer global
-        const auto decodeResult = pb::decodeInto(
-            readBuffer,
-            numReadBytes,
-            &SharedMemory::communicationPacketRef()
-        );
-
-        if (decodeResult.isError())
-        {
-            LOG_CLASS_ERROR("Router::nextPacket -> decode failed: %s", decodeResult.getError());
-            // Discard the corrupt packet
-            if (const auto discardOk = skipToNextPacket(port->getTypeEnum()); !discardOk)
+            const auto numReadBytes = packetQueue_.peekNext(portU8, readBuffer, readSize);
+            if (numReadBytes == 0)
             {
-                LOG_CLASS_ERROR("Router::nextPacket -> discard packet failed: %s", decodeResult.getError());
+                continue;
             }
-            continue;
-        }
-
-        acousea_CommunicationPacket& nextPacketRef = SharedMemory::communicationPacketRef();
-
-        if (!nextPacketRef.has_routing)
-        {
-            LOG_CLASS_ERROR("Router::nextPacket -> packet has no routing info, Discarding...");
-            // Discard the corrupt packet
-            if (const auto discardOk = skipToNextPacket(port->getTypeEnum()); !discardOk)
+            if (!acceptPacket(readBuffer, numReadBytes, localAddress, portU8))
             {
-                LOG_CLASS_ERROR("Router::nextPacket -> discard packet failed: %s", decodeResult.getError());
+                // Discard the packet (not through skipToNextPacket(): it was not processed)
+                if (const auto discardOk = packetQueue_.skipToNextPacket(portU8); !discardOk)
+                {
+                    LOG_CLASS_ERROR("Router::nextPacket -> discard packet failed");
+                }
+                continue;
             }
-            continue;
         }
-
-        const auto receiver = static_cast<uint8_t>(nextPacketRef.routing.receiver);
-        if (receiver != localAddress && receiver != broadcastAddress)
+        else
         {
-            LOG_CLASS_INFO(
-                "Packet not for this node. Relaying through relayed ports and discarding (this=%d, receiver=%d)",
-                localAddress, receiver);
-
-            relayPacket(nextPacketRef);
+            size_t drained = 0;
+            while (drained < numFrames && !acceptPacket(views[drained].payload, views[drained].payloadLength,
+                                                        localAddress, portU8))
+            {
+                drained++;
+            }
 
-            // Discard the packet
-            if (const auto discardOk = skipToNextPacket(port->getTypeEnum()); !discardOk) // Discard the packet
+            // Discard the packets that were relayed, duplicated or corrupt (single cursor update)
+            if (drained > 0 && !packetQueue_.skipPackets(portU8, drained))
             {
-                LOG_CLASS_ERROR("Router::nextPacket -> discard packet failed: %s", decodeResult.getError());
+                LOG_CLASS_ERROR("Router::nextPacket -> discard of %u packets failed",
+                                static_cast<unsigned int>(drained));
+            }
+            if (drained == numFrames)
+            {
+                continue;
             }
-            continue;
         }
 
+        acousea_CommunicationPacket& nextPacketRef = SharedMemory::communicationPacketRef();
+        peekedIds_[portU8] = PeekedId{
+            nextPacketRef.packetId, static_cast<uint8_t>(nextPacketRef.routing.sender), nextPacketRef.packetId != 0
+        };
+
         if (nextPacketRef.packetId == 0)
         {
             LOG_CLASS_ERROR("Router::nextPacket -> packet has invalid packetId=0. Setting id based on readOffset_");
             // Discard the corrupt packet
-            nextPacketRef.packetId = packetQueue_.getReadOffset(port->getTypeU8()) + 1; // +1 to avoid zero packetId
+            nextPacketRef.packetId = packetQueue_.getReadOffset(portU8) + 1; // +1 to avoid zero packetId
         }
 
         // Paquete válido encontrado
@@ -152,6 +170,60 @@ std::optional<std::pair<IPort::PortType, acousea_CommunicationPacket*>> Router::
     return std::nullopt;
 }
 
+bool Router::acceptPacket(const uint8_t* data, const size_t length, const uint8_t localAddress,
+                          const uint8_t portU8) const
+{
+    // Decodificar directamente en el buffer global
+    const auto decodeResult = pb::decodeInto(
+        data,
+        length,
+        &SharedMemory::communicationPacketRef()
+    );
+
+    if (decodeResult.isError())
+    {
+        LOG_CLASS_ERROR("Router::nextPacket -> decode failed: %s", decodeResult.getError());
+        return false;
+    }
+
+    acousea_CommunicationPacket& packetRef = SharedMemory::communicationPacketRef();
+
+    if (!packetRef.has_routing)
+    {
+        LOG_CLASS_ERROR("Router::nextPacket -> packet has no routing info, Discarding...");
+        return false;
+    }
+
+    // The sender is reachable through the port its packet came in on (our own packets echoed by a relay are not)
+    if (const auto sender = static_cast<uint8_t>(packetRef.routing.sender);
+        sender != localAddress && sender != broadcastAddress)
+    {
+        routes_.learn(sender, portU8, nowSeconds());
+    }
+
+    const auto receiver = static_cast<uint8_t>(packetRef.routing.receiver);
+    if (receiver != localAddress && receiver != broadcastAddress)
+    {
+        LOG_CLASS_INFO(
+            "Packet not for this node. Relaying through relayed ports and discarding (this=%d, receiver=%d)",
+            localAddress, receiver);
+
+        relay(packetRef, data, length);
+        return false;
+    }
+
+    // packetId 0 is not a real id (see peekNextPacket): such packets cannot be told apart
+    if (packetRef.packetId != 0 && recentIds_.isDuplicate(static_cast<uint8_t>(packetRef.routing.sender),
+                                                          packetRef.packetId))
+    {
+        LOG_CLASS_WARNING("Router::nextPacket -> duplicate packet discarded (id = %lu, sender=%lu)",
+                          packetRef.packetId, packetRef.routing.sender);
+        return false;
+    }
+
+    return true;
+}
+
 bool Router::skipToNextPacket(IPort::PortType portType) const
 {
     const auto portU8 = static_cast<uint8_t>(portType);
@@ -162,6 +234,12 @@ bool Router::skipToNextPacket(IPort::PortType portType) const
         return false;
     }
 
+    if (PeekedId& peeked = peekedIds_[portU8]; peeked.valid)
+    {
+        recentIds_.remember(peeked.sender, peeked.packetId);
+        peeked.valid = false;
+    }
+
     return true;
 }
 
@@ -184,38 +262,137 @@ bool Router::sendToPort(const IPort::PortType port, const acousea_CommunicationP
         return false;
     }
 
+    return sendBytes(port, SharedMemory::tmpBuffer(), resultBytesWritten.getValueConst());
+}
+
+bool Router::sendBytes(const IPort::PortType port, const uint8_t* data, const size_t length) const
+{
     for (const auto& relayedPort : ports_)
     {
         if (relayedPort->getTypeEnum() == port)
         {
-            return relayedPort->send(
-                reinterpret_cast<const uint8_t*>(SharedMemory::tmpBuffer()),
-                resultBytesWritten.getValueConst()
-            );
+            return relayedPort->send(data, length);
         }
     }
-    LOG_CLASS_FREE_MEMORY("::sendToPort() -> No matching port found, cannot send packet");
+    LOG_CLASS_FREE_MEMORY("::sendBytes() -> No matching port found, cannot send packet");
 
-    LOG_CLASS_ERROR("Router::sendToPort() -> No relayed port found for type %s", IPort::portTypeToCString(port));
+    LOG_CLASS_ERROR("Router::sendBytes() -> No relayed port found for type %s", IPort::portTypeToCString(port));
 
     return false;
 }
 
 
-void Router::relayPacket(const acousea_CommunicationPacket& inPacket) const
+void Router::relayPacket(acousea_CommunicationPacket& inPacket) const
 {
-    for (const auto& portType : relayedPortTypes_)
+    relay(inPacket, nullptr, 0);
+}
+
+void Router::relay(acousea_CommunicationPacket& inPacket, const uint8_t* raw, const size_t rawLength) const
+{
+    // Loop suppression: each (sender, packetId) leaves this node at most once, whatever path brings it back
+    const auto sender = static_cast<uint8_t>(inPacket.routing.sender);
+    if (inPacket.packetId != 0 && relayedIds_.isDuplicate(sender, inPacket.packetId))
+    {
+        relayStats_.loopsDropped++;
+        LOG_CLASS_WARNING("Router::relayPacket() -> packet already relayed, dropping loop (id = %lu, sender=%lu)",
+                          inPacket.packetId, inPacket.routing.sender);
+        return;
+    }
+
+    // TTL: hops the packet may still take. 0 = not set by the sender (older firmware): DEFAULT_TTL
+    const auto receivedTtl = static_cast<uint32_t>(inPacket.routing.ttl);
+    const uint32_t ttl = receivedTtl == 0 ? DEFAULT_TTL : receivedTtl;
+    if (ttl <= 1)
     {
-        if (const bool sendOk = sendToPort(portType, inPacket); !sendOk)
+        relayStats_.ttlExpired++;
+        LOG_CLASS_WARNING("Router::relayPacket() -> TTL expired, not relaying (id = %lu, sender=%lu)",
+                          inPacket.packetId, inPacket.routing.sender);
+        return;
+    }
+    inPacket.routing.ttl = ttl - 1;
+
+    // Remembered only once it leaves: a copy that expired here must not block one arriving later with hops left
+    if (inPacket.packetId != 0)
+    {
+        relayedIds_.remember(sender, inPacket.packetId);
+    }
+
+    // The same bytes go out through every port: the received frame if its TTL can be rewritten without changing
+    // its size (an absent TTL cannot), otherwise a single encode. They are prepared in relayBuffer_: the ports
+    // use the shared tmp buffer while sending (and raw may be in it)
+    uint8_t* out = relayBuffer_;
+    size_t outLength = 0;
+    if (raw != nullptr && receivedTtl != 0 && rawLength <= sizeof(relayBuffer_))
+    {
+        memcpy(out, raw, rawLength);
+        if (pb::patchTtlInPlace(out, rawLength, receivedTtl, ttl - 1))
         {
-            LOG_CLASS_ERROR("Router::relayPacket() -> Failed to relay packet through port %s",
-                            IPort::portTypeToCString(portType));
+            outLength = rawLength;
+            relayStats_.forwardedRaw++;
         }
-        else
+    }
+    if (outLength == 0)
+    {
+        const Result<size_t> encodeResult = pb::encodeInto(inPacket, out, sizeof(relayBuffer_));
+        if (encodeResult.isError())
+        {
+            LOG_CLASS_ERROR("Router::relayPacket() -> encode failed: %s", encodeResult.getError());
+            return;
+        }
+        outLength = encodeResult.getValueConst();
+        relayStats_.reencoded++;
+    }
+
+    // Known next hop: only its ports (an Iridium relay costs a satellite transmission). A route is never a way
+    // around relayedPortTypes_: a next hop learned on a port that does not relay (the serial link) means flooding
+    const auto receiver = static_cast<uint8_t>(inPacket.routing.receiver);
+    uint8_t routePorts = 0;
+    if (receiver != broadcastAddress)
+    {
+        routePorts = routes_.lookup(receiver, nowSeconds()) & relayedPortBits();
+    }
+    if (routePorts != 0)
+    {
+        relayStats_.routed++;
+        for (const auto& port : ports_)
         {
-            LOG_CLASS_INFO("Router::relayPacket() -> Packet relayed successfully through port %s",
-                           IPort::portTypeToCString(portType));
+            if (routePorts & RoutingTable::portBit(port->getTypeU8()))
+            {
+                relayThrough(port->getTypeEnum(), out, outLength);
+            }
         }
+        return;
+    }
+
+    // Broadcast, unknown or aged receiver: flood through every relayed port type
+    relayStats_.flooded++;
+    for (const auto& portType : relayedPortTypes_)
+    {
+        relayThrough(portType, out, outLength);
+    }
+}
+
+uint8_t Router::relayedPortBits() const
+{
+    uint8_t bits = 0;
+    for (const auto& portType : relayedPortTypes_)
+    {
+        bits |= RoutingTable::portBit(static_cast<uint8_t>(portType));
+    }
+    return bits;
+}
+
+void Router::relayThrough(const IPort::PortType portType, const uint8_t* data, const size_t length) const
+{
+    if (const bool sendOk = sendBytes(portType, data, length); !sendOk)
+    {
+        LOG_CLASS_ERROR("Router::relayPacket() -> Failed to relay packet through port %s",
+                        IPort::portTypeToCString(portType));
+    }
+    else
+    {
+        LOG_CLASS_INFO("Router::relayPacket() -> Packet relayed successfully through port %s",
+                       IPort::portTypeToCString(portType));
     }
 }
 
@@ -248,6 +425,7 @@ bool Router::RouterSender::send(acousea_CommunicationPacket& pkt) const
     pkt.routing = acousea_RoutingChunk_init_default;
     pkt.routing.sender = senderAddress;
     pkt.routing.receiver = destination;
+    pkt.routing.ttl = Router::DEFAULT_TTL;
     return router->sendToPort(selectedPort, pkt);
 }
 
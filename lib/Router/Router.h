@@ -8,6 +8,9 @@
 #include "ClassName.h"
 #include "bindings/nodeDevice.pb.h"
 #include "PacketQueue/PacketQueue.hpp"
+#include "RecentIdFilter/RecentIdFilter.hpp"
+#include "RoutingTable/RoutingTable.hpp"
+#include "SharedMemory/SharedMemory.hpp"
 
 
 /**
@@ -21,17 +24,32 @@ public:
     static constexpr uint8_t originAddress = 0;
     static constexpr uint8_t broadcastAddress = 255;
 
+    // Hops a packet may take (routing.ttl): each relay decrements it and a packet arriving with 1 is not relayed
+    static constexpr uint8_t DEFAULT_TTL = 5;
+
+    // Backlog drained per port and per peekNextPacket() call (one storage read per batch)
+    static constexpr size_t BATCH_BUFFER_SIZE = 512;
+    static constexpr size_t BATCH_MAX_FRAMES = PacketQueue::MAX_BATCH_FRAMES;
+
     Router(
         const std::vector<IPort*>& ports,
         const std::vector<IPort::PortType>& relayedPortTypes,
-        PacketQueue& packetQueue
+        PacketQueue& packetQueue,
+        const RoutingTableConfig& routingConfig = RoutingTableConfig{}
     );
 
     void addPort(IPort* port);
 
     void addRelayedPortType(IPort::PortType portType);
 
-    void relayPacket(const acousea_CommunicationPacket& inPacket) const;
+    // Fixed next hop for an address (configuration): packets for it are relayed only through these ports
+    [[nodiscard]] bool addStaticRoute(uint8_t address, IPort::PortType portType);
+
+    // Sends a foreign packet towards its receiver: through the relayed ports of its route if one is known (static
+    // or learned from inbound traffic), otherwise flooded through every relayed port type. Decrements routing.ttl
+    // in place and drops packets whose TTL ran out or that this node has already relayed. Encoded once for all the
+    // ports
+    void relayPacket(acousea_CommunicationPacket& inPacket) const;
 
     class RouterSender;
 
@@ -49,8 +67,24 @@ public:
     [[nodiscard]] std::optional<std::pair<IPort::PortType, acousea_CommunicationPacket*>> peekNextPacket(
         uint8_t localAddress) const;
 
+    // Skips the packet returned by peekNextPacket() for this port and remembers its id as processed
     [[nodiscard]] bool skipToNextPacket(IPort::PortType portType) const;
 
+    // Duplicates (re-delivered packets already processed) discarded by peekNextPacket()
+    [[nodiscard]] const RecentIdFilter::Stats& getDuplicateStats() const { return recentIds_.getStats(); }
+
+    struct RelayStats
+    {
+        uint32_t routed = 0; // Relayed through the ports of a known route
+        uint32_t flooded = 0; // No route: relayed through every relayed port type
+        uint32_t loopsDropped = 0; // Already relayed by this node (came back through a loop or another path)
+        uint32_t ttlExpired = 0; // Arrived on its last hop
+        uint32_t forwardedRaw = 0; // Sent as received, with only the TTL bytes rewritten
+        uint32_t reencoded = 0; // Encoded again (once for all its ports)
+    };
+
+    [[nodiscard]] const RelayStats& getRelayStats() const { return relayStats_; }
+
     // ======================================================
     // Builder interno para API fluida
     // ======================================================
@@ -102,7 +136,52 @@ private:
     std::vector<IPort::PortType> relayedPortTypes_{};
     PacketQueue& packetQueue_;
 
+    // Own buffer for batched peeks: the ports reuse the shared tmp buffer while the batch is relayed
+    mutable uint8_t batchBuffer_[BATCH_BUFFER_SIZE]{};
+
+    // Bytes of the packet being relayed, sent to several ports in a row: SerialPort::send() builds its frame in
+    // the shared tmp buffer and IridiumPort receives into it, so they cannot be kept there
+    mutable uint8_t relayBuffer_[SharedMemory::tmpBufferSize()]{};
+
+    // Ids of the packets already processed by this node (Iridium re-delivers MT messages, the Pi resends on timeout)
+    mutable RecentIdFilter recentIds_{};
+
+    // Packet returned by peekNextPacket() per port: it is remembered only once skipped, so a retried peek of the
+    // same packet is not mistaken for a duplicate
+    struct PeekedId
+    {
+        uint32_t packetId = 0;
+        uint8_t sender = 0;
+        bool valid = false;
+    };
+
+    mutable PeekedId peekedIds_[IPort::MAX_PORT_TYPE_U8 + 1]{};
+
+    // Next-hop ports per address, learned from the routing.sender of inbound packets
+    mutable RoutingTable routes_;
+
+    // Ids of the packets this node has already relayed (loop suppression)
+    mutable RecentIdFilter relayedIds_{};
+    mutable RelayStats relayStats_{};
+
+    [[nodiscard]] static uint32_t nowSeconds();
+
+    // Decodes the packet into the shared packet, learns the route to its sender and relays it if it is not for
+    // this node. Returns true only when the packet must be processed by this node (and it is not a duplicate).
+    [[nodiscard]] bool acceptPacket(const uint8_t* data, size_t length, uint8_t localAddress, uint8_t portU8) const;
+
     [[nodiscard]] bool sendToPort(IPort::PortType port, const acousea_CommunicationPacket& packet) const;
+
+    [[nodiscard]] bool sendBytes(IPort::PortType port, const uint8_t* data, size_t length) const;
+
+    // relayPacket() with the frame the packet was decoded from, if any (raw may be the shared tmp buffer): the
+    // frame is forwarded with its TTL patched in a copy, or else the packet is encoded once for every port
+    void relay(acousea_CommunicationPacket& inPacket, const uint8_t* raw, size_t rawLength) const;
+
+    void relayThrough(IPort::PortType portType, const uint8_t* data, size_t length) const;
+
+    // RoutingTable::portBit() of every relayed port type
+    [[nodiscard]] uint8_t relayedPortBits() const;
 };
 
 #endif // COMMUNICATOR_RELAY_H
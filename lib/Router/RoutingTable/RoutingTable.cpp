@@ -0,0 +1,115 @@
+#include "RoutingTable.hpp"
+
+
+RoutingTable::RoutingTable(const RoutingTableConfig& config) : config_(config)
+{
+}
+
+bool RoutingTable::addStatic(const uint8_t address, const uint8_t portU8)
+{
+    Entry* entry = find(address);
+    if (!entry)
+    {
+        // Configuration comes first: with no time reference every learned-only entry counts as aged
+        entry = freeSlot(0);
+        if (!entry)
+        {
+            return false;
+        }
+        *entry = Entry{address, 0, 0, true, 0};
+    }
+    entry->staticPorts |= portBit(portU8);
+    return true;
+}
+
+void RoutingTable::learn(const uint8_t address, const uint8_t portU8, const uint32_t nowS)
+{
+    Entry* entry = find(address);
+    if (!entry)
+    {
+        entry = freeSlot(nowS);
+        if (!entry)
+        {
+            return;
+        }
+        *entry = Entry{address, 0, 0, true, 0};
+    }
+    entry->learnedPort = portU8;
+    entry->lastSeenS = nowS;
+}
+
+uint8_t RoutingTable::lookup(const uint8_t address, const uint32_t nowS) const
+{
+    const Entry* entry = find(address);
+    if (!entry)
+    {
+        return 0;
+    }
+    const uint8_t learned = isFresh(*entry, nowS) ? portBit(entry->learnedPort) : 0;
+    return static_cast<uint8_t>(entry->staticPorts | learned);
+}
+
+void RoutingTable::clear()
+{
+    for (Entry& entry : entries_)
+    {
+        entry = Entry{};
+    }
+}
+
+size_t RoutingTable::size() const
+{
+    size_t count = 0;
+    for (const Entry& entry : entries_)
+    {
+        count += entry.used ? 1 : 0;
+    }
+    return count;
+}
+
+bool RoutingTable::isFresh(const Entry& entry, const uint32_t nowS) const
+{
+    return entry.learnedPort != 0 && nowS - entry.lastSeenS < config_.maxAgeS;
+}
+
+RoutingTable::Entry* RoutingTable::find(const uint8_t address)
+{
+    for (Entry& entry : entries_)
+    {
+        if (entry.used && entry.address == address)
+        {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+const RoutingTable::Entry* RoutingTable::find(const uint8_t address) const
+{
+    return const_cast<RoutingTable*>(this)->find(address);
+}
+
+RoutingTable::Entry* RoutingTable::freeSlot(const uint32_t nowS)
+{
+    Entry* oldest = nullptr;
+    for (Entry& entry : entries_)
+    {
+        if (!entry.used)
+        {
+            return &entry;
+        }
+        if (entry.staticPorts != 0)
+        {
+            continue;
+        }
+        if (!isFresh(entry, nowS))
+        {
+            return &entry;
+        }
+        if (!oldest || nowS - entry.lastSeenS > nowS - oldest->lastSeenS)
+        {
+            oldest = &entry;
+        }
+    }
+    return oldest;
+}
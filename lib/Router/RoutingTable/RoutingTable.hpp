@@ -0,0 +1,73 @@
+#ifndef ACOUSEA_INFRASTRUCTURE_MKR_ROUTINGTABLE_HPP
+#define ACOUSEA_INFRASTRUCTURE_MKR_ROUTINGTABLE_HPP
+
+#include <cstdint>
+#include <cstddef>
+
+
+struct RoutingTableConfig
+{
+    uint32_t maxAgeS = 30UL * 60UL; // Una ruta aprendida caduca si su dirección no se oye en este tiempo
+};
+
+/**
+ * @brief Tabla de memoria fija dirección -> puerto(s) de siguiente salto del Router.
+ *
+ * Las rutas estáticas vienen de la configuración y no caducan. Las aprendidas salen del routing.sender de los
+ * paquetes entrantes: si la dirección X se oye por el puerto P, lo que vaya a X sale por P. Cada dirección guarda
+ * el último puerto por el que se oyó y cuándo; pasado maxAgeS la ruta deja de valer y el Router vuelve a inundar
+ * por sus puertos de reenvío. Los puertos se representan como máscara de bits (bit = PortType en uint8_t).
+ */
+class RoutingTable
+{
+public:
+    static constexpr size_t CAPACITY = 16;
+
+    explicit RoutingTable(const RoutingTableConfig& config = RoutingTableConfig{});
+
+    /**
+     * Adds a static route: never ages and is never evicted. False if the table is full of static routes.
+     */
+    [[nodiscard]] bool addStatic(uint8_t address, uint8_t portU8);
+
+    /**
+     * Records that `address` was heard through `portU8` at `nowS`. When the table is full, the least recently
+     * heard learned address is replaced (static routes are kept).
+     */
+    void learn(uint8_t address, uint8_t portU8, uint32_t nowS);
+
+    /**
+     * Port mask towards `address` (static ports plus the learned one if it has not aged). 0 if there is no route.
+     */
+    [[nodiscard]] uint8_t lookup(uint8_t address, uint32_t nowS) const;
+
+    void clear();
+
+    [[nodiscard]] size_t size() const;
+
+    static constexpr uint8_t portBit(const uint8_t portU8) { return static_cast<uint8_t>(1u << portU8); }
+
+private:
+    struct Entry
+    {
+        uint8_t address = 0;
+        uint8_t staticPorts = 0;
+        uint8_t learnedPort = 0; // 0 (PortType::None) = sin ruta aprendida
+        bool used = false;
+        uint32_t lastSeenS = 0;
+    };
+
+    RoutingTableConfig config_;
+    Entry entries_[CAPACITY]{};
+
+    [[nodiscard]] bool isFresh(const Entry& entry, uint32_t nowS) const;
+
+    // Entrada de la dirección, o nullptr si no está en la tabla
+    [[nodiscard]] Entry* find(uint8_t address);
+    [[nodiscard]] const Entry* find(uint8_t address) const;
+
+    // Hueco para una dirección nueva: uno libre, una entrada solo aprendida y caducada o la menos reciente de ellas
+    [[nodiscard]] Entry* freeSlot(uint32_t nowS);
+};
+
+#endif //ACOUSEA_INFRASTRUCTURE_MKR_ROUTINGTABLE_HPP
@@ -51,7 +51,7 @@ Result<acousea_CommunicationPacket*> StatusReportingRoutine::execute(
     pkt.routing = acousea_RoutingChunk_init_default;
     pkt.routing.sender = 1;
     pkt.routing.receiver = Router::originAddress;
-    pkt.routing.ttl = 5;
+    pkt.routing.ttl = Router::DEFAULT_TTL;
 
     pkt.which_body = acousea_CommunicationPacket_report_tag;
     // Inicializar directamente la rama elegida
@@ -48,6 +48,8 @@ ModuleProxy::ModuleProxy(
 
 bool ModuleProxy::begin()
 {
+    static_assert(MODULE_FILE_CAPACITY >= SharedMemory::tmpBufferSize(), "A module record must fit in its file");
+
     // Initialize storage manager if needed
     if (const bool beginOk = storage_.begin(); !beginOk)
     {
@@ -62,6 +64,21 @@ bool ModuleProxy::begin()
         char path[10];
         snprintf(path, sizeof(path), "/mod%d", static_cast<int>(code));
 
+        // Persisted records are never read after a reboot: the extent is reused from offset 0
+        preallocated_[code] = false;
+        if (storage_.supportsPreallocation())
+        {
+            const bool reusable = storage_.fileExists(path) && storage_.fileSize(path) == MODULE_FILE_CAPACITY;
+            preallocated_[code] = reusable || storage_.preallocateFile(path, MODULE_FILE_CAPACITY);
+            if (preallocated_[code])
+            {
+                readOffset_[code] = 0;
+                writeOffset_[code] = 0;
+                continue;
+            }
+            LOG_CLASS_WARNING("::begin() -> Cannot preallocate %s, falling back to appends", path);
+        }
+
         if (storage_.fileExists(path))
         {
             LOG_CLASS_INFO("::begin() -> Module cache file exists for module %d", static_cast<int>(code));
@@ -194,7 +211,7 @@ acousea_CommunicationPacket& ModuleProxy::buildRequestModulePacket(const acousea
     pkt.has_routing = true;
     pkt.routing.sender = Router::broadcastAddress;
     pkt.routing.receiver = 0; // device
-    pkt.routing.ttl = 5;
+    pkt.routing.ttl = Router::DEFAULT_TTL;
 
     pkt.which_body = acousea_CommunicationPacket_command_tag;
     pkt.body.command = acousea_CommandBody_init_default;
@@ -233,7 +250,7 @@ acousea_CommunicationPacket& ModuleProxy::buildSetModulePacket(acousea_ModuleCod
     pkt.has_routing = true;
     pkt.routing.sender = Router::broadcastAddress;
     pkt.routing.receiver = 0; // backend
-    pkt.routing.ttl = 5;
+    pkt.routing.ttl = Router::DEFAULT_TTL;
 
     pkt.which_body = acousea_CommunicationPacket_command_tag;
     pkt.body.command = acousea_CommandBody_init_default;
@@ -377,16 +394,15 @@ bool ModuleProxy::storeModule(const acousea_ModuleWrapper& wrapper)
     char filePath[10];
     std::snprintf(filePath, sizeof(filePath), "/mod%d", static_cast<int>(wrapperCode));
 
-    // Buffer temporal compartido
+    // Buffer temporal compartido (solo el payload: cabecera y footer van aparte)
     auto* tmpEncodingBuffer = SharedMemory::tmpBuffer();
     constexpr size_t tmpEncodingBufferMaxSize = SharedMemory::tmpBufferSize();
 
     // Codificamos el wrapper dentro de los límites del buffer
     Result<size_t> encodeResultWithEncodedLength = ProtoUtils::ModuleWrapper::encodeInto(
         wrapper,
-        tmpEncodingBuffer + BinaryFrame::HEADER_SIZE, // Leave space for BinaryFrame header
-        tmpEncodingBufferMaxSize - BinaryFrame::HEADER_SIZE - BinaryFrame::FOOTER_SIZE
-        // Leave space for header and footer
+        tmpEncodingBuffer,
+        tmpEncodingBufferMaxSize
     );
 
     if (!encodeResultWithEncodedLength.isSuccess())
@@ -396,32 +412,56 @@ bool ModuleProxy::storeModule(const acousea_ModuleWrapper& wrapper)
     }
 
     const auto payloadLen = static_cast<uint16_t>(encodeResultWithEncodedLength.getValue());
-    const size_t totalRecordSize = BinaryFrame::requiredSize(payloadLen); // START + LEN + PAYLOAD + END
+    // START + TS + LEN + PAYLOAD + CRC + END
+    const size_t totalRecordSize = BinaryFrame::requiredSize(payloadLen, BinaryFrame::Version::V2);
 
+    // The reader loads the whole record into the same buffer
     if (totalRecordSize > tmpEncodingBufferMaxSize)
     {
         LOG_CLASS_ERROR("::storeModule() -> Module record too large (%u bytes)", totalRecordSize);
         return false;
     }
 
-    // --- CABECERA con BinaryFrame ---
+    // --- CABECERA y FOOTER con BinaryFrame ---
     const uint32_t timestamp = rtc_.getEpoch();
-    auto* payloadPtr = tmpEncodingBuffer + BinaryFrame::HEADER_SIZE; // Payload comienza después de la cabecera
-
-    if (!BinaryFrame::wrapInPlace(
-            tmpEncodingBuffer, // The out buffer which will contain the full wrapped frame
-            tmpEncodingBufferMaxSize, // The max size of the out buffer
-            payloadPtr, // The payload ptr, which is already written in place
-            payloadLen, // The payload length
-            timestamp) // The timestamp
-    )
+    uint8_t header[BinaryFrame::HEADER_SIZE];
+    uint8_t footer[BinaryFrame::FOOTER_SIZE_V2];
+    const size_t footerLen = BinaryFrame::wrapParts(
+        header,
+        footer,
+        tmpEncodingBuffer, // The payload, written once by the encoder
+        payloadLen,
+        timestamp,
+        BinaryFrame::Version::V2); // With CRC: /modN files written before are v1 and still readable
+    if (footerLen == 0)
     {
         LOG_CLASS_WARNING("::storeModule() -> Failed to wrap module %d", static_cast<int>(wrapperCode));
         return false;
     }
 
-    // --- APPEND A SD ---
-    if (const bool appendOk = storage_.appendBytesToFile(filePath, tmpEncodingBuffer, totalRecordSize); !appendOk)
+    // --- ESCRITURA A SD (una sola escritura, sin copiar el payload) ---
+    const IoVec parts[] = {
+        {header, sizeof(header)},
+        {tmpEncodingBuffer, payloadLen},
+        {footer, footerLen},
+    };
+    const int idx = static_cast<int>(wrapperCode);
+    bool writeOk = false;
+    if (preallocated_[idx])
+    {
+        // In place inside the extent; only the last record is ever read, so the older ones can be overwritten
+        if (writeOffset_[idx] + totalRecordSize > MODULE_FILE_CAPACITY)
+        {
+            readOffset_[idx] = 0; // The current record may be overwritten: it is no longer fresh
+            writeOffset_[idx] = 0;
+        }
+        writeOk = storage_.writeFileRegionV(filePath, writeOffset_[idx], parts, 3);
+    }
+    else
+    {
+        writeOk = storage_.appendBytesToFileV(filePath, parts, 3);
+    }
+    if (!writeOk)
     {
         LOG_CLASS_WARNING("::storeModule() -> Failed to write module %d to file %s",
                           static_cast<int>(wrapperCode),
@@ -429,10 +469,10 @@ bool ModuleProxy::storeModule(const acousea_ModuleWrapper& wrapper)
         return false;
     }
     // First we need to update the read offset to the current write offset, to avoid reading more data from previous writes
-    readOffset_[static_cast<int>(wrapperCode)] = writeOffset_[static_cast<int>(wrapperCode)];
+    readOffset_[idx] = writeOffset_[idx];
 
     // Then we update the write offset to account for the newly written data
-    writeOffset_[static_cast<int>(wrapperCode)] += totalRecordSize;
+    writeOffset_[idx] += totalRecordSize;
 
     LOG_CLASS_INFO("::storeModule() -> Stored module %d (%u bytes) in %s",
                    static_cast<int>(wrapperCode),
@@ -476,13 +516,23 @@ const acousea_ModuleWrapper* ModuleProxy::getIfFresh(const acousea_ModuleCode co
     auto* readBuf = SharedMemory::tmpBuffer();
     constexpr size_t readBufMaxSize = SharedMemory::tmpBufferSize();
 
-    // --- Leer desde almacenamiento ---
-    const size_t bytesRead = storage_.readFileRegionBytes(
-        filePath,
-        readOffset_[idx],
-        readBuf,
-        readBufMaxSize
-    );
+    // --- Leer desde almacenamiento (sin copia si el backend mapea el fichero) ---
+    const uint8_t* frameBytes = readBuf;
+    size_t bytesRead = 0;
+    if (const ByteSpan mapped = storage_.mapFileRegion(filePath, readOffset_[idx], readBufMaxSize); !mapped.empty())
+    {
+        frameBytes = mapped.data;
+        bytesRead = mapped.length;
+    }
+    else
+    {
+        bytesRead = storage_.readFileRegionBytes(
+            filePath,
+            readOffset_[idx],
+            readBuf,
+            readBufMaxSize
+        );
+    }
 
     if (bytesRead == 0)
     {
@@ -493,7 +543,7 @@ const acousea_ModuleWrapper* ModuleProxy::getIfFresh(const acousea_ModuleCode co
 
     // --- Unwrap ---
     BinaryFrame::FrameView outFrameView{};
-    if (!BinaryFrame::unwrap(readBuf, bytesRead, outFrameView))
+    if (!BinaryFrame::unwrap(frameBytes, bytesRead, outFrameView))
     {
         LOG_CLASS_WARNING("::getIfFresh() -> unwrap failed for module %d", idx);
         readOffset_[idx] = writeOffset_[idx];
@@ -501,7 +551,7 @@ const acousea_ModuleWrapper* ModuleProxy::getIfFresh(const acousea_ModuleCode co
     }
 
     // Sanity check: payload fits buffer
-    const size_t totalFrameSize = BinaryFrame::requiredSize(outFrameView.payloadLength);
+    const size_t totalFrameSize = outFrameView.frameLength;
     if (bytesRead < totalFrameSize)
     {
         LOG_CLASS_WARNING("::getIfFresh() -> Incomplete frame read for module %d (read %u < needed %u)",
@@ -85,6 +85,9 @@ private:
 #else
     static constexpr uint8_t START_BYTE = 0xAA;
     static constexpr uint8_t END_BYTE = 0x55;
+    // Preallocated /modN extent: records are written in place and wrap to 0 when the next one does not fit
+    static constexpr size_t MODULE_FILE_CAPACITY = 8 * 1024;
+    bool preallocated_[_acousea_ModuleCode_MAX + 1]{}; // /modN spans a preallocated extent (1-based index)
     uint64_t writeOffset_[_acousea_ModuleCode_MAX + 1]{}; // Current write offsets for each port (1-based index)
     uint64_t readOffset_[_acousea_ModuleCode_MAX + 1]{}; // Current read offsets for each port (1-based index)
     StorageManager& storage_;
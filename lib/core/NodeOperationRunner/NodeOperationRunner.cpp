@@ -6,6 +6,7 @@
 
 #include "Ports/IPort.h"
 #include "SharedMemory/SharedMemory.hpp"
+#include "time/TimeService.hpp"
 
 
 namespace
@@ -179,7 +180,9 @@ void NodeOperationRunner::tryTransitionOpMode()
 
 void NodeOperationRunner::processReportingRoutines()
 {
-    const auto currentMinute = getMillis() / 60000;
+    // Minutos desde el arranque sobre el reloj de 64 bits: getMillis() / 60000 volvía a 0 a los ~49 días y el
+    // siguiente minuto de reporte ya no llegaba nunca
+    const auto currentMinute = static_cast<unsigned long>(TimeService::monotonicMillis() / 60000);
     const auto& currentNodeConfiguration = nodeConfigurationRepository.getNodeConfiguration();
 
     currentNodeConfiguration.has_iridiumModule
@@ -1,11 +1,13 @@
 #ifndef ACOUSEA_INFRASTRUCTURE_MKR_ITASK_HPP
 #define ACOUSEA_INFRASTRUCTURE_MKR_ITASK_HPP
 
+#include <cstdint>
+
 struct ITask
 {
     // antes TaskBase
     unsigned long interval{};
-    unsigned long lastTime{};
+    uint64_t lastTime{}; // TimeService::monotonicMillis() de la última ejecución
 
     virtual void execute() = 0;
 
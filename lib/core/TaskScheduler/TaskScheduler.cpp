@@ -1,6 +1,7 @@
 #include "TaskScheduler.h"
 
 #include "WatchDog/WatchDogUtils.hpp"
+#include "time/TimeService.hpp"
 
 
 void TaskScheduler::addTask(ITask* task)
@@ -8,12 +9,18 @@ void TaskScheduler::addTask(ITask* task)
     if (taskCount < MAX_TASKS) tasks[taskCount++] = task;
 }
 
+void TaskScheduler::setIdleTask(ITask* task)
+{
+    idleTask = task;
+}
+
 void TaskScheduler::run() const
 {
-    const unsigned long now = getMillis();
+    const uint64_t now = TimeService::monotonicMillis();
 
     WatchdogUtils::reset(); // Reset watchdog before running tasks
 
+    bool executed = false;
     for (size_t i = 0; i < taskCount; ++i)
     {
         if (now - tasks[i]->lastTime >= tasks[i]->interval)
@@ -21,6 +28,19 @@ void TaskScheduler::run() const
             tasks[i]->execute();
             tasks[i]->lastTime = now;
             WatchdogUtils::reset();
+            executed = true;
+
+            if (idleTask)
+            {
+                idleTask->execute();
+                WatchdogUtils::reset();
+            }
         }
     }
+
+    if (!executed && idleTask)
+    {
+        idleTask->execute();
+        WatchdogUtils::reset();
+    }
 }
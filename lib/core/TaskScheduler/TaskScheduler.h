@@ -12,12 +12,17 @@ class TaskScheduler
 public:
     void addTask(ITask* task);
 
+    // Runs after every executed task, or once per run() if none was due (e.g. draining deferred storage writes).
+    // Its interval is ignored
+    void setIdleTask(ITask* task);
+
     void run() const;
 
 private:
     static constexpr size_t MAX_TASKS = 10;
     ITask* tasks[MAX_TASKS]{};
     size_t taskCount = 0;
+    ITask* idleTask = nullptr;
 };
 
 #endif // TASK_SCHEDULER_H
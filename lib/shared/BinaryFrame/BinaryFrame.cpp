@@ -2,6 +2,8 @@
 
 #include <cstring>
 
+#include "Crc32/Crc32.hpp"
+
 namespace BinaryFrame
 {
     bool parseHeader(const uint8_t* buffer, const size_t bufferSize, Header& outHeader) noexcept
@@ -19,7 +21,7 @@ namespace BinaryFrame
         outHeader.startByte = buffer[pos++];
 
         // Timestamp
-        outHeader.timestamp |= static_cast<uint32_t>(buffer[pos++]);
+        outHeader.timestamp = static_cast<uint32_t>(buffer[pos++]);
         outHeader.timestamp |= static_cast<uint32_t>(buffer[pos++]) << 8;
         outHeader.timestamp |= static_cast<uint32_t>(buffer[pos++]) << 16;
         outHeader.timestamp |= static_cast<uint32_t>(buffer[pos++]) << 24;
@@ -59,14 +61,14 @@ namespace BinaryFrame
 
     bool wrapInPlace(uint8_t* outFrameBuffer, const size_t outFrameBufferSize,
                      const uint8_t* payloadBuffer, const uint16_t payloadLen,
-                     const uint32_t timestamp) noexcept
+                     const uint32_t timestamp, const Version version) noexcept
     {
         if (!outFrameBuffer)
         {
             return false;
         }
 
-        if (const size_t needed = requiredSize(payloadLen); outFrameBufferSize < needed)
+        if (const size_t needed = requiredSize(payloadLen, version); outFrameBufferSize < needed)
         {
             return false;
         }
@@ -75,29 +77,54 @@ namespace BinaryFrame
         {
             memmove(outFrameBuffer + HEADER_SIZE, outFrameBuffer, payloadLen);
         }
-        else // If they're different, copy the payloadData to the required position on the outFrameBuffer
+        else if (outFrameBuffer + HEADER_SIZE != payloadBuffer) // Unless the payload is already in place...
         {
+            // ... copy the payloadData to the required position on the outFrameBuffer
             memcpy(outFrameBuffer + HEADER_SIZE, payloadBuffer, payloadLen);
         }
 
+        uint8_t* payloadInPlace = outFrameBuffer + HEADER_SIZE;
+        return wrapParts(outFrameBuffer, payloadInPlace + payloadLen, payloadInPlace, payloadLen, timestamp, version) > 0;
+    }
+
+    size_t wrapParts(uint8_t* outHeader, uint8_t* outFooter, const uint8_t* payloadBuffer, const uint16_t payloadLen,
+                     const uint32_t timestamp, const Version version) noexcept
+    {
+        if (!outHeader || !outFooter || (!payloadBuffer && payloadLen > 0))
+        {
+            return 0;
+        }
+
         // Start byte
         size_t pos = 0;
-        outFrameBuffer[pos++] = START_BYTE;
+        outHeader[pos++] = startByteOf(version);
 
         // Timestamp little endian
-        outFrameBuffer[pos++] = static_cast<uint8_t>(timestamp & 0xFF);
-        outFrameBuffer[pos++] = static_cast<uint8_t>((timestamp >> 8) & 0xFF);
-        outFrameBuffer[pos++] = static_cast<uint8_t>((timestamp >> 16) & 0xFF);
-        outFrameBuffer[pos++] = static_cast<uint8_t>((timestamp >> 24) & 0xFF);
+        outHeader[pos++] = static_cast<uint8_t>(timestamp & 0xFF);
+        outHeader[pos++] = static_cast<uint8_t>((timestamp >> 8) & 0xFF);
+        outHeader[pos++] = static_cast<uint8_t>((timestamp >> 16) & 0xFF);
+        outHeader[pos++] = static_cast<uint8_t>((timestamp >> 24) & 0xFF);
 
         // Length little endian
-        outFrameBuffer[pos++] = static_cast<uint8_t>(payloadLen & 0xFF);
-        outFrameBuffer[pos++] = static_cast<uint8_t>((payloadLen >> 8) & 0xFF);
+        outHeader[pos++] = static_cast<uint8_t>(payloadLen & 0xFF);
+        outHeader[pos] = static_cast<uint8_t>((payloadLen >> 8) & 0xFF);
+
+        pos = 0;
+        if (version == Version::V2)
+        {
+            // CRC over timestamp + length + payload (the start byte already identifies the version)
+            uint32_t crc = Crc32::update(Crc32::INITIAL, outHeader + 1, HEADER_SIZE - 1);
+            crc = Crc32::finalize(Crc32::update(crc, payloadBuffer, payloadLen));
+            outFooter[pos++] = static_cast<uint8_t>(crc & 0xFF);
+            outFooter[pos++] = static_cast<uint8_t>((crc >> 8) & 0xFF);
+            outFooter[pos++] = static_cast<uint8_t>((crc >> 16) & 0xFF);
+            outFooter[pos++] = static_cast<uint8_t>((crc >> 24) & 0xFF);
+        }
 
         // Footer al final
-        outFrameBuffer[HEADER_SIZE + payloadLen] = END_BYTE;
+        outFooter[pos++] = END_BYTE;
 
-        return true;
+        return pos;
     }
 
     bool unwrap(const uint8_t* buffer, const size_t bufferSize, FrameView& outFrameView) noexcept
@@ -114,8 +141,10 @@ namespace BinaryFrame
 
         size_t pos = 0;
 
-        if (buffer[pos++] != START_BYTE)
+        const uint8_t startByte = buffer[pos++];
+        if (!isStartByte(startByte))
             return false;
+        const Version version = startByte == START_BYTE_V2 ? Version::V2 : Version::V1;
 
         // Timestamp
         uint32_t ts = 0;
@@ -128,7 +157,8 @@ namespace BinaryFrame
         const uint16_t readLength = static_cast<uint16_t>(buffer[pos]) | static_cast<uint16_t>(buffer[pos + 1]) << 8;
         pos += 2;
 
-        if (const size_t needed = requiredSize(readLength); bufferSize < needed)
+        const size_t needed = requiredSize(readLength, version);
+        if (bufferSize < needed)
         {
             return false;
         }
@@ -137,16 +167,86 @@ namespace BinaryFrame
         const uint8_t* payloadPtr = buffer + pos;
         pos += readLength; // apunta a footer
 
-        if (buffer[pos] != END_BYTE)
+        if (buffer[needed - 1] != END_BYTE)
         {
             return false;
         }
 
+        if (version == Version::V2)
+        {
+            const uint32_t storedCrc = static_cast<uint32_t>(buffer[pos])
+                | static_cast<uint32_t>(buffer[pos + 1]) << 8
+                | static_cast<uint32_t>(buffer[pos + 2]) << 16
+                | static_cast<uint32_t>(buffer[pos + 3]) << 24;
+            if (Crc32::compute(buffer + 1, HEADER_SIZE - 1 + readLength) != storedCrc)
+            {
+                return false;
+            }
+        }
+
         outFrameView.payload = payloadPtr;
         outFrameView.payloadLength = readLength;
         outFrameView.timestamp = ts;
+        outFrameView.frameLength = static_cast<uint16_t>(needed);
+        outFrameView.version = version;
 
 
         return true;
     }
+
+    size_t findNextFrame(const uint8_t* buffer, const size_t bufferSize, size_t from) noexcept
+    {
+        if (!buffer)
+        {
+            return bufferSize;
+        }
+
+        // Next occurrence of each start byte (memchr is vectorized on native, a tight loop on the MCU).
+        // Each one is searched again only once it has been passed, so the scan stays linear.
+        const uint8_t* end = buffer + bufferSize;
+        const uint8_t* nextV1 = nullptr;
+        const uint8_t* nextV2 = nullptr;
+
+        while (from < bufferSize)
+        {
+            const uint8_t* cursor = buffer + from;
+            if (nextV1 != end && (!nextV1 || nextV1 < cursor))
+            {
+                nextV1 = static_cast<const uint8_t*>(memchr(cursor, START_BYTE, bufferSize - from));
+                nextV1 = nextV1 ? nextV1 : end;
+            }
+            if (nextV2 != end && (!nextV2 || nextV2 < cursor))
+            {
+                nextV2 = static_cast<const uint8_t*>(memchr(cursor, START_BYTE_V2, bufferSize - from));
+                nextV2 = nextV2 ? nextV2 : end;
+            }
+            const uint8_t* candidate = nextV1 < nextV2 ? nextV1 : nextV2;
+            if (candidate == end)
+            {
+                return bufferSize;
+            }
+            from = static_cast<size_t>(candidate - buffer);
+
+            Header header{};
+            if (!parseHeader(candidate, bufferSize - from, header))
+            {
+                return from; // Header cut by the end of the buffer
+            }
+
+            // A frame cut by the end of the buffer is a candidate only if it would fit in a buffer of the same size
+            if (const size_t size = frameSize(header); size > bufferSize - from)
+            {
+                if (size <= bufferSize)
+                {
+                    return from;
+                }
+            }
+            else if (FrameView view{}; unwrap(candidate, bufferSize - from, view))
+            {
+                return from;
+            }
+            from++;
+        }
+        return bufferSize;
+    }
 } // BinaryFrame
@@ -6,24 +6,45 @@
 
 namespace BinaryFrame
 {
-    // Format:
+    // Format v1:
     // [0]   START_BYTE
     // [1..4] timestamp (uint32 little endian)
     // [5..6] length (uint16 little endian)
     // [7..7+len-1] payload
     // [7+len] END_BYTE
+    //
+    // Format v2 (same header, distinct start byte):
+    // [0]   START_BYTE_V2
+    // [1..4] timestamp (uint32 little endian)
+    // [5..6] length (uint16 little endian)
+    // [7..7+len-1] payload
+    // [7+len..7+len+3] CRC-32 of bytes [1..7+len-1] (uint32 little endian)
+    // [7+len+4] END_BYTE
+    //
+    // unwrap() accepts both, so files written with v1 (queues, /modN) stay readable.
+
+    enum class Version : uint8_t
+    {
+        V1 = 1,
+        V2 = 2,
+    };
 
     constexpr uint8_t START_BYTE = 0xAA;
+    constexpr uint8_t START_BYTE_V2 = 0xAB;
     constexpr uint8_t END_BYTE = 0x55;
 
     constexpr size_t HEADER_SIZE = 1 + 4 + 2; // start + ts + len
     constexpr size_t FOOTER_SIZE = 1; // end byte
+    constexpr size_t CRC_SIZE = 4;
+    constexpr size_t FOOTER_SIZE_V2 = CRC_SIZE + 1; // crc + end byte
 
     struct FrameView
     {
         const uint8_t* payload = nullptr;
         uint16_t payloadLength = 0;
         uint32_t timestamp = 0;
+        uint16_t frameLength = 0; // Whole frame (header + payload + footer), i.e. offset of the next frame
+        Version version = Version::V1;
     };
 
     struct Header
@@ -33,12 +54,39 @@ namespace BinaryFrame
         uint16_t payloadLength;
     };
 
+    constexpr bool isStartByte(const uint8_t byte) noexcept
+    {
+        return byte == START_BYTE || byte == START_BYTE_V2;
+    }
+
+    constexpr uint8_t startByteOf(const Version version) noexcept
+    {
+        return version == Version::V2 ? START_BYTE_V2 : START_BYTE;
+    }
+
+    constexpr size_t footerSize(const Version version) noexcept
+    {
+        return version == Version::V2 ? FOOTER_SIZE_V2 : FOOTER_SIZE;
+    }
+
     /**
      * Returns the required buffer size to wrap a payload of the given length.
      */
-    constexpr size_t requiredSize(const uint16_t payloadLen) noexcept
+    constexpr size_t requiredSize(const uint16_t payloadLen, const Version version = Version::V1) noexcept
     {
-        return HEADER_SIZE + static_cast<size_t>(payloadLen) + FOOTER_SIZE;
+        return HEADER_SIZE + static_cast<size_t>(payloadLen) + footerSize(version);
+    }
+
+    /**
+     * Size of the whole frame described by a parsed header (0 if the start byte is unknown).
+     */
+    constexpr size_t frameSize(const Header& header) noexcept
+    {
+        return header.startByte == START_BYTE_V2
+                   ? requiredSize(header.payloadLength, Version::V2)
+                   : header.startByte == START_BYTE
+                   ? requiredSize(header.payloadLength, Version::V1)
+                   : 0;
     }
 
     bool parseHeader(const uint8_t* buffer, size_t bufferSize, Header& outHeader) noexcept;
@@ -50,17 +98,30 @@ namespace BinaryFrame
      * It is assumed that:
      *  - payload starts at frameBuffer + HEADER_SIZE
      *  - payload is already written there by the caller
-     *  - bufferSize >= HEADER_SIZE + payloadLen + FOOTER_SIZE
+     *  - bufferSize >= requiredSize(payloadLen, version)
      */
     [[nodiscard]] bool wrapInPlace(uint8_t* outFrameBuffer,
                                    size_t outFrameBufferSize,
                                    const uint8_t* payloadBuffer,
                                    uint16_t payloadLen,
-                                   uint32_t timestamp) noexcept;
+                                   uint32_t timestamp,
+                                   Version version = Version::V1) noexcept;
+
+    /** Writes the header and footer of a frame into separate buffers, leaving the payload where it is, so that the
+     * frame can be written as [header][payload][footer] (e.g. StorageManager::appendBytesToFileV) without copying it.
+     *
+     * outHeader must hold HEADER_SIZE bytes and outFooter FOOTER_SIZE_V2 bytes. Returns the footer length.
+     */
+    [[nodiscard]] size_t wrapParts(uint8_t* outHeader,
+                                   uint8_t* outFooter,
+                                   const uint8_t* payloadBuffer,
+                                   uint16_t payloadLen,
+                                   uint32_t timestamp,
+                                   Version version = Version::V1) noexcept;
 
     /**
-     * Returs the unwrapped frame view from the given buffer.
-     * Does not copy the payload: only returns pointer and metadata.
+     * Returs the unwrapped frame view (v1 or v2) from the given buffer.
+     * Does not copy the payload: only returns pointer and metadata. The CRC of v2 frames is verified.
      *
      * buffer      -> pointer to the beginning of the frame (start byte)
      * bufferSize  -> number of valid bytes from buffer
@@ -68,6 +129,13 @@ namespace BinaryFrame
     [[nodiscard]] bool unwrap(const uint8_t* buffer,
                               size_t bufferSize,
                               FrameView& outFrameView) noexcept;
+
+    /**
+     * Resynchronization: offset (>= from) of the next position where a frame may start, i.e. a start byte
+     * followed by a frame that unwraps correctly, or by a frame cut by the end of the buffer that would fit in
+     * bufferSize bytes (the caller must read again from there to validate it). Returns bufferSize if there is none.
+     */
+    [[nodiscard]] size_t findNextFrame(const uint8_t* buffer, size_t bufferSize, size_t from) noexcept;
 } // BinaryFrame
 
 #endif //ACOUSEA_INFRASTRUCTURE_MKR_BINARYFRAME_HPP
@@ -0,0 +1,44 @@
+#include "Crc32.hpp"
+
+namespace
+{
+    struct Crc32Table
+    {
+        uint32_t entries[256];
+    };
+
+    constexpr Crc32Table makeTable() noexcept
+    {
+        Crc32Table table{};
+        for (uint32_t i = 0; i < 256; i++)
+        {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; bit++)
+            {
+                crc = (crc & 1u) ? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
+            }
+            table.entries[i] = crc;
+        }
+        return table;
+    }
+
+    // Computed at compile time: lives in .rodata (flash on the SAMD21), not in RAM
+    constexpr Crc32Table TABLE = makeTable();
+}
+
+namespace Crc32
+{
+    uint32_t update(uint32_t crc, const uint8_t* data, size_t length) noexcept
+    {
+        if (!data)
+        {
+            return crc;
+        }
+
+        while (length--)
+        {
+            crc = TABLE.entries[(crc ^ *data++) & 0xFFu] ^ (crc >> 8);
+        }
+        return crc;
+    }
+} // Crc32
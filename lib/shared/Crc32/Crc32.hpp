@@ -0,0 +1,33 @@
+#ifndef ACOUSEA_INFRASTRUCTURE_MKR_CRC32_HPP
+#define ACOUSEA_INFRASTRUCTURE_MKR_CRC32_HPP
+
+#include <cstdint>
+#include <cstddef>
+
+namespace Crc32
+{
+    // CRC-32 (IEEE 802.3, reflected polynomial 0xEDB88320): same result as zlib's crc32()
+
+    constexpr uint32_t INITIAL = 0xFFFFFFFFu;
+
+    /**
+     * Feeds `length` bytes into a running CRC. Start with INITIAL and finish with finalize().
+     * Table-driven (1 KB const table, kept in flash), one lookup per byte.
+     */
+    [[nodiscard]] uint32_t update(uint32_t crc, const uint8_t* data, size_t length) noexcept;
+
+    constexpr uint32_t finalize(const uint32_t crc) noexcept
+    {
+        return crc ^ 0xFFFFFFFFu;
+    }
+
+    /**
+     * CRC-32 of a contiguous buffer.
+     */
+    [[nodiscard]] inline uint32_t compute(const uint8_t* data, const size_t length) noexcept
+    {
+        return finalize(update(INITIAL, data, length));
+    }
+} // Crc32
+
+#endif //ACOUSEA_INFRASTRUCTURE_MKR_CRC32_HPP
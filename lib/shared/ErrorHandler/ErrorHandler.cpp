@@ -37,7 +37,8 @@ void ErrorHandler::setHandler(const ErrorHandlerCallback handler)
 
 void ErrorHandler::handleError(const char* msg)
 {
-    Logger::vlog("ERROR_HANDLER", msg);
+    Logger::vlog(Logger::Level::Error, msg, "[ERROR_HANDLER]: ");
+    (void)Logger::flush(); // Lo que quede en el anillo del Logger no sobrevive al reset
 
     if (customHandler) customHandler();
     performReset();
@@ -50,8 +51,9 @@ void ErrorHandler::handleErrorf(const char* fmt, ...)
 {
     va_list args;
     va_start(args, fmt);
-    Logger::vlog("ERROR_HANDLER", fmt, args);
+    Logger::vlog(Logger::Level::Error, Logger::Site{0, 0, "[ERROR_HANDLER]: "}, fmt, args);
     va_end(args);
+    (void)Logger::flush();
 
     if (customHandler) customHandler();
     performReset();
@@ -4,6 +4,11 @@
 
 #include <cstring>
 #include <cstdio>
+#include <cstddef> // ptrdiff_t
+
+#include "time/getMillis.hpp"
+#include "time/TimeService.hpp"
+#include "Crc32/Crc32.hpp"
 
 #ifdef PLATFORM_ARDUINO
 #include <Arduino.h>
@@ -32,17 +37,15 @@ void Logger::logfFreeMemory(const char* fmt, ...)
     const int freeMem = topOfStack - endOfHeap;
 
     // Format everything into sharedBuffer, as in vlog()
-    char timestamp[20];
-    getTimestamp(timestamp, sizeof(timestamp));
-
     // Formateamos el encabezado de DEBUG
-    const int headerLen = snprintf(sharedBuffer, sizeof(sharedBuffer), "[%s] DEBUG ", timestamp);
+    const Level level = Level::Debug;
+    const int headerLen = snprintf(sharedBuffer, sizeof(sharedBuffer), "[%s] DEBUG ", TimeService::timestamp());
     if (headerLen < 0 || static_cast<size_t>(headerLen) >= sizeof(sharedBuffer))
     {
         // Error al formatear el encabezado o se ha excedido el tamaño del buffer
         if (display) display->setColor(IDisplay::Color::RED);
         strcpy(sharedBuffer, "[LOGGER INTERNAL ERROR] vlog() header formatting failed.");
-        do_log();
+        do_log(Level::Error, 0);
         return;
     }
 
@@ -57,7 +60,7 @@ void Logger::logfFreeMemory(const char* fmt, ...)
         // Error al formatear el mensaje con los parámetros
         if (display) display->setColor(IDisplay::Color::RED);
         strcpy(sharedBuffer, "[LOGGER INTERNAL ERROR] vlog() message formatting failed.");
-        do_log();
+        do_log(Level::Error, 0);
         return;
     }
 
@@ -78,7 +81,7 @@ void Logger::logfFreeMemory(const char* fmt, ...)
     if (display) display->setColor(IDisplay::Color::ORANGE);
 
     // Salida según modo
-    do_log();
+    do_log(level, static_cast<size_t>(headerLen));
 }
 
 
@@ -88,16 +91,27 @@ void Logger::initialize(IDisplay* display_,
                         StorageManager* sdManager_,
                         RTCController* rtc_,
                         const char* logFilePath_,
-                        const Mode mode_)
+                        const Mode mode_,
+                        const Format format_)
 {
     // Limpieza del buffer global (evita residuos entre logs o tests)
     memset(sharedBuffer, 0, sizeof(sharedBuffer));
 
     Logger::display = display_;
     Logger::storageManager = sdManager_;
-    Logger::rtc = rtc_;
+    TimeService::attach(rtc_);
     Logger::logFilePath = logFilePath_;
     Logger::mode = mode_;
+    Logger::format = format_;
+
+    // Lo pendiente de una configuración anterior se descarta (su StorageManager puede no existir ya)
+    ringHead = 0;
+    ringUsed = 0;
+    lastFlushMs = getMillis();
+    lastFlushFailed = false;
+    droppedLines = 0;
+    reportedDroppedLines = 0;
+    rotating = false;
 
     const bool validPath = (logFilePath_ && strlen(logFilePath_) <= 8);
 
@@ -123,114 +137,202 @@ void Logger::initialize(IDisplay* display_,
 
 void Logger::logInfo(const char* message)
 {
-    if (display)
-        display->setColor(IDisplay::Color::DEFAULT);
-
-    vlog("INFO", message);
+    setLevelColor(Level::Info);
+    vlog(Level::Info, message);
 }
 
 void Logger::logWarning(const char* message)
 {
-    if (display)
-        display->setColor(IDisplay::Color::ORANGE);
-
-    vlog("WARNING", message);
+    setLevelColor(Level::Warning);
+    vlog(Level::Warning, message);
 }
 
 void Logger::logError(const char* message)
 {
-    if (display)
-        display->setColor(IDisplay::Color::RED);
-
-    vlog("ERROR", message);
+    setLevelColor(Level::Error);
+    vlog(Level::Error, message);
 }
 
 
 void Logger::logfInfo(const char* fmt, ...)
 {
-    if (display)
-        display->setColor(IDisplay::Color::DEFAULT);
+    setLevelColor(Level::Info);
 
     va_list args;
     va_start(args, fmt);
-    vlog("INFO", fmt, args);
+    vlog(Level::Info, Site{0, 0, ""}, fmt, args);
     va_end(args);
 }
 
 void Logger::logfWarning(const char* fmt, ...)
 {
-    if (display)
-        display->setColor(IDisplay::Color::ORANGE);
+    setLevelColor(Level::Warning);
 
     va_list args;
     va_start(args, fmt);
-    vlog("WARNING", fmt, args);
+    vlog(Level::Warning, Site{0, 0, ""}, fmt, args);
     va_end(args);
 }
 
 void Logger::logfError(const char* fmt, ...)
 {
-    if (display)
-        display->setColor(IDisplay::Color::RED);
+    setLevelColor(Level::Error);
+
+    va_list args;
+    va_start(args, fmt);
+    vlog(Level::Error, Site{0, 0, ""}, fmt, args);
+    va_end(args);
+}
+
+void Logger::logfSite(const Level level, const Site& site, const char* fmt, ...)
+{
+    setLevelColor(level);
 
     va_list args;
     va_start(args, fmt);
-    vlog("ERROR", fmt, args);
+    vlog(level, site, fmt, args);
     va_end(args);
 }
 
 
-void Logger::do_log()
+const char* Logger::levelName(const Level level)
+{
+    switch (level)
+    {
+    case Level::Info: return "INFO";
+    case Level::Warning: return "WARNING";
+    case Level::Error: return "ERROR";
+    case Level::Debug: return "DEBUG";
+    }
+    return "";
+}
+
+void Logger::setLevelColor(const Level level)
+{
+    if (!display) return;
+
+    switch (level)
+    {
+    case Level::Info: display->setColor(IDisplay::Color::DEFAULT);
+        break;
+    case Level::Warning:
+    case Level::Debug: display->setColor(IDisplay::Color::ORANGE);
+        break;
+    case Level::Error: display->setColor(IDisplay::Color::RED);
+        break;
+    }
+}
+
+
+void Logger::do_log(const Level level, const size_t headerLength)
 {
+    const bool binarySD = format == Format::Binary;
     switch (mode)
     {
     case Mode::SerialOnly:
         logToSerial(sharedBuffer);
         break;
     case Mode::SDCard:
-        logToSDCard(sharedBuffer);
+        binarySD ? logBinaryTextToSDCard(level, sharedBuffer + headerLength) : logToSDCard(level, sharedBuffer);
         break;
     case Mode::Both:
         logToSerial(sharedBuffer);
-        logToSDCard(sharedBuffer);
+        binarySD ? logBinaryTextToSDCard(level, sharedBuffer + headerLength) : logToSDCard(level, sharedBuffer);
         break;
     }
 }
 
-void Logger::vlog(const char* loggingClass, const char* message)
+void Logger::vlog(const Level level, const char* message, const char* prefix)
 {
-    char timestamp[20];
-    getTimestamp(timestamp, sizeof(timestamp));
+    if (!isEnabled(level)) return;
 
-    snprintf(sharedBuffer, sizeof(sharedBuffer), "[%s] %s: %s", timestamp, loggingClass, message);
+    const int headerLen = formatHeader(level);
+    snprintf(sharedBuffer + headerLen, sizeof(sharedBuffer) - static_cast<size_t>(headerLen), "%s%s", prefix, message);
 
-    do_log();
+    do_log(level, static_cast<size_t>(headerLen));
 }
 
 
-void Logger::vlog(const char* loggingClass, const char* fmt, va_list& args)
+int Logger::formatHeader(const Level level)
 {
-    char timestamp[20];
-    getTimestamp(timestamp, sizeof(timestamp));
+    // "[YYYY-MM-DD HH:MM:SS] LEVEL: " sin snprintf: el timestamp ya viene formateado y cacheado
+    const char* name = levelName(level);
+    const size_t nameLen = strlen(name);
+    char* out = sharedBuffer;
+    *out++ = '[';
+    memcpy(out, TimeService::timestamp(), TimeService::TIMESTAMP_LENGTH);
+    out += TimeService::TIMESTAMP_LENGTH;
+    *out++ = ']';
+    *out++ = ' ';
+    memcpy(out, name, nameLen);
+    out += nameLen;
+    *out++ = ':';
+    *out++ = ' ';
+    *out = '\0';
+    return static_cast<int>(out - sharedBuffer);
+}
 
-    const int headerLen = snprintf(sharedBuffer, sizeof(sharedBuffer), "[%s] %s: ", timestamp, loggingClass);
+
+int Logger::formatLine(const Level level, const char* prefix, const char* fmt, va_list& args)
+{
+    const int headerLen = formatHeader(level);
     if (headerLen < 0 || static_cast<size_t>(headerLen) >= sizeof(sharedBuffer))
     {
         // Error al formatear el encabezado o se ha excedido el tamaño del buffer
-        display->setColor(IDisplay::Color::RED);
+        if (display) display->setColor(IDisplay::Color::RED);
         strcpy(sharedBuffer, "[LOGGER INTERNAL ERROR] vlog() header formatting failed.");
-        do_log();
+        do_log(Level::Error, 0);
+        return -1;
+    }
+
+    // Prefijo de clase (lo que antes iba como primer "%s") y mensaje con los argumentos variables
+    size_t used = static_cast<size_t>(headerLen);
+    const size_t prefixLen = strlen(prefix);
+    if (prefixLen > 0 && used + prefixLen < sizeof(sharedBuffer))
+    {
+        memcpy(sharedBuffer + used, prefix, prefixLen + 1);
+        used += prefixLen;
+    }
+    vsnprintf(sharedBuffer + used, sizeof(sharedBuffer) - used, fmt, args);
+    return headerLen;
+}
+
+void Logger::vlog(const Level level, const Site& site, const char* fmt, va_list& args)
+{
+    if (!isEnabled(level)) return;
+
+    if (format == Format::Binary && mode != Mode::SerialOnly)
+    {
+        // Los argumentos se leen dos veces si también hay que formatear la línea para el puerto serie
+        va_list binaryArgs;
+        va_copy(binaryArgs, args);
+        logBinaryRecordToSDCard(level, site, fmt, binaryArgs);
+        va_end(binaryArgs);
+
+        if (mode == Mode::SDCard) return; // Ni vsnprintf ni timestamp en texto
+        if (formatLine(level, site.prefix, fmt, args) >= 0) logToSerial(sharedBuffer);
         return;
     }
 
-    // Formatear el mensaje con los argumentos variables
-    vsnprintf(sharedBuffer + headerLen, sizeof(sharedBuffer) - static_cast<size_t>(headerLen), fmt, args);
+    const int headerLen = formatLine(level, site.prefix, fmt, args);
+    if (headerLen < 0) return;
 
     // Salida según modo
-    do_log();
+    do_log(level, static_cast<size_t>(headerLen));
 }
 
 
+char* Logger::encodeHex(const uint8_t* data, const size_t length, char* out)
+{
+    static constexpr char DIGITS[] = "0123456789ABCDEF";
+    for (size_t i = 0; i < length; ++i)
+    {
+        *out++ = DIGITS[data[i] >> 4];
+        *out++ = DIGITS[data[i] & 0x0F];
+    }
+    return out;
+}
+
 void Logger::vectorToHexString(const unsigned char* data, const size_t dataLength, char* outBuffer, const size_t outSize)
 {
     const size_t needed = (dataLength * 2) + 1;
@@ -238,14 +340,10 @@ void Logger::vectorToHexString(const unsigned char* data, const size_t dataLengt
     {
         return;
     }
-    for (size_t i = 0; i < dataLength; ++i)
-    {
-        sprintf(outBuffer + i * 2, "%02X", data[i]);
-    }
-    outBuffer[dataLength * 2] = '\0';
+    *encodeHex(data, dataLength, outBuffer) = '\0';
 }
 
-// FIXME: Too much memory usage with large buffers?
+// FIXME: Too much memory usage with large buffers? (los logs usan LOG_*_HEX, que escribe directamente en sharedBuffer)
 Logger::HexString Logger::vectorToHexString(const unsigned char* data, const size_t length)
 {
 #ifdef LOGGER_HEXSTRING_DYNAMIC
@@ -254,36 +352,49 @@ Logger::HexString Logger::vectorToHexString(const unsigned char* data, const siz
     hex.buffer = static_cast<char*>(malloc(hex.size));
     if (!hex.buffer)
         return hex;
-    for (size_t i = 0; i < length; ++i)
-        sprintf(hex.buffer + i * 2, "%02X", data[i]);
-    hex.buffer[length * 2] = '\0';
+    *encodeHex(data, length, hex.buffer) = '\0';
     return hex;
 #else
     HexString hex{};
-    constexpr size_t max = HexString::MAX_LOGGER_BUF_SIZE;
-    for (size_t i = 0; i < length && (i * 2 + 2) < max; ++i)
-        sprintf(hex.buffer + i * 2, "%02X", data[i]);
-    hex.buffer[(length * 2) < max ? (length * 2) : (max - 1)] = '\0';
+    constexpr size_t maxBytes = (HexString::MAX_LOGGER_BUF_SIZE - 1) / 2;
+    *encodeHex(data, length < maxBytes ? length : maxBytes, hex.buffer) = '\0';
     return hex;
 #endif
 }
 
-void Logger::getTimestamp(char* buffer, const size_t len)
+void Logger::logfHex(const Level level, const char* prefix, const uint8_t* data, const size_t length,
+                     const char* fmt, ...)
 {
-    time_t epoch_t = rtc ? static_cast<time_t>(rtc->getEpoch()) : time(nullptr);
+    if (!isEnabled(level)) return;
+    setLevelColor(level);
 
-    const tm* t = localtime(&epoch_t);
-    if (!t)
+    va_list args;
+    va_start(args, fmt);
+    const int headerLen = formatLine(level, prefix, fmt, args);
+    va_end(args);
+    if (headerLen < 0) return;
+
+    // El volcado se escribe directamente detrás del texto; si no cabe entero queda sitio para el resumen
+    char* out = sharedBuffer + strlen(sharedBuffer);
+    const size_t room = sizeof(sharedBuffer) - static_cast<size_t>(out - sharedBuffer) - 1;
+    size_t shown = length;
+    if (hexDumpPolicy.maxBytes > 0 && shown > hexDumpPolicy.maxBytes) shown = hexDumpPolicy.maxBytes;
+    if (shown * 2 > room) shown = room > HEX_SUMMARY_RESERVE ? (room - HEX_SUMMARY_RESERVE) / 2 : 0;
+    out = encodeHex(data, shown, out);
+    *out = '\0';
+
+    if (shown < length)
     {
-        // Fallback en caso raro de fallo de localtime()
-        snprintf(buffer, len, "[INVALID TIME]");
-        return;
+        const size_t left = sizeof(sharedBuffer) - static_cast<size_t>(out - sharedBuffer);
+        const auto total = static_cast<unsigned long>(length);
+        hexDumpPolicy.checksum
+            ? snprintf(out, left, "... (%lu bytes, crc32=%08lX)", total,
+                       static_cast<unsigned long>(Crc32::compute(data, length)))
+            : snprintf(out, left, "... (%lu bytes)", total);
     }
-    snprintf(buffer, len, "%04d-%02d-%02d %02d:%02d:%02d",
-             t->tm_year + 1900, t->tm_mon + 1, t->tm_mday,
-             t->tm_hour, t->tm_min, t->tm_sec);
-}
 
+    do_log(level, static_cast<size_t>(headerLen));
+}
 
 bool Logger::clearLog()
 {
@@ -311,24 +422,564 @@ void Logger::logToSerial(const char* line)
 }
 
 
-void Logger::logToSDCard(const char* line)
+void Logger::logToSDCard(const Level level, const char* line)
 {
-    if (!storageManager || !logFilePath)
+    const size_t len = strlen(line);
+    if (len == 0)
+        return;
+
+    // Añadimos salto de línea final si no lo tiene
+    const IoVec parts[] = {
+        {reinterpret_cast<const uint8_t*>(line), len},
+        {reinterpret_cast<const uint8_t*>("\n"), line[len - 1] != '\n' ? 1u : 0u},
+    };
+    bufferForSDCard(level, parts, 2);
+}
+
+
+// -----------------------------------------------------
+// Anillo de escritura a SD
+// -----------------------------------------------------
+
+void Logger::bufferForSDCard(const Level level, const IoVec* parts, const size_t count)
+{
+    if (!storageManager || !sdPath())
     {
         if (display)
-            display->print("Logger::logToSDCard() -> StorageManager not initialized.");
+            display->print("Logger::bufferForSDCard() -> StorageManager not initialized.");
         return;
     }
 
-    const size_t len = strlen(line);
-    if (len == 0)
+    size_t total = 0;
+    for (size_t i = 0; i < count; i++) total += parts[i].length;
+
+    // Tras un fallo solo se reintenta pasado el intervalo, no con cada línea
+    const auto mayFlush = []
+    {
+        return !flushing && (!lastFlushFailed || getMillis() - lastFlushMs >= RING_FLUSH_INTERVAL_MS);
+    };
+
+    // `parts` apunta a sharedBuffer: las líneas que registre el StorageManager durante estas escrituras (o el aviso
+    // de líneas descartadas) la sobrescribirían, así que no se formatean hasta que la línea esté en el anillo
+    holdingLine = true;
+
+    // La línea no cabe en el segmento actual: se escribe lo acumulado en él y se pasa al siguiente
+    if (rotating && !flushing && segmentUsed > 0 && segmentUsed + total > rotation.segmentBytes && flush())
+    {
+        (void)rotateSegment();
+    }
+
+    // Sin sitio: se escribe lo acumulado; si aun así no cabe (SD sin responder), la línea se descarta
+    if (total > RING_SIZE - ringUsed && mayFlush()) (void)flush();
+    holdingLine = false;
+    if (total > RING_SIZE - ringUsed)
+    {
+        droppedLines++;
         return;
+    }
 
-    storageManager->appendBytesToFile(logFilePath, reinterpret_cast<const uint8_t*>(line), len);
+    size_t position = (ringHead + ringUsed) % RING_SIZE;
+    for (size_t i = 0; i < count; i++)
+    {
+        const uint8_t* data = parts[i].data;
+        size_t remaining = parts[i].length;
+        while (remaining > 0)
+        {
+            const size_t chunk = remaining < RING_SIZE - position ? remaining : RING_SIZE - position;
+            memcpy(ring + position, data, chunk);
+            position = (position + chunk) % RING_SIZE;
+            data += chunk;
+            remaining -= chunk;
+        }
+    }
+    ringUsed += total;
+    segmentUsed += total;
 
-    // Añadimos salto de línea final si no lo tiene
-    if (line[len - 1] != '\n')
+    // Las líneas del propio StorageManager durante una escritura van en la siguiente
+    const bool due = level == Level::Error || ringUsed >= RING_FLUSH_THRESHOLD
+        || getMillis() - lastFlushMs >= RING_FLUSH_INTERVAL_MS;
+    if (due && mayFlush())
+    {
+        (void)flush();
+    }
+}
+
+bool Logger::flush()
+{
+    if (flushing || !storageManager || !sdPath()) return false;
+    if (ringUsed == 0) return true;
+
+    // Lo acumulado hasta ahora, en una o dos partes si da la vuelta al anillo
+    const size_t length = ringUsed;
+    const size_t first = length < RING_SIZE - ringHead ? length : RING_SIZE - ringHead;
+    const IoVec parts[] = {{ring + ringHead, first}, {ring, length - first}};
+
+    flushing = true;
+    const bool ok = storageManager->appendBytesToFileV(sdPath(), parts, 2);
+    flushing = false;
+
+    lastFlushMs = getMillis();
+    lastFlushFailed = !ok;
+    if (!ok) return false;
+
+    // Las líneas añadidas durante la escritura siguen en el anillo
+    ringHead = (ringHead + length) % RING_SIZE;
+    ringUsed -= length;
+    if (ringUsed == 0) ringHead = 0;
+
+    if (droppedLines != reportedDroppedLines && !holdingLine) reportDroppedLines();
+    return true;
+}
+
+const char* Logger::sdPath()
+{
+    return rotating ? segmentPath : logFilePath;
+}
+
+
+// -----------------------------------------------------
+// Rotación de segmentos
+// -----------------------------------------------------
+
+bool Logger::buildSegmentPath(const char* suffix, char* out, const size_t outSize)
+{
+    // "<dir>/<stem><suffix><ext>": stem de hasta 5 caracteres para que "<stem>NNN" siga siendo 8.3
+    const char* slash = strrchr(logFilePath, '/');
+    const char* base = slash ? slash + 1 : logFilePath;
+    const char* dot = strchr(base, '.');
+    const size_t stemLength = (dot ? static_cast<size_t>(dot - base) : strlen(base));
+    const int written = snprintf(out, outSize, "%.*s%.*s%s%s",
+                                 static_cast<int>(base - logFilePath), logFilePath,
+                                 static_cast<int>(stemLength < 5 ? stemLength : 5), base,
+                                 suffix, dot && suffix[0] != '.' ? dot : "");
+    return written > 0 && static_cast<size_t>(written) < outSize;
+}
+
+bool Logger::saveSegmentIndex()
+{
+    uint8_t encoded[MAX_LOG_SEGMENTS * SEGMENT_ENTRY_SIZE];
+    for (size_t i = 0; i < rotation.maxSegments; i++)
+    {
+        for (size_t b = 0; b < 4; b++)
+        {
+            encoded[i * SEGMENT_ENTRY_SIZE + b] = static_cast<uint8_t>(segments[i].sequence >> (8 * b));
+            encoded[i * SEGMENT_ENTRY_SIZE + 4 + b] = static_cast<uint8_t>(segments[i].startEpoch >> (8 * b));
+        }
+    }
+    return storageManager->overwriteBytesToFile(indexPath, encoded, rotation.maxSegments * SEGMENT_ENTRY_SIZE);
+}
+
+bool Logger::rotateSegment()
+{
+    const auto next = static_cast<uint8_t>((currentSegment + 1) % rotation.maxSegments);
+    char suffix[4];
+    snprintf(suffix, sizeof(suffix), "%03u", static_cast<unsigned int>(next));
+    char path[MAX_LOG_PATH];
+    if (!buildSegmentPath(suffix, path, sizeof(path))) return false;
+
+    // El segmento más antiguo se reutiliza vacío: su cadena FAT vuelve a empezar
+    if (storageManager->fileExists(path) && !storageManager->clearFile(path))
+    {
+        if (display) display->print("Logger::rotateSegment() -> Could not clear the next log segment.");
+        return false;
+    }
+
+    segments[next].sequence = segments[currentSegment].sequence + 1;
+    segments[next].startEpoch = TimeService::epoch();
+    currentSegment = next;
+    memcpy(segmentPath, path, sizeof(segmentPath));
+    segmentUsed = 0;
+    return saveSegmentIndex();
+}
+
+bool Logger::enableRotation(const LogRotationConfig& config)
+{
+    if (!storageManager || !logFilePath || config.segmentBytes == 0) return false;
+    (void)flush(); // Lo pendiente va al fichero sin rotación
+
+    rotation = config;
+    if (rotation.maxSegments < 2) rotation.maxSegments = 2;
+    if (rotation.maxSegments > MAX_LOG_SEGMENTS) rotation.maxSegments = MAX_LOG_SEGMENTS;
+    if (!buildSegmentPath(".idx", indexPath, sizeof(indexPath))) return false;
+
+    // Índice: entradas de 8 bytes (sequence, startEpoch) little-endian, una por segmento
+    uint8_t encoded[MAX_LOG_SEGMENTS * SEGMENT_ENTRY_SIZE]{};
+    const size_t read = storageManager->fileExists(indexPath)
+                            ? storageManager->readFileBytes(indexPath, encoded, rotation.maxSegments
+                                                            * SEGMENT_ENTRY_SIZE)
+                            : 0;
+    memset(segments, 0, sizeof(segments));
+    currentSegment = 0;
+    for (size_t i = 0; i < read / SEGMENT_ENTRY_SIZE; i++)
+    {
+        for (size_t b = 0; b < 4; b++)
+        {
+            segments[i].sequence |= static_cast<uint32_t>(encoded[i * SEGMENT_ENTRY_SIZE + b]) << (8 * b);
+            segments[i].startEpoch |= static_cast<uint32_t>(encoded[i * SEGMENT_ENTRY_SIZE + 4 + b]) << (8 * b);
+        }
+        if (segments[i].sequence > segments[currentSegment].sequence) currentSegment = static_cast<uint8_t>(i);
+    }
+
+    char suffix[4];
+    snprintf(suffix, sizeof(suffix), "%03u", static_cast<unsigned int>(currentSegment));
+    if (!buildSegmentPath(suffix, segmentPath, sizeof(segmentPath))) return false;
+
+    if (segments[currentSegment].sequence == 0)
+    {
+        // Sin índice: se empieza por el primer segmento, vacío
+        if (storageManager->fileExists(segmentPath) && !storageManager->clearFile(segmentPath)) return false;
+        segments[0].sequence = 1;
+        segments[0].startEpoch = TimeService::epoch();
+        segmentUsed = 0;
+        if (!saveSegmentIndex()) return false;
+    }
+    else
     {
-        storageManager->appendBytesToFile(logFilePath, reinterpret_cast<const uint8_t*>("\n"), 1);
+        segmentUsed = storageManager->fileSize(segmentPath);
     }
+
+    rotating = true;
+    return true;
+}
+
+size_t Logger::getSegmentsSince(const uint32_t sinceEpoch, LogSegment* out, const size_t maxOut)
+{
+    if (!rotating || !out || maxOut == 0) return 0;
+
+    // Segmentos usados en orden de secuencia (como mucho MAX_LOG_SEGMENTS: selección directa)
+    uint8_t order[MAX_LOG_SEGMENTS];
+    size_t used = 0;
+    for (uint8_t i = 0; i < rotation.maxSegments; i++)
+    {
+        if (segments[i].sequence == 0) continue;
+        size_t pos = used++;
+        while (pos > 0 && segments[order[pos - 1]].sequence > segments[i].sequence)
+        {
+            order[pos] = order[pos - 1];
+            pos--;
+        }
+        order[pos] = i;
+    }
+
+    // Un segmento cubre desde su inicio hasta el inicio del siguiente; el actual, hasta ahora
+    size_t count = 0;
+    for (size_t k = 0; k < used; k++)
+    {
+        const bool last = k + 1 == used;
+        if (!last && segments[order[k + 1]].startEpoch <= sinceEpoch) continue;
+        if (count == maxOut)
+        {
+            // Sin sitio: se quedan los más recientes
+            memmove(out, out + 1, (maxOut - 1) * sizeof(LogSegment));
+            count--;
+        }
+        char suffix[4];
+        snprintf(suffix, sizeof(suffix), "%03u", static_cast<unsigned int>(order[k]));
+        if (!buildSegmentPath(suffix, out[count].path, sizeof(out[count].path))) continue;
+        out[count].startEpoch = segments[order[k]].startEpoch;
+        count++;
+    }
+    return count;
+}
+
+void Logger::reportDroppedLines()
+{
+    char message[64];
+    snprintf(message, sizeof(message), "%lu log lines dropped (SD log buffer full)",
+             static_cast<unsigned long>(droppedLines - reportedDroppedLines));
+    reportedDroppedLines = droppedLines;
+    vlog(Level::Warning, message, "[Logger]: ");
+}
+
+
+// -----------------------------------------------------
+// Log binario
+// -----------------------------------------------------
+
+namespace
+{
+    // Escribe los argumentos del formato en crudo; se corta (truncated) cuando no caben
+    class PayloadWriter
+    {
+    public:
+        PayloadWriter(uint8_t* buffer, const size_t capacity) : buffer_(buffer), capacity_(capacity)
+        {
+        }
+
+        void putVarint(uint64_t value)
+        {
+            uint8_t bytes[10];
+            size_t n = 0;
+            do
+            {
+                bytes[n] = static_cast<uint8_t>(value & 0x7F);
+                value >>= 7;
+                if (value) bytes[n] |= 0x80;
+                n++;
+            }
+            while (value);
+            put(bytes, n);
+        }
+
+        void putSigned(const int64_t value)
+        {
+            // Zigzag: los negativos pequeños también ocupan pocos bytes
+            putVarint((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+        }
+
+        void putDouble(const double value)
+        {
+            uint8_t bytes[sizeof(double)];
+            memcpy(bytes, &value, sizeof(bytes)); // Little-endian en SAMD y en los hosts
+            put(bytes, sizeof(bytes));
+        }
+
+        void putString(const char* text, const size_t maxLength)
+        {
+            if (!text) text = "(null)";
+            size_t length = 0;
+            while (length < maxLength && text[length]) length++;
+
+            // Lo que quepa de la cadena (su longitud va delante, varint de hasta 3 bytes)
+            const size_t room = capacity_ - used_ > 3 ? capacity_ - used_ - 3 : 0;
+            const bool cut = length > room;
+            if (cut) length = room;
+            putVarint(length);
+            put(reinterpret_cast<const uint8_t*>(text), length);
+            truncated_ = truncated_ || cut;
+        }
+
+        [[nodiscard]] size_t size() const { return used_; }
+
+        [[nodiscard]] bool truncated() const { return truncated_; }
+
+    private:
+        void put(const uint8_t* data, const size_t length)
+        {
+            if (truncated_) return;
+            if (used_ + length > capacity_)
+            {
+                truncated_ = true;
+                return;
+            }
+            memcpy(buffer_ + used_, data, length);
+            used_ += length;
+        }
+
+        uint8_t* buffer_;
+        size_t capacity_;
+        size_t used_ = 0;
+        bool truncated_ = false;
+    };
+
+    // Recorre las conversiones de fmt (como printf) y escribe cada argumento según su tipo
+    void writeArguments(PayloadWriter& writer, const char* fmt, va_list& args)
+    {
+        for (const char* p = fmt; *p && !writer.truncated(); ++p)
+        {
+            if (*p != '%') continue;
+            ++p;
+            if (*p == '%') continue;
+
+            while (*p && strchr("-+ #0", *p)) ++p;
+
+            if (*p == '*')
+            {
+                writer.putSigned(va_arg(args, int));
+                ++p;
+            }
+            else
+            {
+                while (*p >= '0' && *p <= '9') ++p;
+            }
+
+            size_t precision = SIZE_MAX;
+            if (*p == '.')
+            {
+                ++p;
+                if (*p == '*')
+                {
+                    const int value = va_arg(args, int);
+                    writer.putSigned(value);
+                    precision = value >= 0 ? static_cast<size_t>(value) : SIZE_MAX;
+                    ++p;
+                }
+                else
+                {
+                    precision = 0;
+                    while (*p >= '0' && *p <= '9') precision = precision * 10 + static_cast<size_t>(*p++ - '0');
+                }
+            }
+
+            enum class Length { None, Char, Short, Long, LongLong, IntMax, Size, PtrDiff, LongDouble };
+            Length length = Length::None;
+            switch (*p)
+            {
+            case 'h':
+                length = p[1] == 'h' ? Length::Char : Length::Short;
+                p += p[1] == 'h' ? 2 : 1;
+                break;
+            case 'l':
+                length = p[1] == 'l' ? Length::LongLong : Length::Long;
+                p += p[1] == 'l' ? 2 : 1;
+                break;
+            case 'j': length = Length::IntMax;
+                ++p;
+                break;
+            case 'z': length = Length::Size;
+                ++p;
+                break;
+            case 't': length = Length::PtrDiff;
+                ++p;
+                break;
+            case 'L': length = Length::LongDouble;
+                ++p;
+                break;
+            default: break;
+            }
+
+            switch (*p)
+            {
+            case 'd':
+            case 'i':
+                switch (length)
+                {
+                case Length::Long: writer.putSigned(va_arg(args, long));
+                    break;
+                case Length::LongLong: writer.putSigned(va_arg(args, long long));
+                    break;
+                case Length::IntMax: writer.putSigned(va_arg(args, intmax_t));
+                    break;
+                case Length::Size:
+                case Length::PtrDiff: writer.putSigned(va_arg(args, ptrdiff_t));
+                    break;
+                default: writer.putSigned(va_arg(args, int)); // char y short llegan promocionados
+                    break;
+                }
+                break;
+            case 'u':
+            case 'o':
+            case 'x':
+            case 'X':
+                switch (length)
+                {
+                case Length::Long: writer.putVarint(va_arg(args, unsigned long));
+                    break;
+                case Length::LongLong: writer.putVarint(va_arg(args, unsigned long long));
+                    break;
+                case Length::IntMax: writer.putVarint(va_arg(args, uintmax_t));
+                    break;
+                case Length::Size:
+                case Length::PtrDiff: writer.putVarint(va_arg(args, size_t));
+                    break;
+                case Length::Char: writer.putVarint(static_cast<unsigned char>(va_arg(args, unsigned int)));
+                    break;
+                case Length::Short: writer.putVarint(static_cast<unsigned short>(va_arg(args, unsigned int)));
+                    break;
+                default: writer.putVarint(va_arg(args, unsigned int));
+                    break;
+                }
+                break;
+            case 'c':
+                writer.putSigned(va_arg(args, int));
+                break;
+            case 'e':
+            case 'E':
+            case 'f':
+            case 'F':
+            case 'g':
+            case 'G':
+            case 'a':
+            case 'A':
+                writer.putDouble(length == Length::LongDouble
+                                     ? static_cast<double>(va_arg(args, long double))
+                                     : va_arg(args, double));
+                break;
+            case 's':
+                writer.putString(va_arg(args, const char*), precision);
+                break;
+            case 'p':
+                writer.putVarint(reinterpret_cast<uintptr_t>(va_arg(args, void*)));
+                break;
+            case 'n':
+                (void)va_arg(args, void*); // No se escribe nada
+                break;
+            default:
+                return; // Conversión desconocida: no se puede seguir leyendo argumentos
+            }
+        }
+    }
+
+    void encodeHeader(const Logger::BinaryRecordHeader& header, uint8_t* out)
+    {
+        const auto put32 = [](uint8_t* dst, const uint32_t value)
+        {
+            dst[0] = static_cast<uint8_t>(value);
+            dst[1] = static_cast<uint8_t>(value >> 8);
+            dst[2] = static_cast<uint8_t>(value >> 16);
+            dst[3] = static_cast<uint8_t>(value >> 24);
+        };
+        out[0] = header.sync;
+        out[1] = header.flags;
+        out[2] = static_cast<uint8_t>(header.length);
+        out[3] = static_cast<uint8_t>(header.length >> 8);
+        put32(out + 4, header.epoch);
+        put32(out + 8, header.formatId);
+        put32(out + 12, header.classId);
+    }
+}
+
+void Logger::appendBinaryRecord(BinaryRecordHeader& header, const uint8_t* payload)
+{
+    header.sync = BinaryRecordHeader::SYNC;
+    header.epoch = TimeService::epoch();
+
+    uint8_t encoded[BinaryRecordHeader::SIZE];
+    encodeHeader(header, encoded);
+    const IoVec parts[] = {{encoded, sizeof(encoded)}, {payload, header.length}};
+    bufferForSDCard(static_cast<Level>(header.flags & BinaryRecordHeader::LEVEL_MASK), parts, 2);
+}
+
+void Logger::logBinaryRecordToSDCard(const Level level, const Site& site, const char* fmt, va_list& args)
+{
+    // Payload en sharedBuffer: la línea de texto (si la hay) se formatea después
+    auto* payload = reinterpret_cast<uint8_t*>(sharedBuffer);
+    BinaryRecordHeader header{};
+    header.formatId = site.formatId;
+    header.classId = site.classId;
+
+    if (site.formatId == 0)
+    {
+        // Sin id de formato (logf* directos): el mensaje va formateado, con su prefijo
+        const size_t prefixLen = strlen(site.prefix);
+        const size_t copied = prefixLen < sizeof(sharedBuffer) ? prefixLen : sizeof(sharedBuffer) - 1;
+        memcpy(sharedBuffer, site.prefix, copied);
+        const int written = vsnprintf(sharedBuffer + copied, sizeof(sharedBuffer) - copied, fmt, args);
+        size_t length = copied + (written > 0 ? static_cast<size_t>(written) : 0);
+        if (length >= sizeof(sharedBuffer))
+        {
+            length = sizeof(sharedBuffer) - 1;
+            header.flags = BinaryRecordHeader::TRUNCATED;
+        }
+        header.classId = 0;
+        header.flags |= static_cast<uint8_t>(level);
+        header.length = static_cast<uint16_t>(length);
+        appendBinaryRecord(header, payload);
+        return;
+    }
+
+    PayloadWriter writer(payload, sizeof(sharedBuffer));
+    writeArguments(writer, fmt, args);
+    header.flags = static_cast<uint8_t>(static_cast<uint8_t>(level)
+        | (writer.truncated() ? BinaryRecordHeader::TRUNCATED : 0));
+    header.length = static_cast<uint16_t>(writer.size());
+    appendBinaryRecord(header, payload);
+}
+
+void Logger::logBinaryTextToSDCard(const Level level, const char* message)
+{
+    BinaryRecordHeader header{};
+    header.flags = static_cast<uint8_t>(level);
+    header.length = static_cast<uint16_t>(strlen(message));
+    appendBinaryRecord(header, reinterpret_cast<const uint8_t*>(message));
 }
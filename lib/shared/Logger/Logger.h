@@ -4,11 +4,50 @@
 
 #include <ctime>
 #include <cstdarg>  // para va_list, va_start, va_end
+#include <cstdint>
+#include <type_traits> // std::integral_constant (ids de formato en tiempo de compilación)
 
 #include "StorageManager/StorageManager.hpp"
 #include "RTCController.hpp"
 #include "IDisplay.h"
 
+// ============================================================================
+// Nivel mínimo de log compilado (por entorno en platformio.ini: -DLOG_LEVEL=LOG_LEVEL_INFO).
+// Las macros de los niveles inferiores no generan código ni evalúan sus argumentos.
+// ============================================================================
+#define LOG_LEVEL_DEBUG 0
+#define LOG_LEVEL_INFO 1
+#define LOG_LEVEL_WARNING 2
+#define LOG_LEVEL_ERROR 3
+#define LOG_LEVEL_NONE 4
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_DEBUG
+#endif
+
+
+/**
+ * @brief Recorte de los volcados hexadecimales de LOG_DEBUG_HEX / LOG_CLASS_DEBUG_HEX.
+ *
+ * Un volcado recortado (por maxBytes o por no caber en la línea) termina en "... (N bytes, crc32=XXXXXXXX)":
+ * la longitud y el CRC-32 del bloque completo bastan para comparar paquetes sin volcarlos enteros.
+ */
+struct HexDumpPolicy
+{
+    size_t maxBytes = 0; // Bytes volcados como máximo (0 = los que quepan en la línea)
+    bool checksum = true; // CRC-32 del bloque completo en el resumen
+};
+
+
+/**
+ * @brief Rotación del log de la SD en segmentos de tamaño acotado que se reutilizan en círculo.
+ *        Para "log.bin": log000.bin, log001.bin... e índice log.idx con el inicio (epoch) de cada segmento.
+ */
+struct LogRotationConfig
+{
+    uint32_t segmentBytes = 64UL * 1024UL; // Se rota antes de superar este tamaño (siempre entre líneas)
+    uint8_t maxSegments = 8; // 2..Logger::MAX_LOG_SEGMENTS; el más antiguo se vacía al reutilizarse
+};
 
 class Logger
 {
@@ -21,6 +60,77 @@ public:
         Both
     };
 
+    // Formato de las líneas escritas en la SD (el puerto serie siempre recibe texto)
+    enum class Format
+    {
+        Text,
+        Binary
+    };
+
+    // Mismos valores que LOG_LEVEL_*: también el nivel guardado en los registros binarios
+    enum class Level : uint8_t
+    {
+        Debug = LOG_LEVEL_DEBUG,
+        Info = LOG_LEVEL_INFO,
+        Warning = LOG_LEVEL_WARNING,
+        Error = LOG_LEVEL_ERROR
+    };
+
+    /**
+     * @brief Punto de log generado por las macros LOG_*: ids de su formato y de su prefijo de clase (ambos calculados
+     *        en compilación con formatId()) y el prefijo en texto.
+     */
+    struct Site
+    {
+        uint32_t formatId; // 0: sin id, el registro binario lleva el mensaje ya formateado
+        uint32_t classId; // 0: sin prefijo
+        const char* prefix;
+    };
+
+    /**
+     * @brief Registro del log binario (little-endian), seguido de `length` bytes de payload:
+     *        - Registro con formato (formatId != 0): los argumentos en crudo, en el orden del formato. Enteros como
+     *          varint (los con signo en zigzag, también '*' y %c), %p como varint, flotantes como double de 8 bytes y
+     *          %s como varint de longitud + bytes (sin terminador).
+     *        - Registro de texto (formatId == 0): el mensaje ya formateado, sin la cabecera de la línea.
+     *        scripts/binary_log.py extrae la tabla de formatos del código y decodifica los ficheros.
+     */
+    struct BinaryRecordHeader
+    {
+        static constexpr uint8_t SYNC = 0xA5;
+        static constexpr uint8_t LEVEL_MASK = 0x07;
+        static constexpr uint8_t TRUNCATED = 0x80; // Payload cortado: faltan argumentos o parte de un %s
+        static constexpr size_t SIZE = 16;
+
+        uint8_t sync; // SYNC
+        uint8_t flags; // Level | TRUNCATED
+        uint16_t length; // Payload bytes
+        uint32_t epoch;
+        uint32_t formatId;
+        uint32_t classId;
+    };
+
+    // FNV-1a de 32 bits; 0 queda reservado para "sin id" (cadena vacía)
+    static constexpr uint32_t formatId(const char* text)
+    {
+        if (!text || !*text) return 0;
+        uint32_t hash = 2166136261u;
+        for (; *text; ++text)
+        {
+            hash = (hash ^ static_cast<uint8_t>(*text)) * 16777619u;
+        }
+        return hash != 0 ? hash : 1;
+    }
+
+    static constexpr size_t MAX_LOG_SEGMENTS = 16;
+    static constexpr size_t MAX_LOG_PATH = 24;
+
+    struct LogSegment
+    {
+        char path[MAX_LOG_PATH];
+        uint32_t startEpoch;
+    };
+
 #ifdef LOGGER_HEXSTRING_DYNAMIC
     struct HexString
     {
@@ -40,12 +150,14 @@ public:
 #endif
 
 
+    // rtc_ ancla TimeService, que da los timestamps del log y el reloj de la planificación
     static void initialize(
         IDisplay* display_,
         StorageManager* sdManager_,
         RTCController* rtc_,
         const char* logFilePath_,
-        Mode mode_ = Mode::SerialOnly);
+        Mode mode_ = Mode::SerialOnly,
+        Format format_ = Format::Text);
 
 #ifdef PLATFORM_ARDUINO
     static void logfFreeMemory(const char* fmt = "", ...) __attribute__((format(printf, 1, 2)));
@@ -58,6 +170,45 @@ public:
     static void logfWarning(const char* fmt, ...) __attribute__((format(printf, 1, 2)));
     static void logfError(const char* fmt, ...) __attribute__((format(printf, 1, 2)));
 
+    // Destino de las macros LOG_*: en formato binario no se formatea nada para la SD
+    static void logfSite(Level level, const Site& site, const char* fmt, ...) __attribute__((format(printf, 3, 4)));
+
+
+    // Nivel mínimo en tiempo de ejecución (por encima del compilado con LOG_LEVEL)
+    static void setLevel(const Level level) { minLevel = level; }
+
+    [[nodiscard]] static Level getLevel() { return minLevel; }
+
+    [[nodiscard]] static bool isEnabled(const Level level) { return level >= minLevel && !holdingLine; }
+
+    // Escribe en la SD lo acumulado en el anillo. False si falla (lo pendiente se conserva para el siguiente intento)
+    static bool flush();
+
+    // Líneas descartadas por no caber en el anillo (SD sin responder) desde initialize()
+    [[nodiscard]] static uint32_t getDroppedLines() { return droppedLines; }
+
+    [[nodiscard]] static size_t getBufferedBytes() { return ringUsed; }
+
+    // Activa la rotación tras initialize(): continúa el segmento actual según el índice, o empieza por el primero
+    [[nodiscard]] static bool enableRotation(const LogRotationConfig& config = LogRotationConfig{});
+
+    /**
+     * @brief Segmentos con líneas desde sinceEpoch, del más antiguo al actual (para recuperar los últimos N minutos
+     *        sin leer el resto). Llamar antes a flush() para incluir lo pendiente del anillo.
+     * @return Segmentos escritos en out (0 sin rotación)
+     */
+    [[nodiscard]] static size_t getSegmentsSince(uint32_t sinceEpoch, LogSegment* out, size_t maxOut);
+
+    // Destino de LOG_*_HEX: "<fmt><HEX>" con el volcado escrito directamente en el buffer compartido
+    static void logfHex(Level level, const char* prefix, const uint8_t* data, size_t length, const char* fmt, ...)
+        __attribute__((format(printf, 5, 6)));
+
+    static void setHexDumpPolicy(const HexDumpPolicy& policy) { hexDumpPolicy = policy; }
+
+    [[nodiscard]] static const HexDumpPolicy& getHexDumpPolicy() { return hexDumpPolicy; }
+
+    // Codificador con tabla: escribe 2 * length caracteres en out (sin '\0') y devuelve el final
+    static char* encodeHex(const uint8_t* data, size_t length, char* out);
 
     static void vectorToHexString(const unsigned char* data, size_t dataLength, char* outBuffer, size_t outSize);
     [[nodiscard]] static HexString vectorToHexString(const unsigned char* data, size_t length);
@@ -69,7 +220,12 @@ private:
     static inline StorageManager* storageManager = nullptr;
     static inline const char* logFilePath = nullptr;
     static inline Mode mode = Mode::SerialOnly;
-    static inline RTCController* rtc = nullptr;
+    static inline Format format = Format::Text;
+    static inline Level minLevel = Level::Debug;
+    static inline HexDumpPolicy hexDumpPolicy{};
+
+    // Sitio para "... (N bytes, crc32=XXXXXXXX)" al recortar un volcado
+    static constexpr size_t HEX_SUMMARY_RESERVE = 40;
     static inline time_t currentTime = 0; // tiempo actual en epoch
 
 
@@ -82,17 +238,78 @@ private:
 #endif
     static inline char sharedBuffer[SHARED_BUFFER_SIZE]{};
 
-    static void getTimestamp(char* buffer, size_t len);
+    // Anillo en RAM con lo que va a la SD (modos SDCard y Both): se escribe en bloques grandes al llenarse hasta
+    // RING_FLUSH_THRESHOLD, al pasar RING_FLUSH_INTERVAL_MS desde la última escritura, con cada ERROR o con flush()
+    static constexpr size_t RING_SIZE =
+#ifdef PLATFORM_ARDUINO
+        2048;
+#else
+    8192;
+#endif
+    static constexpr size_t RING_FLUSH_THRESHOLD = RING_SIZE * 3 / 4;
+    static constexpr unsigned long RING_FLUSH_INTERVAL_MS = 5000;
+
+    static inline uint8_t ring[RING_SIZE]{};
+    static inline size_t ringHead = 0; // Byte más antiguo
+    static inline size_t ringUsed = 0;
+    static inline unsigned long lastFlushMs = 0;
+    static inline bool lastFlushFailed = false;
+    static inline bool flushing = false; // El StorageManager también registra logs mientras se escribe el anillo
+    // La línea en curso sigue en sharedBuffer (flush o rotación antes de copiarla al anillo): no se formatea otra
+    static inline bool holdingLine = false;
+    static inline uint32_t droppedLines = 0;
+    static inline uint32_t reportedDroppedLines = 0;
+
+    // Rotación: entradas del índice (sequence 0 = sin usar) y bytes del segmento actual (escritos + en el anillo)
+    struct SegmentEntry
+    {
+        uint32_t sequence;
+        uint32_t startEpoch;
+    };
+
+    static constexpr size_t SEGMENT_ENTRY_SIZE = 8;
+
+    static inline bool rotating = false;
+    static inline LogRotationConfig rotation{};
+    static inline SegmentEntry segments[MAX_LOG_SEGMENTS]{};
+    static inline uint8_t currentSegment = 0;
+    static inline size_t segmentUsed = 0;
+    static inline char segmentPath[MAX_LOG_PATH]{};
+    static inline char indexPath[MAX_LOG_PATH]{};
 
-    static void vlog(const char* loggingClass, const char* fmt, va_list& args);
-    static void vlog(const char* loggingClass, const char* message);
+    static const char* levelName(Level level);
+    static void setLevelColor(Level level);
+
+    static void vlog(Level level, const Site& site, const char* fmt, va_list& args);
+    static void vlog(Level level, const char* message, const char* prefix = "");
+
+    // Escribe "[timestamp] LEVEL: " al principio de sharedBuffer y devuelve su longitud
+    static int formatHeader(Level level);
+
+    // Formatea "[timestamp] LEVEL: <prefix><fmt>" en sharedBuffer. Devuelve la longitud de la cabecera o -1
+    static int formatLine(Level level, const char* prefix, const char* fmt, va_list& args);
 
     static bool clearLog();
 
-    static void do_log();
+    // Saca la línea de sharedBuffer; headerLength: bytes de cabecera que el registro binario no necesita
+    static void do_log(Level level, size_t headerLength);
 
     static void logToSerial(const char* line);
-    static void logToSDCard(const char* line);
+    static void logToSDCard(Level level, const char* line);
+
+    // Copia la línea (o registro) al anillo y decide si toca escribirlo en la SD
+    static void bufferForSDCard(Level level, const IoVec* parts, size_t count);
+    static void reportDroppedLines();
+
+    // Fichero donde escribe el anillo: el segmento actual o logFilePath
+    static const char* sdPath();
+    static bool buildSegmentPath(const char* suffix, char* out, size_t outSize);
+    static bool rotateSegment();
+    static bool saveSegmentIndex();
+
+    static void logBinaryRecordToSDCard(Level level, const Site& site, const char* fmt, va_list& args);
+    static void logBinaryTextToSDCard(Level level, const char* message);
+    static void appendBinaryRecord(BinaryRecordHeader& header, const uint8_t* payload);
 };
 
 // ============================================================================
@@ -102,32 +319,95 @@ private:
 #ifndef ACOUSEA_LOGGER_MACROS
 #define ACOUSEA_LOGGER_MACROS
 
+// ---------- Compile-time site ids (format string and class prefix) ----------
+#define LOG_SITE(prefix, fmt) \
+Logger::Site{std::integral_constant<uint32_t, Logger::formatId(fmt)>::value, \
+             std::integral_constant<uint32_t, Logger::formatId(prefix)>::value, prefix}
+
+// Llamada al Logger solo si el nivel está activo en tiempo de ejecución (expresión void, como antes)
+#define LOG_AT_LEVEL(level, prefix, fmt, ...) \
+(Logger::isEnabled(level) ? Logger::logfSite(level, LOG_SITE(prefix, fmt), fmt, ##__VA_ARGS__) : (void)0)
+
+// Nivel compilado fuera: la rama nunca se ejecuta y el compilador la elimina con sus argumentos, pero el formato y
+// los argumentos se siguen comprobando (y las variables usadas solo en el log no quedan sin usar)
+#define LOG_DISABLED(level, prefix, fmt, ...) \
+(false ? Logger::logfSite(level, LOG_SITE(prefix, fmt), fmt, ##__VA_ARGS__) : (void)0)
+
+#if LOG_LEVEL <= LOG_LEVEL_DEBUG
+#define LOG_IF_DEBUG LOG_AT_LEVEL
+#else
+#define LOG_IF_DEBUG LOG_DISABLED
+#endif
+
+#if LOG_LEVEL <= LOG_LEVEL_INFO
+#define LOG_IF_INFO LOG_AT_LEVEL
+#else
+#define LOG_IF_INFO LOG_DISABLED
+#endif
+
+#if LOG_LEVEL <= LOG_LEVEL_WARNING
+#define LOG_IF_WARNING LOG_AT_LEVEL
+#else
+#define LOG_IF_WARNING LOG_DISABLED
+#endif
+
+#if LOG_LEVEL <= LOG_LEVEL_ERROR
+#define LOG_IF_ERROR LOG_AT_LEVEL
+#else
+#define LOG_IF_ERROR LOG_DISABLED
+#endif
+
 // ---------- Class-aware logging (uses CLASS_NAME) ----------
+#define LOG_CLASS_DEBUG(fmt, ...) \
+LOG_IF_DEBUG(Logger::Level::Debug, getClassNameCString(), fmt, ##__VA_ARGS__)
+
 #define LOG_CLASS_INFO(fmt, ...) \
-Logger::logfInfo("%s" fmt, getClassNameCString(), ##__VA_ARGS__)
+LOG_IF_INFO(Logger::Level::Info, getClassNameCString(), fmt, ##__VA_ARGS__)
 
 #define LOG_CLASS_WARNING(fmt, ...) \
-Logger::logfWarning("%s" fmt, getClassNameCString(), ##__VA_ARGS__)
+LOG_IF_WARNING(Logger::Level::Warning, getClassNameCString(), fmt, ##__VA_ARGS__)
 
 #define LOG_CLASS_ERROR(fmt, ...) \
-Logger::logfError("%s" fmt, getClassNameCString(), ##__VA_ARGS__)
+LOG_IF_ERROR(Logger::Level::Error, getClassNameCString(), fmt, ##__VA_ARGS__)
 
 // ---------- Global / free-function logging (no class prefix) ----------
+#define LOG_DEBUG(fmt, ...) \
+LOG_IF_DEBUG(Logger::Level::Debug, "", fmt, ##__VA_ARGS__)
+
 #define LOG_INFO(fmt, ...) \
-Logger::logfInfo(fmt, ##__VA_ARGS__)
+LOG_IF_INFO(Logger::Level::Info, "", fmt, ##__VA_ARGS__)
 
 #define LOG_WARNING(fmt, ...) \
-Logger::logfWarning(fmt, ##__VA_ARGS__)
+LOG_IF_WARNING(Logger::Level::Warning, "", fmt, ##__VA_ARGS__)
 
 #define LOG_ERROR(fmt, ...) \
-Logger::logfError(fmt, ##__VA_ARGS__)
+LOG_IF_ERROR(Logger::Level::Error, "", fmt, ##__VA_ARGS__)
+
+// ---------- Hex dumps (DEBUG level): fmt seguido del volcado, recortado según Logger::setHexDumpPolicy() ----------
+#if LOG_LEVEL <= LOG_LEVEL_DEBUG
+#define LOG_HEX_AT_DEBUG(prefix, data, length, fmt, ...) \
+(Logger::isEnabled(Logger::Level::Debug) \
+     ? Logger::logfHex(Logger::Level::Debug, prefix, data, length, fmt, ##__VA_ARGS__) \
+     : (void)0)
+#else
+#define LOG_HEX_AT_DEBUG(prefix, data, length, fmt, ...) \
+(false ? Logger::logfHex(Logger::Level::Debug, prefix, data, length, fmt, ##__VA_ARGS__) : (void)0)
+#endif
 
-// ---------- Free memory logging (Arduino-only) ----------
-#ifdef PLATFORM_ARDUINO
+#define LOG_CLASS_DEBUG_HEX(data, length, fmt, ...) \
+LOG_HEX_AT_DEBUG(getClassNameCString(), data, length, fmt, ##__VA_ARGS__)
+
+#define LOG_DEBUG_HEX(data, length, fmt, ...) \
+LOG_HEX_AT_DEBUG("", data, length, fmt, ##__VA_ARGS__)
+
+// ---------- Free memory logging (Arduino-only, DEBUG level) ----------
+#if defined(PLATFORM_ARDUINO) && LOG_LEVEL <= LOG_LEVEL_DEBUG
 #define LOG_FREE_MEMORY(fmt, ...) \
-Logger::logfFreeMemory(fmt, ##__VA_ARGS__)
+(Logger::isEnabled(Logger::Level::Debug) ? Logger::logfFreeMemory(fmt, ##__VA_ARGS__) : (void)0)
 #define LOG_CLASS_FREE_MEMORY(fmt, ...) \
-Logger::logfFreeMemory("%s " fmt, getClassNameCString(), ##__VA_ARGS__)
+(Logger::isEnabled(Logger::Level::Debug) \
+     ? Logger::logfFreeMemory("%s " fmt, getClassNameCString(), ##__VA_ARGS__) \
+     : (void)0)
 #else
 #define LOG_FREE_MEMORY(fmt, ...) \
 ((void)0)
@@ -3,6 +3,8 @@
 #include <pb_encode.h>
 #include <pb_decode.h>
 
+#include <cstring>
+
 #include "Logger/Logger.h"
 #include "ClassName.h"
 
@@ -55,6 +57,108 @@ namespace ProtoUtils
             return RESULT_VOID_SUCCESS();
         }
 
+        pb_size_t peekBodyTag(const uint8_t* data, const size_t length)
+        {
+            if (data == nullptr || length == 0)
+            {
+                return 0;
+            }
+
+            // Recorre solo las claves de nivel superior, saltando el contenido de cada campo
+            pb_istream_t is = pb_istream_from_buffer(data, length);
+            pb_wire_type_t wireType;
+            uint32_t tag;
+            bool eof = false;
+            while (pb_decode_tag(&is, &wireType, &tag, &eof))
+            {
+                switch (tag)
+                {
+                case acousea_CommunicationPacket_command_tag:
+                case acousea_CommunicationPacket_response_tag:
+                case acousea_CommunicationPacket_report_tag:
+                case acousea_CommunicationPacket_error_tag:
+                    return static_cast<pb_size_t>(tag);
+                default:
+                    if (!pb_skip_field(&is, wireType))
+                    {
+                        return 0;
+                    }
+                }
+            }
+            return 0;
+        }
+
+        bool patchTtlInPlace(uint8_t* data, const size_t length, const uint32_t oldTtl, const uint32_t newTtl)
+        {
+            if (data == nullptr || length == 0)
+            {
+                return false;
+            }
+
+            // Busca el submensaje routing entre las claves de nivel superior, como peekBodyTag()
+            pb_istream_t is = pb_istream_from_buffer(data, length);
+            pb_wire_type_t wireType;
+            uint32_t tag;
+            bool eof = false;
+            while (pb_decode_tag(&is, &wireType, &tag, &eof))
+            {
+                if (tag != acousea_CommunicationPacket_routing_tag || wireType != PB_WT_STRING)
+                {
+                    if (!pb_skip_field(&is, wireType))
+                    {
+                        return false;
+                    }
+                    continue;
+                }
+
+                uint32_t routingLength = 0;
+                if (!pb_decode_varint32(&is, &routingLength) || routingLength > is.bytes_left)
+                {
+                    return false;
+                }
+                uint8_t* routing = data + (length - is.bytes_left);
+                pb_istream_t routingStream = pb_istream_from_buffer(routing, routingLength);
+                while (pb_decode_tag(&routingStream, &wireType, &tag, &eof))
+                {
+                    if (tag != acousea_RoutingChunk_ttl_tag || wireType != PB_WT_VARINT)
+                    {
+                        if (!pb_skip_field(&routingStream, wireType))
+                        {
+                            return false;
+                        }
+                        continue;
+                    }
+
+                    const size_t at = routingLength - routingStream.bytes_left;
+                    uint64_t stored = 0;
+                    if (!pb_decode_varint(&routingStream, &stored) || stored != oldTtl)
+                    {
+                        return false; // Otra codificación (p. ej. zigzag): mejor volver a codificar
+                    }
+                    const size_t storedSize = routingLength - routingStream.bytes_left - at;
+
+                    uint8_t encoded[5];
+                    size_t encodedSize = 0;
+                    uint32_t value = newTtl;
+                    do
+                    {
+                        encoded[encodedSize++] = static_cast<uint8_t>((value & 0x7F) | (value > 0x7F ? 0x80 : 0));
+                        value >>= 7;
+                    }
+                    while (value != 0);
+
+                    if (encodedSize != storedSize)
+                    {
+                        return false;
+                    }
+                    memcpy(routing + at, encoded, encodedSize);
+                    return true;
+                }
+                return false; // Sin ttl (el 0 no se codifica en proto3)
+            }
+            return false;
+        }
+
         // ================================ TO BUFFER ================================
         Result<std::vector<uint8_t>> encode(const acousea_CommunicationPacket& pkt)
         {
@@ -19,6 +19,12 @@ namespace ProtoUtils
         Result<size_t> encodeInto(const acousea_CommunicationPacket& pkt, uint8_t* buffer, size_t bufferSize);
         Result<void> decodeInto(const uint8_t* data, size_t length, acousea_CommunicationPacket* out);
 
+        // Tag of the body oneof (acousea_CommunicationPacket_*_tag) without decoding the packet. 0 if not found
+        pb_size_t peekBodyTag(const uint8_t* data, size_t length);
+
+        // Rewrites routing.ttl from oldTtl to newTtl in an encoded packet without re-encoding it. Only when the
+        // field is present as a plain varint equal to oldTtl and newTtl takes the same bytes; false otherwise
+        bool patchTtlInPlace(uint8_t* data, size_t length, uint32_t oldTtl, uint32_t newTtl);
     }
 
     namespace NodeConfiguration
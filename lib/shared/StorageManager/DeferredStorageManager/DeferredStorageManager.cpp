@@ -0,0 +1,307 @@
+#include "DeferredStorageManager.hpp"
+
+#include <cstring>
+
+#include "Logger/Logger.h"
+#include "time/getMillis.hpp"
+
+
+DeferredStorageManager::DeferredStorageManager(StorageManager& inner, const DeferredStorageConfig& config)
+    : inner_(inner), config_(config)
+{
+}
+
+// -----------------------------------------------------
+// Cola
+// -----------------------------------------------------
+
+bool DeferredStorageManager::enqueue(const Kind kind, const char* path, const size_t offset, const IoVec* parts,
+                                     const size_t count)
+{
+    size_t total = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (!parts[i].data && parts[i].length > 0) return false;
+        total += parts[i].length;
+    }
+
+    // Cannot be queued: keep the order by writing everything pending first
+    if (total > BUFFER_SIZE || std::strlen(path) >= MAX_PATH_LENGTH)
+    {
+        stats_.bypassed++;
+        (void)flush();
+        return kind == Kind::Append
+                   ? inner_.appendBytesToFileV(path, parts, count)
+                   : inner_.writeFileRegionV(path, offset, parts, count);
+    }
+
+    // Backpressure: the caller pays for the oldest writes instead of losing data
+    while (count_ == MAX_PENDING || BUFFER_SIZE - bufferUsed_ < total)
+    {
+        stats_.forcedDrains++;
+        writeOldest();
+    }
+
+    Entry& entry = entries_[(head_ + count_) % MAX_PENDING];
+    entry.kind = kind;
+    std::strncpy(entry.path, path, MAX_PATH_LENGTH - 1);
+    entry.path[MAX_PATH_LENGTH - 1] = '\0';
+    entry.offset = offset;
+    entry.start = count_ == 0 ? 0 : (entries_[head_].start + bufferUsed_) % BUFFER_SIZE;
+    entry.length = total;
+
+    size_t position = entry.start;
+    for (size_t i = 0; i < count; i++)
+    {
+        const uint8_t* data = parts[i].data;
+        size_t remaining = parts[i].length;
+        while (remaining > 0)
+        {
+            const size_t chunk = remaining < BUFFER_SIZE - position ? remaining : BUFFER_SIZE - position;
+            std::memcpy(buffer_ + position, data, chunk);
+            position = (position + chunk) % BUFFER_SIZE;
+            data += chunk;
+            remaining -= chunk;
+        }
+    }
+
+    bufferUsed_ += total;
+    count_++;
+    stats_.deferred++;
+    if (count_ > stats_.maxPending) stats_.maxPending = static_cast<uint16_t>(count_);
+    return true;
+}
+
+size_t DeferredStorageManager::dataParts(const Entry& entry, IoVec* outParts) const
+{
+    if (entry.start + entry.length <= BUFFER_SIZE)
+    {
+        outParts[0] = {buffer_ + entry.start, entry.length};
+        return 1;
+    }
+    const size_t first = BUFFER_SIZE - entry.start;
+    outParts[0] = {buffer_ + entry.start, first};
+    outParts[1] = {buffer_, entry.length - first};
+    return 2;
+}
+
+void DeferredStorageManager::writeOldest()
+{
+    if (count_ == 0) return;
+
+    const Entry& first = entries_[head_];
+    IoVec parts[MAX_COALESCED_PARTS];
+    size_t partCount = dataParts(first, parts);
+    size_t entries = 1;
+    size_t bytes = first.length;
+
+    // Following writes to the same file that continue where this one ends go in the same call
+    while (entries < count_)
+    {
+        const Entry& next = entries_[(head_ + entries) % MAX_PENDING];
+        const bool contiguous = next.kind == Kind::Append || next.offset == first.offset + bytes;
+        if (next.kind != first.kind || !contiguous || std::strcmp(next.path, first.path) != 0
+            || partCount + 2 > MAX_COALESCED_PARTS)
+        {
+            break;
+        }
+        partCount += dataParts(next, parts + partCount);
+        bytes += next.length;
+        entries++;
+    }
+
+    const bool ok = first.kind == Kind::Append
+                        ? inner_.appendBytesToFileV(first.path, parts, partCount)
+                        : inner_.writeFileRegionV(first.path, first.offset, parts, partCount);
+    stats_.drained++;
+    if (!ok)
+    {
+        // Dropped: retrying a partially written append could duplicate bytes
+        LOG_CLASS_ERROR("::writeOldest() -> Deferred write of %u bytes to %s failed",
+                        static_cast<unsigned int>(bytes), first.path);
+        stats_.failures++;
+        failed_ = true;
+    }
+
+    // The entry slot may be reused once popped
+    char path[MAX_PATH_LENGTH];
+    std::memcpy(path, first.path, sizeof(path));
+
+    head_ = (head_ + entries) % MAX_PENDING;
+    count_ -= entries;
+    bufferUsed_ -= bytes;
+
+    if (!ok && writeLost_ != nullptr) writeLost_(writeLostContext_, path);
+}
+
+void DeferredStorageManager::barrier(const char* path)
+{
+    if (!path) return;
+
+    size_t through = 0; // Entries to write (up to the last one of the path)
+    for (size_t i = 0; i < count_; i++)
+    {
+        if (std::strcmp(entries_[(head_ + i) % MAX_PENDING].path, path) == 0)
+        {
+            through = i + 1;
+        }
+    }
+    const size_t target = count_ - through;
+    while (count_ > target)
+    {
+        writeOldest();
+    }
+}
+
+void DeferredStorageManager::drain()
+{
+    const unsigned long start = getMillis();
+    while (count_ > 0)
+    {
+        writeOldest();
+        if (getMillis() - start >= config_.drainBudgetMs) break;
+    }
+}
+
+bool DeferredStorageManager::flush()
+{
+    while (count_ > 0)
+    {
+        writeOldest();
+    }
+    const bool ok = !failed_;
+    failed_ = false;
+    return ok;
+}
+
+// -----------------------------------------------------
+// Escrituras diferidas
+// -----------------------------------------------------
+
+bool DeferredStorageManager::appendBytesToFile(const char* path, const uint8_t* data, const size_t length)
+{
+    if (!path || !data || length == 0) return false;
+
+    const IoVec part{data, length};
+    return enqueue(Kind::Append, path, 0, &part, 1);
+}
+
+bool DeferredStorageManager::appendBytesToFileV(const char* path, const IoVec* parts, const size_t count)
+{
+    if (!path || !parts || count == 0) return false;
+    return enqueue(Kind::Append, path, 0, parts, count);
+}
+
+bool DeferredStorageManager::writeFileRegionV(const char* path, const size_t offset, const IoVec* parts,
+                                              const size_t count)
+{
+    // Same answer as the inner storage right away: an unsupported write must not fail later, unseen
+    if (!path || !parts || count == 0 || !inner_.supportsPreallocation()) return false;
+    return enqueue(Kind::WriteRegion, path, offset, parts, count);
+}
+
+// -----------------------------------------------------
+// Operaciones ordenadas tras las escrituras pendientes del fichero
+// -----------------------------------------------------
+
+bool DeferredStorageManager::begin()
+{
+    return inner_.begin();
+}
+
+bool DeferredStorageManager::createEmptyFile(const char* path)
+{
+    barrier(path);
+    return inner_.createEmptyFile(path);
+}
+
+bool DeferredStorageManager::overwriteBytesToFile(const char* path, const uint8_t* data, const size_t length)
+{
+    barrier(path);
+    return inner_.overwriteBytesToFile(path, data, length);
+}
+
+size_t DeferredStorageManager::readFileBytes(const char* path, uint8_t* outBuffer, const size_t maxLen)
+{
+    barrier(path);
+    return inner_.readFileBytes(path, outBuffer, maxLen);
+}
+
+size_t DeferredStorageManager::readFileRegionBytes(const char* path, const size_t offset, uint8_t* outBuffer,
+                                                   const size_t outBufferLen)
+{
+    barrier(path);
+    return inner_.readFileRegionBytes(path, offset, outBuffer, outBufferLen);
+}
+
+ByteSpan DeferredStorageManager::mapFileRegion(const char* path, const size_t offset, const size_t length)
+{
+    barrier(path);
+    return inner_.mapFileRegion(path, offset, length);
+}
+
+bool DeferredStorageManager::writeFileBytes(const char* path, const uint8_t* data, const size_t length)
+{
+    barrier(path);
+    return inner_.writeFileBytes(path, data, length);
+}
+
+bool DeferredStorageManager::preallocateFile(const char* path, const size_t capacity)
+{
+    barrier(path);
+    return inner_.preallocateFile(path, capacity);
+}
+
+bool DeferredStorageManager::truncateFileFromOffset(const char* path, const size_t offset)
+{
+    barrier(path);
+    return inner_.truncateFileFromOffset(path, offset);
+}
+
+bool DeferredStorageManager::clearFile(const char* path)
+{
+    barrier(path);
+    return inner_.clearFile(path);
+}
+
+bool DeferredStorageManager::deleteFile(const char* path)
+{
+    barrier(path);
+    return inner_.deleteFile(path);
+}
+
+bool DeferredStorageManager::fileExists(const char* path)
+{
+    barrier(path); // An append may be the one creating the file
+    return inner_.fileExists(path);
+}
+
+bool DeferredStorageManager::renameFile(const char* oldPath, const char* newPath)
+{
+    barrier(oldPath);
+    barrier(newPath);
+    return inner_.renameFile(oldPath, newPath);
+}
+
+bool DeferredStorageManager::createDirectory(const char* str)
+{
+    return inner_.createDirectory(str);
+}
+
+size_t DeferredStorageManager::fileSize(const char* str)
+{
+    barrier(str);
+    return inner_.fileSize(str);
+}
+
+bool DeferredStorageManager::sync()
+{
+    const bool flushed = flush();
+    return inner_.sync() && flushed;
+}
+
+bool DeferredStorageManager::syncFile(const char* path)
+{
+    barrier(path);
+    return inner_.syncFile(path);
+}
@@ -0,0 +1,167 @@
+#ifndef ACOUSEA_INFRASTRUCTURE_MKR_DEFERREDSTORAGEMANAGER_HPP
+#define ACOUSEA_INFRASTRUCTURE_MKR_DEFERREDSTORAGEMANAGER_HPP
+
+#include "StorageManager/StorageManager.hpp"
+#include "ClassName.h"
+
+#include <cstddef>
+#include <cstdint>
+
+
+/**
+ * @brief Opciones de DeferredStorageManager.
+ */
+struct DeferredStorageConfig
+{
+    // Max time spent by one drain() call (the oldest pending write is always written)
+    unsigned long drainBudgetMs = 50;
+};
+
+/**
+ * @brief Decorador de StorageManager que difiere los appends y las escrituras de región: se copian a una cola FIFO
+ *        acotada en RAM y vuelven enseguida, y drain() (tarea idle del TaskScheduler) las escribe entre tareas.
+ *        Así los caminos de E/S (SerialPort::sync, el handler MQTT) no esperan a la SD.
+ *
+ * Orden: las escrituras llegan al backend en el orden en que se encolaron. Cualquier otra operación sobre un fichero
+ * con escrituras pendientes (lectura, tamaño, truncado, borrado...) escribe antes la cola hasta su última escritura
+ * pendiente, de modo que siempre ve su contenido completo. flush() es la barrera global.
+ *
+ * Con la cola llena se escribe lo más antiguo en el momento (backpressure); una escritura mayor que el buffer o con
+ * una ruta demasiado larga se hace directamente tras vaciar la cola. Una escritura que falla al drenar se registra,
+ * hace que el siguiente flush()/sync() devuelva false y se notifica al callback de setWriteLostCallback(): quien la
+ * encoló ya recibió true y sus offsets van por delante del fichero.
+ */
+class DeferredStorageManager final : public StorageManager
+{
+    CLASS_NAME(DeferredStorageManager)
+
+public:
+    static constexpr size_t BUFFER_SIZE = 2048; // Bytes of the pending writes (ring)
+    static constexpr size_t MAX_PENDING = 16; // Pending write calls
+    static constexpr size_t MAX_PATH_LENGTH = 16; // 8.3 paths ("/queue1c.000") plus the terminator
+    static constexpr size_t MAX_COALESCED_PARTS = 16; // Consecutive writes to one file drained with a single call
+
+    struct Stats
+    {
+        uint32_t deferred = 0; // Write calls queued
+        uint32_t drained = 0; // Write calls issued to the inner storage (each may carry several deferred ones)
+        uint32_t forcedDrains = 0; // Writes done inside an enqueue because the queue was full
+        uint32_t bypassed = 0; // Too large (or too long a path) to be queued: written directly
+        uint32_t failures = 0; // Deferred writes that failed when drained
+        uint16_t maxPending = 0; // Peak of pending write calls
+    };
+
+    // Called with the path of a deferred write dropped when drained. It may run inside any storage call (a full
+    // queue drains on enqueue), so it must only take note and not use the storage
+    using WriteLostCallback = void (*)(void* context, const char* path);
+
+    explicit DeferredStorageManager(StorageManager& inner,
+                                    const DeferredStorageConfig& config = DeferredStorageConfig{});
+
+    void setWriteLostCallback(WriteLostCallback callback, void* context)
+    {
+        writeLost_ = callback;
+        writeLostContext_ = context;
+    }
+
+    // Writes pending writes for up to drainBudgetMs (meant to be the idle task of the TaskScheduler)
+    void drain();
+
+    // Barrier: writes everything pending. False if any deferred write failed since the previous flush()
+    [[nodiscard]] bool flush();
+
+    [[nodiscard]] size_t pendingCount() const { return count_; }
+
+    [[nodiscard]] size_t pendingBytes() const { return bufferUsed_; }
+
+    [[nodiscard]] const Stats& getStats() const { return stats_; }
+
+    [[nodiscard]] StorageManager& inner() const { return inner_; }
+
+    // ---------------- StorageManager ----------------
+    [[nodiscard]] bool begin() override;
+
+    [[nodiscard]] bool createEmptyFile(const char* path) override;
+
+    [[nodiscard]] bool appendBytesToFile(const char* path, const uint8_t* data, size_t length) override;
+
+    [[nodiscard]] bool appendBytesToFileV(const char* path, const IoVec* parts, size_t count) override;
+
+    [[nodiscard]] bool overwriteBytesToFile(const char* path, const uint8_t* data, size_t length) override;
+
+    [[nodiscard]] size_t readFileBytes(const char* path, uint8_t* outBuffer, size_t maxLen) override;
+
+    [[nodiscard]] size_t readFileRegionBytes(const char* path, size_t offset, uint8_t* outBuffer,
+                                             size_t outBufferLen) override;
+
+    [[nodiscard]] ByteSpan mapFileRegion(const char* path, size_t offset, size_t length) override;
+
+    [[nodiscard]] bool writeFileBytes(const char* path, const uint8_t* data, size_t length) override;
+
+    [[nodiscard]] bool supportsPreallocation() const override { return inner_.supportsPreallocation(); }
+
+    [[nodiscard]] bool preallocateFile(const char* path, size_t capacity) override;
+
+    [[nodiscard]] bool writeFileRegionV(const char* path, size_t offset, const IoVec* parts, size_t count) override;
+
+    [[nodiscard]] bool truncateFileFromOffset(const char* path, size_t offset) override;
+
+    [[nodiscard]] bool clearFile(const char* path) override;
+
+    [[nodiscard]] bool deleteFile(const char* path) override;
+
+    [[nodiscard]] bool fileExists(const char* path) override;
+
+    [[nodiscard]] bool renameFile(const char* oldPath, const char* newPath) override;
+
+    [[nodiscard]] bool createDirectory(const char* str) override;
+
+    [[nodiscard]] size_t fileSize(const char* str) override;
+
+    // flush() and then sync() of the inner storage
+    [[nodiscard]] bool sync() override;
+
+    // Writes the pending entries of the path (barrier) and then syncs it in the inner storage
+    [[nodiscard]] bool syncFile(const char* path) override;
+
+private:
+    enum class Kind : uint8_t
+    {
+        Append,
+        WriteRegion,
+    };
+
+    struct Entry
+    {
+        Kind kind = Kind::Append;
+        char path[MAX_PATH_LENGTH]{};
+        size_t offset = 0; // WriteRegion only
+        size_t start = 0; // Position of the data in buffer_
+        size_t length = 0;
+    };
+
+    StorageManager& inner_;
+    const DeferredStorageConfig config_;
+    Entry entries_[MAX_PENDING]{}; // FIFO, oldest at head_
+    size_t head_ = 0;
+    size_t count_ = 0;
+    uint8_t buffer_[BUFFER_SIZE]{}; // Data of the entries, in the same order (may wrap around)
+    size_t bufferUsed_ = 0;
+    bool failed_ = false;
+    Stats stats_{};
+    WriteLostCallback writeLost_ = nullptr;
+    void* writeLostContext_ = nullptr;
+
+    [[nodiscard]] bool enqueue(Kind kind, const char* path, size_t offset, const IoVec* parts, size_t count);
+
+    // Writes the oldest entry together with the following ones it can be coalesced with
+    void writeOldest();
+
+    // Writes the queue up to the last pending entry of the path (nothing if it has none)
+    void barrier(const char* path);
+
+    // Entry data as one or two parts (two when it wraps around the end of buffer_)
+    size_t dataParts(const Entry& entry, IoVec* outParts) const;
+};
+
+#endif //ACOUSEA_INFRASTRUCTURE_MKR_DEFERREDSTORAGEMANAGER_HPP
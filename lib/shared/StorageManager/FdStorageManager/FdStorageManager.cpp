@@ -0,0 +1,578 @@
+#if defined(PLATFORM_NATIVE) && !defined(_WIN32)
+
+#include "FdStorageManager.hpp"
+
+#include <cerrno>
+#include <filesystem>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "Logger/Logger.h"
+#include "time/getMillis.hpp"
+
+
+namespace
+{
+    // write() until everything is written (partial writes, EINTR)
+    bool writeAll(const int fd, const uint8_t* data, size_t length)
+    {
+        while (length > 0)
+        {
+            const ssize_t n = ::write(fd, data, length);
+            if (n < 0)
+            {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            data += n;
+            length -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    // pread() until len bytes or end of file
+    size_t readAll(const int fd, size_t offset, uint8_t* out, const size_t len)
+    {
+        size_t total = 0;
+        while (total < len)
+        {
+            const ssize_t n = ::pread(fd, out + total, len - total, static_cast<off_t>(offset));
+            if (n < 0)
+            {
+                if (errno == EINTR) continue;
+                break;
+            }
+            if (n == 0) break; // EOF
+            total += static_cast<size_t>(n);
+            offset += static_cast<size_t>(n);
+        }
+        return total;
+    }
+
+    // pwrite() until everything is written (partial writes, EINTR)
+    bool pwriteAll(const int fd, const uint8_t* data, size_t length, size_t offset)
+    {
+        while (length > 0)
+        {
+            const ssize_t n = ::pwrite(fd, data, length, static_cast<off_t>(offset));
+            if (n < 0)
+            {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            data += n;
+            length -= static_cast<size_t>(n);
+            offset += static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    constexpr size_t MAX_IOV = 16;
+}
+
+FdStorageManager::FdStorageManager(const char* rootDirectory, const FdStorageConfig& config)
+    : rootDirectory_(rootDirectory ? rootDirectory : ""), config_(config)
+{
+}
+
+FdStorageManager::~FdStorageManager()
+{
+    (void)sync();
+    for (Slot& slot : slots_)
+    {
+        closeSlot(slot);
+    }
+}
+
+bool FdStorageManager::begin()
+{
+    if (rootDirectory_.empty())
+    {
+        return true;
+    }
+    std::error_code ec;
+    std::filesystem::create_directories(rootDirectory_, ec);
+    if (ec)
+    {
+        LOG_CLASS_ERROR("::begin() -> Cannot create root directory %s", rootDirectory_.c_str());
+        return false;
+    }
+    return true;
+}
+
+std::string FdStorageManager::resolve(const char* path) const
+{
+    return rootDirectory_ + path;
+}
+
+FdStorageManager::Slot* FdStorageManager::acquire(const char* path, const bool create)
+{
+    if (!path)
+    {
+        return nullptr;
+    }
+    const std::string resolved = resolve(path);
+
+    Slot* victim = &slots_[0];
+    for (Slot& slot : slots_)
+    {
+        if (slot.fd >= 0 && slot.path == resolved)
+        {
+            slot.lastUse = ++useCounter_;
+            return &slot;
+        }
+        if (victim->fd >= 0 && (slot.fd < 0 || slot.lastUse < victim->lastUse))
+        {
+            victim = &slot; // A free slot, otherwise the least recently used
+        }
+    }
+
+    const int flags = O_RDWR | O_APPEND | O_CLOEXEC | (create ? O_CREAT : 0);
+    const int fd = ::open(resolved.c_str(), flags, 0644);
+    if (fd < 0)
+    {
+        return nullptr;
+    }
+    stats_.opens++;
+
+    closeSlot(*victim);
+    victim->fd = fd;
+    victim->path = resolved;
+    victim->lastUse = ++useCounter_;
+    victim->dirty = false;
+    return victim;
+}
+
+void FdStorageManager::closeSlot(Slot& slot)
+{
+    if (slot.fd < 0)
+    {
+        return;
+    }
+    // A group commit must not be lost because the descriptor was evicted
+    if (slot.dirty && config_.syncPolicy != FdStorageConfig::SyncPolicy::None)
+    {
+        (void)syncSlot(slot);
+    }
+    unmapSlot(slot);
+    ::close(slot.fd);
+    slot.fd = -1;
+    slot.path.clear();
+    slot.dirty = false;
+}
+
+void FdStorageManager::unmapSlot(Slot& slot)
+{
+    if (slot.map)
+    {
+        ::munmap(const_cast<uint8_t*>(slot.map), slot.mapLength);
+        slot.map = nullptr;
+        slot.mapLength = 0;
+    }
+}
+
+void FdStorageManager::release(const std::string& resolvedPath)
+{
+    for (Slot& slot : slots_)
+    {
+        if (slot.fd >= 0 && slot.path == resolvedPath)
+        {
+            closeSlot(slot);
+        }
+    }
+}
+
+bool FdStorageManager::syncSlot(Slot& slot)
+{
+    stats_.syncs++;
+    slot.dirty = false;
+    return ::fdatasync(slot.fd) == 0;
+}
+
+bool FdStorageManager::afterWrite(Slot& slot, const size_t written)
+{
+    slot.dirty = true;
+    switch (config_.syncPolicy)
+    {
+    case FdStorageConfig::SyncPolicy::EveryWrite:
+        return syncSlot(slot);
+
+    case FdStorageConfig::SyncPolicy::GroupCommit:
+        if (pendingBytes_ == 0)
+        {
+            pendingSinceMs_ = getMillis();
+        }
+        pendingBytes_ += written;
+        if (pendingBytes_ >= config_.groupCommitBytes || getMillis() - pendingSinceMs_ >= config_.groupCommitMs)
+        {
+            return sync();
+        }
+        return true;
+
+    case FdStorageConfig::SyncPolicy::None:
+    default:
+        return true;
+    }
+}
+
+bool FdStorageManager::sync()
+{
+    bool success = true;
+    for (Slot& slot : slots_)
+    {
+        if (slot.fd >= 0 && slot.dirty)
+        {
+            success = syncSlot(slot) && success;
+        }
+    }
+    pendingBytes_ = 0;
+    return success;
+}
+
+bool FdStorageManager::syncFile(const char* path)
+{
+    const std::string resolved = resolve(path);
+    for (Slot& slot : slots_)
+    {
+        if (slot.fd >= 0 && slot.dirty && slot.path == resolved)
+        {
+            return syncSlot(slot);
+        }
+    }
+    return true; // No cached descriptor with writes pending
+}
+
+// -----------------------------------------------------
+
+bool FdStorageManager::createEmptyFile(const char* path)
+{
+    Slot* slot = acquire(path, true);
+    if (slot) unmapSlot(*slot);
+    if (!slot || ::ftruncate(slot->fd, 0) != 0)
+    {
+        LOG_CLASS_ERROR("::createEmptyFile() -> Cannot create file: %s", path);
+        return false;
+    }
+    return afterWrite(*slot, 0);
+}
+
+bool FdStorageManager::appendBytesToFile(const char* path, const uint8_t* data, const size_t length)
+{
+    if (!data || length == 0) return false;
+
+    Slot* slot = acquire(path, true);
+    if (!slot)
+    {
+        LOG_CLASS_ERROR("::appendBytesToFile() -> Cannot open file: %s", path);
+        return false;
+    }
+    if (!writeAll(slot->fd, data, length)) // O_APPEND: always at the end
+    {
+        LOG_CLASS_ERROR("::appendBytesToFile() -> Write failed for %s (errno %d)", path, errno);
+        return false;
+    }
+    return afterWrite(*slot, length);
+}
+
+bool FdStorageManager::appendBytesToFileV(const char* path, const IoVec* parts, const size_t count)
+{
+    if (!parts || count == 0) return false;
+
+    Slot* slot = acquire(path, true);
+    if (!slot)
+    {
+        LOG_CLASS_ERROR("::appendBytesToFileV() -> Cannot open file: %s", path);
+        return false;
+    }
+
+    // One writev per MAX_IOV parts; a partial writev falls back to writing the rest part by part
+    size_t total = 0;
+    for (size_t first = 0; first < count; first += MAX_IOV)
+    {
+        iovec iov[MAX_IOV];
+        const size_t n = count - first < MAX_IOV ? count - first : MAX_IOV;
+        size_t expected = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            if (!parts[first + i].data && parts[first + i].length > 0) return false;
+            iov[i].iov_base = const_cast<uint8_t*>(parts[first + i].data);
+            iov[i].iov_len = parts[first + i].length;
+            expected += parts[first + i].length;
+        }
+
+        const ssize_t written = ::writev(slot->fd, iov, static_cast<int>(n));
+        if (written < 0 && errno != EINTR)
+        {
+            LOG_CLASS_ERROR("::appendBytesToFileV() -> Write failed for %s (errno %d)", path, errno);
+            return false;
+        }
+        total += expected;
+
+        size_t done = written < 0 ? 0 : static_cast<size_t>(written);
+        for (size_t i = 0; i < n && done < expected; i++)
+        {
+            const size_t len = iov[i].iov_len;
+            if (done >= len)
+            {
+                done -= len;
+                expected -= len;
+                continue;
+            }
+            if (!writeAll(slot->fd, static_cast<const uint8_t*>(iov[i].iov_base) + done, len - done))
+            {
+                return false;
+            }
+            done = 0;
+            expected -= len;
+        }
+    }
+    return afterWrite(*slot, total);
+}
+
+bool FdStorageManager::overwriteBytesToFile(const char* path, const uint8_t* data, const size_t length)
+{
+    if (!data) return false;
+    return writeFileBytes(path, data, length);
+}
+
+bool FdStorageManager::writeFileBytes(const char* path, const uint8_t* data, const size_t length)
+{
+    if (!data && length > 0) return false;
+
+    Slot* slot = acquire(path, true);
+    if (slot) unmapSlot(*slot);
+    if (!slot || ::ftruncate(slot->fd, 0) != 0)
+    {
+        LOG_CLASS_ERROR("::writeFileBytes() -> Cannot open file: %s", path);
+        return false;
+    }
+    if (length > 0 && !writeAll(slot->fd, data, length))
+    {
+        LOG_CLASS_ERROR("::writeFileBytes() -> Write failed for %s (errno %d)", path, errno);
+        return false;
+    }
+    return afterWrite(*slot, length);
+}
+
+bool FdStorageManager::preallocateFile(const char* path, const size_t capacity)
+{
+    Slot* slot = acquire(path, true);
+    if (slot) unmapSlot(*slot);
+    if (!slot || ::ftruncate(slot->fd, 0) != 0)
+    {
+        LOG_CLASS_ERROR("::preallocateFile() -> Cannot create file: %s", path);
+        return false;
+    }
+    // Reserva los bloques (a ceros) en lugar de dejar un fichero disperso que crezca con cada escritura
+    if (const int err = ::posix_fallocate(slot->fd, 0, static_cast<off_t>(capacity)); err != 0)
+    {
+        LOG_CLASS_ERROR("::preallocateFile() -> fallocate failed for %s (errno %d)", path, err);
+        return false;
+    }
+    return afterWrite(*slot, 0);
+}
+
+bool FdStorageManager::writeFileRegionV(const char* path, const size_t offset, const IoVec* parts, const size_t count)
+{
+    if (!parts || count == 0) return false;
+
+    Slot* slot = acquire(path, true);
+    if (!slot)
+    {
+        LOG_CLASS_ERROR("::writeFileRegionV() -> Cannot open file: %s", path);
+        return false;
+    }
+
+    // En Linux pwrite ignora el offset si el descriptor es O_APPEND: se quita mientras dura la escritura
+    const int flags = ::fcntl(slot->fd, F_GETFL);
+    if (flags < 0 || ::fcntl(slot->fd, F_SETFL, flags & ~O_APPEND) != 0)
+    {
+        return false;
+    }
+    bool ok = true;
+    size_t position = offset;
+    for (size_t i = 0; ok && i < count; i++)
+    {
+        ok = (parts[i].data || parts[i].length == 0) && pwriteAll(slot->fd, parts[i].data, parts[i].length, position);
+        position += parts[i].length;
+    }
+    (void)::fcntl(slot->fd, F_SETFL, flags);
+    if (!ok)
+    {
+        LOG_CLASS_ERROR("::writeFileRegionV() -> Write failed for %s (errno %d)", path, errno);
+        return false;
+    }
+    return afterWrite(*slot, position - offset);
+}
+
+// -----------------------------------------------------
+
+size_t FdStorageManager::readFileBytes(const char* path, uint8_t* outBuffer, const size_t maxLen)
+{
+    return readFileRegionBytes(path, 0, outBuffer, maxLen);
+}
+
+size_t FdStorageManager::readFileRegionBytes(const char* path, const size_t offset, uint8_t* outBuffer,
+                                             const size_t len)
+{
+    if (!outBuffer || len == 0) return 0;
+
+    const Slot* slot = acquire(path, false);
+    if (!slot)
+    {
+        LOG_CLASS_ERROR("::readFileRegionBytes() -> Cannot open file: %s", path);
+        return 0;
+    }
+    return readAll(slot->fd, offset, outBuffer, len);
+}
+
+ByteSpan FdStorageManager::mapFileRegion(const char* path, const size_t offset, const size_t length)
+{
+    if (!config_.mmapReads || length == 0) return {};
+
+    Slot* slot = acquire(path, false);
+    struct stat st{};
+    if (!slot || ::fstat(slot->fd, &st) != 0)
+    {
+        return {};
+    }
+    const auto size = static_cast<size_t>(st.st_size);
+    if (offset >= size)
+    {
+        return {};
+    }
+    const size_t end = offset + length < size ? offset + length : size;
+
+    // Map again only when the region goes past the current window (the file grew)
+    if (end > slot->mapLength)
+    {
+        unmapSlot(*slot);
+        const size_t windowLength = (end + MAP_GRANULARITY - 1) / MAP_GRANULARITY * MAP_GRANULARITY;
+        void* map = ::mmap(nullptr, windowLength, PROT_READ, MAP_SHARED, slot->fd, 0);
+        if (map == MAP_FAILED)
+        {
+            LOG_CLASS_WARNING("::mapFileRegion() -> mmap failed for %s (errno %d)", path, errno);
+            return {};
+        }
+        stats_.maps++;
+        slot->map = static_cast<const uint8_t*>(map);
+        slot->mapLength = windowLength;
+    }
+    return {slot->map + offset, end - offset};
+}
+
+// -----------------------------------------------------
+
+bool FdStorageManager::truncateFileFromOffset(const char* path, const size_t offset)
+{
+    Slot* slot = acquire(path, false);
+    if (!slot)
+    {
+        LOG_CLASS_ERROR("::truncateFileFromOffset() -> Cannot open file: %s", path);
+        return false;
+    }
+
+    // Mismo comportamiento que SDStorageManager: conserva los bytes a partir de offset
+    struct stat st{};
+    if (::fstat(slot->fd, &st) != 0)
+    {
+        return false;
+    }
+    const auto total = static_cast<size_t>(st.st_size);
+    std::vector<uint8_t> tail(offset < total ? total - offset : 0);
+    unmapSlot(*slot);
+    if (readAll(slot->fd, offset, tail.data(), tail.size()) != tail.size() || ::ftruncate(slot->fd, 0) != 0)
+    {
+        return false;
+    }
+    if (!tail.empty() && !writeAll(slot->fd, tail.data(), tail.size()))
+    {
+        return false;
+    }
+    return afterWrite(*slot, tail.size());
+}
+
+bool FdStorageManager::clearFile(const char* path)
+{
+    Slot* slot = acquire(path, false);
+    if (slot) unmapSlot(*slot);
+    if (!slot || ::ftruncate(slot->fd, 0) != 0)
+    {
+        LOG_CLASS_ERROR("::clearFile() -> Cannot open file: %s", path);
+        return false;
+    }
+    return afterWrite(*slot, 0);
+}
+
+bool FdStorageManager::deleteFile(const char* path)
+{
+    if (!path) return false;
+
+    const std::string resolved = resolve(path);
+    release(resolved);
+    if (::unlink(resolved.c_str()) != 0)
+    {
+        LOG_CLASS_ERROR("::deleteFile() -> Failed to remove file: %s", path);
+        return false;
+    }
+    return true;
+}
+
+bool FdStorageManager::fileExists(const char* path)
+{
+    if (!path) return false;
+
+    const std::string resolved = resolve(path);
+    for (const Slot& slot : slots_)
+    {
+        if (slot.fd >= 0 && slot.path == resolved)
+        {
+            return true;
+        }
+    }
+    return ::access(resolved.c_str(), F_OK) == 0;
+}
+
+bool FdStorageManager::renameFile(const char* oldPath, const char* newPath)
+{
+    if (!oldPath || !newPath) return false;
+
+    const std::string from = resolve(oldPath);
+    const std::string to = resolve(newPath);
+    release(from);
+    release(to);
+    if (::rename(from.c_str(), to.c_str()) != 0)
+    {
+        LOG_CLASS_ERROR("::renameFile() -> Cannot rename %s to %s", oldPath, newPath);
+        return false;
+    }
+    return true;
+}
+
+bool FdStorageManager::createDirectory(const char* str)
+{
+    if (!str) return false;
+
+    std::error_code ec;
+    std::filesystem::create_directories(resolve(str), ec);
+    return !ec;
+}
+
+size_t FdStorageManager::fileSize(const char* str)
+{
+    const Slot* slot = acquire(str, false);
+    struct stat st{};
+    if (!slot || ::fstat(slot->fd, &st) != 0)
+    {
+        LOG_CLASS_ERROR("::fileSize() -> Cannot open file: %s", str);
+        return 0;
+    }
+    return static_cast<size_t>(st.st_size);
+}
+
+#endif // PLATFORM_NATIVE && !_WIN32
@@ -0,0 +1,153 @@
+#ifndef ACOUSEA_INFRASTRUCTURE_MKR_FDSTORAGEMANAGER_HPP
+#define ACOUSEA_INFRASTRUCTURE_MKR_FDSTORAGEMANAGER_HPP
+
+#if defined(PLATFORM_NATIVE) && !defined(_WIN32)
+
+#include "StorageManager/StorageManager.hpp"
+#include "ClassName.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+
+/**
+ * @brief Opciones de FdStorageManager.
+ */
+struct FdStorageConfig
+{
+    enum class SyncPolicy : uint8_t
+    {
+        None, // Only sync() persists (the kernel flushes on its own schedule)
+        EveryWrite, // fdatasync after each write call
+        GroupCommit, // fdatasync once groupCommitBytes are pending or the oldest pending write is groupCommitMs old
+    };
+
+    SyncPolicy syncPolicy = SyncPolicy::GroupCommit;
+    uint32_t groupCommitBytes = 64 * 1024;
+    uint32_t groupCommitMs = 1000;
+
+    // mapFileRegion() serves reads from a read-only mmap of the file instead of returning an empty span
+    bool mmapReads = true;
+};
+
+/**
+ * @brief StorageManager POSIX para el gateway (Rock Pi): mantiene abiertos los descriptores de los ficheros usados
+ *        (LRU de MAX_OPEN_FILES) y usa pread para las lecturas y write/writev sobre descriptores O_APPEND para los
+ *        appends, sin iostreams ni open/close por llamada.
+ *
+ * La durabilidad la fija FdStorageConfig::syncPolicy; sync() persiste siempre lo pendiente.
+ *
+ * mapFileRegion() mapea el fichero (PROT_READ, MAP_SHARED) en ventanas de MAP_GRANULARITY bytes que se conservan
+ * mientras el descriptor siga abierto; los appends (write) son visibles en el mapeo sin volver a mapear. Una
+ * operación sobre otro fichero puede expulsar el descriptor del LRU y desmapear la vista devuelta.
+ *
+ * preallocateFile() reserva el extent con posix_fallocate (se lee a ceros) y writeFileRegionV() escribe con pwrite.
+ */
+class FdStorageManager final : public StorageManager
+{
+    CLASS_NAME(FdStorageManager)
+
+public:
+    static constexpr size_t MAX_OPEN_FILES = 8;
+    static constexpr size_t MAP_GRANULARITY = 64 * 1024; // Segments and module files fit in one mapping
+
+    // Las rutas de la SD ("/queue1.000") se resuelven dentro de rootDirectory ("" = tal cual)
+    explicit FdStorageManager(const char* rootDirectory = "", const FdStorageConfig& config = FdStorageConfig{});
+
+    ~FdStorageManager() override;
+
+    FdStorageManager(const FdStorageManager&) = delete;
+    FdStorageManager& operator=(const FdStorageManager&) = delete;
+
+    [[nodiscard]] bool begin() override;
+
+    [[nodiscard]] bool createEmptyFile(const char* path) override;
+
+    [[nodiscard]] bool appendBytesToFile(const char* path, const uint8_t* data, size_t length) override;
+
+    [[nodiscard]] bool appendBytesToFileV(const char* path, const IoVec* parts, size_t count) override;
+
+    [[nodiscard]] bool overwriteBytesToFile(const char* path, const uint8_t* data, size_t length) override;
+
+    [[nodiscard]] bool writeFileBytes(const char* path, const uint8_t* data, size_t length) override;
+
+    [[nodiscard]] bool supportsPreallocation() const override { return true; }
+
+    [[nodiscard]] bool preallocateFile(const char* path, size_t capacity) override;
+
+    [[nodiscard]] bool writeFileRegionV(const char* path, size_t offset, const IoVec* parts, size_t count) override;
+
+    [[nodiscard]] size_t readFileBytes(const char* path, uint8_t* outBuffer, size_t maxLen) override;
+
+    [[nodiscard]] size_t readFileRegionBytes(const char* path, size_t offset, uint8_t* outBuffer, size_t len) override;
+
+    [[nodiscard]] ByteSpan mapFileRegion(const char* path, size_t offset, size_t length) override;
+
+    [[nodiscard]] bool truncateFileFromOffset(const char* path, size_t offset) override;
+
+    [[nodiscard]] bool clearFile(const char* path) override;
+
+    [[nodiscard]] bool deleteFile(const char* path) override;
+
+    [[nodiscard]] bool fileExists(const char* path) override;
+
+    [[nodiscard]] bool renameFile(const char* oldPath, const char* newPath) override;
+
+    [[nodiscard]] bool createDirectory(const char* str) override;
+
+    [[nodiscard]] size_t fileSize(const char* str) override;
+
+    [[nodiscard]] bool sync() override;
+
+    [[nodiscard]] bool syncFile(const char* path) override;
+
+    struct Stats
+    {
+        uint32_t opens = 0;
+        uint32_t syncs = 0; // fdatasync calls
+        uint32_t maps = 0; // mmap calls
+    };
+
+    [[nodiscard]] const Stats& getStats() const { return stats_; }
+
+private:
+    struct Slot
+    {
+        int fd = -1;
+        std::string path{}; // Resolved path
+        uint32_t lastUse = 0;
+        bool dirty = false;
+        const uint8_t* map = nullptr; // Read-only mapping of [0, mapLength)
+        size_t mapLength = 0;
+    };
+
+    std::string rootDirectory_;
+    const FdStorageConfig config_;
+    Slot slots_[MAX_OPEN_FILES]{};
+    uint32_t useCounter_ = 0;
+    size_t pendingBytes_ = 0; // Written since the last fdatasync
+    unsigned long pendingSinceMs_ = 0;
+    Stats stats_{};
+
+    [[nodiscard]] std::string resolve(const char* path) const;
+
+    // Slot with the cached descriptor (O_RDWR | O_APPEND) of the path, nullptr if it cannot be opened
+    [[nodiscard]] Slot* acquire(const char* path, bool create);
+
+    void release(const std::string& resolvedPath);
+
+    // Applies the sync policy after `written` bytes were written through `slot`
+    [[nodiscard]] bool afterWrite(Slot& slot, size_t written);
+
+    [[nodiscard]] bool syncSlot(Slot& slot);
+
+    void closeSlot(Slot& slot);
+
+    // Drops the mapping before the file shrinks (pages past the end must never be touched)
+    static void unmapSlot(Slot& slot);
+};
+
+#endif // PLATFORM_NATIVE && !_WIN32
+
+#endif //ACOUSEA_INFRASTRUCTURE_MKR_FDSTORAGEMANAGER_HPP
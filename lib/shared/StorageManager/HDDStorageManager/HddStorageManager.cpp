@@ -5,23 +5,50 @@
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <vector>
 
 namespace fs = std::filesystem;
 
+HDDStorageManager::HDDStorageManager(const char* rootDirectory)
+    : rootDirectory_(rootDirectory ? rootDirectory : "")
+{
+}
+
+std::string HDDStorageManager::resolve(const char* path) const
+{
+    return rootDirectory_ + path;
+}
+
 bool HDDStorageManager::begin(){
+    if (!rootDirectory_.empty()) {
+        std::error_code ec;
+        fs::create_directories(rootDirectory_, ec);
+        return !ec;
+    }
+    return true;
+}
+
+bool HDDStorageManager::createEmptyFile(const char* path) {
+    if (!path) return false;
+
+    std::ofstream ofs(resolve(path), std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!ofs) {
+        std::cerr << "HDDStorageManager::createEmptyFile() -> Cannot create: " << path << "\n";
+        return false;
+    }
     return true;
 }
 
 bool HDDStorageManager::writeFileBytes(const char* path, const uint8_t* data, size_t length) {
     try {
         // Crear directorios padre si hiciera falta
-        const fs::path p(path);
+        const fs::path p(resolve(path));
         if (p.has_parent_path()) {
             std::error_code ec;
             fs::create_directories(p.parent_path(), ec); // best-effort
         }
 
-        std::ofstream ofs(path, std::ios::out | std::ios::binary | std::ios::trunc);
+        std::ofstream ofs(p, std::ios::out | std::ios::binary | std::ios::trunc);
         if (!ofs) {
             std::cerr << "HDDStorageManager::writeFileBytes() -> Cannot open: " << path << "\n";
             return false;
@@ -41,16 +68,26 @@ bool HDDStorageManager::writeFileBytes(const char* path, const uint8_t* data, si
     }
 }
 
+bool HDDStorageManager::overwriteBytesToFile(const char* path, const uint8_t* data, size_t length) {
+    if (!path || !data) return false;
+    return writeFileBytes(path, data, length);
+}
+
 // --------------------------------------------------------------
 // Lee un archivo binario dentro de un buffer
 // --------------------------------------------------------------
 size_t HDDStorageManager::readFileBytes(const char* path, uint8_t* outBuffer, size_t maxLen) {
-    if (!path || !outBuffer || maxLen == 0) return 0;
+    return readFileRegionBytes(path, 0, outBuffer, maxLen);
+}
+
+size_t HDDStorageManager::readFileRegionBytes(const char* path, size_t offset, uint8_t* outBuffer,
+                                              size_t outBufferLen) {
+    if (!path || !outBuffer || outBufferLen == 0) return 0;
 
     try {
-        std::ifstream ifs(path, std::ios::in | std::ios::binary | std::ios::ate);
+        std::ifstream ifs(resolve(path), std::ios::in | std::ios::binary | std::ios::ate);
         if (!ifs) {
-            std::cerr << "HDDStorageManager::readFileBytes() -> Cannot open: " << path << "\n";
+            std::cerr << "HDDStorageManager::readFileRegionBytes() -> Cannot open: " << path << "\n";
             return 0;
         }
 
@@ -58,83 +95,87 @@ size_t HDDStorageManager::readFileBytes(const char* path, uint8_t* outBuffer, si
         if (endPos <= 0) return 0;
 
         const size_t fileSize = static_cast<size_t>(endPos);
-        const size_t toRead = (fileSize < maxLen) ? fileSize : maxLen;
+        if (offset >= fileSize) return 0;
+        const size_t available = fileSize - offset;
+        const size_t toRead = (available < outBufferLen) ? available : outBufferLen;
 
-        ifs.seekg(0, std::ios::beg);
+        ifs.seekg(static_cast<std::streamoff>(offset), std::ios::beg);
         ifs.read(reinterpret_cast<char*>(outBuffer), static_cast<std::streamsize>(toRead));
 
         if (!ifs && !ifs.eof()) {
-            std::cerr << "HDDStorageManager::readFileBytes() -> Read failed for: " << path << "\n";
+            std::cerr << "HDDStorageManager::readFileRegionBytes() -> Read failed for: " << path << "\n";
             return 0;
         }
 
-        return toRead;
+        return static_cast<size_t>(ifs.gcount());
     } catch (const std::exception& e) {
-        std::cerr << "HDDStorageManager::readFileBytes() -> Exception: " << e.what() << "\n";
+        std::cerr << "HDDStorageManager::readFileRegionBytes() -> Exception: " << e.what() << "\n";
         return 0;
     }
 }
 
 
 // --------------------------------------------------------------
-// Añade texto al final de un archivo
+// Añade bytes al final de un archivo
 // --------------------------------------------------------------
-bool HDDStorageManager::appendToFile(const char* path, const char* content) {
-    if (!path || !content) return false;
-
-    std::ofstream ofs(path, std::ios::out | std::ios::app | std::ios::binary);
-    if (!ofs) {
-        std::cerr << "HDDStorageManager::appendToFile() -> Cannot open: " << path << "\n";
-        return false;
-    }
-
-    ofs << content;
-    return true;
+bool HDDStorageManager::appendBytesToFile(const char* path, const uint8_t* data, size_t length) {
+    const IoVec part{data, length};
+    return data && length > 0 && appendBytesToFileV(path, &part, 1);
 }
 
-
 // --------------------------------------------------------------
-// Sobrescribe completamente un archivo de texto
+// Añade varios fragmentos binarios con una sola apertura
 // --------------------------------------------------------------
-bool HDDStorageManager::overwriteFile(const char* path, const char* content) {
-    if (!path || !content) return false;
+bool HDDStorageManager::appendBytesToFileV(const char* path, const IoVec* parts, size_t count) {
+    if (!path || !parts || count == 0) return false;
 
-    std::ofstream ofs(path, std::ios::out | std::ios::trunc | std::ios::binary);
+    std::ofstream ofs(resolve(path), std::ios::out | std::ios::app | std::ios::binary);
     if (!ofs) {
-        std::cerr << "HDDStorageManager::overwriteFile() -> Cannot open: " << path << "\n";
+        std::cerr << "HDDStorageManager::appendBytesToFileV() -> Cannot open: " << path << "\n";
         return false;
     }
 
-    ofs << content;
+    for (size_t i = 0; i < count; i++) {
+        if (parts[i].length == 0) continue;
+        if (!parts[i].data) return false;
+        ofs.write(reinterpret_cast<const char*>(parts[i].data), static_cast<std::streamsize>(parts[i].length));
+    }
+    if (!ofs) {
+        std::cerr << "HDDStorageManager::appendBytesToFileV() -> Write failed for: " << path << "\n";
+        return false;
+    }
     return true;
 }
+
+
 // --------------------------------------------------------------
-// Lee un archivo de texto completo
+// Truncado / borrado
 // --------------------------------------------------------------
-size_t HDDStorageManager::readFile(const char* path, char* outBuffer, size_t maxLen) {
-    if (!path || !outBuffer || maxLen == 0) return 0;
+bool HDDStorageManager::truncateFileFromOffset(const char* path, size_t offset) {
+    if (!path) return false;
 
-    std::ifstream ifs(path, std::ios::in | std::ios::binary);
-    if (!ifs) {
-        std::cerr << "HDDStorageManager::readFile() -> Cannot open: " << path << "\n";
-        return 0;
+    // Mismo comportamiento que SDStorageManager: conserva los bytes a partir de offset
+    const size_t total = fileSize(path);
+    std::vector<uint8_t> tail(offset < total ? total - offset : 0);
+    if (!tail.empty() && readFileRegionBytes(path, offset, tail.data(), tail.size()) != tail.size()) {
+        return false;
     }
+    return writeFileBytes(path, tail.data(), tail.size());
+}
 
-    size_t count = 0;
-    while (ifs.good() && count < maxLen - 1) {
-        char c;
-        ifs.get(c);
-        if (!ifs.good()) break;
-        outBuffer[count++] = c;
+bool HDDStorageManager::clearFile(const char* path) {
+    if (!fileExists(path)) {
+        std::cerr << "HDDStorageManager::clearFile() -> Cannot open: " << path << "\n";
+        return false;
     }
-    outBuffer[count] = '\0';
-    return count;
+    return createEmptyFile(path);
 }
 
 bool HDDStorageManager::deleteFile(const char* path){
     try{
-        if (fs::exists(path) && fs::is_regular_file(path)){
-            return fs::remove(path);
+        const fs::path p(resolve(path));
+        if (fs::exists(p) && fs::is_regular_file(p)){
+            return fs::remove(p);
         }
         // Si no existe o no es regular, devuelve false
         return false;
@@ -145,4 +186,39 @@ bool HDDStorageManager::deleteFile(const char* path){
     }
 }
 
-#endif // ARDUINO
\ No newline at end of file
+
+// --------------------------------------------------------------
+// Metadatos
+// --------------------------------------------------------------
+bool HDDStorageManager::fileExists(const char* path) {
+    if (!path) return false;
+    std::error_code ec;
+    return fs::exists(resolve(path), ec);
+}
+
+bool HDDStorageManager::renameFile(const char* oldPath, const char* newPath) {
+    if (!oldPath || !newPath) return false;
+    std::error_code ec;
+    fs::rename(resolve(oldPath), resolve(newPath), ec);
+    if (ec) {
+        std::cerr << "HDDStorageManager::renameFile() -> Cannot rename " << oldPath << " to " << newPath << "\n";
+        return false;
+    }
+    return true;
+}
+
+bool HDDStorageManager::createDirectory(const char* str) {
+    if (!str) return false;
+    std::error_code ec;
+    fs::create_directories(resolve(str), ec);
+    return !ec;
+}
+
+size_t HDDStorageManager::fileSize(const char* str) {
+    if (!str) return 0;
+    std::error_code ec;
+    const auto size = fs::file_size(resolve(str), ec);
+    return ec ? 0 : static_cast<size_t>(size);
+}
+
+#endif // PLATFORM_NATIVE
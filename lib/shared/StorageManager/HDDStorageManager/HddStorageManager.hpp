@@ -8,25 +8,44 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <string>
 
 /**
  * @brief Implementación de StorageManager que opera sobre el sistema de archivos del host.
  *        Compatible con la nueva interfaz libre de STL en la API pública.
+ *
+ * Abre un std::ifstream / std::ofstream en cada llamada. En el gateway se usa FdStorageManager (descriptores
+ * cacheados); esta implementación queda como referencia portable (Windows) y como base de los benchmarks.
  */
 class HDDStorageManager final : public StorageManager
 {
 public:
-    HDDStorageManager() = default;
+    // Las rutas de la SD ("/queue1.000") se resuelven dentro de rootDirectory ("" = tal cual)
+    explicit HDDStorageManager(const char* rootDirectory = "");
 
     bool begin() override;
 
-    bool appendToFile(const char* path, const char* content) override;
-    bool overwriteFile(const char* path, const char* content) override;
-    size_t readFile(const char* path, char* outBuffer, size_t maxLen) override;
-    bool deleteFile(const char* path) override;
-
+    bool createEmptyFile(const char* path) override;
+    bool appendBytesToFile(const char* path, const uint8_t* data, size_t length) override;
+    bool appendBytesToFileV(const char* path, const IoVec* parts, size_t count) override;
+    bool overwriteBytesToFile(const char* path, const uint8_t* data, size_t length) override;
     bool writeFileBytes(const char* path, const uint8_t* data, size_t length) override;
+
     size_t readFileBytes(const char* path, uint8_t* outBuffer, size_t maxLen) override;
+    size_t readFileRegionBytes(const char* path, size_t offset, uint8_t* outBuffer, size_t outBufferLen) override;
+
+    bool truncateFileFromOffset(const char* path, size_t offset) override;
+    bool clearFile(const char* path) override;
+    bool deleteFile(const char* path) override;
+    bool fileExists(const char* path) override;
+    bool renameFile(const char* oldPath, const char* newPath) override;
+    bool createDirectory(const char* str) override;
+    size_t fileSize(const char* str) override;
+
+private:
+    std::string rootDirectory_;
+
+    [[nodiscard]] std::string resolve(const char* path) const;
 };
 
 
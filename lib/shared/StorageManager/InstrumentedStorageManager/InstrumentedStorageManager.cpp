@@ -0,0 +1,272 @@
+#include "InstrumentedStorageManager.hpp"
+
+#include "Logger/Logger.h"
+#include "time/getMillis.hpp"
+
+#include <climits>
+
+
+namespace
+{
+    constexpr const char* OP_NAMES[InstrumentedStorageManager::OP_COUNT] = {
+        "begin", "createEmpty", "append", "appendV", "overwrite", "readFile", "readRegion", "mapRegion",
+        "writeFile", "truncate", "clear", "delete", "exists", "rename", "createDir", "fileSize", "sync",
+        "preallocate", "writeRegion"
+    };
+}
+
+InstrumentedStorageManager::InstrumentedStorageManager(StorageManager& inner) : inner_(inner)
+{
+}
+
+const char* InstrumentedStorageManager::opName(const Op op)
+{
+    const auto index = static_cast<size_t>(op);
+    return index < OP_COUNT ? OP_NAMES[index] : "?";
+}
+
+size_t InstrumentedStorageManager::bucketOf(uint32_t us)
+{
+    size_t bucket = 0;
+    while (us != 0 && bucket < LATENCY_BUCKETS - 1)
+    {
+        us >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+uint32_t InstrumentedStorageManager::bucketUpperUs(const size_t bucket)
+{
+    if (bucket >= LATENCY_BUCKETS - 1) return UINT32_MAX;
+    return (static_cast<uint32_t>(1) << bucket) - 1;
+}
+
+uint32_t InstrumentedStorageManager::percentileUs(const Op op, const uint8_t percentile) const
+{
+    const OpStats& s = stats(op);
+    uint32_t samples = 0;
+    for (const uint16_t count : s.histogram) samples += count;
+    if (samples == 0) return 0;
+
+    // Rank of the sample (1-based, rounded up) that the percentile falls on
+    const uint64_t rank = (static_cast<uint64_t>(samples) * (percentile > 100 ? 100 : percentile) + 99) / 100;
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < LATENCY_BUCKETS; bucket++)
+    {
+        seen += s.histogram[bucket];
+        if (seen >= rank && seen > 0)
+        {
+            // Never above the slowest call seen (which also bounds the open-ended bucket)
+            const uint32_t upper = bucketUpperUs(bucket);
+            return upper < s.maxUs ? upper : s.maxUs;
+        }
+    }
+    return s.maxUs;
+}
+
+void InstrumentedStorageManager::reset()
+{
+    for (auto& s : stats_) s = OpStats{};
+}
+
+void InstrumentedStorageManager::record(const Op op, const unsigned long startUs, const bool success,
+                                        const size_t bytes)
+{
+    const auto elapsed = static_cast<uint32_t>(getMicros() - startUs);
+    OpStats& s = stats_[static_cast<size_t>(op)];
+    s.calls++;
+    if (!success) s.failures++;
+    s.bytes += bytes;
+    s.totalUs += elapsed;
+    if (elapsed > s.maxUs) s.maxUs = elapsed;
+    if (uint16_t& count = s.histogram[bucketOf(elapsed)]; count < UINT16_MAX) count++;
+}
+
+void InstrumentedStorageManager::logSummary() const
+{
+    for (size_t i = 0; i < OP_COUNT; i++)
+    {
+        const auto op = static_cast<Op>(i);
+        const OpStats& s = stats_[i];
+        if (s.calls == 0) continue;
+
+        LOG_CLASS_INFO("%s: n=%lu fail=%lu bytes=%llu avg=%luus p50<=%luus p99<=%luus max=%luus",
+                       opName(op),
+                       static_cast<unsigned long>(s.calls),
+                       static_cast<unsigned long>(s.failures),
+                       static_cast<unsigned long long>(s.bytes),
+                       static_cast<unsigned long>(s.totalUs / s.calls),
+                       static_cast<unsigned long>(percentileUs(op, 50)),
+                       static_cast<unsigned long>(percentileUs(op, 99)),
+                       static_cast<unsigned long>(s.maxUs));
+    }
+}
+
+// -----------------------------------------------------
+
+bool InstrumentedStorageManager::begin()
+{
+    const unsigned long start = getMicros();
+    const bool ok = inner_.begin();
+    record(Op::Begin, start, ok, 0);
+    return ok;
+}
+
+bool InstrumentedStorageManager::createEmptyFile(const char* path)
+{
+    const unsigned long start = getMicros();
+    const bool ok = inner_.createEmptyFile(path);
+    record(Op::CreateEmptyFile, start, ok, 0);
+    return ok;
+}
+
+bool InstrumentedStorageManager::appendBytesToFile(const char* path, const uint8_t* data, const size_t length)
+{
+    const unsigned long start = getMicros();
+    const bool ok = inner_.appendBytesToFile(path, data, length);
+    record(Op::Append, start, ok, ok ? length : 0);
+    return ok;
+}
+
+bool InstrumentedStorageManager::appendBytesToFileV(const char* path, const IoVec* parts, const size_t count)
+{
+    const unsigned long start = getMicros();
+    const bool ok = inner_.appendBytesToFileV(path, parts, count);
+    size_t bytes = 0;
+    for (size_t i = 0; ok && i < count; i++) bytes += parts[i].length;
+    record(Op::AppendV, start, ok, bytes);
+    return ok;
+}
+
+bool InstrumentedStorageManager::overwriteBytesToFile(const char* path, const uint8_t* data, const size_t length)
+{
+    const unsigned long start = getMicros();
+    const bool ok = inner_.overwriteBytesToFile(path, data, length);
+    record(Op::Overwrite, start, ok, ok ? length : 0);
+    return ok;
+}
+
+size_t InstrumentedStorageManager::readFileBytes(const char* path, uint8_t* outBuffer, const size_t maxLen)
+{
+    const unsigned long start = getMicros();
+    const size_t read = inner_.readFileBytes(path, outBuffer, maxLen);
+    record(Op::ReadFile, start, read > 0, read);
+    return read;
+}
+
+size_t InstrumentedStorageManager::readFileRegionBytes(const char* path, const size_t offset, uint8_t* outBuffer,
+                                                       const size_t outBufferLen)
+{
+    const unsigned long start = getMicros();
+    const size_t read = inner_.readFileRegionBytes(path, offset, outBuffer, outBufferLen);
+    record(Op::ReadRegion, start, read > 0, read);
+    return read;
+}
+
+ByteSpan InstrumentedStorageManager::mapFileRegion(const char* path, const size_t offset, const size_t length)
+{
+    const unsigned long start = getMicros();
+    const ByteSpan span = inner_.mapFileRegion(path, offset, length);
+    record(Op::MapRegion, start, !span.empty(), span.length);
+    return span;
+}
+
+bool InstrumentedStorageManager::writeFileBytes(const char* path, const uint8_t* data, const size_t length)
+{
+    const unsigned long start = getMicros();
+    const bool ok = inner_.writeFileBytes(path, data, length);
+    record(Op::WriteFile, start, ok, ok ? length : 0);
+    return ok;
+}
+
+bool InstrumentedStorageManager::preallocateFile(const char* path, const size_t capacity)
+{
+    const unsigned long start = getMicros();
+    const bool ok = inner_.preallocateFile(path, capacity);
+    record(Op::Preallocate, start, ok, 0);
+    return ok;
+}
+
+bool InstrumentedStorageManager::writeFileRegionV(const char* path, const size_t offset, const IoVec* parts,
+                                                  const size_t count)
+{
+    const unsigned long start = getMicros();
+    const bool ok = inner_.writeFileRegionV(path, offset, parts, count);
+    size_t bytes = 0;
+    for (size_t i = 0; ok && i < count; i++) bytes += parts[i].length;
+    record(Op::WriteRegion, start, ok, bytes);
+    return ok;
+}
+
+bool InstrumentedStorageManager::truncateFileFromOffset(const char* path, const size_t offset)
+{
+    const unsigned long start = getMicros();
+    const bool ok = inner_.truncateFileFromOffset(path, offset);
+    record(Op::Truncate, start, ok, 0);
+    return ok;
+}
+
+bool InstrumentedStorageManager::clearFile(const char* path)
+{
+    const unsigned long start = getMicros();
+    const bool ok = inner_.clearFile(path);
+    record(Op::Clear, start, ok, 0);
+    return ok;
+}
+
+bool InstrumentedStorageManager::deleteFile(const char* path)
+{
+    const unsigned long start = getMicros();
+    const bool ok = inner_.deleteFile(path);
+    record(Op::Delete, start, ok, 0);
+    return ok;
+}
+
+bool InstrumentedStorageManager::fileExists(const char* path)
+{
+    const unsigned long start = getMicros();
+    const bool ok = inner_.fileExists(path);
+    record(Op::Exists, start, ok, 0);
+    return ok;
+}
+
+bool InstrumentedStorageManager::renameFile(const char* oldPath, const char* newPath)
+{
+    const unsigned long start = getMicros();
+    const bool ok = inner_.renameFile(oldPath, newPath);
+    record(Op::Rename, start, ok, 0);
+    return ok;
+}
+
+bool InstrumentedStorageManager::createDirectory(const char* str)
+{
+    const unsigned long start = getMicros();
+    const bool ok = inner_.createDirectory(str);
+    record(Op::CreateDirectory, start, ok, 0);
+    return ok;
+}
+
+size_t InstrumentedStorageManager::fileSize(const char* str)
+{
+    const unsigned long start = getMicros();
+    const size_t size = inner_.fileSize(str);
+    record(Op::FileSize, start, size > 0, 0);
+    return size;
+}
+
+bool InstrumentedStorageManager::sync()
+{
+    const unsigned long start = getMicros();
+    const bool ok = inner_.sync();
+    record(Op::Sync, start, ok, 0);
+    return ok;
+}
+
+bool InstrumentedStorageManager::syncFile(const char* path)
+{
+    const unsigned long start = getMicros();
+    const bool ok = inner_.syncFile(path);
+    record(Op::Sync, start, ok, 0);
+    return ok;
+}
@@ -0,0 +1,134 @@
+#ifndef ACOUSEA_INFRASTRUCTURE_MKR_INSTRUMENTEDSTORAGEMANAGER_HPP
+#define ACOUSEA_INFRASTRUCTURE_MKR_INSTRUMENTEDSTORAGEMANAGER_HPP
+
+#include "StorageManager/StorageManager.hpp"
+#include "ClassName.h"
+
+#include <cstddef>
+#include <cstdint>
+
+
+/**
+ * @brief Decorador de StorageManager que mide cada operación del backend envuelto: llamadas, fallos, bytes y un
+ *        histograma de latencias en cubetas log2 de microsegundos (memoria fija, sin heap).
+ *
+ * Las estadísticas se consultan con stats()/percentileUs() o se vuelcan con logSummary(). Si el Logger escribe en
+ * este mismo almacenamiento, sus appends también se cuentan (incluidos los del propio volcado).
+ */
+class InstrumentedStorageManager final : public StorageManager
+{
+    CLASS_NAME(InstrumentedStorageManager)
+
+public:
+    enum class Op : uint8_t
+    {
+        Begin,
+        CreateEmptyFile,
+        Append,
+        AppendV,
+        Overwrite,
+        ReadFile,
+        ReadRegion,
+        MapRegion,
+        WriteFile,
+        Truncate,
+        Clear,
+        Delete,
+        Exists,
+        Rename,
+        CreateDirectory,
+        FileSize,
+        Sync,
+        Preallocate,
+        WriteRegion,
+        COUNT
+    };
+
+    static constexpr size_t OP_COUNT = static_cast<size_t>(Op::COUNT);
+
+    // Bucket 0: < 1 us; bucket i: [2^(i-1), 2^i) us; the last one is open-ended (>= 2^(N-2) us, about 0.5 s)
+    static constexpr size_t LATENCY_BUCKETS = 21;
+
+    struct OpStats
+    {
+        uint32_t calls = 0;
+        uint32_t failures = 0; // false / 0 bytes returned (a missing file counts for Exists and FileSize)
+        uint64_t bytes = 0; // Written or read
+        uint64_t totalUs = 0;
+        uint32_t maxUs = 0;
+        uint16_t histogram[LATENCY_BUCKETS]{}; // Saturates at UINT16_MAX
+    };
+
+    explicit InstrumentedStorageManager(StorageManager& inner);
+
+    [[nodiscard]] const OpStats& stats(Op op) const { return stats_[static_cast<size_t>(op)]; }
+
+    // Upper bound (us) of the bucket holding the given percentile (0-100), capped at maxUs; 0 if never called
+    [[nodiscard]] uint32_t percentileUs(Op op, uint8_t percentile) const;
+
+    [[nodiscard]] static const char* opName(Op op);
+
+    [[nodiscard]] static size_t bucketOf(uint32_t us);
+
+    // Upper bound of the bucket in microseconds (UINT32_MAX for the open-ended last bucket)
+    [[nodiscard]] static uint32_t bucketUpperUs(size_t bucket);
+
+    void reset();
+
+    // One Logger line per operation that has been called
+    void logSummary() const;
+
+    [[nodiscard]] StorageManager& inner() const { return inner_; }
+
+    // ---------------- StorageManager ----------------
+    [[nodiscard]] bool begin() override;
+
+    [[nodiscard]] bool createEmptyFile(const char* path) override;
+
+    [[nodiscard]] bool appendBytesToFile(const char* path, const uint8_t* data, size_t length) override;
+
+    [[nodiscard]] bool appendBytesToFileV(const char* path, const IoVec* parts, size_t count) override;
+
+    [[nodiscard]] bool overwriteBytesToFile(const char* path, const uint8_t* data, size_t length) override;
+
+    [[nodiscard]] size_t readFileBytes(const char* path, uint8_t* outBuffer, size_t maxLen) override;
+
+    [[nodiscard]] size_t readFileRegionBytes(const char* path, size_t offset, uint8_t* outBuffer,
+                                             size_t outBufferLen) override;
+
+    [[nodiscard]] ByteSpan mapFileRegion(const char* path, size_t offset, size_t length) override;
+
+    [[nodiscard]] bool writeFileBytes(const char* path, const uint8_t* data, size_t length) override;
+
+    [[nodiscard]] bool supportsPreallocation() const override { return inner_.supportsPreallocation(); }
+
+    [[nodiscard]] bool preallocateFile(const char* path, size_t capacity) override;
+
+    [[nodiscard]] bool writeFileRegionV(const char* path, size_t offset, const IoVec* parts, size_t count) override;
+
+    [[nodiscard]] bool truncateFileFromOffset(const char* path, size_t offset) override;
+
+    [[nodiscard]] bool clearFile(const char* path) override;
+
+    [[nodiscard]] bool deleteFile(const char* path) override;
+
+    [[nodiscard]] bool fileExists(const char* path) override;
+
+    [[nodiscard]] bool renameFile(const char* oldPath, const char* newPath) override;
+
+    [[nodiscard]] bool createDirectory(const char* str) override;
+
+    [[nodiscard]] size_t fileSize(const char* str) override;
+
+    [[nodiscard]] bool sync() override;
+
+    [[nodiscard]] bool syncFile(const char* path) override;
+
+private:
+    StorageManager& inner_;
+    OpStats stats_[OP_COUNT]{};
+
+    void record(Op op, unsigned long startUs, bool success, size_t bytes);
+};
+
+#endif //ACOUSEA_INFRASTRUCTURE_MKR_INSTRUMENTEDSTORAGEMANAGER_HPP
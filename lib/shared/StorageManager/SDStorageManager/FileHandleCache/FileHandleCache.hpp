@@ -0,0 +1,192 @@
+#ifndef ACOUSEA_INFRASTRUCTURE_MKR_FILEHANDLECACHE_HPP
+#define ACOUSEA_INFRASTRUCTURE_MKR_FILEHANDLECACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+
+/**
+ * @brief Caché LRU de N ficheros abiertos indexados por ruta.
+ *
+ * Abrir un fichero en la SD recorre el directorio y la FAT, por lo que las rutas que se usan en cada ciclo (segmentos
+ * e índices de la cola, cursores, log) se mantienen abiertas. Las escrituras quedan en el buffer del fichero hasta
+ * sync(), que es el punto explícito de persistencia (también al expulsar o liberar un handle).
+ *
+ * File debe ofrecer open(path, flags), close(), sync() e isOpen() (File32 / FsFile de SdFat o un fichero simulado).
+ * Las operaciones que cambian la entrada de directorio (borrar, renombrar) deben liberar antes el handle con release().
+ */
+template <typename File, size_t N>
+class FileHandleCache
+{
+public:
+    static constexpr size_t PATH_MAX_LEN = 32;
+
+    struct Stats
+    {
+        uint32_t hits = 0;
+        uint32_t misses = 0;
+        uint32_t evictions = 0;
+    };
+
+    /**
+     * Returns the open handle of the path, opening it with openFlags (evicting the least recently used handle) if it
+     * is not cached. willWrite marks the handle as pending of sync(). Returns nullptr if the file cannot be opened.
+     */
+    [[nodiscard]] File* acquire(const char* path, const int openFlags, const bool willWrite = false)
+    {
+        if (!path || strlen(path) >= PATH_MAX_LEN)
+        {
+            return nullptr;
+        }
+
+        Slot* slot = find(path);
+        if (slot)
+        {
+            stats_.hits++;
+        }
+        else
+        {
+            stats_.misses++;
+            slot = victim();
+            if (slot->file.isOpen())
+            {
+                stats_.evictions++;
+                slot->file.close();
+            }
+            if (!slot->file.open(path, openFlags))
+            {
+                slot->path[0] = '\0';
+                slot->dirty = false;
+                return nullptr;
+            }
+            strncpy(slot->path, path, PATH_MAX_LEN);
+            slot->dirty = false;
+        }
+
+        slot->lastUse = ++useCounter_;
+        slot->dirty = slot->dirty || willWrite;
+        return &slot->file;
+    }
+
+    [[nodiscard]] bool contains(const char* path) const
+    {
+        for (const Slot& slot : slots_)
+        {
+            if (slot.file.isOpen() && strcmp(slot.path, path) == 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Closes the handle of the path if it is cached (close() persists its pending writes).
+     */
+    bool release(const char* path)
+    {
+        Slot* slot = find(path);
+        if (!slot)
+        {
+            return true;
+        }
+        const bool closeOk = slot->file.close();
+        slot->path[0] = '\0';
+        slot->dirty = false;
+        return closeOk;
+    }
+
+    /**
+     * Sync point: persists the pending writes of every cached handle, keeping them open.
+     */
+    bool sync()
+    {
+        bool success = true;
+        for (Slot& slot : slots_)
+        {
+            if (slot.file.isOpen() && slot.dirty)
+            {
+                success = slot.file.sync() && success;
+                slot.dirty = false;
+            }
+        }
+        return success;
+    }
+
+    /**
+     * Persists the pending writes of the handle of the path, if it is cached (otherwise nothing is pending).
+     */
+    bool sync(const char* path)
+    {
+        Slot* slot = find(path);
+        if (!slot || !slot->dirty)
+        {
+            return true;
+        }
+        slot->dirty = false;
+        return slot->file.sync();
+    }
+
+    bool closeAll()
+    {
+        bool success = true;
+        for (Slot& slot : slots_)
+        {
+            if (slot.file.isOpen())
+            {
+                success = slot.file.close() && success;
+            }
+            slot.path[0] = '\0';
+            slot.dirty = false;
+        }
+        return success;
+    }
+
+    [[nodiscard]] const Stats& getStats() const { return stats_; }
+
+private:
+    struct Slot
+    {
+        File file{};
+        char path[PATH_MAX_LEN]{};
+        uint32_t lastUse = 0;
+        bool dirty = false;
+    };
+
+    Slot slots_[N]{};
+    uint32_t useCounter_ = 0;
+    Stats stats_{};
+
+    Slot* find(const char* path)
+    {
+        for (Slot& slot : slots_)
+        {
+            if (slot.file.isOpen() && strcmp(slot.path, path) == 0)
+            {
+                return &slot;
+            }
+        }
+        return nullptr;
+    }
+
+    // A closed slot if there is one, otherwise the least recently used
+    Slot* victim()
+    {
+        Slot* oldest = &slots_[0];
+        for (Slot& slot : slots_)
+        {
+            if (!slot.file.isOpen())
+            {
+                return &slot;
+            }
+            if (slot.lastUse < oldest->lastUse)
+            {
+                oldest = &slot;
+            }
+        }
+        return oldest;
+    }
+};
+
+#endif //ACOUSEA_INFRASTRUCTURE_MKR_FILEHANDLECACHE_HPP
@@ -0,0 +1,48 @@
+#ifndef ACOUSEA_INFRASTRUCTURE_MKR_SDLATENCYMODEL_HPP
+#define ACOUSEA_INFRASTRUCTURE_MKR_SDLATENCYMODEL_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+
+/**
+ * @brief Modelo de latencias de la SD (SAMD21 + SdFat a SD_SCK_MHZ(2)) para estimar en native el coste de una
+ *        secuencia de operaciones sin la tarjeta. Los valores son órdenes de magnitud, no medidas exactas.
+ */
+struct SDLatencyModel
+{
+    static constexpr size_t BLOCK_SIZE = 512;
+
+    uint32_t openUs = 6000; // Directory lookup + first FAT read
+    uint32_t closeUs = 3000; // Directory entry update (only when the file was written)
+    uint32_t syncUs = 3000; // Same as close, keeping the file open
+    uint32_t seekUs = 200; // Cluster chain walk within the cached FAT block
+    uint32_t clusterBytes = 4096; // FAT32 cluster of the card's format
+    uint32_t fatLinkUs = 500; // Following one link of a fragmented chain (often a FAT block read)
+    uint32_t blockTransferUs = 2200; // 512 bytes at 2 MHz SPI plus command overhead
+    uint32_t programBusyUs = 1500; // Card busy programming a written block
+    uint32_t stabilizationDelayUs = 100000; // Legacy fixed waitFor(STABILIZATION_DELAY_MS)
+
+    [[nodiscard]] static constexpr size_t blocksOf(const size_t bytes)
+    {
+        return (bytes + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    }
+
+    [[nodiscard]] uint64_t readUs(const size_t bytes) const
+    {
+        return static_cast<uint64_t>(blocksOf(bytes)) * blockTransferUs;
+    }
+
+    // Seeking to `offset` in a fragmented file walks the chain from its first cluster; a contiguous one does not
+    [[nodiscard]] uint64_t chainWalkUs(const size_t offset) const
+    {
+        return static_cast<uint64_t>(offset / clusterBytes) * fatLinkUs;
+    }
+
+    [[nodiscard]] uint64_t writeUs(const size_t bytes) const
+    {
+        return static_cast<uint64_t>(blocksOf(bytes)) * (blockTransferUs + programBusyUs);
+    }
+};
+
+#endif //ACOUSEA_INFRASTRUCTURE_MKR_SDLATENCYMODEL_HPP
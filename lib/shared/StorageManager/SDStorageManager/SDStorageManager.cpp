@@ -3,7 +3,8 @@
 #include "SDStorageManager.h"
 #include "ErrorHandler/ErrorHandler.h"
 #include "Logger/Logger.h"
-#include <wait/WaitFor.hpp>
+#include "time/getMillis.hpp"
+#include "FileHandleCache/FileHandleCache.hpp"
 
 #define SD_CONFIG SdSpiConfig(chipSelectPin, SHARED_SPI, SPI_SPEED)
 
@@ -27,7 +28,15 @@ typedef FsFile File_t;
 #endif
 
 // -----------------------------------------------------
-#define STABILIZATION_DELAY_MS 100
+namespace
+{
+    // Handles de los ficheros usados en cada ciclo (segmentos e índices de la cola, cursores, log)
+    FileHandleCache<File_t, SDStorageManager::HANDLE_CACHE_SIZE> handleCache;
+
+    // Cached handles are opened read/write so that the same handle serves reads and appends
+    constexpr int CACHED_OPEN_FLAGS = O_RDWR;
+    constexpr int CACHED_CREATE_FLAGS = O_RDWR | O_CREAT;
+}
 
 SDStorageManager::SDStorageManager(uint8_t chipSelectPin)
     : chipSelectPin(chipSelectPin)
@@ -46,22 +55,57 @@ bool SDStorageManager::begin()
         sd.initErrorPrint(&Serial);
         return false;
     }
-    waitFor(STABILIZATION_DELAY_MS); // Wait a bit for the SD card to settle
+    if (!waitUntilReady()) // Wait for the SD card to settle
+    {
+        return false;
+    }
     initialized = true;
     Serial.println("SDStorageManager::begin() -> SD initialized successfully.");
     return true;
 }
 
+bool SDStorageManager::waitUntilReady() const
+{
+    const unsigned long start = getMillis();
+    while (sd.card()->isBusy())
+    {
+        if (getMillis() - start >= READY_TIMEOUT_MS)
+        {
+            LOG_CLASS_ERROR("waitUntilReady() -> Card still busy after %lu ms", READY_TIMEOUT_MS);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SDStorageManager::sync()
+{
+    if (!handleCache.sync())
+    {
+        LOG_CLASS_ERROR("sync() -> Failed to sync cached files");
+        return false;
+    }
+    return waitUntilReady();
+}
+
+bool SDStorageManager::syncFile(const char* path)
+{
+    if (!handleCache.sync(path))
+    {
+        LOG_CLASS_ERROR("syncFile() -> Failed to sync %s", path);
+        return false;
+    }
+    return waitUntilReady();
+}
+
 bool SDStorageManager::createEmptyFile(const char* path)
 {
-    File_t file;
-    if (!file.open(path, O_WRONLY | O_CREAT | O_TRUNC))
+    File_t* file = handleCache.acquire(path, CACHED_CREATE_FLAGS, true);
+    if (!file || !file->truncate(0))
     {
         LOG_CLASS_ERROR("createEmptyFile() -> Cannot create file: %s", path);
         return false;
     }
-    waitFor(STABILIZATION_DELAY_MS);
-    file.close();
     return true;
 }
 
@@ -70,47 +114,72 @@ bool SDStorageManager::appendBytesToFile(const char* path, const uint8_t* data,
 {
     if (!data || length == 0) return false;
 
-    File_t file;
-    if (!file.open(path, O_WRONLY | O_CREAT | O_APPEND))
+    File_t* file = handleCache.acquire(path, CACHED_CREATE_FLAGS, true);
+    if (!file || !file->seekEnd())
     {
         LOG_CLASS_ERROR("appendBytesToFile() -> Cannot open file: %s", path);
         return false;
     }
-    waitFor(STABILIZATION_DELAY_MS);
-    const size_t written = file.write(data, length);
-    waitFor(STABILIZATION_DELAY_MS);
-    file.close();
-    return (written == length);
+    const size_t written = file->write(data, length);
+    if (written != length)
+    {
+        (void)handleCache.release(path); // Do not keep a handle in an unknown state
+        return false;
+    }
+    return true;
+}
+
+bool SDStorageManager::appendBytesToFileV(const char* path, const IoVec* parts, const size_t count)
+{
+    if (!parts || count == 0) return false;
+
+    File_t* file = handleCache.acquire(path, CACHED_CREATE_FLAGS, true);
+    if (!file || !file->seekEnd())
+    {
+        LOG_CLASS_ERROR("appendBytesToFileV() -> Cannot open file: %s", path);
+        return false;
+    }
+    // Consecutive writes on the same handle: SdFat gathers them in its block cache
+    for (size_t i = 0; i < count; i++)
+    {
+        if (parts[i].length == 0) continue;
+        if (!parts[i].data || file->write(parts[i].data, parts[i].length) != parts[i].length)
+        {
+            (void)handleCache.release(path); // Do not keep a handle in an unknown state
+            return false;
+        }
+    }
+    return true;
 }
 
 bool SDStorageManager::overwriteBytesToFile(const char* path, const uint8_t* data, size_t length)
 {
     if (!data) return false;
 
-    File_t file;
-    if (!file.open(path, O_WRONLY | O_CREAT | O_TRUNC))
+    File_t* file = handleCache.acquire(path, CACHED_CREATE_FLAGS, true);
+    if (!file || !file->truncate(0))
     {
         LOG_CLASS_ERROR("overwriteBytesToFile() -> Cannot open file: %s", path);
         return false;
     }
-    waitFor(STABILIZATION_DELAY_MS);
-    const size_t written = file.write(data, length);
-    waitFor(STABILIZATION_DELAY_MS);
-    file.close();
-    return (written == length);
+    const size_t written = file->write(data, length);
+    if (written != length)
+    {
+        (void)handleCache.release(path);
+        return false;
+    }
+    return true;
 }
 
 
 bool SDStorageManager::clearFile(const char* path)
 {
-    File_t file;
-    if (!file.open(path, O_WRONLY | O_TRUNC))
+    File_t* file = handleCache.acquire(path, CACHED_OPEN_FLAGS, true);
+    if (!file || !file->truncate(0))
     {
         LOG_CLASS_ERROR("clearFile() -> Cannot open file: %s", path);
         return false;
     }
-    waitFor(STABILIZATION_DELAY_MS);
-    file.close();
     return true;
 }
 
@@ -120,59 +189,109 @@ bool SDStorageManager::clearFile(const char* path)
 
 bool SDStorageManager::deleteFile(const char* path)
 {
+    (void)handleCache.release(path);
+
     if (!sd.exists(path))
     {
         LOG_CLASS_ERROR("deleteFile() -> File not found: %s", path);
         return false;
     }
 
-    waitFor(STABILIZATION_DELAY_MS);
-
     if (!sd.remove(path))
     {
         LOG_CLASS_ERROR("deleteFile() -> Failed to remove file: %s", path);
         return false;
     }
-    waitFor(STABILIZATION_DELAY_MS);
 
-    return true;
+    return waitUntilReady();
 }
 
 // -----------------------------------------------------
 
 bool SDStorageManager::writeFileBytes(const char* path, const uint8_t* data, size_t length)
 {
-    File_t file;
-    if (!file.open(path, O_WRONLY | O_CREAT | O_TRUNC))
+    File_t* file = handleCache.acquire(path, CACHED_CREATE_FLAGS, true);
+    if (!file || !file->truncate(0))
     {
         LOG_CLASS_ERROR("writeFileBytes() -> Cannot open file: %s", path);
         return false;
     }
-    waitFor(STABILIZATION_DELAY_MS);
 
-    size_t written = file.write(data, length);
-    waitFor(STABILIZATION_DELAY_MS);
-    file.close();
+    const size_t written = file->write(data, length);
+    if (written != length)
+    {
+        (void)handleCache.release(path);
+        return false;
+    }
+    return true;
+}
 
-    return (written == length);
+// -----------------------------------------------------
+// Preasignación contigua
+// -----------------------------------------------------
+
+bool SDStorageManager::preallocateFile(const char* path, size_t capacity)
+{
+    // preAllocate() exige un fichero sin clusters: se libera la cadena anterior
+    File_t* file = handleCache.acquire(path, CACHED_CREATE_FLAGS, true);
+    if (!file || !file->truncate(0))
+    {
+        LOG_CLASS_ERROR("preallocateFile() -> Cannot create file: %s", path);
+        return false;
+    }
+    if (!file->preAllocate(capacity))
+    {
+        LOG_CLASS_WARNING("preallocateFile() -> No contiguous run of %lu bytes for %s",
+                          static_cast<unsigned long>(capacity), path);
+        return false;
+    }
+
+    // Los clusters conservan datos antiguos: se borran para que el tramo no escrito nunca parezca un frame
+    uint32_t firstSector = 0;
+    uint32_t lastSector = 0;
+    if (!file->contiguousRange(&firstSector, &lastSector) || !sd.card()->erase(firstSector, lastSector))
+    {
+        LOG_CLASS_ERROR("preallocateFile() -> Cannot erase the extent of %s", path);
+        (void)file->truncate(0);
+        return false;
+    }
+    return waitUntilReady();
+}
+
+bool SDStorageManager::writeFileRegionV(const char* path, const size_t offset, const IoVec* parts, const size_t count)
+{
+    if (!parts || count == 0) return false;
+
+    File_t* file = handleCache.acquire(path, CACHED_OPEN_FLAGS, true);
+    if (!file || !file->seekSet(offset)) // Contiguous file: the cluster is computed, no FAT walk
+    {
+        LOG_CLASS_ERROR("writeFileRegionV() -> Cannot open file: %s", path);
+        return false;
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+        if (parts[i].length == 0) continue;
+        if (!parts[i].data || file->write(parts[i].data, parts[i].length) != parts[i].length)
+        {
+            (void)handleCache.release(path); // Do not keep a handle in an unknown state
+            return false;
+        }
+    }
+    return true;
 }
 
 // -----------------------------------------------------
 
 size_t SDStorageManager::readFileBytes(const char* path, uint8_t* outBuffer, size_t maxLen)
 {
-    File_t file;
-    if (!file.open(path, O_RDONLY))
+    File_t* file = handleCache.acquire(path, CACHED_OPEN_FLAGS);
+    if (!file || !file->seekSet(0))
     {
         LOG_CLASS_ERROR("readFileBytes() -> Cannot open file: %s", path);
         return 0;
     }
-    waitFor(STABILIZATION_DELAY_MS);
-    const size_t readTotal = file.read(outBuffer, maxLen);
-    waitFor(STABILIZATION_DELAY_MS);
-
-    file.close();
-    return readTotal;
+    const int readTotal = file->read(outBuffer, maxLen);
+    return readTotal > 0 ? static_cast<size_t>(readTotal) : 0;
 }
 
 // -----------------------------------------------------
@@ -181,23 +300,20 @@ size_t SDStorageManager::readFileBytes(const char* path, uint8_t* outBuffer, siz
 
 size_t SDStorageManager::readFileRegionBytes(const char* path, size_t offset, uint8_t* outBuffer, size_t len)
 {
-    File_t file;
-    if (!file.open(path, O_RDONLY))
+    File_t* file = handleCache.acquire(path, CACHED_OPEN_FLAGS);
+    if (!file)
     {
         LOG_CLASS_ERROR("readFileRegion() -> Cannot open file: %s", path);
         return 0;
     }
-    waitFor(STABILIZATION_DELAY_MS);
 
-    file.seekSet(offset);
-    waitFor(STABILIZATION_DELAY_MS);
-
-    const size_t readBytes = file.read(outBuffer, len);
-    waitFor(STABILIZATION_DELAY_MS);
-
-    file.close();
+    if (!file->seekSet(offset))
+    {
+        return 0; // Offset past the end of the file
+    }
 
-    return readBytes;
+    const int readBytes = file->read(outBuffer, len);
+    return readBytes > 0 ? static_cast<size_t>(readBytes) : 0;
 }
 
 // -----------------------------------------------------
@@ -206,24 +322,20 @@ size_t SDStorageManager::readFileRegionBytes(const char* path, size_t offset, ui
 
 bool SDStorageManager::truncateFileFromOffset(const char* path, size_t offset)
 {
-    File_t file;
-    if (!file.open(path, O_RDWR))
+    File_t* file = handleCache.acquire(path, CACHED_OPEN_FLAGS, true);
+    if (!file)
     {
         LOG_CLASS_ERROR("truncateFileFromOffset() -> Cannot open file: %s", path);
         return false;
     }
-    waitFor(STABILIZATION_DELAY_MS);
 
-    const size_t total = file.fileSize();
+    const size_t total = file->fileSize();
     if (offset >= total)
     {
         // Si offset >= tamaño, simplemente vaciamos
-        file.truncate(0);
-        file.close();
-        return true;
+        return file->truncate(0);
     }
 
-    const size_t remaining = total - offset;
     constexpr size_t CHUNK_SIZE = 512;
     uint8_t buffer[CHUNK_SIZE];
     size_t readPos = offset;
@@ -231,39 +343,38 @@ bool SDStorageManager::truncateFileFromOffset(const char* path, size_t offset)
 
     while (readPos < total)
     {
-        file.seekSet(readPos);
-        size_t n = file.read(buffer, CHUNK_SIZE);
-        if (!n)
+        file->seekSet(readPos);
+        const int n = file->read(buffer, CHUNK_SIZE);
+        if (n <= 0)
             break;
 
-        file.seekSet(writePos);
-        file.write(buffer, n);
+        file->seekSet(writePos);
+        file->write(buffer, static_cast<size_t>(n));
 
-        readPos += n;
-        writePos += n;
+        readPos += static_cast<size_t>(n);
+        writePos += static_cast<size_t>(n);
     }
 
-    file.truncate(writePos);
-    file.close();
-    return true;
+    return file->truncate(writePos);
 }
 
 bool SDStorageManager::fileExists(const char* path)
 {
-    // Helper para comprobar existencia
-    const bool exists =  sd.exists(path);
-    waitFor(STABILIZATION_DELAY_MS);
-    return exists;
+    // An open handle already proves it exists (no directory lookup)
+    return handleCache.contains(path) || sd.exists(path);
 }
 
 bool SDStorageManager::renameFile(const char* oldPath, const char* newPath)
 {
+    // The directory entries change: neither path may stay open
+    (void)handleCache.release(oldPath);
+    (void)handleCache.release(newPath);
+
     File_t file;
     if (!file.open(oldPath, O_RDWR)) {
         LOG_CLASS_ERROR("renameFile() -> Cannot open: %s", oldPath);
         return false;
     }
-    waitFor(STABILIZATION_DELAY_MS);
 
     const char* baseName = strrchr(newPath, '/');
     baseName = baseName ? baseName + 1 : newPath;
@@ -274,28 +385,21 @@ bool SDStorageManager::renameFile(const char* oldPath, const char* newPath)
         file.close();
         return false;
     }
-    waitFor(STABILIZATION_DELAY_MS);
 
     file.close();
-    return true;
+    return waitUntilReady();
 }
 
 
 size_t SDStorageManager::fileSize(const char* str)
 {
-    File_t file;
-    if (!file.open(str, O_RDONLY))
+    const File_t* file = handleCache.acquire(str, CACHED_OPEN_FLAGS);
+    if (!file)
     {
         LOG_CLASS_ERROR("fileSize() -> Cannot open file: %s", str);
         return 0;
     }
-    waitFor(STABILIZATION_DELAY_MS);
-
-    const size_t size = file.fileSize();
-    waitFor(STABILIZATION_DELAY_MS);
-
-    file.close();
-    return size;
+    return file->fileSize();
 }
 
 bool SDStorageManager::createDirectory(const char* str)
@@ -311,17 +415,13 @@ bool SDStorageManager::createDirectory(const char* str)
         LOG_CLASS_ERROR("createDirectory() -> Cannot create directory: %s", str);
         return false;
     }
-    waitFor(STABILIZATION_DELAY_MS);
 
-    return true;
+    return waitUntilReady();
 }
 
 bool SDStorageManager::existsDirectory(const char* path)
 {
-    const bool exists =  sd.exists(path);
-    waitFor(STABILIZATION_DELAY_MS);
-    return exists;
-
+    return sd.exists(path);
 }
 
 bool SDStorageManager::clearDirectory(const char* path)
@@ -332,7 +432,9 @@ bool SDStorageManager::clearDirectory(const char* path)
         LOG_CLASS_ERROR("clearDirectory() -> Directory does not exist: %s", path);
         return false;
     }
-    waitFor(STABILIZATION_DELAY_MS);
+
+    // Files inside may be cached: close them before removing the entries
+    (void)handleCache.closeAll();
 
     // Abrir el directorio
     File_t dir;
@@ -341,7 +443,6 @@ bool SDStorageManager::clearDirectory(const char* path)
         LOG_CLASS_ERROR("clearDirectory() -> Cannot open directory: %s", path);
         return false;
     }
-    waitFor(STABILIZATION_DELAY_MS);
 
     File_t entry;
     char name[64];
@@ -400,16 +501,13 @@ bool SDStorageManager::deleteDirectory(const char* path)
         return false;
     }
 
-    waitFor(STABILIZATION_DELAY_MS);
-
     if (!sd.rmdir(path))
     {
         LOG_CLASS_ERROR("deleteDirectory() -> Cannot remove directory: %s", path);
         return false;
     }
-    waitFor(STABILIZATION_DELAY_MS);
 
-    return true;
+    return waitUntilReady();
 }
 
 
@@ -10,6 +10,12 @@
 #define SDCARD_SS_PIN 4
 #define SPI_SPEED SD_SCK_MHZ(2)  // Ajusta según tu placa
 
+/**
+ * Los ficheros usados en cada ciclo se mantienen abiertos en una caché de HANDLE_CACHE_SIZE handles
+ * (FileHandleCache); las escrituras se persisten en sync() (o syncFile() para un solo fichero), al expulsar un handle
+ * o antes de borrar/renombrar.
+ * En lugar de esperas fijas, tras las escrituras se sondea el estado "busy" de la tarjeta con un timeout.
+ */
 class SDStorageManager final : public StorageManager
 {
     CLASS_NAME(SDStorageManager)
@@ -25,12 +31,21 @@ public:
 
     [[nodiscard]] bool appendBytesToFile(const char* path, const uint8_t* data, size_t length) override;
 
+    [[nodiscard]] bool appendBytesToFileV(const char* path, const IoVec* parts, size_t count) override;
+
     [[nodiscard]] bool overwriteBytesToFile(const char* path, const uint8_t* data, size_t length) override;
 
     [[nodiscard]] bool clearFile(const char* path) override;
 
     [[nodiscard]] bool writeFileBytes(const char* path, const uint8_t* data, size_t length) override;
 
+    [[nodiscard]] bool supportsPreallocation() const override { return true; }
+
+    // Extent contiguo (preAllocate) y borrado de sus sectores: lo no escrito se lee como 0x00 o 0xFF según la tarjeta
+    [[nodiscard]] bool preallocateFile(const char* path, size_t capacity) override;
+
+    [[nodiscard]] bool writeFileRegionV(const char* path, size_t offset, const IoVec* parts, size_t count) override;
+
     [[nodiscard]] size_t readFileBytes(const char* path, uint8_t* outBuffer, size_t maxLen) override;
 
     [[nodiscard]] size_t readFileRegionBytes(const char* path, size_t offset, uint8_t* outBuffer, size_t len) override;
@@ -47,15 +62,25 @@ public:
 
     [[nodiscard]] bool createDirectory(const char* str) override;
 
+    [[nodiscard]] bool sync() override;
+
+    [[nodiscard]] bool syncFile(const char* path) override;
+
     [[nodiscard]] bool existsDirectory(const char* path);
 
     [[nodiscard]] bool clearDirectory(const char *path);
 
     [[nodiscard]] bool deleteDirectory(const char* path);
 
+    static constexpr size_t HANDLE_CACHE_SIZE = 4;
+    static constexpr unsigned long READY_TIMEOUT_MS = 250;
+
 private:
     uint8_t chipSelectPin;
     bool initialized = false;
+
+    // Busy-polls the card until it finishes programming (or READY_TIMEOUT_MS elapses)
+    [[nodiscard]] bool waitUntilReady() const;
 };
 
 #endif  // PLATFORM_ARDUINO
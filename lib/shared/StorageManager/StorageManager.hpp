@@ -4,6 +4,22 @@
 #include <cstddef>   // for size_t
 #include <cstdint>   // for uint8_t
 
+// Fragmento de un append scatter/gather (ver StorageManager::appendBytesToFileV)
+struct IoVec
+{
+    const uint8_t* data;
+    size_t length;
+};
+
+// Vista de solo lectura de una región de un fichero (ver StorageManager::mapFileRegion)
+struct ByteSpan
+{
+    const uint8_t* data = nullptr;
+    size_t length = 0;
+
+    [[nodiscard]] bool empty() const { return data == nullptr || length == 0; }
+};
+
 class StorageManager
 {
 public:
@@ -16,6 +32,10 @@ public:
     // Escribe al final / sobrescribe
     [[nodiscard]] virtual bool appendBytesToFile(const char* path, const uint8_t* data, size_t length) = 0;
 
+    // Añade los fragmentos en orden con una sola apertura del fichero (p. ej. cabecera + payload + footer de un frame
+    // sin copiarlos antes a un buffer contiguo). Los fragmentos vacíos se ignoran.
+    [[nodiscard]] virtual bool appendBytesToFileV(const char* path, const IoVec* parts, size_t count) = 0;
+
     [[nodiscard]] virtual bool overwriteBytesToFile(const char* path, const uint8_t* data, size_t length) = 0;
 
     [[nodiscard]] virtual size_t readFileBytes(const char* path, uint8_t* outBuffer, size_t maxLen) = 0;
@@ -23,8 +43,32 @@ public:
     [[nodiscard]] virtual size_t readFileRegionBytes(const char* path, size_t offset, uint8_t* outBuffer, size_t outBufferLen) =
     0;
 
+    // Lectura sin copia: vista de solo lectura de hasta `length` bytes desde `offset` (recortada al final del
+    // fichero). Válida solo hasta la siguiente llamada a este StorageManager, sobre cualquier fichero: abrir otro
+    // puede expulsar el mapeo de una caché de descriptores. Vacía si el backend no la ofrece (SD) o la región no
+    // existe: el llamador usa entonces readFileRegionBytes().
+    [[nodiscard]] virtual ByteSpan mapFileRegion(const char* /*path*/, size_t /*offset*/, size_t /*length*/)
+    {
+        return {};
+    }
+
     [[nodiscard]] virtual bool writeFileBytes(const char* path, const uint8_t* data, size_t length) = 0;
 
+    // Preasignación contigua: los ficheros que crecen a base de appends pequeños fragmentan los clusters FAT y cada
+    // append recorre la cadena. preallocateFile() recrea el fichero con `capacity` bytes contiguos (fileSize() pasa
+    // a ser la capacidad; lo no escrito se lee como 0x00 o 0xFF) y writeFileRegionV() escribe en una posición dentro
+    // de ese extent. El final lógico lo lleva el llamador. Sin soporte (supportsPreallocation() == false) ambas
+    // devuelven false y se sigue con createEmptyFile() + appends.
+    [[nodiscard]] virtual bool supportsPreallocation() const { return false; }
+
+    [[nodiscard]] virtual bool preallocateFile(const char* /*path*/, size_t /*capacity*/) { return false; }
+
+    [[nodiscard]] virtual bool writeFileRegionV(const char* /*path*/, size_t /*offset*/, const IoVec* /*parts*/,
+                                                size_t /*count*/)
+    {
+        return false;
+    }
+
     [[nodiscard]] virtual bool truncateFileFromOffset(const char* path, size_t offset) = 0;
 
     [[nodiscard]] virtual bool clearFile(const char* path) = 0;
@@ -38,6 +82,18 @@ public:
     [[nodiscard]] virtual bool createDirectory(const char* str) = 0;
 
     [[nodiscard]] virtual size_t fileSize(const char* str) = 0;
+
+    // Punto de sincronización: persiste las escrituras pendientes en ficheros que el backend mantiene abiertos.
+    // Los backends sin caché de handles no tienen nada pendiente.
+    [[nodiscard]] virtual bool sync() { return true; }
+
+    // Sincronización de un único fichero (p. ej. un cursor que debe ser durable al volver la escritura).
+    // Por defecto recurre a sync(), que cubre también ese fichero.
+    [[nodiscard]] virtual bool syncFile(const char* path)
+    {
+        (void)path;
+        return sync();
+    }
 };
 
 
@@ -0,0 +1,100 @@
+#include "TimeService.hpp"
+
+#include <ctime>
+
+#include "getMillis.hpp"
+
+
+namespace
+{
+    constexpr uint32_t SECONDS_PER_DAY = 86400;
+
+    void write2(char* out, const unsigned value)
+    {
+        out[0] = static_cast<char>('0' + value / 10);
+        out[1] = static_cast<char>('0' + value % 10);
+    }
+}
+
+void TimeService::attach(RTCController* rtc)
+{
+    rtc_ = rtc;
+    resync();
+}
+
+void TimeService::resync()
+{
+    anchorMillis_ = monotonicMillis();
+    anchorEpoch_ = rtc_ ? rtc_->getEpoch() : static_cast<uint32_t>(time(nullptr));
+}
+
+uint64_t TimeService::monotonicMillis()
+{
+    // getMillis() puede ser de 32 bits (MCU) o de 64 (host): se extienden sus 32 bits bajos en ambos casos
+    const auto now = static_cast<uint32_t>(getMillis());
+    if (now < lastMillis_) millisWraps_++;
+    lastMillis_ = now;
+    return (static_cast<uint64_t>(millisWraps_) << 32) | now;
+}
+
+uint32_t TimeService::epoch()
+{
+    const uint64_t now = monotonicMillis();
+    if (now - anchorMillis_ >= RESYNC_INTERVAL_MS)
+    {
+        resync();
+        return anchorEpoch_;
+    }
+    return anchorEpoch_ + static_cast<uint32_t>((now - anchorMillis_) / 1000);
+}
+
+const char* TimeService::timestamp()
+{
+    const uint32_t now = epoch();
+    if (textValid_ && now == textEpoch_) return text_;
+
+    const uint32_t day = now / SECONDS_PER_DAY;
+    const uint32_t secondOfDay = now % SECONDS_PER_DAY;
+    const auto hour = static_cast<uint8_t>(secondOfDay / 3600);
+    const auto minute = static_cast<uint8_t>(secondOfDay / 60 % 60);
+    const auto second = static_cast<uint8_t>(secondOfDay % 60);
+
+    // "YYYY-MM-DD HH:MM:SS": posiciones 0, 11, 14 y 17
+    const bool full = !textValid_ || day != textDay_;
+    if (full) writeDate(day);
+    if (full || hour != textHour_) write2(text_ + 11, hour);
+    if (full || minute != textMinute_) write2(text_ + 14, minute);
+    if (full || second != textSecond_) write2(text_ + 17, second);
+
+    textValid_ = true;
+    textEpoch_ = now;
+    textDay_ = day;
+    textHour_ = hour;
+    textMinute_ = minute;
+    textSecond_ = second;
+    return text_;
+}
+
+void TimeService::writeDate(const uint32_t daysSinceEpoch)
+{
+    // Días desde 1970-01-01 a fecha civil (algoritmo civil_from_days de H. Hinnant), sin gmtime() ni snprintf()
+    const uint32_t z = daysSinceEpoch + 719468;
+    const uint32_t era = z / 146097;
+    const uint32_t dayOfEra = z - era * 146097;
+    const uint32_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    const uint32_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    const uint32_t shiftedMonth = (5 * dayOfYear + 2) / 153; // Marzo = 0
+    const uint32_t day = dayOfYear - (153 * shiftedMonth + 2) / 5 + 1;
+    const uint32_t month = shiftedMonth < 10 ? shiftedMonth + 3 : shiftedMonth - 9;
+    const uint32_t year = yearOfEra + era * 400 + (month <= 2 ? 1 : 0);
+
+    write2(text_, year / 100 % 100);
+    write2(text_ + 2, year % 100);
+    text_[4] = '-';
+    write2(text_ + 5, month);
+    text_[7] = '-';
+    write2(text_ + 8, day);
+    text_[10] = ' ';
+    text_[13] = ':';
+    text_[16] = ':';
+}
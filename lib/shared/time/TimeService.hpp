@@ -0,0 +1,60 @@
+#ifndef ACOUSEA_TIME_SERVICE_HPP
+#define ACOUSEA_TIME_SERVICE_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#include "RTCController.hpp"
+
+
+/**
+ * @brief Reloj común del logging y de la planificación.
+ *
+ * - monotonicMillis(): milisegundos desde el arranque en 64 bits. Extiende getMillis(), que en el MCU da la vuelta
+ *   cada ~49 días; basta con llamarlo al menos una vez por vuelta (el TaskScheduler lo hace en cada run()).
+ * - epoch(): epoch del RTC anclado a ese reloj. El RTC solo se lee al anclar (attach/resync y cada
+ *   RESYNC_INTERVAL_MS), no en cada línea de log.
+ * - timestamp(): "YYYY-MM-DD HH:MM:SS" (UTC) cacheado; al cambiar el segundo solo se reescriben los campos que
+ *   cambian, y la fecha solo al cambiar de día.
+ */
+class TimeService
+{
+public:
+    static constexpr uint32_t RESYNC_INTERVAL_MS = 60000;
+    static constexpr size_t TIMESTAMP_LENGTH = 19;
+
+    // Ancla el reloj al RTC (sin RTC, al reloj del sistema: solo tiene sentido en nativo)
+    static void attach(RTCController* rtc);
+
+    // Vuelve a leer el RTC: llamar después de ajustarlo (syncTime/setEpoch) para no esperar a la resincronización
+    static void resync();
+
+    [[nodiscard]] static uint64_t monotonicMillis();
+
+    [[nodiscard]] static uint32_t epoch();
+
+    // Cadena terminada en '\0' de TIMESTAMP_LENGTH caracteres; válida hasta la siguiente llamada
+    [[nodiscard]] static const char* timestamp();
+
+private:
+    static inline RTCController* rtc_ = nullptr;
+
+    // Extensión a 64 bits de getMillis()
+    static inline uint32_t lastMillis_ = 0;
+    static inline uint32_t millisWraps_ = 0;
+
+    static inline uint32_t anchorEpoch_ = 0;
+    static inline uint64_t anchorMillis_ = 0;
+
+    static inline char text_[TIMESTAMP_LENGTH + 1] = "0000-00-00 00:00:00";
+    static inline bool textValid_ = false;
+    static inline uint32_t textEpoch_ = 0;
+    static inline uint32_t textDay_ = 0;
+    static inline uint8_t textHour_ = 0;
+    static inline uint8_t textMinute_ = 0;
+    static inline uint8_t textSecond_ = 0;
+
+    static void writeDate(uint32_t daysSinceEpoch);
+};
+
+#endif // ACOUSEA_TIME_SERVICE_HPP
@@ -6,14 +6,40 @@ unsigned long getMillis() {
     return millis();
 }
 
+unsigned long getMicros() {
+    return micros();
+}
+
 #else
 
+namespace {
+#ifdef UNIT_TESTING
+    unsigned long long advancedUs = 0;
+#endif
+
+    unsigned long long elapsedUs() {
+        using namespace std::chrono;
+        static const steady_clock::time_point t0 = steady_clock::now();
+        auto us = static_cast<unsigned long long>(duration_cast<microseconds>(steady_clock::now() - t0).count());
+#ifdef UNIT_TESTING
+        us += advancedUs;
+#endif
+        return us;
+    }
+}
+
 unsigned long getMillis() {
-    using namespace std::chrono;
-    static const steady_clock::time_point t0 = steady_clock::now();
-    return static_cast<unsigned long>(
-        duration_cast<milliseconds>(steady_clock::now() - t0).count()
-    );
+    return static_cast<unsigned long>(elapsedUs() / 1000);
+}
+
+unsigned long getMicros() {
+    return static_cast<unsigned long>(elapsedUs());
 }
 
+#ifdef UNIT_TESTING
+void advanceClockMicros(const unsigned long us) {
+    advancedUs += us;
+}
+#endif
+
 #endif
@@ -9,4 +9,12 @@
 
 unsigned long getMillis();
 
+// Microsecond clock for latency measurements (wraps after ~71 min on Arduino: use differences only)
+unsigned long getMicros();
+
+#if defined(PLATFORM_NATIVE) && defined(UNIT_TESTING)
+// Adelanta getMillis()/getMicros() sin esperar: reloj virtual de los backends simulados en tests nativos
+void advanceClockMicros(unsigned long us);
+#endif
+
 #endif // GETMILLIS_HPP
@@ -0,0 +1,297 @@
+"""
+Herramienta de host para el log binario del Logger (Logger::Format::Binary).
+
+  python scripts/binary_log.py extract -o logfmt.json [--target arm|host]
+      Extrae la tabla de formatos del código: literales de las macros LOG_* y prefijos de CLASS_NAME(...),
+      indexados por el mismo FNV-1a de 32 bits que Logger::formatId() calcula en compilación.
+
+  python scripts/binary_log.py decode LOG000.BIN [LOG001.BIN ...] [--table logfmt.json] [--target arm|host]
+      Decodifica ficheros (o segmentos rotados, en orden) a las mismas líneas que escribe el formato de texto.
+      Sin --table, la tabla se extrae al vuelo del código del repositorio.
+
+El formato de los registros está documentado en Logger::BinaryRecordHeader (lib/shared/Logger/Logger.h).
+"""
+import argparse
+import datetime
+import json
+import re
+import struct
+import sys
+from pathlib import Path
+
+PROJECT_DIR = Path(__file__).resolve().parent.parent
+SOURCE_DIRS = ("src", "lib", "include")
+SOURCE_SUFFIXES = (".cpp", ".h", ".hpp")
+
+SYNC = 0xA5
+HEADER = struct.Struct("<BBHIII")
+LEVEL_MASK = 0x07
+TRUNCATED = 0x80
+LEVEL_NAMES = {0: "DEBUG", 1: "INFO", 2: "WARNING", 3: "ERROR"}
+
+# Macros de <cinttypes> que pueden aparecer entre los literales del formato (dependen de la toolchain)
+PRI_MACROS = {
+    # arm-none-eabi (newlib): int32_t es long
+    "arm": {"32": "l", "64": "ll", "8": "hh", "16": "h", "PTR": ""},
+    # glibc/MinGW: int32_t es int
+    "host": {"32": "", "64": "l", "8": "hh", "16": "h", "PTR": "l"},
+}
+
+LOG_CALL = re.compile(r"\bLOG_(?:CLASS_)?(?:DEBUG|INFO|WARNING|ERROR)\s*\(")
+CLASS_NAME = re.compile(r"\bCLASS_NAME\s*\(\s*(\w+)\s*\)")
+STRING_LITERAL = re.compile(r'"((?:[^"\\]|\\.)*)"')
+PRI_MACRO = re.compile(r"PRI([diouxX])(8|16|32|64|PTR)")
+CONVERSION = re.compile(r"%(?P<flags>[-+ #0]*)(?P<width>\*|\d+)?(?:\.(?P<precision>\*|\d*))?"
+                        r"(?P<length>hh|h|ll|l|j|z|t|L)?(?P<conversion>[diouxXeEfFgGaAcspn%])")
+
+ESCAPES = {"n": "\n", "t": "\t", "r": "\r", "0": "\0", "\\": "\\", '"': '"', "'": "'", "a": "\a", "b": "\b",
+           "f": "\f", "v": "\v", "?": "?"}
+
+
+def format_id(text):
+    """FNV-1a de 32 bits, igual que Logger::formatId(): 0 para la cadena vacía y nunca 0 en otro caso."""
+    if not text:
+        return 0
+    value = 2166136261
+    for byte in text.encode("utf-8"):
+        value = ((value ^ byte) * 16777619) & 0xFFFFFFFF
+    return value or 1
+
+
+def unescape(literal):
+    out = []
+    i = 0
+    while i < len(literal):
+        char = literal[i]
+        if char == "\\" and i + 1 < len(literal):
+            nxt = literal[i + 1]
+            if nxt == "x":
+                digits = re.match(r"[0-9a-fA-F]+", literal[i + 2:]).group(0)
+                out.append(chr(int(digits, 16)))
+                i += 2 + len(digits)
+                continue
+            out.append(ESCAPES.get(nxt, nxt))
+            i += 2
+            continue
+        out.append(char)
+        i += 1
+    return "".join(out)
+
+
+def format_argument(source, start, target):
+    """Lee el primer argumento de la macro: literales adyacentes y macros PRI. None si no es un literal."""
+    pri = PRI_MACROS[target]
+    parts = []
+    pos = start
+    while True:
+        while pos < len(source) and source[pos].isspace():
+            pos += 1
+        literal = STRING_LITERAL.match(source, pos)
+        if literal:
+            parts.append(unescape(literal.group(1)))
+            pos = literal.end()
+            continue
+        macro = PRI_MACRO.match(source, pos)
+        if macro:
+            parts.append(pri[macro.group(2)] + macro.group(1))
+            pos = macro.end()
+            continue
+        break
+    if not parts or pos >= len(source) or source[pos] not in ",)":
+        return None
+    return "".join(parts)
+
+
+def extract_table(project_dir=PROJECT_DIR, target="arm"):
+    formats = {}
+    classes = {format_id("[UNKNOWN CLASS]: "): "[UNKNOWN CLASS]: "}
+    collisions = []
+
+    def add(table, text):
+        key = format_id(text)
+        if key in table and table[key] != text:
+            collisions.append((table[key], text))
+        table[key] = text
+
+    for directory in SOURCE_DIRS:
+        for path in sorted((Path(project_dir) / directory).rglob("*")):
+            if path.suffix not in SOURCE_SUFFIXES or not path.is_file():
+                continue
+            source = path.read_text(encoding="utf-8", errors="ignore")
+            for match in CLASS_NAME.finditer(source):
+                add(classes, f"[{match.group(1)}]: ")
+            for match in LOG_CALL.finditer(source):
+                text = format_argument(source, match.end(), target)
+                if text is not None:
+                    add(formats, text)
+
+    for first, second in collisions:
+        print(f"[binary_log] WARNING: id collision between {first!r} and {second!r}", file=sys.stderr)
+    return {"target": target, "formats": formats, "classes": classes}
+
+
+def save_table(table, path):
+    serializable = {
+        "target": table["target"],
+        "formats": {f"{key:08x}": text for key, text in sorted(table["formats"].items())},
+        "classes": {f"{key:08x}": text for key, text in sorted(table["classes"].items())},
+    }
+    Path(path).write_text(json.dumps(serializable, indent=1, ensure_ascii=False), encoding="utf-8")
+
+
+def load_table(path):
+    data = json.loads(Path(path).read_text(encoding="utf-8"))
+    return {
+        "target": data.get("target", "arm"),
+        "formats": {int(key, 16): text for key, text in data["formats"].items()},
+        "classes": {int(key, 16): text for key, text in data["classes"].items()},
+    }
+
+
+class Payload:
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def varint(self):
+        value = 0
+        shift = 0
+        while True:
+            if self.pos >= len(self.data):
+                raise EOFError
+            byte = self.data[self.pos]
+            self.pos += 1
+            value |= (byte & 0x7F) << shift
+            shift += 7
+            if not byte & 0x80:
+                return value
+
+    def signed(self):
+        value = self.varint()
+        return (value >> 1) ^ -(value & 1)
+
+    def double(self):
+        if self.pos + 8 > len(self.data):
+            raise EOFError
+        value = struct.unpack_from("<d", self.data, self.pos)[0]
+        self.pos += 8
+        return value
+
+    def string(self):
+        length = self.varint()
+        text = self.data[self.pos:self.pos + length]
+        self.pos += length
+        return text.decode("utf-8", errors="replace")
+
+
+def render(fmt, payload):
+    """Reconstruye el mensaje: cada conversión de printf se rellena con su argumento en crudo."""
+    reader = Payload(payload)
+    out = []
+    last = 0
+    for spec in CONVERSION.finditer(fmt):
+        out.append(fmt[last:spec.start()])
+        last = spec.end()
+        conversion = spec.group("conversion")
+        if conversion == "%":
+            out.append("%")
+            continue
+        if conversion == "n":
+            continue
+        try:
+            values = []
+            width, precision = spec.group("width"), spec.group("precision")
+            if width == "*":
+                values.append(reader.signed())
+            if precision == "*":
+                values.append(reader.signed())
+            if conversion in "di":
+                values.append(reader.signed())
+            elif conversion in "ouxX":
+                values.append(reader.varint())
+            elif conversion == "c":
+                values.append(chr(reader.signed() & 0xFF))
+            elif conversion in "eEfFgGaA":
+                values.append(reader.double())
+            elif conversion == "s":
+                values.append(reader.string())
+            elif conversion == "p":
+                values.append(reader.varint())
+        except EOFError:
+            out.append("<?>")
+            continue
+
+        # Python entiende las mismas conversiones salvo las longitudes de C, %p, %a y %F
+        python_conversion = {"p": "x", "a": "e", "A": "E", "F": "f"}.get(conversion, conversion)
+        python_spec = "%" + spec.group("flags") + (width or "")
+        if precision is not None:
+            python_spec += "." + precision
+        python_spec += python_conversion
+        if conversion == "p":
+            out.append("0x")
+        try:
+            out.append(python_spec % tuple(values))
+        except (TypeError, ValueError):
+            out.append(" ".join(str(value) for value in values))
+    out.append(fmt[last:])
+    return "".join(out)
+
+
+def decode_records(data, table):
+    """Genera las líneas de texto de un fichero binario; resincroniza con SYNC si encuentra basura."""
+    pos = 0
+    while pos + HEADER.size <= len(data):
+        if data[pos] != SYNC:
+            pos += 1
+            continue
+        _, flags, length, epoch, fmt_id, class_id = HEADER.unpack_from(data, pos)
+        if pos + HEADER.size + length > len(data):
+            yield f"[BINARY LOG] incomplete record at offset {pos}"
+            return
+        payload = data[pos + HEADER.size:pos + HEADER.size + length]
+        pos += HEADER.size + length
+
+        timestamp = datetime.datetime.fromtimestamp(epoch, tz=datetime.timezone.utc).strftime("%Y-%m-%d %H:%M:%S")
+        level = LEVEL_NAMES.get(flags & LEVEL_MASK, "?")
+        if fmt_id == 0:
+            message = payload.decode("utf-8", errors="replace")
+        elif fmt_id in table["formats"]:
+            prefix = table["classes"].get(class_id, f"[class {class_id:08x}]: ") if class_id else ""
+            message = prefix + render(table["formats"][fmt_id], payload)
+        else:
+            message = f"<unknown format {fmt_id:08x}> {payload.hex()}"
+        if flags & TRUNCATED:
+            message += " [TRUNCATED]"
+        yield f"[{timestamp}] {level}: {message}"
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Tabla de formatos y decodificador del log binario")
+    commands = parser.add_subparsers(dest="command", required=True)
+
+    extract = commands.add_parser("extract", help="extrae la tabla de formatos del código")
+    extract.add_argument("-o", "--output", default="logfmt.json")
+    extract.add_argument("--target", choices=sorted(PRI_MACROS), default="arm")
+    extract.add_argument("--project", default=str(PROJECT_DIR))
+
+    decode = commands.add_parser("decode", help="decodifica un fichero de log binario")
+    decode.add_argument("logs", nargs="+", help="ficheros o segmentos (log000.bin...) en orden cronológico")
+    decode.add_argument("--table", help="tabla generada con 'extract' (por defecto se extrae del código)")
+    decode.add_argument("--target", choices=sorted(PRI_MACROS), default="arm")
+    decode.add_argument("--project", default=str(PROJECT_DIR))
+
+    args = parser.parse_args()
+    if args.command == "extract":
+        table = extract_table(args.project, args.target)
+        save_table(table, args.output)
+        print(f"{len(table['formats'])} formats, {len(table['classes'])} classes -> {args.output}")
+        return
+
+    table = load_table(args.table) if args.table else extract_table(args.project, args.target)
+    for log in args.logs:
+        for line in decode_records(Path(log).read_bytes(), table):
+            print(line)
+
+
+if __name__ == "__main__":
+    main()
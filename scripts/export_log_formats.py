@@ -0,0 +1,19 @@
+import sys
+from pathlib import Path
+
+Import("env")
+
+# Tabla de formatos del log binario junto al firmware (scripts/binary_log.py decode <LOG> --table logfmt.json)
+sys.path.insert(0, str(Path(env.subst("$PROJECT_DIR")) / "scripts"))
+import binary_log  # noqa: E402
+
+
+def export_log_formats(source, target, env):
+    output = Path(env.subst("$BUILD_DIR")) / "logfmt.json"
+    log_target = "host" if env.subst("$PIOPLATFORM") == "native" else "arm"
+    table = binary_log.extract_table(env.subst("$PROJECT_DIR"), log_target)
+    binary_log.save_table(table, output)
+    print(f"[LOGFMT] {len(table['formats'])} formatos de log -> {output}")
+
+
+env.AddPostAction("$PROGPATH", export_log_formats)
@@ -222,19 +222,42 @@ namespace Dependencies
 #endif
 
 #ifdef PLATFORM_NATIVE
+#ifdef _WIN32
         inline HDDStorageManager& hdd()
         {
             static HDDStorageManager instance;
             return instance;
         }
+#else
+        // Gateway (Rock Pi): cached descriptors + group commit (see FdStorageConfig)
+        inline FdStorageManager& hdd()
+        {
+            static FdStorageManager instance;
+            return instance;
+        }
+#endif
 #endif
 
-        inline StorageManager& storage()
+        // Every storage call goes through the decorator: counts and latency histograms (see logSummary())
+        inline InstrumentedStorageManager& instrumentedStorage()
         {
-            return PLATFORM_SELECT(
+            static InstrumentedStorageManager instance(PLATFORM_SELECT(
                 sd(), // ARDUINO
                 hdd() // NATIVE
-            );
+            ));
+            return instance;
+        }
+
+        inline StorageManager& storage()
+        {
+            return instrumentedStorage();
+        }
+
+        // Queue writes from the I/O paths (SerialPort::sync, MQTT handler) are drained by the scheduler idle task
+        inline DeferredStorageManager& deferredStorage()
+        {
+            static DeferredStorageManager instance(instrumentedStorage());
+            return instance;
         }
     } // namespace Hardware
     // ----------------------------------------------------------
@@ -242,12 +265,41 @@ namespace Dependencies
     // ----------------------------------------------------------
     namespace Comm
     {
+        inline const PacketQueueConfig& packetQueueConfig()
+        {
+            static const PacketQueueConfig config = []
+            {
+                PacketQueueConfig c;
+                // Commands received while the node was unreachable for days are no longer meaningful
+                constexpr uint32_t maxAgeSeconds = 3 * 24 * 3600;
+                for (uint8_t port = 1; port <= IPort::MAX_PORT_TYPE_U8; port++)
+                {
+                    c.ports[port].maxAgeSeconds = maxAgeSeconds;
+                    c.ports[port].maxBytes = 256 * 1024;
+                    c.ports[port].overflow = PacketQueuePortPolicy::Overflow::DropOldest;
+                }
+                return c;
+            }();
+            return config;
+        }
+
         inline PacketQueue& packetQueue()
         {
             static PacketQueue instance(
-                Hardware::storage(),
-                Hardware::rtc()
+                Hardware::deferredStorage(),
+                Hardware::rtc(),
+                packetQueueConfig()
             );
+            // A deferred write dropped when drained would leave the queue offsets ahead of its files
+            static const bool writeLostHooked = []
+            {
+                Hardware::deferredStorage().setWriteLostCallback([](void* context, const char* path)
+                {
+                    static_cast<PacketQueue*>(context)->onWriteLost(path);
+                }, &instance);
+                return true;
+            }();
+            (void)writeLostHooked;
             return instance;
         }
 
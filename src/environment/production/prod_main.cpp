@@ -61,14 +61,21 @@ void prod_setup()
         &hardware::display(),
         &hardware::storage(),
         &hardware::rtc(),
-        "log", // MAX 8 chars for 8.3 filenames
-        Logger::Mode::Both
+        "log.bin", // MAX 8 chars for 8.3 filenames. Decode with scripts/binary_log.py
+        Logger::Mode::Both,
+        Logger::Format::Binary
     );
+    // log000.bin..log007.bin de 64 KB e índice log.idx: append de coste acotado y "últimos N minutos" sin leer todo
+    if (!Logger::enableRotation())
+    {
+        LOG_ERROR("Could not enable log rotation: logging to a single file");
+    }
 
     Logger::logInfo("================ Setting up Node =================");
 
     // Sync RTC time with GPS time at startup
     hardware::rtc().syncTime(hardware::gps().getTimestamp());
+    TimeService::resync(); // Los timestamps del log pasan a la hora del GPS sin esperar a la resincronización
 
     // ------------ Initialize communication ports ------------
     // Initialize the packet queue
@@ -126,6 +133,22 @@ void prod_setup()
     );
     sys::scheduler().addTask(&nodeOperationTask);
 
+    // *** Storage Stats Task *** (where the operation cycle spends its storage time)
+    static MethodTask<InstrumentedStorageManager> storageStatsTask(
+        600000, // 10 minutes
+        &hardware::instrumentedStorage(),
+        &InstrumentedStorageManager::logSummary
+    );
+    sys::scheduler().addTask(&storageStatsTask);
+
+    // *** Deferred Storage Drain *** (packet queue writes, between tasks)
+    static MethodTask<DeferredStorageManager> storageDrainTask(
+        0, // Idle task: runs after every task
+        &hardware::deferredStorage(),
+        &DeferredStorageManager::drain
+    );
+    sys::scheduler().setIdleTask(&storageDrainTask);
+
 #if MODE == DRIFTER_MODE
     // saveDrifterConfig();
 #elif MODE == LOCALIZER_MODE
@@ -145,6 +168,14 @@ void prod_loop()
         {
             LOG_FREE_MEMORY("[🚀 PROD LOOP START]");
             sys::scheduler().run();
+
+            // Sync point: write the buffered log lines and the deferred queue writes, then persist everything
+            // through the cached SD handles
+            (void)Logger::flush();
+            if (!hardware::deferredStorage().sync())
+            {
+                LOG_ERROR("Failed to sync storage at the end of the loop");
+            }
             LOG_FREE_MEMORY("[🚀 PROD LOOP END]");
         });
     });
@@ -218,6 +218,7 @@ void test_setup()
 
 
     hardware::rtc().setEpoch(1762778934); // Here you would call synctime with gpsmock.getTimeStamp()
+    TimeService::resync();
 
 
     // ------------ Initialize communication ports ------------
@@ -336,6 +337,13 @@ void test_setup()
     );
     sys::scheduler().addTask(&nodeOperationTask);
 
+    // *** Deferred Storage Drain *** (packet queue writes, between tasks)
+    static MethodTask<DeferredStorageManager> storageDrainTask(
+        0, // Idle task: runs after every task
+        &hardware::deferredStorage(),
+        &DeferredStorageManager::drain
+    );
+    sys::scheduler().setIdleTask(&storageDrainTask);
 
     // #ifdef PLATFORM_HAS_GSM
     // test_gsm_initialization();
@@ -356,6 +364,14 @@ void test_loop()
         {
             LOG_FREE_MEMORY("[🧪 TEST LOOP START]");
             sys::scheduler().run();
+
+            // Sync point: write the buffered log lines and the deferred queue writes, then persist everything
+            // through the cached SD handles
+            (void)Logger::flush();
+            if (!hardware::deferredStorage().sync())
+            {
+                LOG_ERROR("Failed to sync storage at the end of the loop");
+            }
             LOG_FREE_MEMORY("[🧪 TEST LOOP END]");
         });
     });
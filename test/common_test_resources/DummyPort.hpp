@@ -2,6 +2,7 @@
 #define ACOUSEA_INFRASTRUCTURE_MKR_MOCKPORT_HPP
 
 #include "Ports/IPort.h"
+#include "PacketQueue/PacketQueue.hpp"
 #include <vector>
 
 
@@ -11,7 +12,8 @@
 class DummyPort : public IPort
 {
 public:
-    explicit DummyPort(PortType t) : IPort(t)
+    // Like the real ports, received packets reach the Router through the PacketQueue (pushed on sync())
+    explicit DummyPort(PortType t, PacketQueue* packetQueue = nullptr) : IPort(t), packetQueue(packetQueue)
     {
     }
 
@@ -19,19 +21,24 @@ public:
     {
     }
 
-    bool send(const std::vector<uint8_t>& data) override
+    bool send(const uint8_t* data, const size_t length) override
     {
-        sentPackets.push_back(data);
+        sentPackets.emplace_back(data, data + length);
         return sendReturn;
     }
 
-    bool available() override { return !inQueue.empty(); }
+    bool available() override { return packetQueue != nullptr && !packetQueue->isPortEmpty(getTypeU8()); }
 
-    std::vector<std::vector<uint8_t>> read() override
+    bool sync() override
     {
-        auto tmp = inQueue;
+        bool ok = true;
+        for (const auto& raw : inQueue)
+        {
+            ok = packetQueue != nullptr
+                && packetQueue->push(getTypeU8(), raw.data(), static_cast<uint16_t>(raw.size())) && ok;
+        }
         inQueue.clear();
-        return tmp;
+        return ok;
     }
 
     void enqueueRaw(const std::vector<uint8_t>& raw) { inQueue.push_back(raw); }
@@ -40,6 +47,7 @@ public:
     std::vector<std::vector<uint8_t>> sentPackets;
 
 private:
+    PacketQueue* packetQueue;
     std::vector<std::vector<uint8_t>> inQueue;
     bool sendReturn{true};
 };
@@ -3,6 +3,7 @@
 
 #include "StorageManager/StorageManager.hpp"
 #include <unordered_map>
+#include <string>
 #include <cstring>
 #include <vector>
 #include <mutex>
@@ -18,36 +19,97 @@ private:
     mutable std::mutex mtx;
 
 public:
+    bool mapRegions = false; // mapFileRegion() devuelve vistas en lugar de spans vacíos
+    bool preallocation = false; // supportsPreallocation(); desactivado para conservar el layout clásico de appends
+
     bool begin() override { return true; }
 
     // ----------------------------------------------------
-    // Escritura de texto
+    // Creación / escritura binaria
     // ----------------------------------------------------
-    bool appendToFile(const char* path, const char* content) override
+    bool createEmptyFile(const char* path) override
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (!path) return false;
+        files[path].clear();
+        return true;
+    }
+
+    bool appendBytesToFile(const char* path, const uint8_t* data, size_t length) override
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (!path || !data || length == 0) return false;
+
+        auto& fileData = files[path];
+        fileData.insert(fileData.end(), data, data + length);
+        return true;
+    }
+
+    bool appendBytesToFileV(const char* path, const IoVec* parts, size_t count) override
     {
         std::lock_guard<std::mutex> lock(mtx);
-        if (!path || !content) return false;
+        if (!path || !parts || count == 0) return false;
 
-        const size_t len = std::strlen(content);
         auto& fileData = files[path];
-        fileData.insert(fileData.end(), content, content + len);
+        for (size_t i = 0; i < count; i++)
+        {
+            if (parts[i].length == 0) continue;
+            if (!parts[i].data) return false;
+            fileData.insert(fileData.end(), parts[i].data, parts[i].data + parts[i].length);
+        }
         return true;
     }
 
-    bool overwriteFile(const char* path, const char* content) override
+    bool overwriteBytesToFile(const char* path, const uint8_t* data, size_t length) override
     {
         std::lock_guard<std::mutex> lock(mtx);
-        if (!path || !content) return false;
+        if (!path || !data) return false;
 
-        const size_t len = std::strlen(content);
-        files[path] = std::vector<uint8_t>(content, content + len);
+        files[path] = std::vector<uint8_t>(data, data + length);
+        return true;
+    }
+
+    bool writeFileBytes(const char* path, const uint8_t* data, size_t length) override
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (!path || (!data && length > 0)) return false;
+
+        files[path] = std::vector<uint8_t>(data, data + length);
+        return true;
+    }
+
+    bool supportsPreallocation() const override { return preallocation; }
+
+    bool preallocateFile(const char* path, size_t capacity) override
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (!preallocation || !path) return false;
+
+        files[path].assign(capacity, 0);
+        return true;
+    }
+
+    bool writeFileRegionV(const char* path, size_t offset, const IoVec* parts, size_t count) override
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (!preallocation || !path || !parts || count == 0) return false;
+
+        auto& fileData = files[path];
+        for (size_t i = 0; i < count; i++)
+        {
+            if (parts[i].length == 0) continue;
+            if (!parts[i].data) return false;
+            if (fileData.size() < offset + parts[i].length) fileData.resize(offset + parts[i].length, 0);
+            std::memcpy(fileData.data() + offset, parts[i].data, parts[i].length);
+            offset += parts[i].length;
+        }
         return true;
     }
 
     // ----------------------------------------------------
-    // Lectura y borrado de texto
+    // Lectura binaria
     // ----------------------------------------------------
-    size_t readFile(const char* path, char* outBuffer, size_t maxLen) override
+    size_t readFileBytes(const char* path, uint8_t* outBuffer, size_t maxLen) override
     {
         std::lock_guard<std::mutex> lock(mtx);
         if (!path || !outBuffer || maxLen == 0) return 0;
@@ -56,49 +118,119 @@ public:
         if (it == files.end()) return 0;
 
         const auto& data = it->second;
-        size_t len = data.size() < (maxLen - 1) ? data.size() : (maxLen - 1);
+        const size_t len = (data.size() < maxLen) ? data.size() : maxLen;
 
         std::memcpy(outBuffer, data.data(), len);
-        outBuffer[len] = '\0';  // Null-terminate
         return len;
     }
 
-    bool deleteFile(const char* path) override
+    size_t readFileRegionBytes(const char* path, size_t offset, uint8_t* outBuffer, size_t outBufferLen) override
     {
         std::lock_guard<std::mutex> lock(mtx);
-        if (!path) return false;
-        return files.erase(path) > 0;
+        if (!path || !outBuffer || outBufferLen == 0) return 0;
+
+        auto it = files.find(path);
+        if (it == files.end()) return 0;
+
+        const auto& data = it->second;
+        if (offset >= data.size()) return 0;
+
+        const size_t available = data.size() - offset;
+        const size_t len = (available < outBufferLen) ? available : outBufferLen;
+
+        std::memcpy(outBuffer, data.data() + offset, len);
+        return len;
+    }
+
+    // Vista directa al vector (como el mmap de FdStorageManager); desactivada por defecto para que los tests que
+    // cuentan lecturas sigan viendo readFileRegionBytes()
+    ByteSpan mapFileRegion(const char* path, size_t offset, size_t length) override
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (!mapRegions || !path || length == 0) return {};
+
+        auto it = files.find(path);
+        if (it == files.end() || offset >= it->second.size()) return {};
+
+        const size_t available = it->second.size() - offset;
+        return {it->second.data() + offset, available < length ? available : length};
     }
 
     // ----------------------------------------------------
-    // Escritura binaria
+    // Truncado / borrado
     // ----------------------------------------------------
-    bool writeFileBytes(const char* path, const uint8_t* data, size_t length) override
+    bool truncateFileFromOffset(const char* path, size_t offset) override
     {
         std::lock_guard<std::mutex> lock(mtx);
-        if (!path || (!data && length > 0)) return false;
+        if (!path) return false;
 
-        files[path] = std::vector<uint8_t>(data, data + length);
+        auto it = files.find(path);
+        if (it == files.end()) return false;
+
+        auto& data = it->second;
+        if (offset >= data.size())
+        {
+            data.clear();
+            return true;
+        }
+        // Mismo comportamiento que SDStorageManager: conserva los bytes a partir de offset
+        data.erase(data.begin(), data.begin() + static_cast<std::ptrdiff_t>(offset));
+        return true;
+    }
+
+    bool clearFile(const char* path) override
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (!path) return false;
+
+        auto it = files.find(path);
+        if (it == files.end()) return false;
+        it->second.clear();
         return true;
     }
 
+    bool deleteFile(const char* path) override
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (!path) return false;
+        return files.erase(path) > 0;
+    }
 
     // ----------------------------------------------------
-    // Lectura binaria
+    // Metadatos
     // ----------------------------------------------------
-    size_t readFileBytes(const char* path, uint8_t* outBuffer, size_t maxLen) override
+    bool fileExists(const char* path) override
     {
         std::lock_guard<std::mutex> lock(mtx);
-        if (!path || !outBuffer || maxLen == 0) return 0;
+        return path && files.find(path) != files.end();
+    }
 
-        auto it = files.find(path);
-        if (it == files.end()) return 0;
+    bool renameFile(const char* oldPath, const char* newPath) override
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (!oldPath || !newPath) return false;
 
-        const auto& data = it->second;
-        const size_t len = (data.size() < maxLen) ? data.size() : maxLen;
+        auto it = files.find(oldPath);
+        if (it == files.end()) return false;
 
-        std::memcpy(outBuffer, data.data(), len);
-        return len;
+        auto data = std::move(it->second);
+        files.erase(it);
+        files[newPath] = std::move(data);
+        return true;
+    }
+
+    bool createDirectory(const char* /*str*/) override
+    {
+        return true; // Sin jerarquía de directorios en memoria
+    }
+
+    size_t fileSize(const char* str) override
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (!str) return 0;
+
+        auto it = files.find(str);
+        return it == files.end() ? 0 : it->second.size();
     }
 
     // ----------------------------------------------------
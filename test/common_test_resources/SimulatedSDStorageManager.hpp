@@ -0,0 +1,382 @@
+#ifndef ACOUSEA_INFRASTRUCTURE_MKR_SIMULATED_SD_STORAGE_MANAGER_HPP
+#define ACOUSEA_INFRASTRUCTURE_MKR_SIMULATED_SD_STORAGE_MANAGER_HPP
+
+#include "InMemoryStorageManager.hpp"
+#include "StorageManager/SDStorageManager/SDLatencyModel/SDLatencyModel.hpp"
+#include "time/getMillis.hpp"
+
+#include <algorithm>
+#include <set>
+#include <string>
+#include <vector>
+
+
+/**
+ * @brief Opciones de SimulatedSDStorageManager.
+ */
+struct SimulatedSDConfig
+{
+    SDLatencyModel latency{}; // Per-open, per-seek and per-block (512 B) costs
+    size_t cachedHandles = 4; // Like SDStorageManager::HANDLE_CACHE_SIZE; 0 = open + close on every call (legacy)
+    bool advanceClock = true; // Each modelled latency advances getMillis()/getMicros()
+    bool preallocation = true; // preallocateFile() like SDStorageManager (contiguous extent, no chain walk)
+};
+
+/**
+ * @brief InMemoryStorageManager con el coste de una SD real: cada operación suma su latencia modelada
+ *        (SDLatencyModel) y, por defecto, adelanta el reloj virtual, de modo que los benchmarks nativos miden tiempo
+ *        de campo sin esperar. Permite inyectar escrituras cortadas (corte de alimentación) y errores de lectura.
+ *
+ * Como la SD, no ofrece mapFileRegion(): todas las lecturas pasan por readFileRegionBytes(). Los ficheros creados con
+ * appends se consideran fragmentados: cada seek recorre la cadena FAT desde el primer cluster (chainWalkUs), así que
+ * su coste crece con el tamaño; los preasignados son contiguos y el seek es constante.
+ */
+class SimulatedSDStorageManager : public InMemoryStorageManager
+{
+public:
+    struct Stats
+    {
+        uint64_t elapsedUs = 0; // Modelled time spent in storage
+        uint32_t opens = 0;
+        uint32_t seeks = 0;
+        uint64_t fatLinks = 0; // Chain links followed by seeks in fragmented files
+        uint32_t syncs = 0;
+        uint64_t bytesRead = 0;
+        uint64_t bytesWritten = 0;
+        uint32_t tornWrites = 0;
+        uint32_t readErrors = 0;
+    };
+
+    explicit SimulatedSDStorageManager(const SimulatedSDConfig& config = SimulatedSDConfig{}) : config_(config)
+    {
+        preallocation = config.preallocation;
+    }
+
+    // ----------------------------------------------------
+    // Inyección de fallos
+    // ----------------------------------------------------
+
+    // The next write keeps only its first keepBytes bytes and fails, as if power was lost mid-write
+    void tearNextWrite(const size_t keepBytes)
+    {
+        tearPending_ = true;
+        tearKeepBytes_ = keepBytes;
+    }
+
+    // The next `count` reads return 0 bytes (the latency is still paid)
+    void failNextReads(const uint32_t count) { failingReads_ = count; }
+
+    [[nodiscard]] const Stats& getStats() const { return stats_; }
+
+    void resetStats() { stats_ = Stats{}; }
+
+    // ----------------------------------------------------
+    // StorageManager
+    // ----------------------------------------------------
+    bool createEmptyFile(const char* path) override
+    {
+        if (!path) return false;
+        touch(path, true);
+        contiguous_.erase(path);
+        return InMemoryStorageManager::createEmptyFile(path);
+    }
+
+    bool appendBytesToFile(const char* path, const uint8_t* data, const size_t length) override
+    {
+        const IoVec part{data, length};
+        return data && length > 0 && appendBytesToFileV(path, &part, 1);
+    }
+
+    bool appendBytesToFileV(const char* path, const IoVec* parts, const size_t count) override
+    {
+        if (!path || !parts || count == 0) return false;
+
+        size_t total = 0;
+        for (size_t i = 0; i < count; i++) total += parts[i].length;
+        touch(path, true);
+        seek(path, InMemoryStorageManager::fileSize(path)); // seekEnd
+        chargeWrite(total);
+
+        if (!tearPending_)
+        {
+            return InMemoryStorageManager::appendBytesToFileV(path, parts, count);
+        }
+
+        // Torn write: only the first tearKeepBytes_ bytes of the parts reach the card
+        const std::vector<IoVec> kept = tear(parts, count);
+        if (!kept.empty()) (void)InMemoryStorageManager::appendBytesToFileV(path, kept.data(), kept.size());
+        return false;
+    }
+
+    bool preallocateFile(const char* path, const size_t capacity) override
+    {
+        if (!path || !preallocation) return false;
+
+        // Contiguous allocation: a scan of the FAT plus one FAT entry (4 B) written per cluster
+        const size_t clusters = (capacity + config_.latency.clusterBytes - 1) / config_.latency.clusterBytes;
+        touch(path, true);
+        charge(config_.latency.readUs(SDLatencyModel::BLOCK_SIZE));
+        chargeWrite(clusters * 4);
+        contiguous_.insert(path);
+        return InMemoryStorageManager::preallocateFile(path, capacity);
+    }
+
+    bool writeFileRegionV(const char* path, const size_t offset, const IoVec* parts, const size_t count) override
+    {
+        if (!path || !parts || count == 0 || !preallocation) return false;
+
+        size_t total = 0;
+        for (size_t i = 0; i < count; i++) total += parts[i].length;
+        touch(path, true);
+        seek(path, offset);
+        chargeWrite(total);
+
+        if (!tearPending_)
+        {
+            return InMemoryStorageManager::writeFileRegionV(path, offset, parts, count);
+        }
+
+        const std::vector<IoVec> kept = tear(parts, count);
+        if (!kept.empty()) (void)InMemoryStorageManager::writeFileRegionV(path, offset, kept.data(), kept.size());
+        return false;
+    }
+
+    bool overwriteBytesToFile(const char* path, const uint8_t* data, const size_t length) override
+    {
+        if (!path || !data) return false;
+        return writeFileBytes(path, data, length);
+    }
+
+    bool writeFileBytes(const char* path, const uint8_t* data, const size_t length) override
+    {
+        if (!path || (!data && length > 0)) return false;
+
+        touch(path, true);
+        contiguous_.erase(path);
+        chargeWrite(length);
+        if (tearPending_)
+        {
+            tearPending_ = false;
+            stats_.tornWrites++;
+            (void)InMemoryStorageManager::writeFileBytes(path, data, std::min(length, tearKeepBytes_));
+            return false;
+        }
+        return InMemoryStorageManager::writeFileBytes(path, data, length);
+    }
+
+    size_t readFileBytes(const char* path, uint8_t* outBuffer, const size_t maxLen) override
+    {
+        return readFileRegionBytes(path, 0, outBuffer, maxLen);
+    }
+
+    size_t readFileRegionBytes(const char* path, const size_t offset, uint8_t* outBuffer,
+                               const size_t outBufferLen) override
+    {
+        if (!path || !outBuffer || outBufferLen == 0) return 0;
+
+        touch(path, false);
+        if (offset > 0) seek(path, offset);
+        const size_t read = InMemoryStorageManager::readFileRegionBytes(path, offset, outBuffer, outBufferLen);
+        charge(config_.latency.readUs(read));
+        stats_.bytesRead += read;
+
+        if (failingReads_ > 0)
+        {
+            failingReads_--;
+            stats_.readErrors++;
+            return 0;
+        }
+        return read;
+    }
+
+    ByteSpan mapFileRegion(const char* /*path*/, size_t /*offset*/, size_t /*length*/) override
+    {
+        return {};
+    }
+
+    bool truncateFileFromOffset(const char* path, const size_t offset) override
+    {
+        if (!path) return false;
+
+        // SDStorageManager reads the tail and rewrites the file with it
+        const size_t total = InMemoryStorageManager::fileSize(path);
+        const size_t tail = offset < total ? total - offset : 0;
+        touch(path, true);
+        seek(path, offset);
+        charge(config_.latency.readUs(tail));
+        chargeWrite(tail);
+        return InMemoryStorageManager::truncateFileFromOffset(path, offset);
+    }
+
+    bool clearFile(const char* path) override
+    {
+        if (!path) return false;
+        touch(path, true);
+        contiguous_.erase(path);
+        return InMemoryStorageManager::clearFile(path);
+    }
+
+    bool deleteFile(const char* path) override
+    {
+        if (!path) return false;
+        forget(path);
+        contiguous_.erase(path);
+        charge(config_.latency.openUs + config_.latency.closeUs); // Directory lookup + entry update
+        return InMemoryStorageManager::deleteFile(path);
+    }
+
+    bool fileExists(const char* path) override
+    {
+        if (!path) return false;
+        if (!isCached(path)) charge(config_.latency.openUs); // Directory lookup
+        return InMemoryStorageManager::fileExists(path);
+    }
+
+    bool renameFile(const char* oldPath, const char* newPath) override
+    {
+        if (!oldPath || !newPath) return false;
+        forget(oldPath);
+        forget(newPath);
+        charge(config_.latency.openUs + config_.latency.closeUs);
+        contiguous_.erase(newPath);
+        if (contiguous_.erase(oldPath) > 0) contiguous_.insert(newPath);
+        return InMemoryStorageManager::renameFile(oldPath, newPath);
+    }
+
+    size_t fileSize(const char* str) override
+    {
+        if (!str) return 0;
+        if (!isCached(str)) charge(config_.latency.openUs);
+        return InMemoryStorageManager::fileSize(str);
+    }
+
+    bool sync() override
+    {
+        for (auto& handle : handles_)
+        {
+            if (handle.dirty)
+            {
+                charge(config_.latency.syncUs);
+                stats_.syncs++;
+                handle.dirty = false;
+            }
+        }
+        return true;
+    }
+
+    bool syncFile(const char* path) override
+    {
+        for (auto& handle : handles_)
+        {
+            if (handle.dirty && handle.path == path)
+            {
+                charge(config_.latency.syncUs);
+                stats_.syncs++;
+                handle.dirty = false;
+            }
+        }
+        return true;
+    }
+
+private:
+    struct Handle
+    {
+        std::string path;
+        bool dirty;
+    };
+
+    const SimulatedSDConfig config_;
+    std::vector<Handle> handles_{}; // Most recently used first
+    std::set<std::string> contiguous_{}; // Preallocated files (the rest grew by appends and are fragmented)
+    Stats stats_{};
+    bool tearPending_ = false;
+    size_t tearKeepBytes_ = 0;
+    uint32_t failingReads_ = 0;
+
+    void charge(const uint64_t us)
+    {
+        stats_.elapsedUs += us;
+        if (config_.advanceClock) advanceClockMicros(static_cast<unsigned long>(us));
+    }
+
+    void chargeWrite(const size_t bytes)
+    {
+        charge(config_.latency.writeUs(bytes));
+        stats_.bytesWritten += bytes;
+    }
+
+    void seek(const char* path, const size_t offset)
+    {
+        charge(config_.latency.seekUs);
+        stats_.seeks++;
+        if (contiguous_.count(path) == 0)
+        {
+            charge(config_.latency.chainWalkUs(offset));
+            stats_.fatLinks += offset / config_.latency.clusterBytes;
+        }
+    }
+
+    // Consumes the pending torn write: the prefix of the parts that reaches the card
+    std::vector<IoVec> tear(const IoVec* parts, const size_t count)
+    {
+        tearPending_ = false;
+        stats_.tornWrites++;
+        std::vector<IoVec> kept;
+        size_t keep = tearKeepBytes_;
+        for (size_t i = 0; i < count && keep > 0; i++)
+        {
+            const size_t len = std::min(parts[i].length, keep);
+            if (len > 0) kept.push_back(IoVec{parts[i].data, len});
+            keep -= len;
+        }
+        return kept;
+    }
+
+    [[nodiscard]] bool isCached(const char* path) const
+    {
+        return std::any_of(handles_.begin(), handles_.end(), [path](const Handle& h) { return h.path == path; });
+    }
+
+    // Pays the open of the file unless its handle is cached (legacy mode: open and, after a write, close)
+    void touch(const char* path, const bool write)
+    {
+        if (config_.cachedHandles == 0)
+        {
+            charge(config_.latency.openUs + (write ? config_.latency.closeUs : 0));
+            stats_.opens++;
+            return;
+        }
+
+        const auto it = std::find_if(handles_.begin(), handles_.end(),
+                                     [path](const Handle& h) { return h.path == path; });
+        if (it != handles_.end())
+        {
+            Handle handle = *it;
+            handle.dirty = handle.dirty || write;
+            handles_.erase(it);
+            handles_.insert(handles_.begin(), handle);
+            return;
+        }
+
+        charge(config_.latency.openUs);
+        stats_.opens++;
+        if (handles_.size() >= config_.cachedHandles)
+        {
+            if (handles_.back().dirty) charge(config_.latency.closeUs);
+            handles_.pop_back();
+        }
+        handles_.insert(handles_.begin(), Handle{path, write});
+    }
+
+    // Closes the cached handle (delete / rename)
+    void forget(const char* path)
+    {
+        const auto it = std::find_if(handles_.begin(), handles_.end(),
+                                     [path](const Handle& h) { return h.path == path; });
+        if (it == handles_.end()) return;
+        if (it->dirty) charge(config_.latency.closeUs);
+        handles_.erase(it);
+    }
+};
+
+#endif // ACOUSEA_INFRASTRUCTURE_MKR_SIMULATED_SD_STORAGE_MANAGER_HPP
@@ -0,0 +1,117 @@
+#ifndef UNIT_TESTING
+#define UNIT_TESTING
+#endif
+
+#include <gtest/gtest.h>
+#include <cstring>
+#include <vector>
+
+#include "BinaryFrame/BinaryFrame.hpp"
+#include "Crc32/Crc32.hpp"
+
+
+// =====================================================================
+// Helpers
+// =====================================================================
+namespace
+{
+    std::vector<uint8_t> makeFrame(const std::vector<uint8_t>& payload, const uint32_t ts,
+                                   const BinaryFrame::Version version)
+    {
+        std::vector<uint8_t> frame(BinaryFrame::requiredSize(static_cast<uint16_t>(payload.size()), version));
+        EXPECT_TRUE(BinaryFrame::wrapInPlace(frame.data(), frame.size(), payload.data(),
+            static_cast<uint16_t>(payload.size()), ts, version));
+        return frame;
+    }
+}
+
+// =====================================================================
+// TESTS
+// =====================================================================
+TEST(Crc32Test, MatchesStandardCheckValue)
+{
+    const auto* data = reinterpret_cast<const uint8_t*>("123456789");
+    EXPECT_EQ(Crc32::compute(data, 9), 0xCBF43926u);
+
+    // Incremental == one shot
+    uint32_t crc = Crc32::update(Crc32::INITIAL, data, 4);
+    crc = Crc32::update(crc, data + 4, 5);
+    EXPECT_EQ(Crc32::finalize(crc), 0xCBF43926u);
+}
+
+TEST(BinaryFrameTest, V1AndV2RoundTrip)
+{
+    const std::vector<uint8_t> payload = {1, 2, 3, 4, 5};
+
+    for (const auto version : {BinaryFrame::Version::V1, BinaryFrame::Version::V2})
+    {
+        const auto frame = makeFrame(payload, 0x12345678, version);
+
+        BinaryFrame::FrameView view{};
+        ASSERT_TRUE(BinaryFrame::unwrap(frame.data(), frame.size(), view));
+        EXPECT_EQ(view.version, version);
+        EXPECT_EQ(view.timestamp, 0x12345678u);
+        EXPECT_EQ(view.frameLength, frame.size());
+        EXPECT_EQ(std::vector<uint8_t>(view.payload, view.payload + view.payloadLength), payload);
+    }
+}
+
+TEST(BinaryFrameTest, WrapPartsMatchesWrapInPlace)
+{
+    const std::vector<uint8_t> payload = {9, 8, 7, 6, 5, 4};
+
+    for (const auto version : {BinaryFrame::Version::V1, BinaryFrame::Version::V2})
+    {
+        uint8_t header[BinaryFrame::HEADER_SIZE];
+        uint8_t footer[BinaryFrame::FOOTER_SIZE_V2];
+        const size_t footerLen = BinaryFrame::wrapParts(header, footer, payload.data(),
+                                                        static_cast<uint16_t>(payload.size()), 77, version);
+        ASSERT_EQ(footerLen, BinaryFrame::footerSize(version));
+
+        std::vector<uint8_t> joined(header, header + sizeof(header));
+        joined.insert(joined.end(), payload.begin(), payload.end());
+        joined.insert(joined.end(), footer, footer + footerLen);
+        EXPECT_EQ(joined, makeFrame(payload, 77, version));
+    }
+}
+
+TEST(BinaryFrameTest, V2DetectsCorruptedPayload)
+{
+    auto frame = makeFrame({10, 20, 30, 40}, 1, BinaryFrame::Version::V2);
+    frame[BinaryFrame::HEADER_SIZE + 1] ^= 0x01;
+
+    BinaryFrame::FrameView view{};
+    EXPECT_FALSE(BinaryFrame::unwrap(frame.data(), frame.size(), view));
+}
+
+TEST(BinaryFrameTest, FindNextFrameSkipsGarbage)
+{
+    const auto first = makeFrame({1, 2, 3}, 1, BinaryFrame::Version::V2);
+    const auto second = makeFrame({4, 5, 6}, 2, BinaryFrame::Version::V2);
+
+    // Garbage with start bytes that do not begin valid frames
+    std::vector<uint8_t> stream = {0x00, BinaryFrame::START_BYTE_V2, 0x13, BinaryFrame::START_BYTE, 0x55};
+    stream.insert(stream.end(), first.begin(), first.end());
+    stream.insert(stream.end(), second.begin(), second.end());
+
+    const size_t firstAt = 5;
+    EXPECT_EQ(BinaryFrame::findNextFrame(stream.data(), stream.size(), 0), firstAt);
+    EXPECT_EQ(BinaryFrame::findNextFrame(stream.data(), stream.size(), firstAt + 1), firstAt + first.size());
+}
+
+TEST(BinaryFrameTest, FindNextFrameReportsFrameCutByBufferEnd)
+{
+    const auto frame = makeFrame({1, 2, 3, 4, 5, 6}, 1, BinaryFrame::Version::V2);
+
+    // The cut frame would fit in a buffer of this size once read again from its start
+    std::vector<uint8_t> stream(8, 0x01);
+    stream.insert(stream.end(), frame.begin(), frame.end() - 3);
+
+    EXPECT_EQ(BinaryFrame::findNextFrame(stream.data(), stream.size(), 0), 8u);
+}
+
+TEST(BinaryFrameTest, FindNextFrameWithoutCandidatesReturnsBufferSize)
+{
+    const std::vector<uint8_t> noise(64, 0x42);
+    EXPECT_EQ(BinaryFrame::findNextFrame(noise.data(), noise.size(), 0), noise.size());
+}
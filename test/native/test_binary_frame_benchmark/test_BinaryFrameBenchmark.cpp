@@ -0,0 +1,85 @@
+#ifndef UNIT_TESTING
+#define UNIT_TESTING
+#endif
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include "BinaryFrame/BinaryFrame.hpp"
+#include "Crc32/Crc32.hpp"
+
+
+// =====================================================================
+// Fixture para el benchmark de BinaryFrame / Crc32
+// =====================================================================
+class BinaryFrameBenchmark : public ::testing::Test
+{
+protected:
+    template <typename F>
+    static double megabytesPerSecond(const size_t bytesPerRun, F&& run)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < RUNS; i++)
+        {
+            run();
+        }
+        const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return static_cast<double>(bytesPerRun * RUNS) / elapsed / (1024.0 * 1024.0);
+    }
+
+    static constexpr size_t RUNS = 200;
+    static constexpr size_t BUFFER_SIZE = 64 * 1024;
+};
+
+// =====================================================================
+// TESTS
+// =====================================================================
+TEST_F(BinaryFrameBenchmark, Crc32Throughput)
+{
+    std::vector<uint8_t> data(BUFFER_SIZE);
+    for (size_t i = 0; i < data.size(); i++)
+    {
+        data[i] = static_cast<uint8_t>(i * 31);
+    }
+
+    volatile uint32_t sink = 0;
+    const double mbps = megabytesPerSecond(data.size(), [&]
+    {
+        sink = sink ^ Crc32::compute(data.data(), data.size());
+    });
+
+    std::printf("[BENCH] Crc32 (table-driven) over %zu KB: %10.1f MB/s\n", BUFFER_SIZE / 1024, mbps);
+    EXPECT_GT(mbps, 0.0);
+}
+
+TEST_F(BinaryFrameBenchmark, ResyncScannerThroughput)
+{
+    // Worst realistic case: noise full of plausible headers (start byte + short length) whose CRC fails,
+    // and one valid frame near the end
+    std::vector<uint8_t> data(BUFFER_SIZE);
+    for (size_t i = 0; i < data.size(); i++)
+    {
+        const size_t phase = i % 97;
+        data[i] = phase == 0 ? BinaryFrame::START_BYTE_V2
+                  : phase == 6 ? 0x00 // High byte of the length
+                  : static_cast<uint8_t>((i * 7 + 1) & 0x3F);
+    }
+    const uint8_t payload[48] = {};
+    constexpr size_t frameSize = BinaryFrame::requiredSize(sizeof(payload), BinaryFrame::Version::V2);
+    const size_t frameAt = data.size() - frameSize - 128;
+    std::fill(data.begin() + static_cast<long>(frameAt), data.end(), 0x00);
+    ASSERT_TRUE(BinaryFrame::wrapInPlace(data.data() + frameAt, frameSize, payload, sizeof(payload), 0,
+        BinaryFrame::Version::V2));
+
+    size_t found = 0;
+    const double mbps = megabytesPerSecond(data.size(), [&]
+    {
+        found = BinaryFrame::findNextFrame(data.data(), data.size(), 0);
+    });
+
+    std::printf("[BENCH] BinaryFrame::findNextFrame over %zu KB of noise: %10.1f MB/s\n", BUFFER_SIZE / 1024, mbps);
+    EXPECT_EQ(found, frameAt);
+}
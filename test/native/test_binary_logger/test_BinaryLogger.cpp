@@ -0,0 +1,172 @@
+#ifndef UNIT_TESTING
+#define UNIT_TESTING
+#endif
+
+#include <gtest/gtest.h>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "Logger/Logger.h"
+#include "ClassName.h"
+#include <ConsoleDisplay/ConsoleDisplay.hpp>
+#include "MockRTCController/MockRTCController.h"
+
+// ................. Common test resources ..................
+#include "../common_test_resources/InMemoryStorageManager.hpp"
+
+
+/**
+ * @brief Clase con CLASS_NAME para generar registros con prefijo de clase.
+ */
+class BinaryLogSource
+{
+    CLASS_NAME(BinaryLogSource)
+
+public:
+    static void logSample()
+    {
+        LOG_CLASS_WARNING("x=%d u=%u s=%s f=%.2f c=%c", -5, 300u, "abc", 1.5, 'Z');
+    }
+
+    static void logLong(const char* text)
+    {
+        LOG_CLASS_INFO("%s|%d", text, 7);
+    }
+};
+
+// =====================================================================
+// Fixture para el log binario
+// =====================================================================
+class BinaryLoggerTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        rtc.setEpoch(1700000000);
+        Logger::initialize(&display, &storage, &rtc, "LOG.BIN", Logger::Mode::SDCard, Logger::Format::Binary);
+    }
+
+    void TearDown() override
+    {
+        Logger::initialize(&display, nullptr, nullptr, "LOG.TXT", Logger::Mode::SerialOnly);
+    }
+
+    struct Record
+    {
+        uint8_t flags = 0;
+        uint32_t epoch = 0;
+        uint32_t formatId = 0;
+        uint32_t classId = 0;
+        std::vector<uint8_t> payload;
+    };
+
+    static uint32_t read32(const uint8_t* p)
+    {
+        return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+    }
+
+    std::vector<Record> records()
+    {
+        EXPECT_TRUE(Logger::flush());
+        std::vector<uint8_t> file(storage.fileSize("LOG.BIN"));
+        file.resize(storage.readFileBytes("LOG.BIN", file.data(), file.size()));
+
+        std::vector<Record> out;
+        size_t pos = 0;
+        while (pos + Logger::BinaryRecordHeader::SIZE <= file.size())
+        {
+            EXPECT_EQ(file[pos], Logger::BinaryRecordHeader::SYNC);
+            Record record;
+            record.flags = file[pos + 1];
+            const size_t length = file[pos + 2] | (file[pos + 3] << 8);
+            record.epoch = read32(&file[pos + 4]);
+            record.formatId = read32(&file[pos + 8]);
+            record.classId = read32(&file[pos + 12]);
+            pos += Logger::BinaryRecordHeader::SIZE;
+            record.payload.assign(file.begin() + static_cast<std::ptrdiff_t>(pos),
+                                  file.begin() + static_cast<std::ptrdiff_t>(pos + length));
+            pos += length;
+            out.push_back(record);
+        }
+        EXPECT_EQ(pos, file.size());
+        return out;
+    }
+
+    ConsoleDisplay display;
+    InMemoryStorageManager storage;
+    MockRTCController rtc;
+};
+
+// =====================================================================
+// TESTS
+// =====================================================================
+TEST_F(BinaryLoggerTest, FormatIdsAreComputedAtCompileTime)
+{
+    static_assert(Logger::formatId("") == 0, "Empty string is reserved");
+    static_assert(Logger::formatId("a") == 0xE40C292Cu, "FNV-1a 32");
+    constexpr Logger::Site site = LOG_SITE("[X]: ", "value=%d");
+    static_assert(site.formatId == Logger::formatId("value=%d"), "Format id");
+    static_assert(site.classId == Logger::formatId("[X]: "), "Class id");
+    SUCCEED();
+}
+
+TEST_F(BinaryLoggerTest, MacroWritesRawArguments)
+{
+    BinaryLogSource::logSample();
+
+    const auto written = records();
+    ASSERT_EQ(written.size(), 1u);
+    const Record& record = written[0];
+    EXPECT_EQ(record.flags, static_cast<uint8_t>(Logger::Level::Warning));
+    EXPECT_EQ(record.epoch, 1700000000u);
+    EXPECT_EQ(record.formatId, Logger::formatId("x=%d u=%u s=%s f=%.2f c=%c"));
+    EXPECT_EQ(record.classId, Logger::formatId("[BinaryLogSource]: "));
+
+    // -5 zigzag, 300 varint, "abc" con longitud, 1.5 como double, 'Z' zigzag
+    std::vector<uint8_t> expected = {9, 0xAC, 0x02, 3, 'a', 'b', 'c'};
+    const double value = 1.5;
+    const auto* raw = reinterpret_cast<const uint8_t*>(&value);
+    expected.insert(expected.end(), raw, raw + sizeof(value));
+    expected.push_back(0xB4); // 'Z' * 2 = 180: dos bytes de varint
+    expected.push_back(0x01);
+    EXPECT_EQ(record.payload, expected);
+}
+
+TEST_F(BinaryLoggerTest, UnformattedMessagesAreTextRecords)
+{
+    Logger::logError("plain message");
+    LOG_INFO("free %s", "function");
+
+    const auto written = records();
+    ASSERT_EQ(written.size(), 2u);
+    EXPECT_EQ(written[0].formatId, 0u);
+    EXPECT_EQ(written[0].flags, static_cast<uint8_t>(Logger::Level::Error));
+    EXPECT_EQ(std::string(written[0].payload.begin(), written[0].payload.end()), "plain message");
+
+    EXPECT_EQ(written[1].formatId, Logger::formatId("free %s"));
+    EXPECT_EQ(written[1].classId, 0u);
+}
+
+TEST_F(BinaryLoggerTest, OversizedArgumentsAreTruncated)
+{
+    const std::string text(4096, 'q');
+    BinaryLogSource::logLong(text.c_str());
+
+    const auto written = records();
+    ASSERT_EQ(written.size(), 1u);
+    EXPECT_TRUE(written[0].flags & Logger::BinaryRecordHeader::TRUNCATED);
+    EXPECT_LE(written[0].payload.size(), 2048u);
+}
+
+TEST_F(BinaryLoggerTest, TextFormatKeepsTheSameLines)
+{
+    Logger::initialize(&display, &storage, &rtc, "LOG.TXT", Logger::Mode::SDCard);
+    BinaryLogSource::logSample();
+    ASSERT_TRUE(Logger::flush());
+
+    std::vector<uint8_t> file(storage.fileSize("LOG.TXT"));
+    file.resize(storage.readFileBytes("LOG.TXT", file.data(), file.size()));
+    const std::string line(file.begin(), file.end());
+    EXPECT_NE(line.find("] WARNING: [BinaryLogSource]: x=-5 u=300 s=abc f=1.50 c=Z\n"), std::string::npos);
+}
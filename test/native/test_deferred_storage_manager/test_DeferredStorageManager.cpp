@@ -0,0 +1,258 @@
+#ifndef UNIT_TESTING
+#define UNIT_TESTING
+#endif
+
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+#include "Logger/Logger.h"
+#include <ConsoleDisplay/ConsoleDisplay.hpp>
+#include "StorageManager/DeferredStorageManager/DeferredStorageManager.hpp"
+#include "PacketQueue/PacketQueue.hpp"
+#include "MockRTCController/MockRTCController.h"
+#include "TaskScheduler/TaskScheduler.h"
+#include "TaskScheduler/MethodTask.hpp"
+
+// ................. Common test resources ..................
+#include "../common_test_resources/InMemoryStorageManager.hpp"
+
+
+/**
+ * @brief InMemoryStorageManager que cuenta las llamadas de escritura y puede fallarlas.
+ */
+class CountingStorageManager : public InMemoryStorageManager
+{
+public:
+    bool appendBytesToFileV(const char* path, const IoVec* parts, const size_t count) override
+    {
+        appendCalls++;
+        return !failWrites && InMemoryStorageManager::appendBytesToFileV(path, parts, count);
+    }
+
+    size_t appendCalls = 0;
+    bool failWrites = false;
+};
+
+// =====================================================================
+// Fixture para DeferredStorageManager
+// =====================================================================
+class DeferredStorageManagerTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        Logger::initialize(&display, nullptr, nullptr, "LOG.TXT", Logger::Mode::SerialOnly);
+    }
+
+    static std::vector<uint8_t> bytes(const std::string& text)
+    {
+        return {text.begin(), text.end()};
+    }
+
+    std::string contents(const char* path)
+    {
+        std::vector<uint8_t> out(inner.fileSize(path));
+        const size_t read = inner.readFileBytes(path, out.data(), out.size());
+        return {out.begin(), out.begin() + static_cast<std::ptrdiff_t>(read)};
+    }
+
+    ConsoleDisplay display;
+    CountingStorageManager inner;
+    DeferredStorageManager storage{inner};
+};
+
+// =====================================================================
+// TESTS
+// =====================================================================
+TEST_F(DeferredStorageManagerTest, AppendsReturnBeforeReachingStorage)
+{
+    const auto hello = bytes("hello ");
+    const auto world = bytes("world");
+    ASSERT_TRUE(storage.appendBytesToFile("/a", hello.data(), hello.size()));
+    const IoVec parts[] = {{world.data(), 2}, {world.data() + 2, 3}};
+    ASSERT_TRUE(storage.appendBytesToFileV("/a", parts, 2));
+
+    EXPECT_EQ(inner.appendCalls, 0u);
+    EXPECT_FALSE(inner.exists("/a"));
+    EXPECT_EQ(storage.pendingCount(), 2u);
+    EXPECT_EQ(storage.pendingBytes(), 11u);
+
+    storage.drain();
+    EXPECT_EQ(contents("/a"), "hello world");
+    EXPECT_EQ(inner.appendCalls, 1u); // Consecutive appends to one file are coalesced
+    EXPECT_EQ(storage.pendingCount(), 0u);
+}
+
+TEST_F(DeferredStorageManagerTest, OperationsOnAFileSeeItsPendingWrites)
+{
+    const auto first = bytes("first");
+    const auto other = bytes("other");
+    const auto second = bytes("second");
+    ASSERT_TRUE(storage.appendBytesToFile("/a", first.data(), first.size()));
+    ASSERT_TRUE(storage.appendBytesToFile("/b", other.data(), other.size()));
+    ASSERT_TRUE(storage.appendBytesToFile("/a", second.data(), second.size()));
+    ASSERT_TRUE(storage.appendBytesToFile("/c", other.data(), other.size()));
+
+    // Reading /a writes the queue up to its last pending write (the /b one in between too, in order)
+    EXPECT_EQ(storage.fileSize("/a"), first.size() + second.size());
+    EXPECT_EQ(contents("/a"), "firstsecond");
+    EXPECT_EQ(contents("/b"), "other");
+    EXPECT_FALSE(inner.exists("/c"));
+    EXPECT_EQ(storage.pendingCount(), 1u);
+
+    // A truncation is applied after the pending appends, never before
+    ASSERT_TRUE(storage.appendBytesToFile("/a", first.data(), first.size()));
+    ASSERT_TRUE(storage.clearFile("/a"));
+    EXPECT_EQ(inner.fileSize("/a"), 0u);
+    EXPECT_TRUE(storage.fileExists("/c"));
+}
+
+TEST_F(DeferredStorageManagerTest, FullQueueWritesTheOldestInsteadOfDropping)
+{
+    const std::vector<uint8_t> record(100, 0x5A);
+    for (size_t i = 0; i < DeferredStorageManager::MAX_PENDING + 4; i++)
+    {
+        // Alternate files so that nothing is coalesced
+        ASSERT_TRUE(storage.appendBytesToFile(i % 2 == 0 ? "/a" : "/b", record.data(), record.size()));
+    }
+    EXPECT_EQ(storage.pendingCount(), DeferredStorageManager::MAX_PENDING);
+    EXPECT_EQ(storage.getStats().forcedDrains, 4u);
+
+    // Larger than the whole buffer: written directly, after everything queued before it
+    const std::vector<uint8_t> big(DeferredStorageManager::BUFFER_SIZE + 1, 0x11);
+    ASSERT_TRUE(storage.appendBytesToFile("/a", big.data(), big.size()));
+    EXPECT_EQ(storage.getStats().bypassed, 1u);
+    EXPECT_EQ(storage.pendingCount(), 0u);
+    EXPECT_EQ(inner.fileSize("/a"), record.size() * 10 + big.size());
+    EXPECT_EQ(inner.fileSize("/b"), record.size() * 10);
+}
+
+TEST_F(DeferredStorageManagerTest, WrappedRingDataIsWrittenIntact)
+{
+    // Fill most of the ring, drain it and append across its end
+    const std::vector<uint8_t> filler(DeferredStorageManager::BUFFER_SIZE - 10, 0x00);
+    ASSERT_TRUE(storage.appendBytesToFile("/x", filler.data(), filler.size()));
+    const auto head = bytes("0123456789");
+    ASSERT_TRUE(storage.appendBytesToFile("/y", head.data(), head.size()));
+    ASSERT_TRUE(storage.appendBytesToFile("/x", filler.data(), 1)); // Forces the oldest out
+
+    const auto wrapped = bytes("wrapped around");
+    ASSERT_TRUE(storage.appendBytesToFile("/y", wrapped.data(), wrapped.size()));
+    ASSERT_TRUE(storage.flush());
+    EXPECT_EQ(contents("/y"), "0123456789wrapped around");
+}
+
+TEST_F(DeferredStorageManagerTest, FlushReportsFailedDeferredWrites)
+{
+    const auto data = bytes("lost");
+    inner.failWrites = true;
+    ASSERT_TRUE(storage.appendBytesToFile("/a", data.data(), data.size()));
+    EXPECT_FALSE(storage.flush());
+    EXPECT_EQ(storage.getStats().failures, 1u);
+
+    inner.failWrites = false;
+    ASSERT_TRUE(storage.appendBytesToFile("/a", data.data(), data.size()));
+    EXPECT_TRUE(storage.sync());
+    EXPECT_EQ(contents("/a"), "lost");
+}
+
+TEST_F(DeferredStorageManagerTest, SchedulerDrainsBetweenTasks)
+{
+    const auto data = bytes("queued by a task");
+    struct WritingTask final : ITask
+    {
+        DeferredStorageManager* storage = nullptr;
+        const std::vector<uint8_t>* data = nullptr;
+        size_t pendingAtExecute = 0;
+
+        void execute() override
+        {
+            pendingAtExecute = storage->pendingCount();
+            (void)storage->appendBytesToFile("/t", data->data(), data->size());
+        }
+    };
+    WritingTask first;
+    first.storage = &storage;
+    first.data = &data;
+    WritingTask second = first;
+
+    MethodTask<DeferredStorageManager> drainTask(0, &storage, &DeferredStorageManager::drain);
+    TaskScheduler scheduler;
+    scheduler.addTask(&first);
+    scheduler.addTask(&second);
+    scheduler.setIdleTask(&drainTask);
+    scheduler.run();
+
+    EXPECT_EQ(second.pendingAtExecute, 0u); // The write of the first task was drained before the second one ran
+    EXPECT_EQ(storage.pendingCount(), 0u);
+    EXPECT_EQ(inner.fileSize("/t"), 2 * data.size());
+}
+
+TEST_F(DeferredStorageManagerTest, PacketQueueOnDeferredStorage)
+{
+    MockRTCController rtc;
+    PacketQueue queue(storage, rtc);
+    ASSERT_TRUE(queue.begin());
+    const size_t callsAfterBegin = inner.appendCalls;
+
+    const auto payload = bytes("packet from the serial port");
+    ASSERT_TRUE(queue.push(1, payload.data(), payload.size()));
+    ASSERT_TRUE(queue.flush());
+    EXPECT_EQ(inner.appendCalls, callsAfterBegin); // The I/O path returned without writing
+    EXPECT_GT(storage.pendingCount(), 0u);
+
+    // Reading the segment drains its pending frame first
+    uint8_t out[64];
+    ASSERT_EQ(queue.popNext(1, out, sizeof(out)), payload.size());
+    EXPECT_EQ(std::string(out, out + payload.size()), "packet from the serial port");
+}
+
+TEST_F(DeferredStorageManagerTest, LostWritesAreReportedWithTheirPath)
+{
+    std::vector<std::string> lost;
+    storage.setWriteLostCallback([](void* context, const char* path)
+    {
+        static_cast<std::vector<std::string>*>(context)->emplace_back(path);
+    }, &lost);
+
+    const auto data = bytes("lost");
+    ASSERT_TRUE(storage.appendBytesToFile("/a", data.data(), data.size()));
+    ASSERT_TRUE(storage.appendBytesToFile("/b", data.data(), data.size()));
+    inner.failWrites = true;
+    storage.drain();
+
+    ASSERT_EQ(lost.size(), 2u);
+    EXPECT_EQ(lost[0], "/a");
+    EXPECT_EQ(lost[1], "/b");
+}
+
+TEST_F(DeferredStorageManagerTest, PacketQueueResyncsAfterALostWrite)
+{
+    MockRTCController rtc;
+    PacketQueue queue(storage, rtc);
+    storage.setWriteLostCallback([](void* context, const char* path)
+    {
+        static_cast<PacketQueue*>(context)->onWriteLost(path);
+    }, &queue);
+    ASSERT_TRUE(queue.begin());
+
+    // The frame and its index record are accepted and then lost when drained
+    const auto lostPayload = bytes("never reaches the card");
+    ASSERT_TRUE(queue.push(1, lostPayload.data(), lostPayload.size()));
+    ASSERT_TRUE(queue.flush());
+    inner.failWrites = true;
+    storage.drain();
+    inner.failWrites = false;
+    EXPECT_EQ(storage.getStats().failures, 2u);
+
+    // The offsets follow the files again: the next packet is neither stalled behind the lost one nor misread
+    const auto payload = bytes("after the failure");
+    ASSERT_TRUE(queue.push(1, payload.data(), payload.size()));
+    EXPECT_EQ(queue.countPending(1), 1u);
+    uint8_t out[64];
+    ASSERT_EQ(queue.popNext(1, out, sizeof(out)), payload.size());
+    EXPECT_EQ(std::string(out, out + payload.size()), "after the failure");
+    EXPECT_EQ(queue.countPending(1), 0u);
+    EXPECT_EQ(queue.popNext(1, out, sizeof(out)), 0u);
+}
@@ -0,0 +1,226 @@
+#ifndef UNIT_TESTING
+#define UNIT_TESTING
+#endif
+
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "Logger/Logger.h"
+#include <ConsoleDisplay/ConsoleDisplay.hpp>
+#include "StorageManager/FdStorageManager/FdStorageManager.hpp"
+
+
+// =====================================================================
+// Fixture: cada test trabaja en un directorio temporal propio
+// =====================================================================
+class FdStorageManagerTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        Logger::initialize(&display, nullptr, nullptr, "LOG.TXT", Logger::Mode::SerialOnly);
+        root = std::filesystem::temp_directory_path()
+            / ("acousea_fd_" + std::string(::testing::UnitTest::GetInstance()->current_test_info()->name()));
+        std::filesystem::remove_all(root);
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove_all(root);
+    }
+
+    static std::vector<uint8_t> bytes(const std::string& text)
+    {
+        return {text.begin(), text.end()};
+    }
+
+    ConsoleDisplay display;
+    std::filesystem::path root;
+};
+
+// =====================================================================
+// TESTS
+// =====================================================================
+TEST_F(FdStorageManagerTest, AppendsAndReadsRegions)
+{
+    FdStorageManager storage(root.c_str());
+    ASSERT_TRUE(storage.begin());
+
+    const auto first = bytes("hello ");
+    const auto second = bytes("world");
+    ASSERT_TRUE(storage.appendBytesToFile("/queue1.000", first.data(), first.size()));
+    ASSERT_TRUE(storage.appendBytesToFile("/queue1.000", second.data(), second.size()));
+    EXPECT_EQ(storage.fileSize("/queue1.000"), 11u);
+
+    uint8_t out[16] = {};
+    ASSERT_EQ(storage.readFileRegionBytes("/queue1.000", 6, out, sizeof(out)), 5u);
+    EXPECT_EQ(std::string(reinterpret_cast<char*>(out), 5), "world");
+    EXPECT_EQ(storage.readFileRegionBytes("/queue1.000", 11, out, sizeof(out)), 0u);
+
+    // Handle reused: a single open for all of the above
+    EXPECT_EQ(storage.getStats().opens, 1u);
+}
+
+TEST_F(FdStorageManagerTest, VectoredAppendWritesPartsInOrder)
+{
+    FdStorageManager storage(root.c_str());
+    ASSERT_TRUE(storage.begin());
+
+    const auto a = bytes("[hdr]");
+    const auto b = bytes("payload");
+    const auto c = bytes("[end]");
+    const IoVec parts[] = {{a.data(), a.size()}, {nullptr, 0}, {b.data(), b.size()}, {c.data(), c.size()}};
+    ASSERT_TRUE(storage.appendBytesToFileV("/mod1", parts, 4));
+
+    uint8_t out[32] = {};
+    const size_t n = storage.readFileBytes("/mod1", out, sizeof(out));
+    EXPECT_EQ(std::string(reinterpret_cast<char*>(out), n), "[hdr]payload[end]");
+}
+
+TEST_F(FdStorageManagerTest, OverwriteTruncateAndRename)
+{
+    FdStorageManager storage(root.c_str());
+    ASSERT_TRUE(storage.begin());
+
+    const auto data = bytes("0123456789");
+    ASSERT_TRUE(storage.overwriteBytesToFile("/queue1.cur", data.data(), data.size()));
+    ASSERT_TRUE(storage.overwriteBytesToFile("/queue1.cur", data.data(), 4));
+    EXPECT_EQ(storage.fileSize("/queue1.cur"), 4u);
+
+    ASSERT_TRUE(storage.writeFileBytes("/log.txt", data.data(), data.size()));
+    ASSERT_TRUE(storage.truncateFileFromOffset("/log.txt", 7));
+    uint8_t out[16] = {};
+    ASSERT_EQ(storage.readFileBytes("/log.txt", out, sizeof(out)), 3u);
+    EXPECT_EQ(std::string(reinterpret_cast<char*>(out), 3), "789");
+
+    ASSERT_TRUE(storage.renameFile("/log.txt", "/log1.txt"));
+    EXPECT_FALSE(storage.fileExists("/log.txt"));
+    EXPECT_TRUE(storage.fileExists("/log1.txt"));
+
+    ASSERT_TRUE(storage.deleteFile("/log1.txt"));
+    EXPECT_FALSE(storage.fileExists("/log1.txt"));
+    EXPECT_FALSE(storage.deleteFile("/log1.txt"));
+}
+
+TEST_F(FdStorageManagerTest, MappedRegionsFollowAppendsAndTruncation)
+{
+    FdStorageManager storage(root.c_str());
+    ASSERT_TRUE(storage.begin());
+
+    const auto first = bytes("hello ");
+    const auto second = bytes("world");
+    ASSERT_TRUE(storage.appendBytesToFile("/queue1.000", first.data(), first.size()));
+    ASSERT_TRUE(storage.appendBytesToFile("/queue1.000", second.data(), second.size()));
+
+    ByteSpan span = storage.mapFileRegion("/queue1.000", 6, 64);
+    ASSERT_FALSE(span.empty());
+    EXPECT_EQ(std::string(reinterpret_cast<const char*>(span.data), span.length), "world");
+    EXPECT_TRUE(storage.mapFileRegion("/queue1.000", 11, 4).empty());
+    EXPECT_TRUE(storage.mapFileRegion("/missing", 0, 4).empty());
+
+    // Appends within the mapped window are visible without mapping again
+    ASSERT_TRUE(storage.appendBytesToFile("/queue1.000", first.data(), 1));
+    span = storage.mapFileRegion("/queue1.000", 10, 64);
+    EXPECT_EQ(std::string(reinterpret_cast<const char*>(span.data), span.length), "dh");
+    EXPECT_EQ(storage.getStats().maps, 1u);
+
+    // Shrinking drops the mapping; the next region maps the new contents
+    ASSERT_TRUE(storage.truncateFileFromOffset("/queue1.000", 6));
+    span = storage.mapFileRegion("/queue1.000", 0, 64);
+    EXPECT_EQ(std::string(reinterpret_cast<const char*>(span.data), span.length), "worldh");
+
+    FdStorageConfig noMap;
+    noMap.mmapReads = false;
+    FdStorageManager unmapped(root.c_str(), noMap);
+    EXPECT_TRUE(unmapped.mapFileRegion("/queue1.000", 0, 4).empty());
+}
+
+TEST_F(FdStorageManagerTest, PreallocatedFileIsWrittenInPlace)
+{
+    FdStorageManager storage(root.c_str());
+    ASSERT_TRUE(storage.begin());
+    ASSERT_TRUE(storage.supportsPreallocation());
+
+    const auto old = bytes("stale contents");
+    ASSERT_TRUE(storage.appendBytesToFile("/mod3", old.data(), old.size()));
+    ASSERT_TRUE(storage.preallocateFile("/mod3", 4096));
+    EXPECT_EQ(storage.fileSize("/mod3"), 4096u);
+
+    const auto header = bytes("<h>");
+    const auto payload = bytes("payload");
+    const IoVec parts[] = {{header.data(), header.size()}, {payload.data(), payload.size()}};
+    ASSERT_TRUE(storage.writeFileRegionV("/mod3", 100, parts, 2));
+    ASSERT_TRUE(storage.writeFileRegionV("/mod3", 0, parts, 1));
+    EXPECT_EQ(storage.fileSize("/mod3"), 4096u);
+
+    // The previous contents are gone and the unwritten extent reads as zeros
+    uint8_t out[16] = {};
+    ASSERT_EQ(storage.readFileRegionBytes("/mod3", 0, out, sizeof(out)), sizeof(out));
+    EXPECT_EQ(std::string(reinterpret_cast<char*>(out), 3), "<h>");
+    EXPECT_EQ(out[3], 0);
+    ASSERT_EQ(storage.readFileRegionBytes("/mod3", 100, out, 10), 10u);
+    EXPECT_EQ(std::string(reinterpret_cast<char*>(out), 10), "<h>payload");
+
+    // Appends on the same cached descriptor still go to the end
+    ASSERT_TRUE(storage.appendBytesToFile("/mod3", payload.data(), payload.size()));
+    EXPECT_EQ(storage.fileSize("/mod3"), 4096u + payload.size());
+}
+
+TEST_F(FdStorageManagerTest, ReadingMissingFileDoesNotCreateIt)
+{
+    FdStorageManager storage(root.c_str());
+    ASSERT_TRUE(storage.begin());
+
+    uint8_t out[4];
+    EXPECT_EQ(storage.readFileBytes("/missing", out, sizeof(out)), 0u);
+    EXPECT_FALSE(storage.fileExists("/missing"));
+}
+
+TEST_F(FdStorageManagerTest, EvictedHandlesAreReopened)
+{
+    FdStorageManager storage(root.c_str());
+    ASSERT_TRUE(storage.begin());
+
+    const auto data = bytes("x");
+    for (size_t i = 0; i < FdStorageManager::MAX_OPEN_FILES + 2; i++)
+    {
+        const std::string path = "/f" + std::to_string(i);
+        ASSERT_TRUE(storage.appendBytesToFile(path.c_str(), data.data(), data.size()));
+    }
+    // "/f0" was evicted: still readable through a new descriptor
+    uint8_t out[2] = {};
+    EXPECT_EQ(storage.readFileBytes("/f0", out, sizeof(out)), 1u);
+    EXPECT_EQ(storage.getStats().opens, FdStorageManager::MAX_OPEN_FILES + 3);
+}
+
+TEST_F(FdStorageManagerTest, SyncPolicies)
+{
+    const auto data = bytes("0123456789");
+
+    FdStorageConfig every;
+    every.syncPolicy = FdStorageConfig::SyncPolicy::EveryWrite;
+    FdStorageManager everyStorage((root / "every").c_str(), every);
+    ASSERT_TRUE(everyStorage.begin());
+    for (int i = 0; i < 3; i++)
+    {
+        ASSERT_TRUE(everyStorage.appendBytesToFile("/q", data.data(), data.size()));
+    }
+    EXPECT_EQ(everyStorage.getStats().syncs, 3u);
+
+    // Group commit: one fdatasync every 25 bytes (and one more at the explicit sync point)
+    FdStorageConfig group;
+    group.syncPolicy = FdStorageConfig::SyncPolicy::GroupCommit;
+    group.groupCommitBytes = 25;
+    group.groupCommitMs = 60000;
+    FdStorageManager groupStorage((root / "group").c_str(), group);
+    ASSERT_TRUE(groupStorage.begin());
+    for (int i = 0; i < 6; i++)
+    {
+        ASSERT_TRUE(groupStorage.appendBytesToFile("/q", data.data(), data.size()));
+    }
+    EXPECT_EQ(groupStorage.getStats().syncs, 2u);
+    ASSERT_TRUE(groupStorage.sync());
+    EXPECT_EQ(groupStorage.getStats().syncs, 2u); // Nothing pending after the 6th write (60 bytes: 30 + 30)
+}
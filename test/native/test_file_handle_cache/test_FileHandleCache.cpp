@@ -0,0 +1,229 @@
+#ifndef UNIT_TESTING
+#define UNIT_TESTING
+#endif
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <set>
+#include <string>
+
+#include "StorageManager/SDStorageManager/FileHandleCache/FileHandleCache.hpp"
+#include "StorageManager/SDStorageManager/SDLatencyModel/SDLatencyModel.hpp"
+
+
+// =====================================================================
+// Simulated SD file: accumulates the modelled latency of each operation
+// =====================================================================
+namespace
+{
+    struct ModelSd
+    {
+        SDLatencyModel model{};
+        uint64_t elapsedUs = 0;
+        uint32_t opens = 0;
+        uint32_t syncs = 0;
+        std::set<std::string> existing{};
+    };
+
+    ModelSd* currentSd = nullptr;
+
+    constexpr int O_READ = 0x1;
+    constexpr int O_CREATE = 0x2;
+
+    class ModelFile
+    {
+    public:
+        bool open(const char* path, const int flags)
+        {
+            currentSd->elapsedUs += currentSd->model.openUs;
+            currentSd->opens++;
+            if (!(flags & O_CREATE) && currentSd->existing.count(path) == 0)
+            {
+                return false;
+            }
+            currentSd->existing.insert(path);
+            open_ = true;
+            return true;
+        }
+
+        bool close()
+        {
+            if (dirty_)
+            {
+                currentSd->elapsedUs += currentSd->model.closeUs;
+            }
+            open_ = false;
+            dirty_ = false;
+            return true;
+        }
+
+        bool sync()
+        {
+            currentSd->elapsedUs += currentSd->model.syncUs;
+            currentSd->syncs++;
+            dirty_ = false;
+            return true;
+        }
+
+        [[nodiscard]] bool isOpen() const { return open_; }
+
+        void read(const size_t bytes) const
+        {
+            currentSd->elapsedUs += currentSd->model.seekUs + currentSd->model.readUs(bytes);
+        }
+
+        void write(const size_t bytes)
+        {
+            currentSd->elapsedUs += currentSd->model.writeUs(bytes);
+            dirty_ = true;
+        }
+
+    private:
+        bool open_ = false;
+        bool dirty_ = false;
+    };
+
+    using Cache = FileHandleCache<ModelFile, 4>;
+}
+
+class FileHandleCacheTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        currentSd = &sd;
+    }
+
+    void TearDown() override
+    {
+        currentSd = nullptr;
+    }
+
+    ModelSd sd;
+};
+
+// =====================================================================
+// TESTS
+// =====================================================================
+TEST_F(FileHandleCacheTest, ReusesOpenHandles)
+{
+    Cache cache;
+    ModelFile* first = cache.acquire("/queue1.000", O_READ | O_CREATE);
+    ASSERT_NE(first, nullptr);
+    EXPECT_EQ(cache.acquire("/queue1.000", O_READ), first);
+
+    EXPECT_EQ(sd.opens, 1u);
+    EXPECT_EQ(cache.getStats().hits, 1u);
+    EXPECT_EQ(cache.getStats().misses, 1u);
+}
+
+TEST_F(FileHandleCacheTest, EvictsLeastRecentlyUsed)
+{
+    Cache cache;
+    const char* paths[] = {"/a", "/b", "/c", "/d"};
+    for (const char* path : paths)
+    {
+        ASSERT_NE(cache.acquire(path, O_CREATE), nullptr);
+    }
+    ASSERT_NE(cache.acquire("/a", O_READ), nullptr); // "/b" is now the oldest
+
+    ASSERT_NE(cache.acquire("/e", O_CREATE), nullptr);
+    EXPECT_EQ(cache.getStats().evictions, 1u);
+    EXPECT_FALSE(cache.contains("/b"));
+    EXPECT_TRUE(cache.contains("/a"));
+    EXPECT_TRUE(cache.contains("/e"));
+}
+
+TEST_F(FileHandleCacheTest, FailedOpenIsNotCached)
+{
+    Cache cache;
+    EXPECT_EQ(cache.acquire("/missing", O_READ), nullptr);
+    EXPECT_FALSE(cache.contains("/missing"));
+
+    // Paths longer than the slot are rejected instead of truncated
+    const std::string longPath = "/" + std::string(Cache::PATH_MAX_LEN, 'x');
+    EXPECT_EQ(cache.acquire(longPath.c_str(), O_CREATE), nullptr);
+}
+
+TEST_F(FileHandleCacheTest, SyncOnlyTouchesWrittenHandles)
+{
+    Cache cache;
+    ModelFile* log = cache.acquire("/log.txt", O_CREATE, true);
+    ASSERT_NE(log, nullptr);
+    log->write(40);
+    ASSERT_NE(cache.acquire("/queue1.cur", O_CREATE), nullptr);
+
+    EXPECT_TRUE(cache.sync());
+    EXPECT_EQ(sd.syncs, 1u);
+
+    // Nothing pending: the next sync point is free
+    EXPECT_TRUE(cache.sync());
+    EXPECT_EQ(sd.syncs, 1u);
+}
+
+TEST_F(FileHandleCacheTest, SyncOfAPathLeavesTheOtherHandlesPending)
+{
+    Cache cache;
+    ModelFile* log = cache.acquire("/log.txt", O_CREATE, true);
+    ASSERT_NE(log, nullptr);
+    log->write(40);
+    ModelFile* cursor = cache.acquire("/queue1.cur", O_CREATE, true);
+    ASSERT_NE(cursor, nullptr);
+    cursor->write(32);
+
+    EXPECT_TRUE(cache.sync("/queue1.cur"));
+    EXPECT_EQ(sd.syncs, 1u);
+    EXPECT_TRUE(cache.sync("/queue1.cur"));
+    EXPECT_TRUE(cache.sync("/not/cached"));
+    EXPECT_EQ(sd.syncs, 1u);
+
+    // The log is still pending for the general sync point
+    EXPECT_TRUE(cache.sync());
+    EXPECT_EQ(sd.syncs, 2u);
+}
+
+TEST_F(FileHandleCacheTest, ReleaseClosesTheHandle)
+{
+    Cache cache;
+    ASSERT_NE(cache.acquire("/old.txt", O_CREATE), nullptr);
+    EXPECT_TRUE(cache.release("/old.txt"));
+    EXPECT_FALSE(cache.contains("/old.txt"));
+    EXPECT_TRUE(cache.release("/never.txt"));
+
+    ASSERT_NE(cache.acquire("/old.txt", O_READ), nullptr);
+    EXPECT_EQ(sd.opens, 2u);
+}
+
+TEST_F(FileHandleCacheTest, LatencyModelShowsCachedCycleIsFaster)
+{
+    // One operation cycle: peek 8 frames from a queue segment, read its index, append a log line per frame
+    constexpr int FRAMES = 8;
+    const SDLatencyModel& model = sd.model;
+
+    // Legacy SDStorageManager: open + fixed waits + close around every access
+    uint64_t legacyUs = 0;
+    for (int i = 0; i < FRAMES; i++)
+    {
+        legacyUs += model.openUs + 3ull * model.stabilizationDelayUs + model.seekUs + model.readUs(12); // index
+        legacyUs += model.openUs + 3ull * model.stabilizationDelayUs + model.seekUs + model.readUs(120); // frame
+        legacyUs += model.openUs + 2ull * model.stabilizationDelayUs + model.writeUs(60) + model.closeUs; // log
+    }
+
+    // Cached handles with a single sync point at the end of the cycle
+    Cache cache;
+    for (int i = 0; i < FRAMES; i++)
+    {
+        cache.acquire("/qidx1.000", O_CREATE)->read(12);
+        cache.acquire("/queue1.000", O_CREATE)->read(120);
+        cache.acquire("/log.txt", O_CREATE, true)->write(60);
+    }
+    ASSERT_TRUE(cache.sync());
+    const uint64_t cachedUs = sd.elapsedUs;
+
+    std::printf("[ INFO     ] Modelled cycle: legacy %.1f ms, cached %.1f ms (x%.0f)\n",
+                static_cast<double>(legacyUs) / 1000.0, static_cast<double>(cachedUs) / 1000.0,
+                static_cast<double>(legacyUs) / static_cast<double>(cachedUs));
+
+    EXPECT_EQ(sd.opens, 3u);
+    EXPECT_LT(cachedUs * 50, legacyUs);
+}
@@ -0,0 +1,127 @@
+#ifndef UNIT_TESTING
+#define UNIT_TESTING
+#endif
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "Logger/Logger.h"
+#include "ClassName.h"
+#include "Crc32/Crc32.hpp"
+#include <ConsoleDisplay/ConsoleDisplay.hpp>
+#include "MockRTCController/MockRTCController.h"
+
+// ................. Common test resources ..................
+#include "../common_test_resources/InMemoryStorageManager.hpp"
+
+
+/**
+ * @brief Clase con CLASS_NAME para volcar paquetes como los puertos.
+ */
+class HexDumpSource
+{
+    CLASS_NAME(HexDumpSource)
+
+public:
+    static void dump(const std::vector<uint8_t>& packet)
+    {
+        LOG_CLASS_DEBUG_HEX(packet.data(), packet.size(), "send(%d) -> ", static_cast<int>(packet.size()));
+    }
+};
+
+// =====================================================================
+// Fixture para los volcados hexadecimales del Logger
+// =====================================================================
+class HexDumpTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        Logger::initialize(nullptr, &storage, &rtc, "LOG.TXT", Logger::Mode::SDCard);
+    }
+
+    void TearDown() override
+    {
+        Logger::setHexDumpPolicy(HexDumpPolicy{});
+        Logger::initialize(&display, nullptr, nullptr, "LOG.TXT", Logger::Mode::SerialOnly);
+    }
+
+    std::string contents()
+    {
+        EXPECT_TRUE(Logger::flush());
+        std::vector<uint8_t> file(storage.fileSize("LOG.TXT"));
+        file.resize(storage.readFileBytes("LOG.TXT", file.data(), file.size()));
+        return {file.begin(), file.end()};
+    }
+
+    static std::vector<uint8_t> packet(const size_t length)
+    {
+        std::vector<uint8_t> data(length);
+        for (size_t i = 0; i < length; i++) data[i] = static_cast<uint8_t>(i * 37 + 5);
+        return data;
+    }
+
+    static std::string sprintfHex(const uint8_t* data, const size_t length)
+    {
+        std::string out;
+        char byte[3];
+        for (size_t i = 0; i < length; i++)
+        {
+            snprintf(byte, sizeof(byte), "%02X", data[i]);
+            out += byte;
+        }
+        return out;
+    }
+
+    ConsoleDisplay display;
+    InMemoryStorageManager storage;
+    MockRTCController rtc;
+};
+
+// =====================================================================
+// TESTS
+// =====================================================================
+TEST_F(HexDumpTest, EncoderMatchesSprintf)
+{
+    std::vector<uint8_t> all(256);
+    for (size_t i = 0; i < all.size(); i++) all[i] = static_cast<uint8_t>(i);
+    std::string encoded(all.size() * 2, '\0');
+    EXPECT_EQ(Logger::encodeHex(all.data(), all.size(), &encoded[0]), &encoded[0] + encoded.size());
+    EXPECT_EQ(encoded, sprintfHex(all.data(), all.size()));
+}
+
+TEST_F(HexDumpTest, WholePacketWhenItFits)
+{
+    const auto data = packet(40);
+    HexDumpSource::dump(data);
+    EXPECT_NE(contents().find("DEBUG: [HexDumpSource]: send(40) -> " + sprintfHex(data.data(), data.size()) + "\n"),
+              std::string::npos);
+}
+
+TEST_F(HexDumpTest, PolicyKeepsFirstBytesLengthAndCrc)
+{
+    HexDumpPolicy policy;
+    policy.maxBytes = 8;
+    Logger::setHexDumpPolicy(policy);
+
+    const auto data = packet(300);
+    HexDumpSource::dump(data);
+
+    char summary[64];
+    snprintf(summary, sizeof(summary), "... (300 bytes, crc32=%08lX)\n",
+             static_cast<unsigned long>(Crc32::compute(data.data(), data.size())));
+    EXPECT_NE(contents().find("send(300) -> " + sprintfHex(data.data(), 8) + summary), std::string::npos);
+}
+
+TEST_F(HexDumpTest, OversizedPacketIsCutToTheLine)
+{
+    const auto data = packet(4000);
+    HexDumpSource::dump(data);
+
+    const std::string text = contents();
+    EXPECT_NE(text.find("send(4000) -> " + sprintfHex(data.data(), 16)), std::string::npos);
+    EXPECT_NE(text.find("... (4000 bytes, crc32="), std::string::npos);
+    EXPECT_EQ(text.back(), '\n');
+}
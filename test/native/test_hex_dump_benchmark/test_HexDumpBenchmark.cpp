@@ -0,0 +1,118 @@
+#ifndef UNIT_TESTING
+#define UNIT_TESTING
+#endif
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "Logger/Logger.h"
+#include <ConsoleDisplay/ConsoleDisplay.hpp>
+#include "MockRTCController/MockRTCController.h"
+
+// ................. Common test resources ..................
+#include "../common_test_resources/InMemoryStorageManager.hpp"
+
+
+// =====================================================================
+// Fixture para el benchmark de los volcados hexadecimales
+// =====================================================================
+class HexDumpBenchmark : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        packet.resize(PACKET_SIZE);
+        for (size_t i = 0; i < packet.size(); i++) packet[i] = static_cast<uint8_t>(i * 131 + 7);
+        Logger::initialize(nullptr, &storage, &rtc, "LOG.TXT", Logger::Mode::SDCard);
+    }
+
+    void TearDown() override
+    {
+        Logger::setHexDumpPolicy(HexDumpPolicy{});
+        Logger::initialize(&display, nullptr, nullptr, "LOG.TXT", Logger::Mode::SerialOnly);
+    }
+
+    template <typename F>
+    static double nanosecondsPerRun(F&& run)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < RUNS; i++)
+        {
+            run();
+        }
+        const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start);
+        return elapsed.count() / RUNS;
+    }
+
+    static constexpr size_t RUNS = 20000;
+    static constexpr size_t PACKET_SIZE = 255; // Máximo de SerialPort::send
+
+    std::vector<uint8_t> packet;
+    ConsoleDisplay display;
+    InMemoryStorageManager storage;
+    MockRTCController rtc;
+};
+
+// =====================================================================
+// TESTS
+// =====================================================================
+TEST_F(HexDumpBenchmark, LookupTableVersusSprintf)
+{
+    char out[PACKET_SIZE * 2 + 1];
+    volatile char sink = 0;
+
+    const double sprintfNs = nanosecondsPerRun([&]
+    {
+        for (size_t i = 0; i < packet.size(); i++) sprintf(out + i * 2, "%02X", packet[i]);
+        sink = sink ^ out[PACKET_SIZE];
+    });
+    const double tableNs = nanosecondsPerRun([&]
+    {
+        *Logger::encodeHex(packet.data(), packet.size(), out) = '\0';
+        sink = sink ^ out[PACKET_SIZE];
+    });
+
+    std::printf("[BENCH] Hex of %zu bytes: sprintf %8.0f ns, lookup table %8.0f ns (x%.1f)\n",
+                PACKET_SIZE, sprintfNs, tableNs, sprintfNs / tableNs);
+
+    // Timings are informative only; the encoders must agree byte for byte
+    char expected[PACKET_SIZE * 2 + 1];
+    for (size_t i = 0; i < packet.size(); i++) sprintf(expected + i * 2, "%02X", packet[i]);
+    *Logger::encodeHex(packet.data(), packet.size(), out) = '\0';
+    EXPECT_STREQ(out, expected);
+}
+
+TEST_F(HexDumpBenchmark, LogLineWithAndWithoutPolicy)
+{
+    const double fullNs = nanosecondsPerRun([&]
+    {
+        LOG_DEBUG_HEX(packet.data(), packet.size(), "send() -> ");
+    });
+
+    HexDumpPolicy policy;
+    policy.maxBytes = 16;
+    Logger::setHexDumpPolicy(policy);
+    const double sampledNs = nanosecondsPerRun([&]
+    {
+        LOG_DEBUG_HEX(packet.data(), packet.size(), "send() -> ");
+    });
+
+    Logger::setLevel(Logger::Level::Info);
+    const double disabledNs = nanosecondsPerRun([&]
+    {
+        LOG_DEBUG_HEX(packet.data(), packet.size(), "send() -> ");
+    });
+    Logger::setLevel(Logger::Level::Debug);
+
+    std::printf("[BENCH] LOG_DEBUG_HEX of %zu bytes to the SD ring: full %8.0f ns, first 16 + crc %8.0f ns, "
+                "level off %6.1f ns\n", PACKET_SIZE, fullNs, sampledNs, disabledNs);
+    EXPECT_TRUE(Logger::flush());
+
+    // Not timed: with the level off nothing reaches the ring
+    Logger::setLevel(Logger::Level::Info);
+    LOG_DEBUG_HEX(packet.data(), packet.size(), "send() -> ");
+    EXPECT_EQ(Logger::getBufferedBytes(), 0u);
+    Logger::setLevel(Logger::Level::Debug);
+}
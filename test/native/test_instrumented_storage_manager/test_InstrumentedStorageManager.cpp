@@ -0,0 +1,106 @@
+#ifndef UNIT_TESTING
+#define UNIT_TESTING
+#endif
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <thread>
+
+#include "Logger/Logger.h"
+#include <ConsoleDisplay/ConsoleDisplay.hpp>
+#include "StorageManager/InstrumentedStorageManager/InstrumentedStorageManager.hpp"
+
+// ................. Common test resources ..................
+#include "../common_test_resources/InMemoryStorageManager.hpp"
+
+
+/**
+ * @brief InMemoryStorageManager cuya lectura de regiones tarda unos milisegundos.
+ */
+class SlowReadStorageManager : public InMemoryStorageManager
+{
+public:
+    size_t readFileRegionBytes(const char* path, const size_t offset, uint8_t* outBuffer,
+                               const size_t outBufferLen) override
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(3));
+        return InMemoryStorageManager::readFileRegionBytes(path, offset, outBuffer, outBufferLen);
+    }
+};
+
+using Op = InstrumentedStorageManager::Op;
+
+// =====================================================================
+// Fixture para InstrumentedStorageManager
+// =====================================================================
+class InstrumentedStorageManagerTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        Logger::initialize(&display, nullptr, nullptr, "LOG.TXT", Logger::Mode::SerialOnly);
+    }
+
+    ConsoleDisplay display;
+    SlowReadStorageManager inner;
+    InstrumentedStorageManager storage{inner};
+};
+
+// =====================================================================
+// TESTS
+// =====================================================================
+TEST_F(InstrumentedStorageManagerTest, CountsCallsBytesAndFailures)
+{
+    const uint8_t data[10] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+    ASSERT_TRUE(storage.appendBytesToFile("/a", data, sizeof(data)));
+    ASSERT_TRUE(storage.appendBytesToFile("/a", data, 4));
+    const IoVec parts[] = {{data, 3}, {data, 5}};
+    ASSERT_TRUE(storage.appendBytesToFileV("/a", parts, 2));
+    EXPECT_TRUE(storage.fileExists("/a"));
+    EXPECT_FALSE(storage.fileExists("/b"));
+    EXPECT_EQ(storage.fileSize("/a"), 22u);
+
+    EXPECT_EQ(storage.stats(Op::Append).calls, 2u);
+    EXPECT_EQ(storage.stats(Op::Append).bytes, 14u);
+    EXPECT_EQ(storage.stats(Op::AppendV).bytes, 8u);
+    EXPECT_EQ(storage.stats(Op::Exists).calls, 2u);
+    EXPECT_EQ(storage.stats(Op::Exists).failures, 1u);
+    EXPECT_EQ(storage.stats(Op::FileSize).calls, 1u);
+    EXPECT_EQ(storage.stats(Op::ReadRegion).calls, 0u);
+}
+
+TEST_F(InstrumentedStorageManagerTest, LatencyLandsInLog2Buckets)
+{
+    const uint8_t data[4] = {1, 2, 3, 4};
+    ASSERT_TRUE(storage.appendBytesToFile("/a", data, sizeof(data)));
+
+    uint8_t out[4];
+    ASSERT_EQ(storage.readFileRegionBytes("/a", 0, out, sizeof(out)), 4u);
+    ASSERT_EQ(storage.readFileRegionBytes("/a", 2, out, sizeof(out)), 2u);
+
+    const auto& reads = storage.stats(Op::ReadRegion);
+    EXPECT_EQ(reads.calls, 2u);
+    EXPECT_EQ(reads.bytes, 6u);
+    EXPECT_GE(reads.maxUs, 3000u);
+    EXPECT_GT(reads.histogram[InstrumentedStorageManager::bucketOf(reads.maxUs)], 0u);
+
+    // 3 ms falls in [2048, 4096) us or above: the percentile bound is at least the sleep and at most the max
+    EXPECT_GE(storage.percentileUs(Op::ReadRegion, 50), 3000u);
+    EXPECT_LE(storage.percentileUs(Op::ReadRegion, 99), reads.maxUs);
+    EXPECT_EQ(storage.percentileUs(Op::Delete, 50), 0u);
+
+    storage.logSummary();
+    storage.reset();
+    EXPECT_EQ(storage.stats(Op::ReadRegion).calls, 0u);
+}
+
+TEST_F(InstrumentedStorageManagerTest, BucketBoundaries)
+{
+    EXPECT_EQ(InstrumentedStorageManager::bucketOf(0), 0u);
+    EXPECT_EQ(InstrumentedStorageManager::bucketOf(1), 1u);
+    EXPECT_EQ(InstrumentedStorageManager::bucketOf(1023), 10u);
+    EXPECT_EQ(InstrumentedStorageManager::bucketOf(1024), 11u);
+    EXPECT_EQ(InstrumentedStorageManager::bucketOf(UINT32_MAX), InstrumentedStorageManager::LATENCY_BUCKETS - 1);
+    EXPECT_EQ(InstrumentedStorageManager::bucketUpperUs(10), 1023u);
+    EXPECT_EQ(InstrumentedStorageManager::bucketUpperUs(InstrumentedStorageManager::LATENCY_BUCKETS - 1), UINT32_MAX);
+}
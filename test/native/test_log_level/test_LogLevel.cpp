@@ -0,0 +1,102 @@
+#ifndef UNIT_TESTING
+#define UNIT_TESTING
+#endif
+
+// Nivel compilado de este test (en los entornos va en platformio.ini)
+#define LOG_LEVEL LOG_LEVEL_WARNING
+
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+#include "Logger/Logger.h"
+#include <ConsoleDisplay/ConsoleDisplay.hpp>
+#include "MockRTCController/MockRTCController.h"
+
+// ................. Common test resources ..................
+#include "../common_test_resources/InMemoryStorageManager.hpp"
+
+
+namespace
+{
+    int evaluations = 0;
+
+    // Argumento "caro": cuenta cuántas veces se evalúa
+    const char* expensiveArgument()
+    {
+        evaluations++;
+        return "payload";
+    }
+}
+
+// =====================================================================
+// Fixture para los niveles de log
+// =====================================================================
+class LogLevelTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        evaluations = 0;
+        Logger::initialize(nullptr, &storage, &rtc, "LOG.TXT", Logger::Mode::SDCard);
+    }
+
+    void TearDown() override
+    {
+        Logger::setLevel(Logger::Level::Debug);
+        Logger::initialize(&display, nullptr, nullptr, "LOG.TXT", Logger::Mode::SerialOnly);
+    }
+
+    std::string contents()
+    {
+        EXPECT_TRUE(Logger::flush());
+        std::vector<uint8_t> file(storage.fileSize("LOG.TXT"));
+        file.resize(storage.readFileBytes("LOG.TXT", file.data(), file.size()));
+        return {file.begin(), file.end()};
+    }
+
+    ConsoleDisplay display;
+    InMemoryStorageManager storage;
+    MockRTCController rtc;
+};
+
+// =====================================================================
+// TESTS
+// =====================================================================
+TEST_F(LogLevelTest, CompiledOutLevelsDoNotEvaluateArguments)
+{
+    LOG_DEBUG("debug %s", expensiveArgument());
+    LOG_INFO("info %s", expensiveArgument());
+    EXPECT_EQ(evaluations, 0);
+
+    LOG_WARNING("warning %s", expensiveArgument());
+    LOG_ERROR("error %s", expensiveArgument());
+    EXPECT_EQ(evaluations, 2);
+
+    const std::string text = contents();
+    EXPECT_EQ(text.find("info payload"), std::string::npos);
+    EXPECT_NE(text.find("WARNING: warning payload"), std::string::npos);
+    EXPECT_NE(text.find("ERROR: error payload"), std::string::npos);
+}
+
+TEST_F(LogLevelTest, RuntimeLevelSkipsArgumentsToo)
+{
+    Logger::setLevel(Logger::Level::Error);
+    LOG_WARNING("warning %s", expensiveArgument());
+    Logger::logWarning("direct warning");
+    EXPECT_EQ(evaluations, 0);
+
+    LOG_ERROR("error %s", expensiveArgument());
+    EXPECT_EQ(evaluations, 1);
+
+    const std::string text = contents();
+    EXPECT_EQ(text.find("warning"), std::string::npos);
+    EXPECT_NE(text.find("ERROR: error payload"), std::string::npos);
+}
+
+TEST_F(LogLevelTest, DisabledMacrosAreStillExpressions)
+{
+    const bool ok = false;
+    ok ? LOG_INFO("never") : LOG_ERROR("conditional %d", 1);
+    EXPECT_NE(contents().find("ERROR: conditional 1"), std::string::npos);
+}
@@ -0,0 +1,169 @@
+#ifndef UNIT_TESTING
+#define UNIT_TESTING
+#endif
+
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+#include "Logger/Logger.h"
+#include <ConsoleDisplay/ConsoleDisplay.hpp>
+#include "MockRTCController/MockRTCController.h"
+#include "time/TimeService.hpp"
+
+// ................. Common test resources ..................
+#include "../common_test_resources/InMemoryStorageManager.hpp"
+
+/**
+ * @brief InMemoryStorageManager que puede registrar un log desde dentro de sus escrituras, como un backend real.
+ */
+class LoggingStorageManager : public InMemoryStorageManager
+{
+public:
+    bool appendBytesToFileV(const char* path, const IoVec* parts, const size_t count) override
+    {
+        if (logOnWrite) LOG_WARNING("card busy, retrying");
+        return InMemoryStorageManager::appendBytesToFileV(path, parts, count);
+    }
+
+    bool logOnWrite = false;
+};
+
+
+// =====================================================================
+// Fixture para la rotación del log
+// =====================================================================
+class LogRotationTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        rtc.setEpoch(1700000000);
+        Logger::initialize(nullptr, &storage, &rtc, "/LOG.TXT", Logger::Mode::SDCard);
+        config.segmentBytes = 1000;
+        config.maxSegments = 3;
+        ASSERT_TRUE(Logger::enableRotation(config));
+    }
+
+    void TearDown() override
+    {
+        Logger::initialize(&display, nullptr, nullptr, "LOG.TXT", Logger::Mode::SerialOnly);
+    }
+
+    std::string contents(const char* path)
+    {
+        std::vector<uint8_t> file(storage.fileSize(path));
+        file.resize(storage.readFileBytes(path, file.data(), file.size()));
+        return {file.begin(), file.end()};
+    }
+
+    static void logLines(const int count, int& next)
+    {
+        const std::string filler(60, 'r');
+        for (int i = 0; i < count; i++)
+        {
+            LOG_INFO("line %04d %s", next++, filler.c_str());
+        }
+    }
+
+    ConsoleDisplay display;
+    LoggingStorageManager storage;
+    MockRTCController rtc;
+    LogRotationConfig config;
+};
+
+// =====================================================================
+// TESTS
+// =====================================================================
+TEST_F(LogRotationTest, SegmentsAreCappedAndReusedInCircle)
+{
+    int next = 0;
+    logLines(60, next); // ~6 KB: two full turns over three 1 KB segments
+    ASSERT_TRUE(Logger::flush());
+
+    const char* paths[] = {"/LOG000.TXT", "/LOG001.TXT", "/LOG002.TXT"};
+    size_t lines = 0;
+    std::string all;
+    for (const char* path : paths)
+    {
+        const std::string text = contents(path);
+        all += text;
+        ASSERT_FALSE(text.empty()) << path;
+        EXPECT_LE(text.size(), config.segmentBytes) << path;
+        EXPECT_EQ(text.front(), '[') << path; // Starts and ends on line boundaries
+        EXPECT_EQ(text.back(), '\n') << path;
+        for (const char c : text) lines += c == '\n' ? 1 : 0;
+    }
+    EXPECT_LT(lines, 60u); // The oldest segments were emptied when reused
+    EXPECT_NE(all.find("line 0059"), std::string::npos);
+    EXPECT_EQ(all.find("line 0000"), std::string::npos);
+    EXPECT_FALSE(storage.fileExists("/LOG.TXT"));
+    EXPECT_EQ(storage.fileSize("/LOG.idx"), 3u * 8u);
+}
+
+TEST_F(LogRotationTest, RotationResumesFromTheIndex)
+{
+    int next = 0;
+    logLines(15, next); // ~10 lines per segment: the second one is half full
+    ASSERT_TRUE(Logger::flush());
+    Logger::LogSegment before[3];
+    ASSERT_EQ(Logger::getSegmentsSince(0, before, 3), 2u);
+
+    // After a reset the current segment keeps growing instead of starting over
+    const size_t currentSize = storage.fileSize(before[1].path);
+    Logger::initialize(nullptr, &storage, &rtc, "/LOG.TXT", Logger::Mode::SDCard);
+    ASSERT_TRUE(Logger::enableRotation(config));
+    logLines(1, next);
+    ASSERT_TRUE(Logger::flush());
+    EXPECT_GT(storage.fileSize(before[1].path), currentSize);
+
+    Logger::LogSegment after[3];
+    ASSERT_EQ(Logger::getSegmentsSince(0, after, 3), 2u);
+    EXPECT_STREQ(after[1].path, before[1].path);
+}
+
+TEST_F(LogRotationTest, RecentSegmentsAreFoundByTimestamp)
+{
+    int next = 0;
+    logLines(12, next); // Segment 0 and the start of segment 1
+    rtc.setEpoch(1700000600);
+    TimeService::resync();
+    logLines(14, next); // Rotates to segment 2 at +10 min
+    rtc.setEpoch(1700001200);
+    TimeService::resync();
+    ASSERT_TRUE(Logger::flush());
+
+    Logger::LogSegment segments[3];
+    const size_t all = Logger::getSegmentsSince(0, segments, 3);
+    ASSERT_EQ(all, 3u);
+    EXPECT_STREQ(segments[0].path, "/LOG000.TXT");
+    EXPECT_EQ(segments[0].startEpoch, 1700000000u);
+    EXPECT_STREQ(segments[2].path, "/LOG002.TXT");
+    EXPECT_EQ(segments[2].startEpoch, 1700000600u);
+
+    // Last 5 minutes: only the current segment has lines that recent
+    ASSERT_EQ(Logger::getSegmentsSince(1700000900, segments, 3), 1u);
+    EXPECT_STREQ(segments[0].path, "/LOG002.TXT");
+
+    // Less room than segments: the most recent ones are kept
+    ASSERT_EQ(Logger::getSegmentsSince(0, segments, 2), 2u);
+    EXPECT_STREQ(segments[0].path, "/LOG001.TXT");
+}
+
+TEST_F(LogRotationTest, LineThatRotatesIsIntactWhenTheStorageLogs)
+{
+    storage.logOnWrite = true;
+    int next = 0;
+    logLines(15, next); // The line that does not fit in segment 0 flushes it before being copied
+    storage.logOnWrite = false;
+    ASSERT_TRUE(Logger::flush());
+
+    const std::string all = contents("/LOG000.TXT") + contents("/LOG001.TXT");
+    const std::string filler(60, 'r');
+    for (int i = 0; i < 15; i++)
+    {
+        char line[16];
+        snprintf(line, sizeof(line), "line %04d ", i);
+        EXPECT_NE(all.find(line + filler + "\n"), std::string::npos) << line;
+    }
+}
@@ -0,0 +1,168 @@
+#ifndef UNIT_TESTING
+#define UNIT_TESTING
+#endif
+
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+#include "Logger/Logger.h"
+#include <ConsoleDisplay/ConsoleDisplay.hpp>
+#include "MockRTCController/MockRTCController.h"
+#include "time/getMillis.hpp"
+
+// ................. Common test resources ..................
+#include "../common_test_resources/InMemoryStorageManager.hpp"
+
+
+/**
+ * @brief InMemoryStorageManager que cuenta las escrituras del Logger y puede fallarlas.
+ */
+class CountingStorageManager : public InMemoryStorageManager
+{
+public:
+    bool appendBytesToFileV(const char* path, const IoVec* parts, const size_t count) override
+    {
+        appendCalls++;
+        if (logOnWrite) LOG_WARNING("card busy, retrying"); // Like a backend reporting from inside the write
+        return !failWrites && InMemoryStorageManager::appendBytesToFileV(path, parts, count);
+    }
+
+    size_t appendCalls = 0;
+    bool failWrites = false;
+    bool logOnWrite = false;
+};
+
+// =====================================================================
+// Fixture para el anillo de escritura a SD del Logger
+// =====================================================================
+class LoggerRingTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        Logger::initialize(nullptr, &storage, &rtc, "LOG.TXT", Logger::Mode::SDCard);
+    }
+
+    void TearDown() override
+    {
+        Logger::initialize(&display, nullptr, nullptr, "LOG.TXT", Logger::Mode::SerialOnly);
+    }
+
+    std::string contents()
+    {
+        std::vector<uint8_t> file(storage.fileSize("LOG.TXT"));
+        file.resize(storage.readFileBytes("LOG.TXT", file.data(), file.size()));
+        return {file.begin(), file.end()};
+    }
+
+    static size_t countLines(const std::string& text)
+    {
+        size_t lines = 0;
+        for (const char c : text) lines += c == '\n' ? 1 : 0;
+        return lines;
+    }
+
+    ConsoleDisplay display;
+    CountingStorageManager storage;
+    MockRTCController rtc;
+};
+
+// =====================================================================
+// TESTS
+// =====================================================================
+TEST_F(LoggerRingTest, LinesAreWrittenInOneChunk)
+{
+    for (int i = 0; i < 10; i++)
+    {
+        LOG_INFO("line %d", i);
+    }
+    EXPECT_EQ(storage.appendCalls, 0u);
+    EXPECT_GT(Logger::getBufferedBytes(), 0u);
+
+    ASSERT_TRUE(Logger::flush());
+    EXPECT_EQ(storage.appendCalls, 1u);
+    EXPECT_EQ(Logger::getBufferedBytes(), 0u);
+
+    const std::string text = contents();
+    EXPECT_EQ(countLines(text), 10u);
+    EXPECT_NE(text.find("INFO: line 0\n"), std::string::npos);
+    EXPECT_NE(text.find("INFO: line 9\n"), std::string::npos);
+}
+
+TEST_F(LoggerRingTest, ErrorsAreWrittenImmediately)
+{
+    LOG_INFO("before the error");
+    LOG_WARNING("still buffered");
+    EXPECT_EQ(storage.appendCalls, 0u);
+
+    LOG_ERROR("something failed");
+    EXPECT_EQ(storage.appendCalls, 1u);
+    EXPECT_EQ(countLines(contents()), 3u);
+}
+
+TEST_F(LoggerRingTest, FlushesOnSizeAndTime)
+{
+    const std::string filler(100, 'x');
+    size_t lines = 0;
+    while (storage.appendCalls == 0)
+    {
+        LOG_INFO("%s", filler.c_str());
+        lines++;
+    }
+    // A single chunk with the lines that fill 3/4 of the ring
+    EXPECT_GT(lines, 10u);
+    EXPECT_EQ(countLines(contents()), lines);
+
+    LOG_INFO("waiting for the interval");
+    EXPECT_EQ(storage.appendCalls, 1u);
+    advanceClockMicros(6000UL * 1000UL);
+    LOG_INFO("interval elapsed");
+    EXPECT_EQ(storage.appendCalls, 2u);
+}
+
+TEST_F(LoggerRingTest, FullRingDropsLinesAndReportsThem)
+{
+    storage.failWrites = true;
+    const std::string filler(200, 'y');
+    for (int i = 0; i < 100; i++)
+    {
+        LOG_INFO("%s", filler.c_str());
+    }
+    EXPECT_GT(Logger::getDroppedLines(), 0u);
+    EXPECT_FALSE(Logger::flush());
+
+    // The kept lines are written once the SD answers again, followed by the dropped-lines warning
+    storage.failWrites = false;
+    const uint32_t dropped = Logger::getDroppedLines();
+    ASSERT_TRUE(Logger::flush());
+    ASSERT_TRUE(Logger::flush());
+    const std::string text = contents();
+    EXPECT_EQ(countLines(text), 100u - dropped + 1u);
+    EXPECT_NE(text.find("WARNING: [Logger]: " + std::to_string(dropped) + " log lines dropped"), std::string::npos);
+}
+
+TEST_F(LoggerRingTest, LineIsIntactWhenTheStorageLogsDuringTheFlushThatMakesRoom)
+{
+    // Ring full after failed writes: the next line needs a flush before it is copied
+    storage.failWrites = true;
+    const std::string filler(200, 'z');
+    for (int i = 0; i < 100; i++)
+    {
+        LOG_INFO("%s", filler.c_str());
+    }
+    ASSERT_GT(Logger::getDroppedLines(), 0u);
+
+    storage.failWrites = false;
+    storage.logOnWrite = true;
+    advanceClockMicros(6000UL * 1000UL);
+    LOG_INFO("%s", std::string(300, 'o').c_str());
+    storage.logOnWrite = false;
+    ASSERT_TRUE(Logger::flush());
+    ASSERT_TRUE(Logger::flush());
+
+    const std::string text = contents();
+    EXPECT_NE(text.find("INFO: " + std::string(300, 'o') + "\n"), std::string::npos);
+    // The dropped-lines warning is written by a later flush, not in place of the line
+    EXPECT_NE(text.find("log lines dropped"), std::string::npos);
+}
@@ -0,0 +1,1046 @@
+#ifndef UNIT_TESTING
+#define UNIT_TESTING
+#endif
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "Logger/Logger.h"
+#include <ConsoleDisplay/ConsoleDisplay.hpp>
+#include "PacketQueue/PacketQueue.hpp"
+#include "MockRTCController/MockRTCController.h"
+#include "BinaryFrame/BinaryFrame.hpp"
+#include "SharedMemory/SharedMemory.hpp"
+
+// ................. Common test resources ..................
+#include "../common_test_resources/InMemoryStorageManager.hpp"
+
+
+/**
+ * @brief InMemoryStorageManager que recuerda el tamaño pedido en la última lectura de cada región.
+ */
+class ReadTrackingStorageManager : public InMemoryStorageManager
+{
+public:
+    size_t readFileRegionBytes(const char* path, const size_t offset, uint8_t* outBuffer,
+                               const size_t outBufferLen) override
+    {
+        lastRegionReadLength = outBufferLen;
+        if (std::strncmp(path, "/queue", 6) == 0) segmentRegionReads++;
+        return InMemoryStorageManager::readFileRegionBytes(path, offset, outBuffer, outBufferLen);
+    }
+
+    size_t fileSize(const char* path) override
+    {
+        if (!fileExists(path)) missingFileSizeQueries++;
+        return InMemoryStorageManager::fileSize(path);
+    }
+
+    size_t lastRegionReadLength = 0;
+    size_t segmentRegionReads = 0; // Reads of queue segments (index and cursor files excluded)
+    size_t missingFileSizeQueries = 0; // The SD/Fd backends log these as errors
+};
+
+/**
+ * @brief InMemoryStorageManager que cuenta los puntos de sincronización.
+ */
+class SyncTrackingStorageManager : public InMemoryStorageManager
+{
+public:
+    bool sync() override
+    {
+        syncs++;
+        return InMemoryStorageManager::sync();
+    }
+
+    bool syncFile(const char* path) override
+    {
+        syncedFiles.emplace_back(path);
+        return true; // Counted apart from sync()
+    }
+
+    size_t syncs = 0;
+    std::vector<std::string> syncedFiles;
+};
+
+
+
+// =====================================================================
+// Fixture para PacketQueue
+// =====================================================================
+class PacketQueueTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        Logger::initialize(&display, nullptr, nullptr, "LOG.TXT", Logger::Mode::SerialOnly);
+    }
+
+    static std::vector<uint8_t> makePayload(const uint8_t seed, const uint16_t length)
+    {
+        std::vector<uint8_t> payload(length);
+        for (uint16_t i = 0; i < length; i++)
+        {
+            payload[i] = static_cast<uint8_t>(seed + i);
+        }
+        return payload;
+    }
+
+    static constexpr uint8_t PORT = 1;
+
+    ConsoleDisplay display;
+    InMemoryStorageManager storage;
+    MockRTCController rtc;
+};
+
+// =====================================================================
+// TESTS
+// =====================================================================
+TEST_F(PacketQueueTest, PushThenPopPreservesOrder)
+{
+    PacketQueue queue(storage, rtc);
+    ASSERT_TRUE(queue.begin());
+    ASSERT_TRUE(queue.isEmpty());
+
+    for (uint8_t i = 0; i < 5; i++)
+    {
+        const auto payload = makePayload(i, 10 + i);
+        ASSERT_TRUE(queue.push(PORT, payload.data(), payload.size()));
+    }
+    EXPECT_FALSE(queue.isPortEmpty(PORT));
+
+    uint8_t out[64];
+    for (uint8_t i = 0; i < 5; i++)
+    {
+        const auto expected = makePayload(i, 10 + i);
+        const uint16_t len = queue.popNext(PORT, out, sizeof(out));
+        ASSERT_EQ(len, expected.size());
+        EXPECT_EQ(std::vector<uint8_t>(out, out + len), expected);
+    }
+    EXPECT_TRUE(queue.isPortEmpty(PORT));
+    EXPECT_EQ(queue.popNext(PORT, out, sizeof(out)), 0u);
+}
+
+TEST_F(PacketQueueTest, PeekDoesNotConsumeUntilSkip)
+{
+    PacketQueue queue(storage, rtc);
+    ASSERT_TRUE(queue.begin());
+
+    const auto first = makePayload(1, 8);
+    const auto second = makePayload(2, 8);
+    ASSERT_TRUE(queue.push(PORT, first.data(), first.size()));
+    ASSERT_TRUE(queue.push(PORT, second.data(), second.size()));
+
+    uint8_t out[32];
+    ASSERT_EQ(queue.peekNext(PORT, out, sizeof(out)), first.size());
+    ASSERT_EQ(queue.peekNext(PORT, out, sizeof(out)), first.size());
+    EXPECT_EQ(std::vector<uint8_t>(out, out + first.size()), first);
+
+    ASSERT_TRUE(queue.skipToNextPacket(PORT));
+    ASSERT_EQ(queue.peekNext(PORT, out, sizeof(out)), second.size());
+    EXPECT_EQ(std::vector<uint8_t>(out, out + second.size()), second);
+}
+
+TEST_F(PacketQueueTest, UnreadPacketsSurviveRestart)
+{
+    {
+        PacketQueue queue(storage, rtc);
+        ASSERT_TRUE(queue.begin());
+        for (uint8_t i = 0; i < 3; i++)
+        {
+            const auto payload = makePayload(i, 16);
+            ASSERT_TRUE(queue.push(PORT, payload.data(), payload.size()));
+        }
+        uint8_t out[32];
+        ASSERT_EQ(queue.popNext(PORT, out, sizeof(out)), 16u);
+    }
+
+    // Simula un reinicio: nueva instancia sobre el mismo almacenamiento
+    PacketQueue rebooted(storage, rtc);
+    ASSERT_TRUE(rebooted.begin());
+    ASSERT_FALSE(rebooted.isPortEmpty(PORT));
+
+    uint8_t out[32];
+    for (uint8_t i = 1; i < 3; i++)
+    {
+        const auto expected = makePayload(i, 16);
+        const uint16_t len = rebooted.popNext(PORT, out, sizeof(out));
+        ASSERT_EQ(len, expected.size());
+        EXPECT_EQ(std::vector<uint8_t>(out, out + len), expected);
+    }
+    EXPECT_TRUE(rebooted.isPortEmpty(PORT));
+}
+
+TEST_F(PacketQueueTest, RotationDeletesConsumedSegments)
+{
+    PacketQueue queue(storage, rtc);
+    ASSERT_TRUE(queue.begin());
+
+    constexpr uint16_t payloadLen = 1000;
+    constexpr size_t framesPerSegment =
+        PacketQueue::SEGMENT_MAX_BYTES / BinaryFrame::requiredSize(payloadLen, PacketQueue::FRAME_VERSION);
+    constexpr size_t totalFrames = framesPerSegment * 3 + 1;
+
+    for (size_t i = 0; i < totalFrames; i++)
+    {
+        const auto payload = makePayload(static_cast<uint8_t>(i), payloadLen);
+        ASSERT_TRUE(queue.push(PORT, payload.data(), payload.size()));
+    }
+    EXPECT_TRUE(storage.exists("/queue1.000"));
+    EXPECT_TRUE(storage.exists("/queue1.003"));
+
+    std::vector<uint8_t> out(payloadLen);
+    for (size_t i = 0; i < totalFrames; i++)
+    {
+        const auto expected = makePayload(static_cast<uint8_t>(i), payloadLen);
+        ASSERT_EQ(queue.popNext(PORT, out.data(), out.size()), payloadLen);
+        ASSERT_EQ(out, expected);
+    }
+
+    EXPECT_TRUE(queue.isPortEmpty(PORT));
+    EXPECT_FALSE(storage.exists("/queue1.000"));
+    EXPECT_FALSE(storage.exists("/queue1.001"));
+    EXPECT_FALSE(storage.exists("/queue1.002"));
+    EXPECT_TRUE(storage.exists("/queue1.003"));
+}
+
+TEST_F(PacketQueueTest, StagedFramesAreCoalescedIntoOneAppend)
+{
+    PacketQueue queue(storage, rtc);
+    ASSERT_TRUE(queue.begin());
+
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        const auto payload = makePayload(i, 20);
+        ASSERT_TRUE(queue.push(PORT, payload.data(), payload.size()));
+    }
+    // Nada escrito todavía, pero el puerto no está vacío
+    EXPECT_EQ(storage.fileSize("/queue1.000"), 0u);
+    EXPECT_FALSE(queue.isPortEmpty(PORT));
+
+    ASSERT_TRUE(queue.flush());
+    EXPECT_EQ(storage.fileSize("/queue1.000"), 4 * BinaryFrame::requiredSize(20, PacketQueue::FRAME_VERSION));
+}
+
+TEST_F(PacketQueueTest, LargeFrameIsAppendedInPartsWithoutStaging)
+{
+    PacketQueue queue(storage, rtc);
+    ASSERT_TRUE(queue.begin());
+
+    const auto payload = makePayload(3, PacketQueue::STAGING_BUFFER_SIZE + 100);
+    ASSERT_TRUE(queue.push(PORT, payload.data(), payload.size()));
+    EXPECT_EQ(storage.fileSize("/queue1.000"), BinaryFrame::requiredSize(payload.size(), PacketQueue::FRAME_VERSION));
+
+    std::vector<uint8_t> out(SharedMemory::tmpBufferSize());
+    ASSERT_EQ(queue.popNext(PORT, out.data(), out.size()), payload.size());
+    EXPECT_TRUE(std::equal(payload.begin(), payload.end(), out.begin()));
+
+    // Frames that could not be peeked into the shared buffer are rejected
+    const auto huge = makePayload(4, SharedMemory::tmpBufferSize());
+    EXPECT_FALSE(queue.push(PORT, huge.data(), huge.size()));
+}
+
+TEST_F(PacketQueueTest, PeekFlushesStagedFramesOfSamePort)
+{
+    PacketQueue queue(storage, rtc);
+    ASSERT_TRUE(queue.begin());
+
+    const auto payload = makePayload(3, 12);
+    ASSERT_TRUE(queue.push(PORT, payload.data(), payload.size()));
+
+    uint8_t out[32];
+    ASSERT_EQ(queue.peekNext(PORT, out, sizeof(out)), payload.size());
+    EXPECT_EQ(std::vector<uint8_t>(out, out + payload.size()), payload);
+    EXPECT_EQ(storage.fileSize("/queue1.000"), BinaryFrame::requiredSize(12, PacketQueue::FRAME_VERSION));
+}
+
+TEST_F(PacketQueueTest, PushToAnotherPortFlushesStagedFrames)
+{
+    PacketQueue queue(storage, rtc);
+    ASSERT_TRUE(queue.begin());
+
+    const auto first = makePayload(1, 12);
+    const auto second = makePayload(2, 12);
+    ASSERT_TRUE(queue.push(PORT, first.data(), first.size()));
+    ASSERT_TRUE(queue.push(PORT + 1, second.data(), second.size()));
+
+    EXPECT_EQ(storage.fileSize("/queue1.000"), BinaryFrame::requiredSize(12, PacketQueue::FRAME_VERSION));
+    EXPECT_EQ(storage.fileSize("/queue2.000"), 0u);
+    EXPECT_FALSE(queue.isPortEmpty(PORT + 1));
+}
+
+TEST_F(PacketQueueTest, PendingCountersTrackPushAndPop)
+{
+    PacketQueue queue(storage, rtc);
+    ASSERT_TRUE(queue.begin());
+
+    for (uint8_t i = 0; i < 6; i++)
+    {
+        const auto payload = makePayload(i, 30);
+        ASSERT_TRUE(queue.push(PORT, payload.data(), payload.size()));
+    }
+    const auto other = makePayload(9, 10);
+    ASSERT_TRUE(queue.push(PORT + 1, other.data(), other.size()));
+
+    EXPECT_EQ(queue.countPending(PORT), 6u);
+    EXPECT_EQ(queue.size(PORT), 6 * BinaryFrame::requiredSize(30, PacketQueue::FRAME_VERSION));
+    EXPECT_EQ(queue.countPending(), 7u);
+
+    uint8_t out[64];
+    ASSERT_EQ(queue.popNext(PORT, out, sizeof(out)), 30u);
+    ASSERT_EQ(queue.peekNext(PORT, out, sizeof(out)), 30u);
+    ASSERT_TRUE(queue.skipToNextPacket(PORT));
+    EXPECT_EQ(queue.countPending(PORT), 4u);
+    EXPECT_EQ(queue.size(PORT), 4 * BinaryFrame::requiredSize(30, PacketQueue::FRAME_VERSION));
+
+    // Counters are rebuilt from the index after a restart
+    ASSERT_TRUE(queue.flush());
+    PacketQueue rebooted(storage, rtc);
+    ASSERT_TRUE(rebooted.begin());
+    EXPECT_EQ(rebooted.countPending(PORT), 4u);
+    EXPECT_EQ(rebooted.size(PORT), 4 * BinaryFrame::requiredSize(30, PacketQueue::FRAME_VERSION));
+    EXPECT_EQ(rebooted.countPending(), 5u);
+}
+
+TEST_F(PacketQueueTest, IndexedPeekReadsExactlyOneFrame)
+{
+    ReadTrackingStorageManager trackingStorage;
+    PacketQueue queue(trackingStorage, rtc);
+    ASSERT_TRUE(queue.begin());
+
+    const auto payload = makePayload(4, 25);
+    ASSERT_TRUE(queue.push(PORT, payload.data(), payload.size()));
+    ASSERT_TRUE(queue.push(PORT, payload.data(), payload.size()));
+
+    uint8_t out[64];
+    ASSERT_EQ(queue.peekNext(PORT, out, sizeof(out)), payload.size());
+    EXPECT_EQ(trackingStorage.lastRegionReadLength, BinaryFrame::requiredSize(25, PacketQueue::FRAME_VERSION));
+}
+
+TEST_F(PacketQueueTest, MappedStorageIsReadWithoutRegionCopies)
+{
+    ReadTrackingStorageManager trackingStorage;
+    trackingStorage.mapRegions = true;
+    PacketQueue queue(trackingStorage, rtc);
+    ASSERT_TRUE(queue.begin());
+
+    const auto first = makePayload(1, 25);
+    const auto second = makePayload(2, 40);
+    ASSERT_TRUE(queue.push(PORT, first.data(), first.size()));
+    ASSERT_TRUE(queue.push(PORT, second.data(), second.size()));
+
+    uint8_t out[64];
+    ASSERT_EQ(queue.popNext(PORT, out, sizeof(out)), first.size());
+    EXPECT_TRUE(std::equal(first.begin(), first.end(), out));
+    ASSERT_EQ(queue.popNext(PORT, out, sizeof(out)), second.size());
+    EXPECT_TRUE(std::equal(second.begin(), second.end(), out));
+    // Frames were unwrapped in place: no segment bytes were copied out with readFileRegionBytes()
+    EXPECT_EQ(trackingStorage.segmentRegionReads, 0u);
+}
+
+TEST_F(PacketQueueTest, MissingIndexRecordsAreRebuiltOnBegin)
+{
+    {
+        PacketQueue queue(storage, rtc);
+        ASSERT_TRUE(queue.begin());
+        for (uint8_t i = 0; i < 3; i++)
+        {
+            const auto payload = makePayload(i, 16);
+            ASSERT_TRUE(queue.push(PORT, payload.data(), payload.size()));
+        }
+        ASSERT_TRUE(queue.flush());
+    }
+    // Simula un reinicio entre el append del frame y el de su registro de índice
+    ASSERT_TRUE(storage.deleteFile("/qidx1.000"));
+
+    PacketQueue rebooted(storage, rtc);
+    ASSERT_TRUE(rebooted.begin());
+    EXPECT_EQ(rebooted.countPending(PORT), 3u);
+
+    uint8_t out[32];
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        const auto expected = makePayload(i, 16);
+        ASSERT_EQ(rebooted.popNext(PORT, out, sizeof(out)), expected.size());
+        EXPECT_EQ(std::vector<uint8_t>(out, out + expected.size()), expected);
+    }
+}
+
+TEST_F(PacketQueueTest, BeginNeverAsksTheSizeOfMissingFiles)
+{
+    ReadTrackingStorageManager trackingStorage;
+    {
+        PacketQueue queue(trackingStorage, rtc);
+        ASSERT_TRUE(queue.begin());
+        const auto payload = makePayload(0, 16);
+        ASSERT_TRUE(queue.push(PORT, payload.data(), payload.size()));
+        ASSERT_TRUE(queue.flush());
+    }
+    ASSERT_TRUE(trackingStorage.deleteFile("/qidx1.000"));
+
+    PacketQueue rebooted(trackingStorage, rtc);
+    ASSERT_TRUE(rebooted.begin());
+    EXPECT_EQ(rebooted.countPending(PORT), 1u);
+    EXPECT_EQ(trackingStorage.missingFileSizeQueries, 0u);
+}
+
+TEST_F(PacketQueueTest, PreallocatedSegmentsRecoverTheirLogicalEnd)
+{
+    storage.preallocation = true;
+    constexpr uint16_t payloadLen = 1000;
+    constexpr size_t framesPerSegment =
+        PacketQueue::SEGMENT_MAX_BYTES / BinaryFrame::requiredSize(payloadLen, PacketQueue::FRAME_VERSION);
+    constexpr size_t totalFrames = framesPerSegment + 2;
+    {
+        PacketQueue queue(storage, rtc);
+        ASSERT_TRUE(queue.begin());
+        for (size_t i = 0; i < totalFrames; i++)
+        {
+            const auto payload = makePayload(static_cast<uint8_t>(i), payloadLen);
+            ASSERT_TRUE(queue.push(PORT, payload.data(), payload.size()));
+        }
+        ASSERT_TRUE(queue.flush());
+    }
+    // Both segments span the whole extent: fileSize() no longer tells where the frames end
+    EXPECT_EQ(storage.fileSize("/queue1.000"), PacketQueue::SEGMENT_MAX_BYTES);
+    EXPECT_EQ(storage.fileSize("/queue1.001"), PacketQueue::SEGMENT_MAX_BYTES);
+
+    // Simula un reinicio antes de indexar el último frame del segmento de escritura
+    std::vector<uint8_t> index(storage.fileSize("/qidx1.001"));
+    ASSERT_EQ(storage.readFileBytes("/qidx1.001", index.data(), index.size()), index.size());
+    ASSERT_TRUE(storage.writeFileBytes("/qidx1.001", index.data(), index.size() - 10));
+
+    PacketQueue rebooted(storage, rtc);
+    ASSERT_TRUE(rebooted.begin());
+    EXPECT_EQ(rebooted.countPending(PORT), totalFrames);
+
+    // New frames go right after the recovered end, not after the preallocated tail
+    const auto extra = makePayload(0xEE, payloadLen);
+    ASSERT_TRUE(rebooted.push(PORT, extra.data(), extra.size()));
+    ASSERT_TRUE(rebooted.flush());
+
+    std::vector<uint8_t> out(payloadLen);
+    for (size_t i = 0; i < totalFrames; i++)
+    {
+        ASSERT_EQ(rebooted.popNext(PORT, out.data(), out.size()), payloadLen);
+        ASSERT_EQ(out, makePayload(static_cast<uint8_t>(i), payloadLen));
+    }
+    ASSERT_EQ(rebooted.popNext(PORT, out.data(), out.size()), payloadLen);
+    EXPECT_EQ(out, extra);
+    EXPECT_TRUE(rebooted.isPortEmpty(PORT));
+}
+
+TEST_F(PacketQueueTest, WorksWithoutFrameIndex)
+{
+    PacketQueueConfig config;
+    config.frameIndex = false;
+
+    {
+        PacketQueue queue(storage, rtc, config);
+        ASSERT_TRUE(queue.begin());
+        for (uint8_t i = 0; i < 3; i++)
+        {
+            const auto payload = makePayload(i, 16);
+            ASSERT_TRUE(queue.push(PORT, payload.data(), payload.size()));
+        }
+        ASSERT_TRUE(queue.flush());
+    }
+    EXPECT_FALSE(storage.exists("/qidx1.000"));
+
+    PacketQueue rebooted(storage, rtc, config);
+    ASSERT_TRUE(rebooted.begin());
+    EXPECT_EQ(rebooted.countPending(PORT), 3u);
+
+    uint8_t out[32];
+    ASSERT_EQ(rebooted.popNext(PORT, out, sizeof(out)), 16u);
+    EXPECT_EQ(rebooted.countPending(PORT), 2u);
+}
+
+TEST_F(PacketQueueTest, PeekBatchReturnsConsecutivePacketsWithoutConsuming)
+{
+    PacketQueue queue(storage, rtc);
+    ASSERT_TRUE(queue.begin());
+
+    for (uint8_t i = 0; i < 5; i++)
+    {
+        const auto payload = makePayload(i, 20 + i);
+        ASSERT_TRUE(queue.push(PORT, payload.data(), payload.size()));
+    }
+
+    uint8_t buffer[256];
+    BinaryFrame::FrameView views[PacketQueue::MAX_BATCH_FRAMES];
+    ASSERT_EQ(queue.peekBatch(PORT, buffer, sizeof(buffer), views, 3), 3u);
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        const auto expected = makePayload(i, 20 + i);
+        ASSERT_EQ(views[i].payloadLength, expected.size());
+        EXPECT_EQ(std::vector<uint8_t>(views[i].payload, views[i].payload + views[i].payloadLength), expected);
+    }
+    EXPECT_EQ(queue.countPending(PORT), 5u);
+
+    // Only the frames that fit completely in the buffer are returned
+    const size_t bufferSize = BinaryFrame::requiredSize(20, PacketQueue::FRAME_VERSION) + 10;
+    ASSERT_EQ(queue.peekBatch(PORT, buffer, bufferSize, views, 3), 1u);
+}
+
+TEST_F(PacketQueueTest, PeekBatchOfAnOversizedHeadFrameIsNotAnError)
+{
+    PacketQueue queue(storage, rtc);
+    ASSERT_TRUE(queue.begin());
+    const auto payload = makePayload(0, 300);
+    ASSERT_TRUE(queue.push(PORT, payload.data(), payload.size()));
+
+    InMemoryStorageManager logStorage;
+    Logger::initialize(nullptr, &logStorage, &rtc, "/LOG.TXT", Logger::Mode::SDCard);
+
+    // Legal frame, only larger than the batch buffer: the caller falls back to peekNext()
+    uint8_t buffer[256];
+    BinaryFrame::FrameView views[PacketQueue::MAX_BATCH_FRAMES];
+    EXPECT_EQ(queue.peekBatch(PORT, buffer, sizeof(buffer), views, PacketQueue::MAX_BATCH_FRAMES), 0u);
+    uint8_t out[512];
+    EXPECT_EQ(queue.peekNext(PORT, out, sizeof(out)), payload.size());
+
+    ASSERT_TRUE(Logger::flush());
+    std::vector<uint8_t> log(logStorage.fileSize("/LOG.TXT"));
+    log.resize(logStorage.readFileBytes("/LOG.TXT", log.data(), log.size()));
+    Logger::initialize(&display, nullptr, nullptr, "LOG.TXT", Logger::Mode::SerialOnly);
+    EXPECT_EQ(std::string(log.begin(), log.end()).find("ERROR"), std::string::npos);
+}
+
+TEST_F(PacketQueueTest, SkipPacketsConsumesPartOfBatchAndKeepsHeadPeeked)
+{
+    PacketQueue queue(storage, rtc);
+    ASSERT_TRUE(queue.begin());
+
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        const auto payload = makePayload(i, 12);
+        ASSERT_TRUE(queue.push(PORT, payload.data(), payload.size()));
+    }
+
+    uint8_t buffer[256];
+    BinaryFrame::FrameView views[PacketQueue::MAX_BATCH_FRAMES];
+    ASSERT_EQ(queue.peekBatch(PORT, buffer, sizeof(buffer), views, PacketQueue::MAX_BATCH_FRAMES), 4u);
+    ASSERT_TRUE(queue.skipPackets(PORT, 2));
+    EXPECT_EQ(queue.countPending(PORT), 2u);
+
+    // The third packet of the batch is now the peeked head
+    ASSERT_TRUE(queue.skipToNextPacket(PORT));
+    EXPECT_FALSE(queue.skipPackets(PORT, 2)); // Only one packet left in the batch
+
+    uint8_t out[32];
+    const auto expected = makePayload(3, 12);
+    ASSERT_EQ(queue.popNext(PORT, out, sizeof(out)), expected.size());
+    EXPECT_EQ(std::vector<uint8_t>(out, out + expected.size()), expected);
+    EXPECT_TRUE(queue.isPortEmpty(PORT));
+}
+
+TEST_F(PacketQueueTest, PopBatchConsumesAndPersists)
+{
+    PacketQueue queue(storage, rtc);
+    ASSERT_TRUE(queue.begin());
+
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        const auto payload = makePayload(i, 12);
+        ASSERT_TRUE(queue.push(PORT, payload.data(), payload.size()));
+    }
+
+    uint8_t buffer[256];
+    BinaryFrame::FrameView views[PacketQueue::MAX_BATCH_FRAMES];
+    ASSERT_EQ(queue.popBatch(PORT, buffer, sizeof(buffer), views, 2), 2u);
+    EXPECT_EQ(queue.countPending(PORT), 1u);
+
+    PacketQueue rebooted(storage, rtc);
+    ASSERT_TRUE(rebooted.begin());
+    uint8_t out[32];
+    const auto expected = makePayload(2, 12);
+    ASSERT_EQ(rebooted.popNext(PORT, out, sizeof(out)), expected.size());
+    EXPECT_EQ(std::vector<uint8_t>(out, out + expected.size()), expected);
+}
+
+TEST_F(PacketQueueTest, LegacyQueueFileIsRemovedOnBegin)
+{
+    const uint8_t legacy[] = {0x01, 0x02, 0x03};
+    ASSERT_TRUE(storage.writeFileBytes("/queue1", legacy, sizeof(legacy)));
+
+    PacketQueue queue(storage, rtc);
+    ASSERT_TRUE(queue.begin());
+
+    EXPECT_FALSE(storage.exists("/queue1"));
+    EXPECT_TRUE(storage.exists("/queue1.cur"));
+    EXPECT_TRUE(queue.isPortEmpty(PORT));
+}
+
+TEST_F(PacketQueueTest, ClearEmptiesPort)
+{
+    PacketQueue queue(storage, rtc);
+    ASSERT_TRUE(queue.begin());
+
+    const auto payload = makePayload(7, 32);
+    ASSERT_TRUE(queue.push(PORT, payload.data(), payload.size()));
+    ASSERT_TRUE(queue.clear(PORT));
+    EXPECT_TRUE(queue.isPortEmpty(PORT));
+
+    PacketQueue rebooted(storage, rtc);
+    ASSERT_TRUE(rebooted.begin());
+    EXPECT_TRUE(rebooted.isPortEmpty(PORT));
+}
+
+TEST_F(PacketQueueTest, HigherPriorityLaneIsServedFirst)
+{
+    PacketQueue queue(storage, rtc);
+    ASSERT_TRUE(queue.begin());
+
+    const auto bulk = makePayload(1, 16);
+    const auto report = makePayload(2, 16);
+    const auto control = makePayload(3, 16);
+    ASSERT_TRUE(queue.push(PORT, bulk.data(), bulk.size(), PacketQueue::Priority::Bulk));
+    ASSERT_TRUE(queue.push(PORT, report.data(), report.size(), PacketQueue::Priority::Report));
+    ASSERT_TRUE(queue.push(PORT, control.data(), control.size(), PacketQueue::Priority::Control));
+    EXPECT_EQ(queue.countPending(PORT), 3u);
+    EXPECT_EQ(queue.countPending(PORT, PacketQueue::Priority::Control), 1u);
+
+    uint8_t out[32];
+    for (const auto* expected : {&control, &report, &bulk})
+    {
+        ASSERT_EQ(queue.peekNext(PORT, out, sizeof(out)), expected->size());
+        EXPECT_EQ(std::vector<uint8_t>(out, out + expected->size()), *expected);
+        ASSERT_TRUE(queue.skipToNextPacket(PORT));
+    }
+    EXPECT_TRUE(queue.isPortEmpty(PORT));
+}
+
+TEST_F(PacketQueueTest, PeekAnyPrefersControlLaneOfLaterPort)
+{
+    PacketQueue queue(storage, rtc);
+    ASSERT_TRUE(queue.begin());
+
+    const auto bulk = makePayload(1, 16);
+    const auto control = makePayload(2, 16);
+    ASSERT_TRUE(queue.push(1, bulk.data(), bulk.size(), PacketQueue::Priority::Bulk));
+    ASSERT_TRUE(queue.push(2, control.data(), control.size(), PacketQueue::Priority::Control));
+
+    uint8_t out[32];
+    ASSERT_EQ(queue.popAny(out, sizeof(out)), control.size());
+    EXPECT_EQ(std::vector<uint8_t>(out, out + control.size()), control);
+    ASSERT_EQ(queue.popAny(out, sizeof(out)), bulk.size());
+    EXPECT_EQ(std::vector<uint8_t>(out, out + bulk.size()), bulk);
+}
+
+TEST_F(PacketQueueTest, AgingServesStarvedLowerLane)
+{
+    PacketQueue queue(storage, rtc);
+    ASSERT_TRUE(queue.begin());
+
+    const auto bulk = makePayload(0xB0, 8);
+    ASSERT_TRUE(queue.push(PORT, bulk.data(), bulk.size(), PacketQueue::Priority::Bulk));
+
+    // A steady stream of control packets must not hold the bulk packet back forever
+    uint8_t out[32];
+    size_t controlServed = 0;
+    bool bulkServed = false;
+    for (uint8_t i = 0; i < 2 * PacketQueue::LANE_AGING_THRESHOLD && !bulkServed; i++)
+    {
+        const auto control = makePayload(i, 8);
+        ASSERT_TRUE(queue.push(PORT, control.data(), control.size(), PacketQueue::Priority::Control));
+        ASSERT_EQ(queue.popNext(PORT, out, sizeof(out)), 8u);
+        if (out[0] == 0xB0)
+        {
+            bulkServed = true;
+        }
+        else
+        {
+            controlServed++;
+        }
+    }
+    EXPECT_TRUE(bulkServed);
+    EXPECT_EQ(controlServed, PacketQueue::LANE_AGING_THRESHOLD);
+}
+
+TEST_F(PacketQueueTest, LanesSurviveRestart)
+{
+    {
+        PacketQueue queue(storage, rtc);
+        ASSERT_TRUE(queue.begin());
+        const auto bulk = makePayload(1, 16);
+        const auto control = makePayload(2, 16);
+        ASSERT_TRUE(queue.push(PORT, bulk.data(), bulk.size(), PacketQueue::Priority::Bulk));
+        ASSERT_TRUE(queue.push(PORT, control.data(), control.size(), PacketQueue::Priority::Control));
+        ASSERT_TRUE(queue.flush());
+    }
+    EXPECT_TRUE(storage.exists("/queue1c.000"));
+    EXPECT_TRUE(storage.exists("/queue1c.cur"));
+
+    PacketQueue rebooted(storage, rtc);
+    ASSERT_TRUE(rebooted.begin());
+    EXPECT_EQ(rebooted.countPending(PORT, PacketQueue::Priority::Control), 1u);
+    EXPECT_EQ(rebooted.countPending(PORT, PacketQueue::Priority::Bulk), 1u);
+
+    uint8_t out[32];
+    ASSERT_EQ(rebooted.popNext(PORT, out, sizeof(out)), 16u);
+    EXPECT_EQ(out[0], 2);
+    ASSERT_EQ(rebooted.popNext(PORT, out, sizeof(out)), 16u);
+    EXPECT_EQ(out[0], 1);
+}
+
+TEST_F(PacketQueueTest, PriorityOfClassifiesPacketBody)
+{
+    // Hand-encoded CommunicationPacket: packetId = 1 (field 1, varint) followed by an empty body field
+    const uint8_t command[] = {0x08, 0x01, 0x1A, 0x00}; // field 3: command
+    const uint8_t report[] = {0x08, 0x01, 0x2A, 0x00}; // field 5: report
+    const uint8_t error[] = {0x08, 0x01, 0x32, 0x00}; // field 6: error
+    const uint8_t noBody[] = {0x08, 0x01};
+    const uint8_t garbage[] = {0xFF, 0xFF, 0xFF};
+
+    EXPECT_EQ(PacketQueue::priorityOf(command, sizeof(command)), PacketQueue::Priority::Control);
+    EXPECT_EQ(PacketQueue::priorityOf(error, sizeof(error)), PacketQueue::Priority::Control);
+    EXPECT_EQ(PacketQueue::priorityOf(report, sizeof(report)), PacketQueue::Priority::Report);
+    EXPECT_EQ(PacketQueue::priorityOf(noBody, sizeof(noBody)), PacketQueue::Priority::Bulk);
+    EXPECT_EQ(PacketQueue::priorityOf(garbage, sizeof(garbage)), PacketQueue::Priority::Bulk);
+}
+
+TEST_F(PacketQueueTest, CorruptFrameIsSkippedInsteadOfStallingPort)
+{
+    {
+        PacketQueue queue(storage, rtc);
+        ASSERT_TRUE(queue.begin());
+        for (uint8_t i = 0; i < 3; i++)
+        {
+            const auto payload = makePayload(i, 16);
+            ASSERT_TRUE(queue.push(PORT, payload.data(), payload.size()));
+        }
+        ASSERT_TRUE(queue.flush());
+    }
+
+    // Flip one payload byte of the second frame: its CRC no longer matches
+    constexpr size_t frameSize = BinaryFrame::requiredSize(16, PacketQueue::FRAME_VERSION);
+    uint8_t segment[3 * frameSize];
+    ASSERT_EQ(storage.readFileBytes("/queue1.000", segment, sizeof(segment)), sizeof(segment));
+    segment[frameSize + BinaryFrame::HEADER_SIZE + 3] ^= 0xFF;
+    ASSERT_TRUE(storage.writeFileBytes("/queue1.000", segment, sizeof(segment)));
+
+    PacketQueue rebooted(storage, rtc);
+    ASSERT_TRUE(rebooted.begin());
+
+    uint8_t out[32];
+    ASSERT_EQ(rebooted.popNext(PORT, out, sizeof(out)), 16u);
+    EXPECT_EQ(out[0], 0);
+    EXPECT_EQ(rebooted.popNext(PORT, out, sizeof(out)), 0u); // Corrupt frame: skipped
+    ASSERT_EQ(rebooted.popNext(PORT, out, sizeof(out)), 16u);
+    EXPECT_EQ(out[0], 2);
+    EXPECT_TRUE(rebooted.isPortEmpty(PORT));
+}
+
+TEST_F(PacketQueueTest, IndexStaysInSyncAfterSkippingSeveralCorruptFrames)
+{
+    ReadTrackingStorageManager trackingStorage;
+    {
+        PacketQueue queue(trackingStorage, rtc);
+        ASSERT_TRUE(queue.begin());
+        for (uint8_t i = 0; i < 5; i++)
+        {
+            const auto payload = makePayload(i, 16);
+            ASSERT_TRUE(queue.push(PORT, payload.data(), payload.size()));
+        }
+        ASSERT_TRUE(queue.flush());
+    }
+
+    // Frame 1 fails its CRC and frame 2 lost its start byte: both are skipped as one corrupt run
+    constexpr size_t frameSize = BinaryFrame::requiredSize(16, PacketQueue::FRAME_VERSION);
+    uint8_t segment[5 * frameSize];
+    ASSERT_EQ(trackingStorage.readFileBytes("/queue1.000", segment, sizeof(segment)), sizeof(segment));
+    segment[frameSize + BinaryFrame::HEADER_SIZE + 3] ^= 0xFF;
+    segment[2 * frameSize] = 0x00;
+    ASSERT_TRUE(trackingStorage.writeFileBytes("/queue1.000", segment, sizeof(segment)));
+
+    PacketQueue rebooted(trackingStorage, rtc);
+    ASSERT_TRUE(rebooted.begin());
+
+    uint8_t out[32];
+    ASSERT_EQ(rebooted.popNext(PORT, out, sizeof(out)), 16u);
+    EXPECT_EQ(rebooted.popNext(PORT, out, sizeof(out)), 0u); // Corrupt run: skipped
+
+    // The index points at frame 3 again: only its bytes are read
+    for (uint8_t expected = 3; expected < 5; expected++)
+    {
+        ASSERT_EQ(rebooted.popNext(PORT, out, sizeof(out)), 16u);
+        EXPECT_EQ(out[0], expected);
+        EXPECT_EQ(trackingStorage.lastRegionReadLength, frameSize);
+    }
+    EXPECT_TRUE(rebooted.isPortEmpty(PORT));
+}
+
+TEST_F(PacketQueueTest, ShortSegmentDoesNotStallThePort)
+{
+    ReadTrackingStorageManager trackingStorage;
+    PacketQueue queue(trackingStorage, rtc);
+    ASSERT_TRUE(queue.begin());
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        const auto payload = makePayload(i, 16);
+        ASSERT_TRUE(queue.push(PORT, payload.data(), payload.size()));
+    }
+    ASSERT_TRUE(queue.flush());
+
+    // The last two frames never reached the file (torn append, dropped deferred write)
+    constexpr size_t frameSize = BinaryFrame::requiredSize(16, PacketQueue::FRAME_VERSION);
+    uint8_t segment[frameSize];
+    ASSERT_EQ(trackingStorage.readFileBytes("/queue1.000", segment, sizeof(segment)), sizeof(segment));
+    ASSERT_TRUE(trackingStorage.writeFileBytes("/queue1.000", segment, sizeof(segment)));
+
+    uint8_t out[32];
+    ASSERT_EQ(queue.popNext(PORT, out, sizeof(out)), 16u);
+    EXPECT_EQ(queue.popNext(PORT, out, sizeof(out)), 0u); // Missing data: the cursor is clamped to the file end
+    EXPECT_TRUE(queue.isPortEmpty(PORT));
+    EXPECT_EQ(queue.countPending(PORT), 0u);
+
+    // New packets go after the real end and are read through the index again
+    const auto payload = makePayload(7, 16);
+    ASSERT_TRUE(queue.push(PORT, payload.data(), payload.size()));
+    ASSERT_TRUE(queue.flush());
+    ASSERT_EQ(queue.popNext(PORT, out, sizeof(out)), 16u);
+    EXPECT_EQ(out[0], 7);
+    EXPECT_EQ(trackingStorage.lastRegionReadLength, frameSize);
+    EXPECT_TRUE(queue.isPortEmpty(PORT));
+}
+
+TEST_F(PacketQueueTest, TornCursorSlotFallsBackToTheOtherOne)
+{
+    constexpr uint16_t payloadLen = 200;
+    constexpr size_t totalFrames = 200;
+
+    // Whichever slot the torn write hit, the other one still points at the unread packets
+    for (const char* tornSlot : {"/queue1.cur", "/queue1.cub"})
+    {
+        InMemoryStorageManager slotStorage;
+        {
+            PacketQueue queue(slotStorage, rtc);
+            ASSERT_TRUE(queue.begin());
+            for (size_t i = 0; i < totalFrames; i++)
+            {
+                const auto payload = makePayload(static_cast<uint8_t>(i), payloadLen);
+                ASSERT_TRUE(queue.push(PORT, payload.data(), payload.size()));
+            }
+            ASSERT_TRUE(queue.flush());
+            std::vector<uint8_t> out(payloadLen);
+            ASSERT_EQ(queue.popNext(PORT, out.data(), out.size()), payloadLen);
+            ASSERT_EQ(queue.popNext(PORT, out.data(), out.size()), payloadLen);
+        }
+        ASSERT_TRUE(slotStorage.exists("/queue1.002"));
+        ASSERT_TRUE(slotStorage.clearFile(tornSlot));
+
+        PacketQueue rebooted(slotStorage, rtc);
+        ASSERT_TRUE(rebooted.begin());
+        // The cursor of the last pop or of the one before it, not a rebuild from the start of the segments
+        const uint32_t pending = rebooted.countPending(PORT);
+        ASSERT_GE(pending, totalFrames - 2) << tornSlot;
+        ASSERT_LE(pending, totalFrames - 1) << tornSlot;
+
+        std::vector<uint8_t> out(payloadLen);
+        for (size_t i = totalFrames - pending; i < totalFrames; i++)
+        {
+            ASSERT_EQ(rebooted.popNext(PORT, out.data(), out.size()), payloadLen) << tornSlot;
+            ASSERT_EQ(out, makePayload(static_cast<uint8_t>(i), payloadLen)) << tornSlot;
+        }
+        EXPECT_TRUE(rebooted.isPortEmpty(PORT));
+    }
+}
+
+TEST_F(PacketQueueTest, LostCursorIsRebuiltFromTheSegments)
+{
+    constexpr uint16_t payloadLen = 200;
+    constexpr size_t totalFrames = 200;
+    {
+        PacketQueue queue(storage, rtc);
+        ASSERT_TRUE(queue.begin());
+        for (size_t i = 0; i < totalFrames; i++)
+        {
+            const auto payload = makePayload(static_cast<uint8_t>(i), payloadLen);
+            ASSERT_TRUE(queue.push(PORT, payload.data(), payload.size()));
+        }
+        ASSERT_TRUE(queue.flush());
+        std::vector<uint8_t> out(payloadLen);
+        ASSERT_EQ(queue.popNext(PORT, out.data(), out.size()), payloadLen);
+    }
+
+    // Both slots unreadable: one truncated, the other corrupted
+    ASSERT_TRUE(storage.clearFile("/queue1.cur"));
+    uint8_t slot[64];
+    const size_t slotLength = storage.readFileBytes("/queue1.cub", slot, sizeof(slot));
+    ASSERT_GT(slotLength, 8u);
+    slot[slotLength - 8] ^= 0xFF;
+    ASSERT_TRUE(storage.overwriteBytesToFile("/queue1.cub", slot, slotLength));
+
+    PacketQueue rebooted(storage, rtc);
+    ASSERT_TRUE(rebooted.begin());
+    EXPECT_TRUE(storage.exists("/queue1.001"));
+    EXPECT_TRUE(storage.exists("/queue1.002"));
+
+    // The read position is lost: the packet already popped comes again, none of the others is missing
+    ASSERT_EQ(rebooted.countPending(PORT), totalFrames);
+    std::vector<uint8_t> out(payloadLen);
+    for (size_t i = 0; i < totalFrames; i++)
+    {
+        ASSERT_EQ(rebooted.popNext(PORT, out.data(), out.size()), payloadLen);
+        ASSERT_EQ(out, makePayload(static_cast<uint8_t>(i), payloadLen));
+    }
+    EXPECT_TRUE(rebooted.isPortEmpty(PORT));
+
+    // The rebuilt cursor is persisted: the next boot resumes normally
+    PacketQueue again(storage, rtc);
+    ASSERT_TRUE(again.begin());
+    EXPECT_TRUE(again.isPortEmpty(PORT));
+}
+
+TEST_F(PacketQueueTest, CursorIsSyncedAsSoonAsItIsWritten)
+{
+    SyncTrackingStorageManager syncStorage;
+    PacketQueue queue(syncStorage, rtc);
+    ASSERT_TRUE(queue.begin());
+
+    const auto payload = makePayload(3, 16);
+    ASSERT_TRUE(queue.push(PORT, payload.data(), payload.size()));
+    syncStorage.syncedFiles.clear();
+
+    uint8_t out[32];
+    ASSERT_EQ(queue.popNext(PORT, out, sizeof(out)), 16u);
+    ASSERT_FALSE(syncStorage.syncedFiles.empty());
+    const std::string& synced = syncStorage.syncedFiles.back();
+    EXPECT_TRUE(synced == "/queue1.cur" || synced == "/queue1.cub") << synced;
+}
+
+TEST_F(PacketQueueTest, SyncPersistsOnlyAfterAppends)
+{
+    SyncTrackingStorageManager syncStorage;
+    PacketQueue queue(syncStorage, rtc);
+    ASSERT_TRUE(queue.begin());
+    ASSERT_TRUE(queue.sync());
+    EXPECT_EQ(syncStorage.syncs, 0u);
+
+    // Staged frames are still in RAM: nothing to persist yet
+    const auto payload = makePayload(4, 16);
+    ASSERT_TRUE(queue.push(PORT, payload.data(), payload.size()));
+    ASSERT_TRUE(queue.sync());
+    EXPECT_EQ(syncStorage.syncs, 0u);
+
+    ASSERT_TRUE(queue.flush());
+    ASSERT_TRUE(queue.sync());
+    EXPECT_EQ(syncStorage.syncs, 1u);
+    ASSERT_TRUE(queue.sync());
+    EXPECT_EQ(syncStorage.syncs, 1u);
+}
+
+TEST_F(PacketQueueTest, V1FramesFromOlderFirmwareAreStillRead)
+{
+    {
+        PacketQueue queue(storage, rtc);
+        ASSERT_TRUE(queue.begin());
+    }
+
+    // Segment written by a previous firmware (v1 frames, no CRC) and no index for it
+    const auto first = makePayload(1, 10);
+    const auto second = makePayload(2, 12);
+    uint8_t frames[BinaryFrame::requiredSize(10) + BinaryFrame::requiredSize(12)];
+    ASSERT_TRUE(BinaryFrame::wrapInPlace(frames, sizeof(frames), first.data(), first.size(), 0));
+    ASSERT_TRUE(BinaryFrame::wrapInPlace(frames + BinaryFrame::requiredSize(10), BinaryFrame::requiredSize(12),
+        second.data(), second.size(), 0));
+    ASSERT_TRUE(storage.writeFileBytes("/queue1.000", frames, sizeof(frames)));
+    ASSERT_TRUE(storage.clearFile("/qidx1.000"));
+
+    PacketQueue rebooted(storage, rtc);
+    ASSERT_TRUE(rebooted.begin());
+    EXPECT_EQ(rebooted.countPending(PORT), 2u);
+
+    uint8_t out[32];
+    ASSERT_EQ(rebooted.popNext(PORT, out, sizeof(out)), first.size());
+    EXPECT_EQ(std::vector<uint8_t>(out, out + first.size()), first);
+    ASSERT_EQ(rebooted.popNext(PORT, out, sizeof(out)), second.size());
+    EXPECT_EQ(std::vector<uint8_t>(out, out + second.size()), second);
+}
+
+TEST_F(PacketQueueTest, ExpiredPacketsAreSkippedWithoutReadingThem)
+{
+    PacketQueueConfig config;
+    config.ports[PORT].maxAgeSeconds = 3600;
+    ReadTrackingStorageManager trackingStorage;
+    PacketQueue queue(trackingStorage, rtc, config);
+    ASSERT_TRUE(queue.begin());
+
+    rtc.setEpoch(1'700'000'000);
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        const auto payload = makePayload(i, 40);
+        ASSERT_TRUE(queue.push(PORT, payload.data(), payload.size()));
+    }
+    ASSERT_TRUE(queue.flush());
+
+    rtc.setEpoch(1'700'000'000 + 2 * 3600);
+    const auto fresh = makePayload(9, 20);
+    ASSERT_TRUE(queue.push(PORT, fresh.data(), fresh.size()));
+
+    uint8_t out[64];
+    ASSERT_EQ(queue.popNext(PORT, out, sizeof(out)), fresh.size());
+    EXPECT_EQ(std::vector<uint8_t>(out, out + fresh.size()), fresh);
+    EXPECT_EQ(queue.getDropCounters(PORT).expired, 3u);
+    EXPECT_TRUE(queue.isPortEmpty(PORT));
+
+    // Only the fresh frame was read from the segment, the expired ones were resolved through the index
+    EXPECT_EQ(trackingStorage.lastRegionReadLength, BinaryFrame::requiredSize(20, PacketQueue::FRAME_VERSION));
+}
+
+TEST_F(PacketQueueTest, DropOldestEvictsLowestLaneFirst)
+{
+    constexpr size_t frameSize = BinaryFrame::requiredSize(16, PacketQueue::FRAME_VERSION);
+    PacketQueueConfig config;
+    config.ports[PORT].maxBytes = 3 * frameSize;
+    PacketQueue queue(storage, rtc, config);
+    ASSERT_TRUE(queue.begin());
+
+    const auto control = makePayload(1, 16);
+    const auto bulkOld = makePayload(2, 16);
+    const auto bulkNew = makePayload(3, 16);
+    const auto extra = makePayload(4, 16);
+    ASSERT_TRUE(queue.push(PORT, control.data(), control.size(), PacketQueue::Priority::Control));
+    ASSERT_TRUE(queue.push(PORT, bulkOld.data(), bulkOld.size(), PacketQueue::Priority::Bulk));
+    ASSERT_TRUE(queue.push(PORT, bulkNew.data(), bulkNew.size(), PacketQueue::Priority::Bulk));
+    ASSERT_TRUE(queue.push(PORT, extra.data(), extra.size(), PacketQueue::Priority::Report));
+
+    EXPECT_EQ(queue.size(PORT), 3 * frameSize);
+    EXPECT_EQ(queue.getDropCounters(PORT).evicted, 1u);
+
+    uint8_t out[32];
+    for (const auto* expected : {&control, &extra, &bulkNew})
+    {
+        ASSERT_EQ(queue.popNext(PORT, out, sizeof(out)), expected->size());
+        EXPECT_EQ(std::vector<uint8_t>(out, out + expected->size()), *expected);
+    }
+    EXPECT_TRUE(queue.isPortEmpty(PORT));
+}
+
+TEST_F(PacketQueueTest, RejectNewKeepsQueuedPackets)
+{
+    constexpr size_t frameSize = BinaryFrame::requiredSize(16, PacketQueue::FRAME_VERSION);
+    PacketQueueConfig config;
+    config.ports[PORT].maxBytes = 2 * frameSize;
+    config.ports[PORT].overflow = PacketQueuePortPolicy::Overflow::RejectNew;
+    PacketQueue queue(storage, rtc, config);
+    ASSERT_TRUE(queue.begin());
+
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        const auto payload = makePayload(i, 16);
+        ASSERT_TRUE(queue.push(PORT, payload.data(), payload.size()));
+    }
+    const auto rejected = makePayload(7, 16);
+    EXPECT_FALSE(queue.push(PORT, rejected.data(), rejected.size()));
+    EXPECT_EQ(queue.getDropCounters(PORT).rejected, 1u);
+    EXPECT_EQ(queue.countPending(PORT), 2u);
+
+    uint8_t out[32];
+    ASSERT_EQ(queue.popNext(PORT, out, sizeof(out)), 16u);
+    EXPECT_EQ(out[0], 0);
+}
@@ -0,0 +1,125 @@
+#ifndef UNIT_TESTING
+#define UNIT_TESTING
+#endif
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "Logger/Logger.h"
+#include <ConsoleDisplay/ConsoleDisplay.hpp>
+#include "PacketQueue/PacketQueue.hpp"
+#include "MockRTCController/MockRTCController.h"
+
+// ................. Common test resources ..................
+#include "../common_test_resources/InMemoryStorageManager.hpp"
+
+
+/**
+ * @brief InMemoryStorageManager que añade una latencia fija por operación de escritura,
+ *        imitando el open + esperas de estabilización + close de SDStorageManager.
+ */
+class SlowAppendStorageManager : public InMemoryStorageManager
+{
+public:
+    explicit SlowAppendStorageManager(const std::chrono::microseconds perWriteLatency)
+        : perWriteLatency_(perWriteLatency)
+    {
+    }
+
+    bool appendBytesToFile(const char* path, const uint8_t* data, const size_t length) override
+    {
+        if (std::strncmp(path, "/queue", 6) == 0)
+        {
+            appendCalls++; // Only frame appends, index appends are not counted
+        }
+        std::this_thread::sleep_for(perWriteLatency_);
+        return InMemoryStorageManager::appendBytesToFile(path, data, length);
+    }
+
+    bool appendBytesToFileV(const char* path, const IoVec* parts, const size_t count) override
+    {
+        if (std::strncmp(path, "/queue", 6) == 0)
+        {
+            appendCalls++;
+        }
+        std::this_thread::sleep_for(perWriteLatency_);
+        return InMemoryStorageManager::appendBytesToFileV(path, parts, count);
+    }
+
+    size_t appendCalls = 0;
+
+private:
+    std::chrono::microseconds perWriteLatency_;
+};
+
+
+// =====================================================================
+// Fixture para el benchmark de PacketQueue
+// =====================================================================
+class PacketQueueBenchmark : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        Logger::initialize(&display, nullptr, nullptr, "LOG.TXT", Logger::Mode::SerialOnly);
+    }
+
+    struct BurstResult
+    {
+        double packetsPerSecond;
+        size_t appendCalls;
+    };
+
+    // Pushes a burst of packets through the queue; when unstaged, every push is flushed immediately
+    BurstResult runBurst(const bool staged)
+    {
+        SlowAppendStorageManager storage(WRITE_LATENCY);
+        PacketQueue queue(storage, rtc);
+        EXPECT_TRUE(queue.begin());
+
+        const std::vector<uint8_t> payload(PAYLOAD_SIZE, 0x5A);
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < BURST_PACKETS; i++)
+        {
+            EXPECT_TRUE(queue.push(PORT, payload.data(), payload.size()));
+            if (!staged)
+            {
+                EXPECT_TRUE(queue.flush());
+            }
+        }
+        EXPECT_TRUE(queue.flush());
+        const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        return {static_cast<double>(BURST_PACKETS) / elapsed, storage.appendCalls};
+    }
+
+    static constexpr uint8_t PORT = 1;
+    static constexpr size_t BURST_PACKETS = 200;
+    static constexpr uint16_t PAYLOAD_SIZE = 48; // Typical serial frame from the Pi
+    static constexpr std::chrono::microseconds WRITE_LATENCY{500};
+
+    ConsoleDisplay display;
+    MockRTCController rtc;
+};
+
+// =====================================================================
+// TESTS
+// =====================================================================
+TEST_F(PacketQueueBenchmark, StagedBurstOutperformsPerPacketAppend)
+{
+    const auto direct = runBurst(false);
+    const auto staged = runBurst(true);
+
+    std::printf("[BENCH] PacketQueue burst of %zu x %u B (%lld us per append)\n",
+                BURST_PACKETS, PAYLOAD_SIZE, static_cast<long long>(WRITE_LATENCY.count()));
+    std::printf("[BENCH]   per-packet append : %10.1f pkt/s (%zu appends)\n", direct.packetsPerSecond,
+                direct.appendCalls);
+    std::printf("[BENCH]   staged (%zu B)   : %10.1f pkt/s (%zu appends)\n", PacketQueue::STAGING_BUFFER_SIZE,
+                staged.packetsPerSecond, staged.appendCalls);
+
+    EXPECT_EQ(direct.appendCalls, BURST_PACKETS);
+    EXPECT_LT(staged.appendCalls, direct.appendCalls / 4); // The rates above are printed, not asserted
+}
@@ -0,0 +1,85 @@
+#ifndef UNIT_TESTING
+#define UNIT_TESTING
+#endif
+
+#include <gtest/gtest.h>
+
+#include "RecentIdFilter/RecentIdFilter.hpp"
+
+
+// =====================================================================
+// TESTS
+// =====================================================================
+TEST(RecentIdFilterTest, DetectsRememberedPacketsAndCountsHitsAndMisses)
+{
+    RecentIdFilter filter;
+
+    EXPECT_FALSE(filter.isDuplicate(1, 100));
+    filter.remember(1, 100);
+    EXPECT_TRUE(filter.isDuplicate(1, 100));
+
+    // Same id from another sender is a different packet
+    EXPECT_FALSE(filter.isDuplicate(2, 100));
+
+    EXPECT_EQ(filter.getStats().hits, 1u);
+    EXPECT_EQ(filter.getStats().misses, 2u);
+}
+
+TEST(RecentIdFilterTest, RememberingTwiceKeepsOneEntry)
+{
+    RecentIdFilter filter;
+    filter.remember(1, 7);
+    filter.remember(1, 7);
+    EXPECT_EQ(filter.size(), 1u);
+}
+
+TEST(RecentIdFilterTest, ForgetsOldestWhenFull)
+{
+    RecentIdFilter filter;
+    for (uint32_t id = 1; id <= RecentIdFilter::CAPACITY + 5; id++)
+    {
+        filter.remember(3, id);
+    }
+    EXPECT_EQ(filter.size(), RecentIdFilter::CAPACITY);
+
+    for (uint32_t id = 1; id <= 5; id++)
+    {
+        EXPECT_FALSE(filter.isDuplicate(3, id)) << id;
+    }
+    for (uint32_t id = 6; id <= RecentIdFilter::CAPACITY + 5; id++)
+    {
+        EXPECT_TRUE(filter.isDuplicate(3, id)) << id;
+    }
+}
+
+TEST(RecentIdFilterTest, LookupsSurviveManyEvictionsWithCollidingKeys)
+{
+    // Long run over ids that share low bits: eviction must keep every probe chain reachable
+    RecentIdFilter filter;
+    for (uint32_t i = 0; i < 2000; i++)
+    {
+        const uint32_t id = i * RecentIdFilter::TABLE_SIZE;
+        const auto sender = static_cast<uint8_t>(i % 3);
+        ASSERT_FALSE(filter.isDuplicate(sender, id)) << i;
+        filter.remember(sender, id);
+
+        const uint32_t window = i + 1 < RecentIdFilter::CAPACITY ? i + 1 : RecentIdFilter::CAPACITY;
+        for (uint32_t back = 0; back < window; back++)
+        {
+            const uint32_t j = i - back;
+            ASSERT_TRUE(filter.isDuplicate(static_cast<uint8_t>(j % 3), j * RecentIdFilter::TABLE_SIZE)) << i;
+        }
+    }
+}
+
+TEST(RecentIdFilterTest, ClearForgetsEverything)
+{
+    RecentIdFilter filter;
+    filter.remember(1, 1);
+    filter.remember(1, 2);
+    filter.clear();
+    EXPECT_EQ(filter.size(), 0u);
+    EXPECT_FALSE(filter.isDuplicate(1, 1));
+    filter.remember(1, 1);
+    EXPECT_TRUE(filter.isDuplicate(1, 1));
+}
@@ -3,17 +3,38 @@
 #endif
 
 #include <gtest/gtest.h>
+#include <cstring>
 
 #include "Logger/Logger.h"
 #include <ConsoleDisplay/ConsoleDisplay.hpp>
 
 #include "Router.h"
+#include "MockRTCController/MockRTCController.h"
+#include "ProtoUtils/ProtoUtils.hpp"
+#include "SharedMemory/SharedMemory.hpp"
 
 #include "../common_test_resources/DummyPort.hpp"
+#include "../common_test_resources/InMemoryStorageManager.hpp"
 #include "../common_test_resources/PacketUtils.hpp"
 
 
 
+/**
+ * @brief DummyPort que, como SerialPort e IridiumPort, usa el buffer compartido de SharedMemory al enviar.
+ */
+class TmpBufferPort : public DummyPort
+{
+public:
+    using DummyPort::DummyPort;
+
+    bool send(const uint8_t* data, const size_t length) override
+    {
+        const bool ok = DummyPort::send(data, length);
+        std::memset(SharedMemory::tmpBuffer(), 0xEE, SharedMemory::tmpBufferSize());
+        return ok;
+    }
+};
+
 // ======================================================================
 // Fixture con logger
 // ======================================================================
@@ -23,9 +44,23 @@ protected:
     void SetUp() override
     {
         Logger::initialize(&display, nullptr, nullptr, "LOG.TXT", Logger::Mode::SerialOnly);
+        ASSERT_TRUE(queue.begin());
+    }
+
+    // Routed packet with a real id and TTL, like the ones the Router relays
+    static acousea_CommunicationPacket makeRoutedPacket(const uint32_t packetId, const uint8_t sender,
+                                                        const uint8_t receiver, const uint32_t ttl)
+    {
+        auto pkt = PacketUtils::makeRoutedPacket(sender, receiver);
+        pkt.packetId = packetId;
+        pkt.routing.ttl = ttl;
+        return pkt;
     }
 
     ConsoleDisplay display;
+    InMemoryStorageManager storage;
+    MockRTCController rtc;
+    PacketQueue queue{storage, rtc};
 };
 
 // ======================================================================
@@ -35,7 +70,7 @@ TEST_F(RouterTest, SendThroughSpecificPortWithSenderSetsRoutingSender)
 {
     DummyPort serial(IPort::PortType::SerialPort);
     DummyPort lora(IPort::PortType::LoraPort);
-    Router router({&serial, &lora});
+    Router router({&serial, &lora}, {}, queue);
 
     acousea_CommunicationPacket pkt = acousea_CommunicationPacket_init_default;
     pkt.which_body = acousea_CommunicationPacket_command_tag;
@@ -57,7 +92,7 @@ TEST_F(RouterTest, SendThroughSpecificPortWithSenderSetsRoutingSender)
 TEST_F(RouterTest, BroadcastUsesBroadcastSender)
 {
     DummyPort serial(IPort::PortType::SerialPort);
-    Router router({&serial});
+    Router router({&serial}, {}, queue);
 
     acousea_CommunicationPacket pkt = acousea_CommunicationPacket_init_default;
     pkt.which_body = acousea_CommunicationPacket_command_tag;
@@ -74,11 +109,11 @@ TEST_F(RouterTest, BroadcastUsesBroadcastSender)
     EXPECT_EQ(sent.routing.sender, Router::broadcastAddress);
 }
 
-TEST_F(RouterTest, ReadPortsGroupsByPortTypeAndFiltersReceiver)
+TEST_F(RouterTest, PeekNextPacketReturnsOnlyPacketsForThisNode)
 {
-    DummyPort serial(IPort::PortType::SerialPort);
-    DummyPort lora(IPort::PortType::LoraPort);
-    Router router({&serial, &lora});
+    DummyPort serial(IPort::PortType::SerialPort, &queue);
+    DummyPort lora(IPort::PortType::LoraPort, &queue);
+    Router router({&serial, &lora}, {}, queue);
 
     auto pktLocal = PacketUtils::makeRoutedPacket(10, 7);
     serial.enqueueRaw(PacketUtils::encodePacketTest(pktLocal));
@@ -89,25 +124,28 @@ TEST_F(RouterTest, ReadPortsGroupsByPortTypeAndFiltersReceiver)
     auto pktBcast = PacketUtils::makeRoutedPacket(12, Router::broadcastAddress);
     lora.enqueueRaw(PacketUtils::encodePacketTest(pktBcast));
 
-    auto result = router.readPorts(7);
-
-    ASSERT_EQ(result.count(IPort::PortType::SerialPort), 1u);
-    ASSERT_EQ(result.count(IPort::PortType::LoraPort), 1u);
+    ASSERT_TRUE(router.syncAllPorts());
 
-    EXPECT_EQ(result[IPort::PortType::SerialPort].size(), 1u);
-    EXPECT_EQ(result[IPort::PortType::LoraPort].size(), 1u);
+    auto next = router.peekNextPacket(7);
+    ASSERT_TRUE(next.has_value());
+    EXPECT_EQ(next->first, IPort::PortType::SerialPort);
+    EXPECT_EQ(next->second->routing.receiver, 7u);
+    ASSERT_TRUE(router.skipToNextPacket(IPort::PortType::SerialPort));
 
-    const auto& sPkt = result[IPort::PortType::SerialPort].front();
-    EXPECT_EQ(sPkt.routing.receiver, 7);
+    // The packet for 99 is not for this node: it is drained on the way to the broadcast one
+    next = router.peekNextPacket(7);
+    ASSERT_TRUE(next.has_value());
+    EXPECT_EQ(next->first, IPort::PortType::LoraPort);
+    EXPECT_EQ(next->second->routing.receiver, Router::broadcastAddress);
+    ASSERT_TRUE(router.skipToNextPacket(IPort::PortType::LoraPort));
 
-    const auto& lPkt = result[IPort::PortType::LoraPort].front();
-    EXPECT_EQ(lPkt.routing.receiver, Router::broadcastAddress);
+    EXPECT_FALSE(router.peekNextPacket(7).has_value());
 }
 
-TEST_F(RouterTest, ReadPortsSkipsPacketsWithoutRouting)
+TEST_F(RouterTest, PeekNextPacketSkipsPacketsWithoutRouting)
 {
-    DummyPort serial(IPort::PortType::SerialPort);
-    Router router({&serial});
+    DummyPort serial(IPort::PortType::SerialPort, &queue);
+    Router router({&serial}, {}, queue);
 
     acousea_CommunicationPacket pkt = acousea_CommunicationPacket_init_default;
     pkt.which_body = acousea_CommunicationPacket_command_tag;
@@ -116,24 +154,26 @@ TEST_F(RouterTest, ReadPortsSkipsPacketsWithoutRouting)
     pkt.body.command.command.setConfiguration = acousea_SetNodeConfigurationPayload_init_default;
 
     serial.enqueueRaw(PacketUtils::encodePacketTest(pkt));
+    ASSERT_TRUE(router.syncAllPorts());
 
-    auto result = router.readPorts(5);
-    EXPECT_TRUE(result.empty());
+    EXPECT_FALSE(router.peekNextPacket(5).has_value());
+    EXPECT_TRUE(queue.isPortEmpty(serial.getTypeU8()));
 }
 
-TEST_F(RouterTest, ReadPortsSkipsPacketsThatFailToDecode)
+TEST_F(RouterTest, PeekNextPacketSkipsPacketsThatFailToDecode)
 {
-    DummyPort serial(IPort::PortType::SerialPort);
-    Router router({&serial});
+    DummyPort serial(IPort::PortType::SerialPort, &queue);
+    Router router({&serial}, {}, queue);
     serial.enqueueRaw(std::vector<uint8_t>{0xFF, 0x00, 0xAA});
-    auto result = router.readPorts(1);
-    EXPECT_TRUE(result.empty());
+    ASSERT_TRUE(router.syncAllPorts());
+
+    EXPECT_FALSE(router.peekNextPacket(1).has_value());
 }
 
 TEST_F(RouterTest, SendFailsWhenPortTypeNotPresent)
 {
     DummyPort serial(IPort::PortType::SerialPort);
-    Router router({&serial});
+    Router router({&serial}, {}, queue);
 
     acousea_CommunicationPacket pkt = acousea_CommunicationPacket_init_default;
     pkt.which_body = acousea_CommunicationPacket_command_tag;
@@ -149,7 +189,7 @@ TEST_F(RouterTest, SendFailsWhenPortTypeNotPresent)
 TEST_F(RouterTest, SendAlwaysSetsHasRoutingTrue)
 {
     DummyPort sbd(IPort::PortType::SBDPort);
-    Router router({&sbd});
+    Router router({&sbd}, {}, queue);
 
     acousea_CommunicationPacket pkt = acousea_CommunicationPacket_init_default;
     pkt.which_body = acousea_CommunicationPacket_command_tag;
@@ -164,3 +204,241 @@ TEST_F(RouterTest, SendAlwaysSetsHasRoutingTrue)
     EXPECT_TRUE(sent.has_routing);
     EXPECT_EQ(sent.routing.sender, 3);
 }
+
+TEST_F(RouterTest, KnownRouteIsRelayedOnlyThroughItsPort)
+{
+    DummyPort serial(IPort::PortType::SerialPort);
+    DummyPort lora(IPort::PortType::LoraPort);
+    DummyPort sbd(IPort::PortType::SBDPort);
+    Router router({&serial, &lora, &sbd}, {IPort::PortType::LoraPort, IPort::PortType::SBDPort}, queue);
+    ASSERT_TRUE(router.addStaticRoute(7, IPort::PortType::LoraPort));
+
+    auto pkt = makeRoutedPacket(1, 9, 7, 3);
+    router.relayPacket(pkt);
+
+    EXPECT_EQ(lora.sentPackets.size(), 1u);
+    EXPECT_TRUE(sbd.sentPackets.empty());
+    EXPECT_TRUE(serial.sentPackets.empty());
+    EXPECT_EQ(router.getRelayStats().routed, 1u);
+    EXPECT_EQ(router.getRelayStats().flooded, 0u);
+}
+
+TEST_F(RouterTest, UnknownReceiverIsFloodedThroughRelayedPorts)
+{
+    DummyPort serial(IPort::PortType::SerialPort);
+    DummyPort lora(IPort::PortType::LoraPort);
+    DummyPort sbd(IPort::PortType::SBDPort);
+    Router router({&serial, &lora, &sbd}, {IPort::PortType::LoraPort, IPort::PortType::SBDPort}, queue);
+
+    auto pkt = makeRoutedPacket(1, 9, 7, 3);
+    router.relayPacket(pkt);
+    auto bcast = makeRoutedPacket(2, 9, Router::broadcastAddress, 3);
+    router.relayPacket(bcast);
+
+    EXPECT_EQ(lora.sentPackets.size(), 2u);
+    EXPECT_EQ(sbd.sentPackets.size(), 2u);
+    EXPECT_TRUE(serial.sentPackets.empty());
+    EXPECT_EQ(router.getRelayStats().routed, 0u);
+    EXPECT_EQ(router.getRelayStats().flooded, 2u);
+}
+
+TEST_F(RouterTest, RouteThroughAPortThatDoesNotRelayFallsBackToFlooding)
+{
+    DummyPort serial(IPort::PortType::SerialPort, &queue);
+    DummyPort lora(IPort::PortType::LoraPort);
+    DummyPort sbd(IPort::PortType::SBDPort);
+    Router router({&serial, &lora, &sbd}, {IPort::PortType::LoraPort, IPort::PortType::SBDPort}, queue);
+
+    // Address 7 is learned on the serial link, which is not a relayed port type
+    auto fromSeven = makeRoutedPacket(1, 7, 1, 3);
+    serial.enqueueRaw(PacketUtils::encodePacketTest(fromSeven));
+    ASSERT_TRUE(router.syncAllPorts());
+    ASSERT_TRUE(router.peekNextPacket(1).has_value());
+    ASSERT_TRUE(router.skipToNextPacket(IPort::PortType::SerialPort));
+
+    auto pkt = makeRoutedPacket(2, 9, 7, 3);
+    router.relayPacket(pkt);
+
+    EXPECT_TRUE(serial.sentPackets.empty());
+    EXPECT_EQ(lora.sentPackets.size(), 1u);
+    EXPECT_EQ(sbd.sentPackets.size(), 1u);
+    EXPECT_EQ(router.getRelayStats().routed, 0u);
+    EXPECT_EQ(router.getRelayStats().flooded, 1u);
+}
+
+TEST_F(RouterTest, LearnedRouteOnARelayedPortIsUsed)
+{
+    DummyPort lora(IPort::PortType::LoraPort, &queue);
+    DummyPort sbd(IPort::PortType::SBDPort);
+    Router router({&lora, &sbd}, {IPort::PortType::LoraPort, IPort::PortType::SBDPort}, queue);
+
+    auto fromSeven = makeRoutedPacket(1, 7, 1, 3);
+    lora.enqueueRaw(PacketUtils::encodePacketTest(fromSeven));
+    ASSERT_TRUE(router.syncAllPorts());
+    ASSERT_TRUE(router.peekNextPacket(1).has_value());
+    ASSERT_TRUE(router.skipToNextPacket(IPort::PortType::LoraPort));
+
+    auto pkt = makeRoutedPacket(2, 9, 7, 3);
+    router.relayPacket(pkt);
+
+    EXPECT_EQ(lora.sentPackets.size(), 1u);
+    EXPECT_TRUE(sbd.sentPackets.empty());
+    EXPECT_EQ(router.getRelayStats().routed, 1u);
+}
+
+TEST_F(RouterTest, SendSetsDefaultTtl)
+{
+    DummyPort lora(IPort::PortType::LoraPort);
+    Router router({&lora}, {}, queue);
+
+    auto pkt = PacketUtils::makeRoutedPacket(4, 1);
+    ASSERT_TRUE(router.from(3).through(IPort::PortType::LoraPort).send(pkt));
+    ASSERT_EQ(lora.sentPackets.size(), 1u);
+
+    const auto sent = PacketUtils::decodePacketTest(lora.sentPackets[0]);
+    EXPECT_EQ(sent.routing.ttl, Router::DEFAULT_TTL);
+}
+
+TEST_F(RouterTest, RelayDecrementsTtlOnTheForwardedBytes)
+{
+    DummyPort serial(IPort::PortType::SerialPort, &queue);
+    DummyPort lora(IPort::PortType::LoraPort);
+    Router router({&serial, &lora}, {IPort::PortType::LoraPort}, queue);
+
+    auto pkt = makeRoutedPacket(1, 9, 7, 5);
+    router.relayPacket(pkt);
+
+    // Received from a port: forwarded from the frame taken from the queue
+    serial.enqueueRaw(PacketUtils::encodePacketTest(makeRoutedPacket(2, 9, 7, 5)));
+    ASSERT_TRUE(router.syncAllPorts());
+    EXPECT_FALSE(router.peekNextPacket(1).has_value());
+
+    ASSERT_EQ(lora.sentPackets.size(), 2u);
+    EXPECT_EQ(PacketUtils::decodePacketTest(lora.sentPackets[0]).routing.ttl, 4u);
+    EXPECT_EQ(PacketUtils::decodePacketTest(lora.sentPackets[1]).routing.ttl, 4u);
+}
+
+TEST_F(RouterTest, MissingTtlIsTreatedAsDefault)
+{
+    DummyPort lora(IPort::PortType::LoraPort);
+    Router router({&lora}, {IPort::PortType::LoraPort}, queue);
+
+    auto pkt = makeRoutedPacket(1, 9, 7, 0);
+    router.relayPacket(pkt);
+
+    ASSERT_EQ(lora.sentPackets.size(), 1u);
+    EXPECT_EQ(PacketUtils::decodePacketTest(lora.sentPackets[0]).routing.ttl, Router::DEFAULT_TTL - 1u);
+    EXPECT_EQ(router.getRelayStats().ttlExpired, 0u);
+}
+
+TEST_F(RouterTest, PacketOnItsLastHopIsNotRelayed)
+{
+    DummyPort lora(IPort::PortType::LoraPort);
+    Router router({&lora}, {IPort::PortType::LoraPort}, queue);
+
+    auto lastHop = makeRoutedPacket(1, 9, 7, 1);
+    router.relayPacket(lastHop);
+    EXPECT_TRUE(lora.sentPackets.empty());
+    EXPECT_EQ(router.getRelayStats().ttlExpired, 1u);
+
+    // A copy that came through a shorter path still has hops left: the expired one did not mark it as relayed
+    auto sameWithHopsLeft = makeRoutedPacket(1, 9, 7, 3);
+    router.relayPacket(sameWithHopsLeft);
+    ASSERT_EQ(lora.sentPackets.size(), 1u);
+    EXPECT_EQ(PacketUtils::decodePacketTest(lora.sentPackets[0]).routing.ttl, 2u);
+    EXPECT_EQ(router.getRelayStats().loopsDropped, 0u);
+}
+
+TEST_F(RouterTest, SecondArrivalOfARelayedPacketIsDroppedAsLoop)
+{
+    DummyPort lora(IPort::PortType::LoraPort);
+    DummyPort sbd(IPort::PortType::SBDPort);
+    Router router({&lora, &sbd}, {IPort::PortType::LoraPort, IPort::PortType::SBDPort}, queue);
+
+    auto first = makeRoutedPacket(1, 9, 7, 4);
+    router.relayPacket(first);
+    auto back = makeRoutedPacket(1, 9, 7, 2);
+    router.relayPacket(back);
+
+    EXPECT_EQ(lora.sentPackets.size(), 1u);
+    EXPECT_EQ(sbd.sentPackets.size(), 1u);
+    EXPECT_EQ(router.getRelayStats().loopsDropped, 1u);
+
+    // Same id from another sender is another packet
+    auto other = makeRoutedPacket(1, 8, 7, 4);
+    router.relayPacket(other);
+    EXPECT_EQ(lora.sentPackets.size(), 2u);
+    EXPECT_EQ(router.getRelayStats().loopsDropped, 1u);
+}
+
+TEST_F(RouterTest, RelayedBytesSurvivePortsThatUseTheSharedBuffer)
+{
+    DummyPort serial(IPort::PortType::SerialPort, &queue);
+    TmpBufferPort sbd(IPort::PortType::SBDPort);
+    DummyPort lora(IPort::PortType::LoraPort);
+    Router router({&serial, &sbd, &lora}, {IPort::PortType::SBDPort, IPort::PortType::LoraPort}, queue);
+
+    // Encoded by the Router
+    auto pkt = makeRoutedPacket(1, 9, 7, 3);
+    router.relayPacket(pkt);
+
+    // Forwarded from the received frame
+    serial.enqueueRaw(PacketUtils::encodePacketTest(makeRoutedPacket(2, 9, 7, 5)));
+    ASSERT_TRUE(router.syncAllPorts());
+    EXPECT_FALSE(router.peekNextPacket(1).has_value());
+
+    ASSERT_EQ(sbd.sentPackets.size(), 2u);
+    ASSERT_EQ(lora.sentPackets.size(), 2u);
+    EXPECT_EQ(lora.sentPackets[0], sbd.sentPackets[0]);
+    EXPECT_EQ(lora.sentPackets[1], sbd.sentPackets[1]);
+    EXPECT_EQ(PacketUtils::decodePacketTest(lora.sentPackets[0]).routing.ttl, 2u);
+    EXPECT_EQ(PacketUtils::decodePacketTest(lora.sentPackets[1]).routing.ttl, 4u);
+    EXPECT_EQ(router.getRelayStats().reencoded, 1u);
+    EXPECT_EQ(router.getRelayStats().forwardedRaw, 1u);
+}
+
+TEST_F(RouterTest, PatchTtlRewritesTheEncodedPacket)
+{
+    auto raw = PacketUtils::encodePacketTest(makeRoutedPacket(1, 9, 7, 5));
+    ASSERT_TRUE(ProtoUtils::CommunicationPacket::patchTtlInPlace(raw.data(), raw.size(), 5, 4));
+
+    // Same bytes as encoding the packet with the new TTL
+    EXPECT_EQ(raw, PacketUtils::encodePacketTest(makeRoutedPacket(1, 9, 7, 4)));
+    const auto patched = PacketUtils::decodePacketTest(raw);
+    EXPECT_EQ(patched.packetId, 1u);
+    EXPECT_EQ(patched.routing.sender, 9u);
+    EXPECT_EQ(patched.routing.receiver, 7u);
+    EXPECT_EQ(patched.routing.ttl, 4u);
+    EXPECT_EQ(patched.which_body, acousea_CommunicationPacket_command_tag);
+}
+
+TEST_F(RouterTest, PatchTtlRefusesToChangeTheEncodedSize)
+{
+    // 128 takes two varint bytes and 127 one
+    auto raw = PacketUtils::encodePacketTest(makeRoutedPacket(1, 9, 7, 128));
+    const auto original = raw;
+    EXPECT_FALSE(ProtoUtils::CommunicationPacket::patchTtlInPlace(raw.data(), raw.size(), 128, 127));
+    EXPECT_EQ(raw, original);
+}
+
+TEST_F(RouterTest, PatchTtlNeedsTheExpectedTtl)
+{
+    // proto3 does not encode a 0: there is nothing to patch
+    auto absent = PacketUtils::encodePacketTest(makeRoutedPacket(1, 9, 7, 0));
+    EXPECT_FALSE(ProtoUtils::CommunicationPacket::patchTtlInPlace(absent.data(), absent.size(), 0, 4));
+
+    auto raw = PacketUtils::encodePacketTest(makeRoutedPacket(1, 9, 7, 5));
+    const auto original = raw;
+    EXPECT_FALSE(ProtoUtils::CommunicationPacket::patchTtlInPlace(raw.data(), raw.size(), 6, 5));
+    EXPECT_EQ(raw, original);
+}
+
+TEST_F(RouterTest, PatchTtlNeedsARoutingChunk)
+{
+    auto pkt = makeRoutedPacket(1, 9, 7, 5);
+    pkt.has_routing = false;
+    auto raw = PacketUtils::encodePacketTest(pkt);
+    const auto original = raw;
+    EXPECT_FALSE(ProtoUtils::CommunicationPacket::patchTtlInPlace(raw.data(), raw.size(), 5, 4));
+    EXPECT_EQ(raw, original);
+}
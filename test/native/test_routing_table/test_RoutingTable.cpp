@@ -0,0 +1,92 @@
+#ifndef UNIT_TESTING
+#define UNIT_TESTING
+#endif
+
+#include <gtest/gtest.h>
+
+#include "RoutingTable/RoutingTable.hpp"
+
+
+namespace
+{
+    // Valores de IPort::PortType (sin depender de los flags de plataforma)
+    constexpr uint8_t LORA = 2;
+    constexpr uint8_t SBD = 3;
+    constexpr uint8_t SERIAL = 4;
+}
+
+// =====================================================================
+// TESTS
+// =====================================================================
+TEST(RoutingTableTest, LearnsTheLastPortAnAddressWasHeardOn)
+{
+    RoutingTable table;
+    EXPECT_EQ(table.lookup(7, 100), 0u);
+
+    table.learn(7, LORA, 100);
+    EXPECT_EQ(table.lookup(7, 100), RoutingTable::portBit(LORA));
+
+    // The node moved: it is now heard through the serial link
+    table.learn(7, SERIAL, 200);
+    EXPECT_EQ(table.lookup(7, 200), RoutingTable::portBit(SERIAL));
+    EXPECT_EQ(table.size(), 1u);
+}
+
+TEST(RoutingTableTest, LearnedRoutesAge)
+{
+    RoutingTableConfig config;
+    config.maxAgeS = 60;
+    RoutingTable table(config);
+
+    table.learn(7, LORA, 1000);
+    EXPECT_EQ(table.lookup(7, 1059), RoutingTable::portBit(LORA));
+    EXPECT_EQ(table.lookup(7, 1060), 0u);
+
+    // Hearing it again refreshes the route
+    table.learn(7, LORA, 1100);
+    EXPECT_EQ(table.lookup(7, 1150), RoutingTable::portBit(LORA));
+}
+
+TEST(RoutingTableTest, StaticRoutesDoNotAgeAndCombineWithLearnedOnes)
+{
+    RoutingTableConfig config;
+    config.maxAgeS = 60;
+    RoutingTable table(config);
+
+    ASSERT_TRUE(table.addStatic(0, SBD));
+    table.learn(0, LORA, 10);
+    EXPECT_EQ(table.lookup(0, 20), RoutingTable::portBit(SBD) | RoutingTable::portBit(LORA));
+    EXPECT_EQ(table.lookup(0, 100000), RoutingTable::portBit(SBD));
+}
+
+TEST(RoutingTableTest, FullTableReplacesTheLeastRecentlyHeardAddress)
+{
+    RoutingTable table;
+    ASSERT_TRUE(table.addStatic(200, SBD));
+    for (uint8_t address = 1; address < RoutingTable::CAPACITY; address++)
+    {
+        table.learn(address, LORA, address); // Address 1 is the least recently heard
+    }
+    ASSERT_EQ(table.size(), RoutingTable::CAPACITY);
+
+    table.learn(100, SERIAL, 500);
+    EXPECT_EQ(table.size(), RoutingTable::CAPACITY);
+    EXPECT_EQ(table.lookup(1, 500), 0u);
+    EXPECT_EQ(table.lookup(2, 500), RoutingTable::portBit(LORA));
+    EXPECT_EQ(table.lookup(100, 500), RoutingTable::portBit(SERIAL));
+    EXPECT_EQ(table.lookup(200, 500), RoutingTable::portBit(SBD));
+}
+
+TEST(RoutingTableTest, StaticRoutesAreNeverEvicted)
+{
+    RoutingTable table;
+    for (uint8_t address = 0; address < RoutingTable::CAPACITY; address++)
+    {
+        ASSERT_TRUE(table.addStatic(address, SBD));
+    }
+    EXPECT_FALSE(table.addStatic(99, SBD));
+
+    table.learn(99, LORA, 10);
+    EXPECT_EQ(table.lookup(99, 10), 0u);
+    EXPECT_EQ(table.lookup(0, 10), RoutingTable::portBit(SBD));
+}
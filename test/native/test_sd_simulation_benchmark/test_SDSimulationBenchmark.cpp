@@ -0,0 +1,315 @@
+#ifndef UNIT_TESTING
+#define UNIT_TESTING
+#endif
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstring>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Logger/Logger.h"
+#include <ConsoleDisplay/ConsoleDisplay.hpp>
+#include "PacketQueue/PacketQueue.hpp"
+#include "ModuleProxy/ModuleProxy.hpp"
+#include "MockRTCController/MockRTCController.h"
+#include <Ports/Serial/MockSerialPort.h>
+#include "time/getMillis.hpp"
+
+// ................. Common test resources ..................
+#include "../common_test_resources/SimulatedSDStorageManager.hpp"
+
+
+// =====================================================================
+// Fixture: PacketQueue, ModuleProxy y Logger sobre una SD simulada (tiempo modelado, sin esperas)
+// =====================================================================
+class SDSimulationBenchmark : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        Logger::initialize(&display, nullptr, nullptr, "LOG.TXT", Logger::Mode::SerialOnly);
+    }
+
+    void TearDown() override
+    {
+        Logger::initialize(&display, nullptr, nullptr, "LOG.TXT", Logger::Mode::SerialOnly);
+    }
+
+    static std::vector<uint8_t> makePayload(const uint8_t seed, const uint16_t length)
+    {
+        std::vector<uint8_t> payload(length);
+        for (uint16_t i = 0; i < length; i++)
+        {
+            payload[i] = static_cast<uint8_t>(seed + i);
+        }
+        return payload;
+    }
+
+    // One operation cycle of the node: the Pi pushes a burst of packets and the router drains them
+    static uint64_t queueCycleUs(SimulatedSDStorageManager& sd, PacketQueue& queue)
+    {
+        sd.resetStats();
+        for (uint8_t i = 0; i < CYCLE_PACKETS; i++)
+        {
+            const auto payload = makePayload(i, PAYLOAD_SIZE);
+            EXPECT_TRUE(queue.push(PORT, payload.data(), payload.size()));
+        }
+        uint8_t out[PAYLOAD_SIZE];
+        for (uint8_t i = 0; i < CYCLE_PACKETS; i++)
+        {
+            EXPECT_EQ(queue.popNext(PORT, out, sizeof(out)), PAYLOAD_SIZE);
+        }
+        EXPECT_TRUE(sd.sync());
+        return sd.getStats().elapsedUs;
+    }
+
+    static constexpr uint8_t PORT = 1;
+    static constexpr uint8_t CYCLE_PACKETS = 8;
+    static constexpr uint16_t PAYLOAD_SIZE = 48;
+
+    ConsoleDisplay display;
+    MockRTCController rtc;
+};
+
+// =====================================================================
+// TESTS
+// =====================================================================
+TEST_F(SDSimulationBenchmark, QueueCycleWithCachedHandles)
+{
+    SimulatedSDConfig legacyConfig;
+    legacyConfig.cachedHandles = 0;
+    SimulatedSDStorageManager legacySd(legacyConfig);
+    PacketQueue legacyQueue(legacySd, rtc);
+    ASSERT_TRUE(legacyQueue.begin());
+
+    SimulatedSDStorageManager sd;
+    PacketQueue queue(sd, rtc);
+    ASSERT_TRUE(queue.begin());
+
+    const uint64_t legacyUs = queueCycleUs(legacySd, legacyQueue);
+    const unsigned long startMs = getMillis();
+    const uint64_t cachedUs = queueCycleUs(sd, queue);
+    const unsigned long clockMs = getMillis() - startMs;
+
+    std::printf("[BENCH] PacketQueue cycle (%u x %u B push + pop) on simulated SD\n", CYCLE_PACKETS, PAYLOAD_SIZE);
+    std::printf("[BENCH]   open/close per call : %8.1f ms (%u opens)\n", static_cast<double>(legacyUs) / 1000.0,
+                static_cast<unsigned int>(legacySd.getStats().opens));
+    std::printf("[BENCH]   cached handles      : %8.1f ms (%u opens, %u seeks)\n",
+                static_cast<double>(cachedUs) / 1000.0, static_cast<unsigned int>(sd.getStats().opens),
+                static_cast<unsigned int>(sd.getStats().seeks));
+
+    // The virtual clock advanced by the modelled time
+    EXPECT_GE(clockMs, cachedUs / 1000);
+    EXPECT_LT(cachedUs, legacyUs);
+    // Regression guard: one cycle must stay well below the 15 s operation period
+    EXPECT_LT(cachedUs, 500000u);
+}
+
+TEST_F(SDSimulationBenchmark, LoggerLinesOnSimulatedSd)
+{
+    SimulatedSDStorageManager sd;
+    Logger::initialize(&display, &sd, &rtc, "/log.txt", Logger::Mode::SDCard);
+
+    constexpr int LINES = 50;
+    for (int i = 0; i < LINES; i++)
+    {
+        LOG_INFO("Simulated log line %d with a typical payload of a few dozen characters", i);
+    }
+    ASSERT_TRUE(sd.sync());
+
+    const auto& stats = sd.getStats();
+    std::printf("[BENCH] Logger: %d lines -> %.2f ms per line (%u opens, %llu B)\n", LINES,
+                static_cast<double>(stats.elapsedUs) / 1000.0 / LINES, static_cast<unsigned int>(stats.opens),
+                static_cast<unsigned long long>(stats.bytesWritten));
+
+    EXPECT_GT(sd.fileSize("/log.txt"), 0u);
+    EXPECT_LE(stats.opens, 2u); // The log file handle stays cached
+}
+
+TEST_F(SDSimulationBenchmark, ModuleProxyStoreAndLoadOnSimulatedSd)
+{
+    SimulatedSDStorageManager sd;
+    PacketQueue queue(sd, rtc);
+    ASSERT_TRUE(queue.begin());
+    MockSerialPort serialPort;
+    Router router({&serialPort}, {}, queue);
+    const std::unordered_map<ModuleProxy::DeviceAlias, IPort::PortType> devicePortMap{
+        {ModuleProxy::DeviceAlias::PIDevice, IPort::PortType::SerialPort}
+    };
+    ModuleProxy proxy(router, devicePortMap, sd, rtc);
+    ASSERT_TRUE(proxy.begin());
+
+    acousea_ModuleWrapper wrapper = acousea_ModuleWrapper_init_default;
+    wrapper.which_module = acousea_ModuleWrapper_icListenHF_tag;
+    wrapper.module.icListenHF = acousea_ICListenHF_init_default;
+    std::strcpy(wrapper.module.icListenHF.serialNumber, "SIM123");
+    const auto code = static_cast<acousea_ModuleCode>(wrapper.which_module);
+
+    sd.resetStats();
+    ASSERT_TRUE(proxy.storeModule(wrapper));
+    const uint64_t storeUs = sd.getStats().elapsedUs;
+
+    sd.resetStats();
+    const acousea_ModuleWrapper* loaded = proxy.getIfFresh(code);
+    ASSERT_NE(loaded, nullptr);
+    EXPECT_STREQ(loaded->module.icListenHF.serialNumber, "SIM123");
+    const uint64_t loadUs = sd.getStats().elapsedUs;
+
+    std::printf("[BENCH] ModuleProxy on simulated SD: store %.1f ms, getIfFresh %.1f ms\n",
+                static_cast<double>(storeUs) / 1000.0, static_cast<double>(loadUs) / 1000.0);
+    EXPECT_LT(storeUs + loadUs, 100000u);
+}
+
+TEST_F(SDSimulationBenchmark, PreallocatedFileKeepsAppendCostFlat)
+{
+    constexpr size_t RECORD = 64;
+    constexpr size_t RECORDS = PacketQueue::SEGMENT_MAX_BYTES / RECORD;
+    const auto record = makePayload(7, RECORD);
+    const IoVec part{record.data(), record.size()};
+
+    // Cost of one record write at the start and at the end of the file
+    const auto firstAndLastUs = [&](SimulatedSDStorageManager& sd, const bool preallocated)
+    {
+        uint64_t firstUs = 0;
+        uint64_t lastUs = 0;
+        for (size_t i = 0; i < RECORDS; i++)
+        {
+            sd.resetStats();
+            EXPECT_TRUE(preallocated
+                ? sd.writeFileRegionV("/queue1.000", i * RECORD, &part, 1)
+                : sd.appendBytesToFileV("/queue1.000", &part, 1));
+            if (i == 0) firstUs = sd.getStats().elapsedUs;
+            lastUs = sd.getStats().elapsedUs;
+        }
+        return std::make_pair(firstUs, lastUs);
+    };
+
+    SimulatedSDStorageManager plainSd;
+    ASSERT_TRUE(plainSd.createEmptyFile("/queue1.000"));
+    const auto plain = firstAndLastUs(plainSd, false);
+
+    SimulatedSDStorageManager contiguousSd;
+    ASSERT_TRUE(contiguousSd.preallocateFile("/queue1.000", PacketQueue::SEGMENT_MAX_BYTES));
+    const auto contiguous = firstAndLastUs(contiguousSd, true);
+
+    std::printf("[BENCH] %u B record at the start / end of a %lu B file on simulated SD\n",
+                static_cast<unsigned int>(RECORD), static_cast<unsigned long>(PacketQueue::SEGMENT_MAX_BYTES));
+    std::printf("[BENCH]   fragmented (appends) : %6.1f / %6.1f ms\n", static_cast<double>(plain.first) / 1000.0,
+                static_cast<double>(plain.second) / 1000.0);
+    std::printf("[BENCH]   preallocated         : %6.1f / %6.1f ms\n",
+                static_cast<double>(contiguous.first) / 1000.0, static_cast<double>(contiguous.second) / 1000.0);
+
+    // Appends walk a longer FAT chain as the file grows; writes into the contiguous extent do not
+    EXPECT_GT(plain.second, plain.first);
+    EXPECT_EQ(contiguous.second, contiguous.first);
+    EXPECT_EQ(contiguousSd.getStats().fatLinks, 0u);
+}
+
+TEST_F(SDSimulationBenchmark, QueueSegmentFillWithPreallocation)
+{
+    SimulatedSDConfig plainConfig;
+    plainConfig.preallocation = false;
+    SimulatedSDStorageManager plainSd(plainConfig);
+    SimulatedSDStorageManager sd;
+
+    // Fill most of one segment with single-frame flushes (a quiet port: the staging buffer never fills)
+    const auto fillUs = [](SimulatedSDStorageManager& storage, PacketQueue& queue)
+    {
+        storage.resetStats();
+        for (uint16_t i = 0; i < 200; i++)
+        {
+            const auto payload = makePayload(static_cast<uint8_t>(i), PAYLOAD_SIZE);
+            EXPECT_TRUE(queue.push(PORT, payload.data(), payload.size()));
+            EXPECT_TRUE(queue.flush());
+        }
+        return storage.getStats().elapsedUs;
+    };
+
+    PacketQueue plainQueue(plainSd, rtc);
+    ASSERT_TRUE(plainQueue.begin());
+    const uint64_t plainUs = fillUs(plainSd, plainQueue);
+    {
+        PacketQueue queue(sd, rtc);
+        ASSERT_TRUE(queue.begin());
+        const uint64_t preallocatedUs = fillUs(sd, queue);
+        std::printf("[BENCH] 200 flushed pushes: appends %.1f ms, preallocated segment %.1f ms\n",
+                    static_cast<double>(plainUs) / 1000.0, static_cast<double>(preallocatedUs) / 1000.0);
+        EXPECT_LT(preallocatedUs, plainUs);
+    }
+
+    // After a reboot the logical end comes from the index, not from the size of the extent
+    PacketQueue rebooted(sd, rtc);
+    ASSERT_TRUE(rebooted.begin());
+    EXPECT_EQ(rebooted.countPending(PORT), 200u);
+    uint8_t out[PAYLOAD_SIZE];
+    for (uint16_t i = 0; i < 200; i++)
+    {
+        ASSERT_EQ(rebooted.popNext(PORT, out, sizeof(out)), PAYLOAD_SIZE);
+        ASSERT_EQ(out[0], static_cast<uint8_t>(i));
+    }
+    EXPECT_TRUE(rebooted.isPortEmpty(PORT));
+}
+
+TEST_F(SDSimulationBenchmark, TornWriteIsSkippedAfterReboot)
+{
+    SimulatedSDStorageManager sd;
+    {
+        PacketQueue queue(sd, rtc);
+        ASSERT_TRUE(queue.begin());
+        const auto first = makePayload(1, 16);
+        ASSERT_TRUE(queue.push(PORT, first.data(), first.size()));
+        ASSERT_TRUE(queue.flush());
+
+        // Power is lost halfway through the second frame
+        const auto second = makePayload(2, 16);
+        ASSERT_TRUE(queue.push(PORT, second.data(), second.size()));
+        sd.tearNextWrite(10);
+        EXPECT_FALSE(queue.flush());
+    }
+    EXPECT_EQ(sd.getStats().tornWrites, 1u);
+
+    PacketQueue rebooted(sd, rtc);
+    ASSERT_TRUE(rebooted.begin());
+    const auto third = makePayload(3, 16);
+    ASSERT_TRUE(rebooted.push(PORT, third.data(), third.size()));
+
+    uint8_t out[32];
+    ASSERT_EQ(rebooted.popNext(PORT, out, sizeof(out)), 16u);
+    EXPECT_EQ(out[0], 1);
+    uint16_t len = 0;
+    for (int attempt = 0; attempt < 3 && len == 0; attempt++)
+    {
+        len = rebooted.popNext(PORT, out, sizeof(out)); // The torn bytes are skipped, never returned
+    }
+    ASSERT_EQ(len, 16u);
+    EXPECT_EQ(out[0], 3);
+}
+
+TEST_F(SDSimulationBenchmark, ReadErrorDoesNotDropThePacket)
+{
+    // Without the index the only read of popNext() is the frame itself
+    PacketQueueConfig config;
+    config.frameIndex = false;
+    SimulatedSDStorageManager sd;
+    PacketQueue queue(sd, rtc, config);
+    ASSERT_TRUE(queue.begin());
+    for (uint8_t i = 1; i <= 2; i++)
+    {
+        const auto payload = makePayload(i, 16);
+        ASSERT_TRUE(queue.push(PORT, payload.data(), payload.size()));
+    }
+    ASSERT_TRUE(queue.flush());
+
+    uint8_t out[32];
+    sd.failNextReads(1);
+    EXPECT_EQ(queue.popNext(PORT, out, sizeof(out)), 0u);
+    EXPECT_EQ(sd.getStats().readErrors, 1u);
+
+    // A transient read error is not corruption: the same packet is read on the next attempt
+    ASSERT_EQ(queue.popNext(PORT, out, sizeof(out)), 16u);
+    EXPECT_EQ(out[0], 1);
+    ASSERT_EQ(queue.popNext(PORT, out, sizeof(out)), 16u);
+    EXPECT_EQ(out[0], 2);
+}
@@ -0,0 +1,100 @@
+#ifndef UNIT_TESTING
+#define UNIT_TESTING
+#endif
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "Logger/Logger.h"
+#include <ConsoleDisplay/ConsoleDisplay.hpp>
+#include "StorageManager/HDDStorageManager/HddStorageManager.hpp"
+#include "StorageManager/FdStorageManager/FdStorageManager.hpp"
+
+
+// =====================================================================
+// Fixture: appends del tamaño de un frame de la cola y lecturas de región
+// =====================================================================
+class StorageBenchmark : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        Logger::initialize(&display, nullptr, nullptr, "LOG.TXT", Logger::Mode::SerialOnly);
+        root = std::filesystem::temp_directory_path() / "acousea_storage_benchmark";
+        std::filesystem::remove_all(root);
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove_all(root);
+    }
+
+    struct Result
+    {
+        double appendsPerSecond;
+        double readsPerSecond;
+    };
+
+    static Result run(StorageManager& storage)
+    {
+        EXPECT_TRUE(storage.begin());
+        const std::vector<uint8_t> frame(FRAME_SIZE, 0x5A);
+
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < OPERATIONS; i++)
+        {
+            EXPECT_TRUE(storage.appendBytesToFile("/queue1.000", frame.data(), frame.size()));
+        }
+        const double appendSeconds = secondsSince(start);
+
+        std::vector<uint8_t> out(FRAME_SIZE);
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < OPERATIONS; i++)
+        {
+            const size_t offset = (i * 7919 % OPERATIONS) * FRAME_SIZE; // Scattered, like peeks of several ports
+            EXPECT_EQ(storage.readFileRegionBytes("/queue1.000", offset, out.data(), out.size()), FRAME_SIZE);
+        }
+        const double readSeconds = secondsSince(start);
+        EXPECT_TRUE(storage.sync());
+
+        return {OPERATIONS / appendSeconds, OPERATIONS / readSeconds};
+    }
+
+    static double secondsSince(const std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    static constexpr size_t OPERATIONS = 5000;
+    static constexpr size_t FRAME_SIZE = 80;
+
+    ConsoleDisplay display;
+    std::filesystem::path root;
+};
+
+// =====================================================================
+// TESTS
+// =====================================================================
+TEST_F(StorageBenchmark, FdBackendOutperformsStreams)
+{
+    HDDStorageManager streams((root / "streams").c_str());
+    const Result streamResult = run(streams);
+
+    FdStorageConfig config;
+    config.syncPolicy = FdStorageConfig::SyncPolicy::None; // Same durability as the stream backend
+    FdStorageManager fds((root / "fd").c_str(), config);
+    const Result fdResult = run(fds);
+
+    std::printf("[ INFO     ] streams: %.0f appends/s, %.0f reads/s\n",
+                streamResult.appendsPerSecond, streamResult.readsPerSecond);
+    std::printf("[ INFO     ] fd:      %.0f appends/s, %.0f reads/s\n",
+                fdResult.appendsPerSecond, fdResult.readsPerSecond);
+
+    // Throughput is only reported: wall-clock comparisons are noise on a loaded CI machine. What makes the fd
+    // backend faster is deterministic: every append and read reuses one cached descriptor
+    EXPECT_EQ(fds.getStats().opens, 1u);
+}
@@ -0,0 +1,105 @@
+#ifndef UNIT_TESTING
+#define UNIT_TESTING
+#endif
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <ctime>
+#include <string>
+
+#include "time/TimeService.hpp"
+#include "time/getMillis.hpp"
+#include "MockRTCController/MockRTCController.h"
+
+
+// =====================================================================
+// Fixture para el reloj común (monotónico + timestamp cacheado)
+// =====================================================================
+class TimeServiceTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        rtc.setEpoch(1700000000);
+        TimeService::attach(&rtc);
+    }
+
+    void TearDown() override
+    {
+        TimeService::attach(nullptr);
+    }
+
+    void setEpoch(const uint32_t epoch)
+    {
+        rtc.setEpoch(epoch);
+        TimeService::resync();
+    }
+
+    static std::string expected(const uint32_t epoch)
+    {
+        const time_t value = epoch;
+        const tm t = *gmtime(&value);
+        char text[32];
+        snprintf(text, sizeof(text), "%04d-%02d-%02d %02d:%02d:%02d",
+                 t.tm_year + 1900, t.tm_mon + 1, t.tm_mday, t.tm_hour, t.tm_min, t.tm_sec);
+        return text;
+    }
+
+    MockRTCController rtc;
+};
+
+// =====================================================================
+// TESTS
+// =====================================================================
+TEST_F(TimeServiceTest, TimestampMatchesCalendar)
+{
+    // Cambios de día, mes y año, 29 de febrero (2000 y 2024 bisiestos, 2100 no) y el final de uint32_t
+    const uint32_t epochs[] = {0, 59, 86399, 86400, 951782399, 951868800, 1709164800, 1735689599, 1735689600,
+                               1762778934, 4107542400u, 4294967295u};
+    for (const uint32_t epoch : epochs)
+    {
+        setEpoch(epoch);
+        EXPECT_EQ(TimeService::timestamp(), expected(epoch)) << epoch;
+    }
+}
+
+TEST_F(TimeServiceTest, IncrementalUpdatesFollowTheClock)
+{
+    // Segundo a segundo a través de una medianoche de fin de año: solo cambian los campos necesarios
+    const uint32_t start = 1735689600 - 90;
+    setEpoch(start);
+    for (uint32_t i = 0; i < 180; i++)
+    {
+        ASSERT_EQ(TimeService::timestamp(), expected(start + i)) << i;
+        advanceClockMicros(1000UL * 1000UL);
+    }
+}
+
+TEST_F(TimeServiceTest, EpochIsAnchoredUntilResync)
+{
+    advanceClockMicros(5UL * 1000UL * 1000UL);
+    EXPECT_EQ(TimeService::epoch(), 1700000005u);
+
+    // El RTC solo se vuelve a leer con resync() o pasado RESYNC_INTERVAL_MS
+    rtc.setEpoch(1800000000);
+    EXPECT_EQ(TimeService::epoch(), 1700000005u);
+    advanceClockMicros(TimeService::RESYNC_INTERVAL_MS * 1000UL);
+    EXPECT_EQ(TimeService::epoch(), 1800000000u + TimeService::RESYNC_INTERVAL_MS / 1000);
+}
+
+TEST_F(TimeServiceTest, MonotonicMillisSurvivesTheMillisWrap)
+{
+    // En el MCU getMillis() es de 32 bits: da la vuelta cada ~49.7 días
+    const uint64_t start = TimeService::monotonicMillis();
+    constexpr unsigned long HALF_WRAP_MS = 1UL << 31;
+    uint64_t previous = start;
+    for (int i = 0; i < 5; i++)
+    {
+        for (int ms = 0; ms < 1000; ms++) advanceClockMicros(HALF_WRAP_MS); // HALF_WRAP_MS ms sin desbordar long
+        const uint64_t now = TimeService::monotonicMillis();
+        EXPECT_GE(now - previous, static_cast<uint64_t>(HALF_WRAP_MS));
+        previous = now;
+    }
+    EXPECT_GE(previous - start, 5ULL * HALF_WRAP_MS);
+    EXPECT_GT(previous, 0xFFFFFFFFULL);
+}